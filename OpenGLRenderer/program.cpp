@@ -9,6 +9,8 @@
 #define TINYOBJLOADER_IMPLEMENTATION
 
 #include <string>
+#include <cstdlib>
+#include <ctime>
 #include <iostream>
 
 #include <glad/glad.h>
@@ -20,6 +22,9 @@
 
 #include "sources/application.h"
 #include "sources/utils/debug.h"
+#include "sources/utils/profiler.h"
+#include "sources/utils/dev/benchmark_runner.h"
+#include "sources/utils/dev/self_test.h"
 
 // Global variables.
 int SCREEN_WIDTH = 1600;
@@ -65,8 +70,50 @@ static void showFramesPerSecond(GLFWwindow* window)
 	}
 }
 
-int main()
+int main(int argc, char** argv)
 {
+	// "--selftest" runs the self tests (no window) and exits with their result.
+	for (int i = 1; i < argc; i++)
+	{
+		if (std::string(argv[i]) == "--selftest")
+		{
+			return runSelfTests();
+		}
+	}
+
+	// "--benchmark" runs every scene along a camera path in a hidden window and exits (see "BenchmarkOptions").
+	BenchmarkOptions benchmarkOptions;
+
+	if (parseBenchmarkOptions(argc, argv, benchmarkOptions))
+	{
+		PROFILE_THREAD_NAME("Main");
+
+		return runBenchmark(benchmarkOptions);
+	}
+
+	// "--trace <file>" saves a CPU trace of the last frames when the program exits.
+	const char* traceFilepath = nullptr;
+
+	for (int i = 1; i < argc; i++)
+	{
+		if (std::string(argv[i]) == "--trace" && i + 1 < argc)
+		{
+			traceFilepath = argv[++i];
+		}
+	}
+
+#ifndef ENABLE_PROFILER
+	if (traceFilepath != nullptr)
+	{
+		std::cout << "[WARNING] PROGRAM: Built without \"ENABLE_PROFILER\", no trace will be saved." << std::endl;
+	}
+#endif
+
+	PROFILE_THREAD_NAME("Main");
+
+	// The benchmark seeds every scene setup instead, so its runs are deterministic.
+	std::srand(unsigned(std::time(NULL)));
+
 	if (!glfwInit())
 	{
 		std::cout << "Failed to initialize GLFW!" << std::endl;
@@ -151,6 +198,8 @@ int main()
 
 	while (!glfwWindowShouldClose(window))
 	{
+		PROFILE_FRAME();
+
 		float currTime = float(glfwGetTime());
 
 		DELTA_TIME = currTime - LAST_FRAME;
@@ -169,6 +218,13 @@ int main()
 		glfwSwapBuffers(window);
 	}
 
+#ifdef ENABLE_PROFILER
+	if (traceFilepath != nullptr)
+	{
+		Profiler::dumpTrace(traceFilepath);
+	}
+#endif
+
 	app.clean();
 
 	ImGui_ImplOpenGL3_Shutdown();
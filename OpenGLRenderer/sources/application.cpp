@@ -10,43 +10,15 @@ Application::Application(int screenWidth, int screenHeight)
 
 void Application::setup()
 {
-	switch (currSceneType)
-	{
-	case SceneTypes::INSTANCING:
-		currScene = new InstancingScene();
-		break;
-
-	case SceneTypes::FRUSTUM_CULLING:
-		currScene = new FrustumCullingScene();
-		break;
-
-	case SceneTypes::GRASS:
-		currScene = new GrassScene();
-		break;
-	
-	case SceneTypes::PARTICLES:
-		currScene = new ParticlesScene();
-		break;
-
-	case SceneTypes::SKELETAL_ANIMATION:
-		currScene = new SkeletalAnimationScene();
-		break;
+	// Workers must exist before the scenes, they are used while loading.
+	JobSystem::setup();
 
-	case SceneTypes::WATER:
-		currScene = new WaterScene();
-		break;
-
-	case SceneTypes::TESSELLATION:
-		currScene = new TessellationScene();
-		break;
-
-	default:
-		std::cout << "Scene not found!" << std::endl;
-		break;
-	}
+	currScene = createScene(currSceneType);
 
 	if (currScene != nullptr)
 	{
+		PROFILE_ZONE("Scene::setup");
+
 		currScene->setup();
 	}
 }
@@ -59,57 +31,68 @@ void Application::clean()
 
 		delete currScene;
 	}
+
+	JobSystem::clean();
+	GPUTimer::clean();
 }
 
 void Application::update(float deltaTime)
 {
+	PROFILE_ZONE("Application::update");
+
 	if (currScene != nullptr)
 	{
 		if (lastSceneType != currSceneType)
 		{
 			currScene->clean();
 
-			switch (currSceneType)
+			delete currScene;
+
+			currScene = createScene(currSceneType);
+
 			{
-			case SceneTypes::INSTANCING:
-				currScene = new InstancingScene();
-				break;
+				PROFILE_ZONE("Scene::setup");
 
-			case SceneTypes::FRUSTUM_CULLING:
-				currScene = new FrustumCullingScene();
-				break;
+				currScene->setup();
+			}
 
-			case SceneTypes::GRASS:
-				currScene = new GrassScene();
-				break;
+			lastSceneType = currSceneType;
+		}
 
-			case SceneTypes::PARTICLES:
-				currScene = new ParticlesScene();
-				break;
+		PROFILE_ZONE("Scene::update");
 
-			case SceneTypes::SKELETAL_ANIMATION:
-				currScene = new SkeletalAnimationScene();
-				break;
+		currScene->update(deltaTime);
+	}
+}
 
-			case SceneTypes::WATER:
-				currScene = new WaterScene();
-				break;
+Scene* Application::createScene(SceneTypes type)
+{
+	switch (type)
+	{
+	case SceneTypes::INSTANCING:
+		return new InstancingScene();
 
-			case SceneTypes::TESSELLATION:
-				currScene = new TessellationScene();
-				break;
+	case SceneTypes::FRUSTUM_CULLING:
+		return new FrustumCullingScene();
 
-			default:
-				std::cout << "Scene not found!" << std::endl;
-				break;
-			}
+	case SceneTypes::GRASS:
+		return new GrassScene();
 
-			currScene->setup();
+	case SceneTypes::PARTICLES:
+		return new ParticlesScene();
 
-			lastSceneType = currSceneType;
-		}
+	case SceneTypes::SKELETAL_ANIMATION:
+		return new SkeletalAnimationScene();
 
-		currScene->update(deltaTime);
+	case SceneTypes::WATER:
+		return new WaterScene();
+
+	case SceneTypes::TESSELLATION:
+		return new TessellationScene();
+
+	default:
+		std::cout << "Scene not found!" << std::endl;
+		return nullptr;
 	}
 }
 
@@ -147,18 +130,40 @@ void Application::processInput(float deltaTime)
 
 		keyboardProcessedState[GLFW_KEY_LEFT_CONTROL] = true;
 	}
+
+#ifdef ENABLE_PROFILER
+	if (keyboardState[GLFW_KEY_F9] && !keyboardProcessedState[GLFW_KEY_F9])
+	{
+		Profiler::dumpTrace("profiler_trace.json");
+
+		keyboardProcessedState[GLFW_KEY_F9] = true;
+	}
+#endif
 }
 
 void Application::render(float deltaTime)
 {
+	PROFILE_ZONE("Application::render");
+
+	GLState::beginFrame();
+	GPUTimer::beginFrame();
+
 	if (currScene != nullptr)
 	{
+		PROFILE_ZONE("Scene::render");
+
+		GPUTimer::begin("Scene");
+
 		currScene->render(camera, deltaTime);
+
+		GPUTimer::end();
 	}
 }
 
 void Application::processGUI(const ImGuiIO& io)
 {
+	PROFILE_ZONE("Application::processGUI");
+
 	ImGui_ImplOpenGL3_NewFrame();
 	ImGui_ImplGlfw_NewFrame();
 
@@ -169,6 +174,7 @@ void Application::processGUI(const ImGuiIO& io)
 	ImGui::Begin("Debug Dialog", &dialogOpen, ImGuiWindowFlags_MenuBar);
 
 	ImGui::Text("%.2f ms/frame (%.1f FPS)", 1000.0f / io.Framerate, io.Framerate);
+	ImGui::Text("GL state calls: %u issued / %u elided", GLState::getIssuedCalls(), GLState::getElidedCalls());
 
 	if (ImGui::BeginMenuBar())
 	{
@@ -215,10 +221,49 @@ void Application::processGUI(const ImGuiIO& io)
 		ImGui::EndMenuBar();
 	}
 
+	// Results are a few frames old, see "GPUTimer::FRAME_LATENCY".
+	if (ImGui::CollapsingHeader("GPU Timers", ImGuiTreeNodeFlags_DefaultOpen))
+	{
+		if (ImGui::BeginTable("GPU Timers Table", 3, ImGuiTableFlags_RowBg | ImGuiTableFlags_BordersInnerV))
+		{
+			ImGui::TableSetupColumn("Pass");
+			ImGui::TableSetupColumn("Last (ms)");
+			ImGui::TableSetupColumn("Average (ms)");
+			ImGui::TableHeadersRow();
+
+			for (const GPUTimer::Timer& timer : GPUTimer::getTimers())
+			{
+				if (timer.lastFrame != GPUTimer::getResolvedFrame())
+				{
+					continue;
+				}
+
+				ImGui::TableNextRow();
+
+				ImGui::TableNextColumn();
+				ImGui::Text("%*s%s", int(2 * timer.depth), "", timer.name.c_str());
+
+				ImGui::TableNextColumn();
+				ImGui::Text("%.3f", timer.lastTime);
+
+				ImGui::TableNextColumn();
+				ImGui::Text("%.3f", timer.averageTime);
+			}
+
+			ImGui::EndTable();
+		}
+
+		ImGui::Text("Dropped frames: %u", GPUTimer::getDroppedFrames());
+	}
+
 	ImGui::Text("Mouse to rotare the camera.");
 	ImGui::Text("W/S/A/D and Q/E to move.");
 	ImGui::Text("LEFT CTRL to unlock/lock the cursor.");
 
+#ifdef ENABLE_PROFILER
+	ImGui::Text("F9 to save a CPU trace of the last %u frames.", Profiler::MAX_FRAMES);
+#endif
+
 	ImGui::End();
 
 	if (currScene != nullptr)
@@ -12,6 +12,10 @@
 #include "camera.h"
 #include "scene.h"
 
+#include "systems/job_system.h"
+#include "utils/gpu_timer.h"
+#include "utils/profiler.h"
+
 #include "scenes/instancing_scene.h"
 #include "scenes/frustum_culling_scene.h"
 #include "scenes/grass_scene.h"
@@ -41,6 +45,9 @@ public:
 
 	void setMousePosition(float x, float y);
 
+	// Returns nullptr for unknown types. The scene is not set up.
+	static Scene* createScene(SceneTypes type);
+
 private:
 	int screenWidth, screenHeight;
 
@@ -1,51 +1,52 @@
 #include "entity.h"
+#include "systems/entity_pool.h"
 
-Entity::Entity(BasicModel* model)
-	: model(model)
+static constexpr UniformName MODEL_MATRIX_UNIFORM("uModelMatrix");
+
+Entity::Entity(EntityPool* pool, TransformHierarchy* hierarchy, Entity* parent, BasicModel* model)
+	: transform(hierarchy, hierarchy->createNode(parent ? parent->transform.getIndex() : TransformHierarchy::INVALID_INDEX)), parent(parent), model(model), pool(pool)
 {
-	boundingVolume = std::make_unique<Sphere>(model);
+	boundingVolume = new (&volumeStorage) Sphere(model);
 }
 
-void Entity::updateSelfAndChildren(bool forced)
+Entity::~Entity()
 {
-	if (forced)
-	{
-		if (parent)
-		{
-			transform.computeModelMatrix(parent->transform.getModelMatrix());
-		}
-		else
-		{
-			transform.computeModelMatrix();
-		}
-
-		for (std::unique_ptr<Entity>& child : children)
-		{
-			child->updateSelfAndChildren();
-		}
-	}
-	else
+	boundingVolume->~BoundingVolume();
+}
+
+void Entity::setBoundingVolumeType(BoundingVolumeType type)
+{
+	boundingVolume->~BoundingVolume();
+
+	switch (type)
 	{
-		if (transform.isDirty())
-		{
-			updateSelfAndChildren(true); // Forced update.
-		}
-		else
-		{
-			for (std::unique_ptr<Entity>& child : children)
-			{
-				child->updateSelfAndChildren();
-			}
-		}
+	case BoundingVolumeType::AABB:
+		boundingVolume = new (&volumeStorage) AABB(model);
+
+		break;
+
+	case BoundingVolumeType::OBB:
+		boundingVolume = new (&volumeStorage) OBB(model);
+
+		break;
+
+	default:
+		boundingVolume = new (&volumeStorage) Sphere(model);
+
+		break;
 	}
+}
 
+Entity* Entity::addChild(BasicModel* model)
+{
+	return pool->create(transform.getHierarchy(), this, model);
 }
 
 void Entity::renderSelfAndChildren(ShaderProgram* shader, const Frustum& frustum, uint32_t& display, uint32_t& total)
 {
 	if (boundingVolume->isOnFrustum(frustum, transform))
 	{
-		shader->setUniformMatrix4fv("uModelMatrix", transform.getModelMatrix());
+		shader->setUniformMatrix4fv(MODEL_MATRIX_UNIFORM, transform.getModelMatrix());
 
 		model->render(shader);
 
@@ -54,7 +55,7 @@ void Entity::renderSelfAndChildren(ShaderProgram* shader, const Frustum& frustum
 
 	total += 1;
 
-	for (std::unique_ptr<Entity>& child : children)
+	for (Entity* child = firstChild; child; child = child->nextSibling)
 	{
 		child->renderSelfAndChildren(shader, frustum, display, total);
 	}
@@ -1,120 +1,78 @@
 #pragma once
 
-#include <list>
-#include <memory>
+#include <new>
+#include <algorithm>
+#include <type_traits>
 
 #include <glm/glm.hpp>
 
 #include "graphics/shader.h"
 #include "graphics/basic_model.h"
+#include "systems/transform_hierarchy.h"
 #include "camera.h"
 
 class Transform
 {
 protected:
-	// Local space information.
-	glm::vec3 position = { 0.0f, 0.0f, 0.0f };
-	glm::vec3 eulerRotation = { 0.0f, 0.0f, 0.0f };
-	glm::vec3 scale = { 1.0f, 1.0f, 1.0f };
-
-	// Global space information, concatenate in a matrix.
-	glm::mat4 modelMatrix = glm::mat4(1.0f);
-
-	// Dirty flag.
-	bool dirty = true;
-
-	glm::mat4 getLocalModelMatrix()
-	{
-		const glm::mat4 transformX = glm::rotate(glm::mat4(1.0f), glm::radians(eulerRotation.x), glm::vec3(1.0f, 0.0f, 0.0f));
-		const glm::mat4 transformY = glm::rotate(glm::mat4(1.0f), glm::radians(eulerRotation.y), glm::vec3(0.0f, 1.0f, 0.0f));
-		const glm::mat4 transformZ = glm::rotate(glm::mat4(1.0f), glm::radians(eulerRotation.z), glm::vec3(0.0f, 0.0f, 1.0f));
-
-		// Y * X * Z
-		const glm::mat4 roationMatrix = transformY * transformX * transformZ;
-
-		// translation * rotation * scale (also know as TRS matrix)
-		return glm::translate(glm::mat4(1.0f), position) * roationMatrix * glm::scale(glm::mat4(1.0f), scale);
-	}
+	// Handle into the scene's flattened transform hierarchy.
+	TransformHierarchy* hierarchy;
+	uint32_t index;
 
 public:
-	void computeModelMatrix()
-	{
-		modelMatrix = getLocalModelMatrix();
-		dirty = true;
-	}
-
-	void computeModelMatrix(const glm::mat4& parentGlobalModelMatrix)
-	{
-		modelMatrix = parentGlobalModelMatrix * getLocalModelMatrix();
-		dirty = true;
-	}
+	Transform(TransformHierarchy* hierarchy, uint32_t index)
+		: hierarchy(hierarchy), index(index)
+	{}
 
 	void setLocalPosition(const glm::vec3& newPosition)
 	{
-		position = newPosition;
-		dirty = true;
+		hierarchy->setLocalPosition(index, newPosition);
 	}
 
 	void setLocalEulerRotation(const glm::vec3& newEulerRotation)
 	{
-		eulerRotation = newEulerRotation;
-		dirty = true;
+		hierarchy->setLocalEulerRotation(index, newEulerRotation);
 	}
 
 	void setLocalScale(const glm::vec3& newScale)
 	{
-		scale = newScale;
-		dirty = true;
-	}
-
-	const glm::vec3& getLocalPosition()
-	{
-		return position;
-	}
-
-	const glm::vec3& getLocalEulerRotation()
-	{
-		return eulerRotation;
-	}
-
-	const glm::vec3& getLocalScale()
-	{
-		return scale;
-	}
-
-	const glm::mat4& getModelMatrix()
-	{
-		return modelMatrix;
+		hierarchy->setLocalScale(index, newScale);
 	}
 
 	const glm::vec3& getLocalPosition() const
 	{
-		return position;
+		return hierarchy->getLocalPosition(index);
 	}
 
 	const glm::vec3& getLocalEulerRotation() const
 	{
-		return eulerRotation;
+		return hierarchy->getLocalEulerRotation(index);
 	}
 
 	const glm::vec3& getLocalScale() const
 	{
-		return scale;
+		return hierarchy->getLocalScale(index);
 	}
 
 	const glm::mat4& getModelMatrix() const
 	{
-		return modelMatrix;
+		return hierarchy->getModelMatrix(index);
 	}
 
 	glm::vec3 getGlobalScale() const
 	{
+		const glm::mat4& modelMatrix = getModelMatrix();
+
 		return { glm::length(modelMatrix[0]), glm::length(modelMatrix[1]), glm::length(modelMatrix[2]) };
 	}
 
-	bool isDirty() const
+	TransformHierarchy* getHierarchy() const
 	{
-		return dirty;
+		return hierarchy;
+	}
+
+	uint32_t getIndex() const
+	{
+		return index;
 	}
 };
 
@@ -165,6 +123,8 @@ struct Frustum
 
 struct BoundingVolume
 {
+	virtual ~BoundingVolume() = default;
+
 	virtual bool isOnFrustum(const Frustum& camFrustum, const Transform& modelTransform) const = 0;
 
 	virtual bool isOnOrForwardPlane(const Plane& plane) const = 0;
@@ -195,25 +155,8 @@ struct Sphere : public BoundingVolume
 	{}
 
 	Sphere(BasicModel* model)
-		: BoundingVolume{}
-	{
-		glm::vec3 minAABB = glm::vec3(std::numeric_limits<float>::max());
-		glm::vec3 maxAABB = glm::vec3(std::numeric_limits<float>::min());
-
-		for (const BMVertex& vertex : model->getVertices())
-		{
-			minAABB.x = std::min(minAABB.x, vertex.position.x);
-			minAABB.y = std::min(minAABB.y, vertex.position.y);
-			minAABB.z = std::min(minAABB.z, vertex.position.z);
-
-			maxAABB.x = std::max(maxAABB.x, vertex.position.x);
-			maxAABB.y = std::max(maxAABB.y, vertex.position.y);
-			maxAABB.z = std::max(maxAABB.z, vertex.position.z);
-		}
-
-		center = (maxAABB + minAABB) * 0.5f;
-		radius = glm::length(minAABB - maxAABB);
-	}
+		: BoundingVolume{}, center(model->getBounds().sphere.center), radius(model->getBounds().sphere.radius)
+	{}
 
 	bool isOnOrForwardPlane(const Plane& plane) const final
 	{
@@ -224,17 +167,7 @@ struct Sphere : public BoundingVolume
 	{
 		bool bit = true;
 
-		// Get global scale thanks to our transform.
-		glm::vec3 globalScale = transform.getGlobalScale();
-
-		// Get our global center with process it with the global model matrix of our transform.
-		glm::vec3 globalCenter{ transform.getModelMatrix() * glm::vec4(center, 1.f) };
-
-		// To wrap correctly our shape, we need the maximum scale scalar.
-		float maxScale = std::max(std::max(globalScale.x, globalScale.y), globalScale.z);
-
-		// Max scale is assuming for the diameter. So, we need the half to apply it to our radius.
-		Sphere globalSphere(globalCenter, radius * (maxScale * 0.5f));
+		Sphere globalSphere = computeGlobalSphere(transform.getModelMatrix());
 
 		// Check firstly the result that have the most chance to failure to avoid to call all functions.
 		bit = bit && globalSphere.isOnOrForwardPlane(camFrustum.leftFace);
@@ -246,28 +179,135 @@ struct Sphere : public BoundingVolume
 
 		return bit;
 	}
+
+	Sphere computeGlobalSphere(const glm::mat4& modelMatrix) const
+	{
+		// Get global scale thanks to our model matrix.
+		glm::vec3 globalScale = { glm::length(modelMatrix[0]), glm::length(modelMatrix[1]), glm::length(modelMatrix[2]) };
+
+		// Get our global center with process it with the global model matrix of our transform.
+		glm::vec3 globalCenter{ modelMatrix * glm::vec4(center, 1.f) };
+
+		// To wrap correctly our shape, we need the maximum scale scalar.
+		float maxScale = std::max(std::max(globalScale.x, globalScale.y), globalScale.z);
+
+		return Sphere(globalCenter, radius * maxScale);
+	}
+};
+
+struct AABB : public BoundingVolume
+{
+	glm::vec3 center = { 0.0f, 0.0f, 0.0f };
+	glm::vec3 extents = { 0.0f, 0.0f, 0.0f };
+
+	AABB(const glm::vec3& center, const glm::vec3& extents)
+		: BoundingVolume{}, center(center), extents(extents)
+	{}
+
+	AABB(BasicModel* model)
+		: BoundingVolume{}, center(model->getBounds().aabb.center), extents(model->getBounds().aabb.extents)
+	{}
+
+	bool isOnOrForwardPlane(const Plane& plane) const final
+	{
+		// Projection interval radius of the box onto the plane normal.
+		float r = extents.x * std::abs(plane.normal.x) + extents.y * std::abs(plane.normal.y) + extents.z * std::abs(plane.normal.z);
+
+		return plane.getSignedDistanceTo(center) > -r;
+	}
+
+	bool isOnFrustum(const Frustum& camFrustum, const Transform& transform) const final
+	{
+		AABB globalAABB = computeGlobalAABB(transform.getModelMatrix());
+
+		return globalAABB.BoundingVolume::isOnFrustum(camFrustum);
+	}
+
+	AABB computeGlobalAABB(const glm::mat4& modelMatrix) const
+	{
+		glm::vec3 globalCenter{ modelMatrix * glm::vec4(center, 1.f) };
+
+		// The world space extents are the local ones through the absolute values of the rotation and scale (Arvo's method).
+		glm::mat3 absoluteMatrix(glm::abs(glm::vec3(modelMatrix[0])), glm::abs(glm::vec3(modelMatrix[1])), glm::abs(glm::vec3(modelMatrix[2])));
+
+		return AABB(globalCenter, absoluteMatrix * extents);
+	}
 };
 
+struct OBB : public BoundingVolume
+{
+	glm::vec3 center = { 0.0f, 0.0f, 0.0f };
+	glm::mat3 axes = glm::mat3(1.0f); // Axes scaled by the transform, one per column.
+	glm::vec3 extents = { 0.0f, 0.0f, 0.0f };
+
+	OBB(const glm::vec3& center, const glm::mat3& axes, const glm::vec3& extents)
+		: BoundingVolume{}, center(center), axes(axes), extents(extents)
+	{}
+
+	OBB(BasicModel* model)
+		: BoundingVolume{}, center(model->getBounds().obb.center), axes(model->getBounds().obb.axes), extents(model->getBounds().obb.extents)
+	{}
+
+	bool isOnOrForwardPlane(const Plane& plane) const final
+	{
+		float r = extents.x * std::abs(glm::dot(axes[0], plane.normal)) + extents.y * std::abs(glm::dot(axes[1], plane.normal)) + extents.z * std::abs(glm::dot(axes[2], plane.normal));
+
+		return plane.getSignedDistanceTo(center) > -r;
+	}
+
+	bool isOnFrustum(const Frustum& camFrustum, const Transform& transform) const final
+	{
+		OBB globalOBB = computeGlobalOBB(transform.getModelMatrix());
+
+		return globalOBB.BoundingVolume::isOnFrustum(camFrustum);
+	}
+
+	OBB computeGlobalOBB(const glm::mat4& modelMatrix) const
+	{
+		glm::vec3 globalCenter{ modelMatrix * glm::vec4(center, 1.f) };
+
+		// Extents are kept, the scale of the transform goes along with the axes.
+		return OBB(globalCenter, glm::mat3(modelMatrix) * axes, extents);
+	}
+};
+
+enum class BoundingVolumeType { SPHERE, AABB, OBB };
+
+class EntityPool;
+
+// Entities are created by (and live in) an "EntityPool". Children are linked through intrusive sibling pointers
+// and the bounding volume is built inside the entity itself, so an entity needs no allocation of its own.
 class Entity
 {
 public:
 	Transform transform;
 
-	std::list<std::unique_ptr<Entity>> children;
 	Entity* parent = nullptr;
+	Entity* firstChild = nullptr;
+	Entity* lastChild = nullptr;
+	Entity* nextSibling = nullptr;
 
-	std::unique_ptr<Sphere> boundingVolume;
+	BoundingVolume* boundingVolume = nullptr; // Points to "volumeStorage".
 	BasicModel* model = nullptr;
 
-	Entity(BasicModel* model);
+	Entity(EntityPool* pool, TransformHierarchy* hierarchy, Entity* parent, BasicModel* model);
+	~Entity();
 
-	template<typename... T>
-	void addChild(const T&... args)
-	{
-		children.emplace_back(std::make_unique<Entity>(args...));
-		children.back()->parent = this;
-	}
+	Entity(const Entity&) = delete;
+	Entity& operator=(const Entity&) = delete;
+
+	// Volumes are built from the bounds cached in the model, so switching is cheap.
+	void setBoundingVolumeType(BoundingVolumeType type);
+
+	Entity* addChild(BasicModel* model);
 
-	void updateSelfAndChildren(bool forced = false);
 	void renderSelfAndChildren(ShaderProgram* shader, const Frustum& frustum, uint32_t& display, uint32_t& total);
+
+private:
+	EntityPool* pool;
+
+	static const size_t VOLUME_STORAGE_SIZE = std::max(sizeof(Sphere), std::max(sizeof(AABB), sizeof(OBB)));
+	static const size_t VOLUME_STORAGE_ALIGNMENT = std::max(alignof(Sphere), std::max(alignof(AABB), alignof(OBB)));
+
+	std::aligned_storage<VOLUME_STORAGE_SIZE, VOLUME_STORAGE_ALIGNMENT>::type volumeStorage;
 };
@@ -1,7 +1,10 @@
 #include "basic_model.h"
 
-BasicModel::BasicModel(const char* filepath)
-	: VAO(0), VBO(0), IBO(0), instanceMatricesVBO(0)
+static constexpr UniformName DIFFUSE_MAP_UNIFORM("uMaterial.diffuseMap");
+
+BasicModel::BasicModel(const char* filepath, VertexFormat vertexFormat)
+	: VAO(0), VBO(0), IBO(0), instanceMatricesVBO(0), instanceMatricesSource(0), instanceMatricesCapacity(0),
+	  vertexFormat(vertexFormat), indexType(GL_UNSIGNED_INT)
 {
 	load(filepath);
 }
@@ -11,70 +14,213 @@ const std::vector<BMVertex>& BasicModel::getVertices()
 	return vertices;
 }
 
-void BasicModel::render(ShaderProgram* shader, int instances)
+void BasicModel::render(ShaderProgram* shader, int instances, uint32_t lod, uint32_t baseInstance)
 {
-	int unit = 0;
-
-	for (const BMTexture& texture : textures)
+	if (!bindTextures(shader) || lods.empty())
 	{
-		if (texture.type == BMTexture::Type::DIFFUSE)
-		{
-			shader->setUniform1i("uMaterial.diffuseMap", unit);
-		}
+		return;
+	}
 
-		// Activating and binding texture.
-		if (unit >= 0 && unit <= 15)
-		{
-			glActiveTexture(GL_TEXTURE0 + unit);
-			glBindTexture(GL_TEXTURE_2D, texture.ID);
-		}
-		else
-		{
-			std::cout << "[ERROR] MODEL: Failed to bind texture in unit " << unit << "." << std::endl;
+	lod = std::min(lod, getLodCount() - 1);
 
-			return;
-		}
+	const void* offset = (void*)(size_t(lods[lod].indexOffset) * getIndexSize(indexType));
 
-		unit += 1;
-	}
+	setVertexFormatUniforms(shader, vertexFormat, positionQuantization);
 
-	glBindVertexArray(VAO);
+	GLState::bindVertexArray(VAO);
 
-	if (instances == 1)
+	if (instances == 1 && baseInstance == 0)
 	{
-		glDrawElements(GL_TRIANGLES, indices.size(), GL_UNSIGNED_INT, 0);
+		glDrawElements(GL_TRIANGLES, lods[lod].indexCount, indexType, offset);
 	}
 	else
 	{
-		glDrawElementsInstanced(GL_TRIANGLES, indices.size(), GL_UNSIGNED_INT, 0, instances);
+		glDrawElementsInstancedBaseInstance(GL_TRIANGLES, lods[lod].indexCount, indexType, offset, instances, baseInstance);
 	}
 
-	glBindVertexArray(0);
+	GLState::bindVertexArray(0);
+}
+
+void BasicModel::renderIndirect(ShaderProgram* shader, int drawCount, const void* indirectOffset)
+{
+	if (!bindTextures(shader))
+	{
+		return;
+	}
+
+	setVertexFormatUniforms(shader, vertexFormat, positionQuantization);
+
+	GLState::bindVertexArray(VAO);
+
+	glMultiDrawElementsIndirect(GL_TRIANGLES, indexType, indirectOffset, drawCount, 0);
+
+	GLState::bindVertexArray(0);
 }
 
 void BasicModel::clean()
 {
-	glDeleteBuffers(1, &IBO);
-	glDeleteBuffers(1, &VBO);
-	glDeleteVertexArrays(1, &VAO);
+	if (instanceMatricesVBO != 0)
+	{
+		GLState::deleteBuffers(1, &instanceMatricesVBO);
+	}
+
+	GLState::deleteBuffers(1, &IBO);
+	GLState::deleteBuffers(1, &VBO);
+	GLState::deleteVertexArrays(1, &VAO);
 
 	for (const BMTexture& texture : textures)
 	{
-		glDeleteTextures(1, &texture.ID);
+		GLState::deleteTextures(1, &texture.ID);
 	}
 
 	textures.clear();
 }
 
 void BasicModel::attachInstanceMatricesVBO(const void* vertices, int size)
+{
+	glGenBuffers(1, &instanceMatricesVBO);
+	GLState::bindBuffer(GL_ARRAY_BUFFER, instanceMatricesVBO);
+	glBufferData(GL_ARRAY_BUFFER, size, vertices, GL_STATIC_DRAW);
+	GLState::bindBuffer(GL_ARRAY_BUFFER, 0);
+
+	instanceMatricesCapacity = size;
+
+	setInstanceMatricesSource(instanceMatricesVBO);
+}
+
+void BasicModel::updateInstanceMatricesVBO(const void* vertices, int size)
+{
+	if (instanceMatricesVBO == 0)
+	{
+		attachInstanceMatricesVBO(vertices, size);
+
+		return;
+	}
+
+	if (instanceMatricesSource != instanceMatricesVBO)
+	{
+		setInstanceMatricesSource(instanceMatricesVBO);
+	}
+
+	GLState::bindBuffer(GL_ARRAY_BUFFER, instanceMatricesVBO);
+
+	if (size > instanceMatricesCapacity)
+	{
+		glBufferData(GL_ARRAY_BUFFER, size, vertices, GL_DYNAMIC_DRAW);
+
+		instanceMatricesCapacity = size;
+	}
+	else
+	{
+		// Orphaning the old storage, so we don't have to wait for the draws still reading it.
+		glBufferData(GL_ARRAY_BUFFER, instanceMatricesCapacity, nullptr, GL_DYNAMIC_DRAW);
+		glBufferSubData(GL_ARRAY_BUFFER, 0, size, vertices);
+	}
+
+	GLState::bindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void BasicModel::bindInstanceMatricesBuffer(uint32_t buffer)
+{
+	if (instanceMatricesSource != buffer)
+	{
+		setInstanceMatricesSource(buffer);
+	}
+}
+
+void BasicModel::computeBounds()
+{
+	std::vector<glm::vec3> positions;
+
+	positions.reserve(vertices.size());
+
+	for (const BMVertex& vertex : vertices)
+	{
+		positions.push_back(vertex.position);
+	}
+
+	bounds.aabb = computeAABBBounds(positions);
+	bounds.obb = computeOBBBounds(positions);
+	bounds.sphere = computeSphereBounds(positions);
+}
+
+void BasicModel::generateLods()
+{
+	PROFILE_ZONE("BasicModel::generateLods");
+
+	std::vector<glm::vec3> positions;
+
+	positions.reserve(vertices.size());
+
+	for (const BMVertex& vertex : vertices)
+	{
+		positions.push_back(vertex.position);
+	}
+
+	lods.clear();
+	lods.push_back({ 0, uint32_t(indices.size()), 0.0f });
+
+	MeshSimplifier::buildLodChain(positions, indices, lods);
+}
+
+void BasicModel::optimizeMesh()
+{
+	PROFILE_ZONE("BasicModel::optimizeMesh");
+
+	std::vector<glm::vec3> positions;
+	float acmrBefore = 0.0f, acmrAfter = 0.0f;
+
+	positions.reserve(vertices.size());
+
+	for (const BMVertex& vertex : vertices)
+	{
+		positions.push_back(vertex.position);
+	}
+
+	std::vector<uint32_t> remap = MeshOptimizer::optimize(positions, indices, lods, &acmrBefore, &acmrAfter);
+
+	MeshOptimizer::remapVertices(vertices, remap);
+
+	std::cout << "[LOG] MODEL: Vertex cache ACMR " << acmrBefore << " -> " << acmrAfter << " (" << indices.size() / 3 << " triangles, all LODs)." << std::endl;
+}
+
+bool BasicModel::bindTextures(ShaderProgram* shader)
+{
+	int unit = 0;
+
+	for (const BMTexture& texture : textures)
+	{
+		if (texture.type == BMTexture::Type::DIFFUSE)
+		{
+			shader->setUniform1i(DIFFUSE_MAP_UNIFORM, unit);
+		}
+
+		// Activating and binding texture.
+		if (unit >= 0 && unit <= 15)
+		{
+			GLState::activeTexture(GL_TEXTURE0 + unit);
+			GLState::bindTexture(GL_TEXTURE_2D, texture.ID);
+		}
+		else
+		{
+			std::cout << "[ERROR] MODEL: Failed to bind texture in unit " << unit << "." << std::endl;
+
+			return false;
+		}
+
+		unit += 1;
+	}
+
+	return true;
+}
+
+void BasicModel::setInstanceMatricesSource(uint32_t buffer)
 {
 	std::size_t vec4_s = sizeof(glm::vec4);
 
-	glBindVertexArray(VAO);
+	GLState::bindVertexArray(VAO);
 
-	glGenBuffers(1, &instanceMatricesVBO);
-	glBindBuffer(GL_ARRAY_BUFFER, instanceMatricesVBO);
-	glBufferData(GL_ARRAY_BUFFER, size, vertices, GL_STATIC_DRAW);
+	GLState::bindBuffer(GL_ARRAY_BUFFER, buffer);
 
 	glEnableVertexAttribArray(3);
 	glVertexAttribPointer(3, 4, GL_FLOAT, GL_FALSE, 4 * vec4_s, (void*)(0));
@@ -90,13 +236,17 @@ void BasicModel::attachInstanceMatricesVBO(const void* vertices, int size)
 	glVertexAttribDivisor(5, 1);
 	glVertexAttribDivisor(6, 1);
 
-	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	GLState::bindBuffer(GL_ARRAY_BUFFER, 0);
+
+	GLState::bindVertexArray(0);
 
-	glBindVertexArray(0);
+	instanceMatricesSource = buffer;
 }
 
 void BasicModel::load(const char* filepath)
 {
+	PROFILE_ZONE("BasicModel::load");
+
 	tinyobj::attrib_t attrib;
 	std::vector<tinyobj::shape_t> shapes;
 	std::vector<tinyobj::material_t> materials;
@@ -156,6 +306,10 @@ void BasicModel::load(const char* filepath)
 		}
 	}
 
+	computeBounds();
+	generateLods();
+	optimizeMesh();
+
 	for (const auto& material : materials)
 	{
 		if (!material.diffuse_texname.empty())
@@ -166,28 +320,76 @@ void BasicModel::load(const char* filepath)
 		// TODO: Check if there is a "specular" texture too.
 	}
 
+	loadGeometry();
+}
+
+void BasicModel::loadGeometry()
+{
+	if (vertices.empty() || indices.empty())
+	{
+		return;
+	}
+
 	glGenVertexArrays(1, &VAO);
 	glGenBuffers(1, &VBO);
 	glGenBuffers(1, &IBO);
 
-	glBindVertexArray(VAO);
-	glBindBuffer(GL_ARRAY_BUFFER, VBO);
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, IBO);
+	GLState::bindVertexArray(VAO);
+	GLState::bindBuffer(GL_ARRAY_BUFFER, VBO);
+	GLState::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, IBO);
+
+	if (vertexFormat == VertexFormat::PACKED)
+	{
+		std::vector<PackedBMVertex> packedVertices(vertices.size());
 
-	glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(BMVertex), &vertices[0], GL_STATIC_DRAW);
-	glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), &indices[0], GL_STATIC_DRAW);
+		positionQuantization = computePositionQuantization(bounds.aabb);
 
-	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(BMVertex), (void*)(0));
-	glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(BMVertex), (void*)(offsetof(BMVertex, normal)));
-	glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(BMVertex), (void*)(offsetof(BMVertex, uvs)));
+		for (size_t i = 0; i < vertices.size(); i++)
+		{
+			quantizePosition(vertices[i].position, positionQuantization, packedVertices[i].position);
+
+			packedVertices[i].position[3] = 0;
+			packedVertices[i].normal = encodeOctahedral(vertices[i].normal);
+			packedVertices[i].uvs = encodeHalf2(vertices[i].uvs);
+		}
+
+		glBufferData(GL_ARRAY_BUFFER, packedVertices.size() * sizeof(PackedBMVertex), &packedVertices[0], GL_STATIC_DRAW);
+
+		glVertexAttribPointer(0, 3, GL_UNSIGNED_SHORT, GL_TRUE, sizeof(PackedBMVertex), (void*)(0));
+		glVertexAttribPointer(1, 2, GL_SHORT, GL_TRUE, sizeof(PackedBMVertex), (void*)(offsetof(PackedBMVertex, normal)));
+		glVertexAttribPointer(2, 2, GL_HALF_FLOAT, GL_FALSE, sizeof(PackedBMVertex), (void*)(offsetof(PackedBMVertex, uvs)));
+	}
+	else
+	{
+		glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(BMVertex), &vertices[0], GL_STATIC_DRAW);
+
+		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(BMVertex), (void*)(0));
+		glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(BMVertex), (void*)(offsetof(BMVertex, normal)));
+		glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(BMVertex), (void*)(offsetof(BMVertex, uvs)));
+	}
+
+	if (canUseShortIndices(uint32_t(vertices.size())))
+	{
+		std::vector<uint16_t> shortIndices = narrowIndices(indices);
+
+		glBufferData(GL_ELEMENT_ARRAY_BUFFER, shortIndices.size() * sizeof(uint16_t), &shortIndices[0], GL_STATIC_DRAW);
+
+		indexType = GL_UNSIGNED_SHORT;
+	}
+	else
+	{
+		glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(uint32_t), &indices[0], GL_STATIC_DRAW);
+
+		indexType = GL_UNSIGNED_INT;
+	}
 
 	glEnableVertexAttribArray(0);
 	glEnableVertexAttribArray(1);
 	glEnableVertexAttribArray(2);
 
-	glBindVertexArray(0); // Unbind the VAO before any other buffer.
-	glBindBuffer(GL_ARRAY_BUFFER, 0);
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+	GLState::bindVertexArray(0); // Unbind the VAO before any other buffer.
+	GLState::bindBuffer(GL_ARRAY_BUFFER, 0);
+	GLState::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
 }
 
 void BasicModel::loadTexture(const char* filepath, BMTexture::Type type)
@@ -199,7 +401,7 @@ void BasicModel::loadTexture(const char* filepath, BMTexture::Type type)
 	stbi_uc* data = stbi_load(filepath, &width, &height, &colorChannels, 0);
 
 	glGenTextures(1, &ID);
-	glBindTexture(GL_TEXTURE_2D, ID);
+	GLState::bindTexture(GL_TEXTURE_2D, ID);
 
 	// WARNING!
 	// 
@@ -243,7 +445,7 @@ void BasicModel::loadTexture(const char* filepath, BMTexture::Type type)
 		std::cerr << "[ERROR] MODEL: Failed to load texture \"" << filepath << "\"." << std::endl;
 	}
 
-	glBindTexture(GL_TEXTURE_2D, 0);
+	GLState::bindTexture(GL_TEXTURE_2D, 0);
 
 	stbi_image_free(data);
 
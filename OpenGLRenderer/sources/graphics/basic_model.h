@@ -19,6 +19,11 @@
 #include <TOL/tiny_obj_loader.h>
 
 #include "../graphics/shader.h"
+#include "../utils/bounds.h"
+#include "../utils/mesh_simplifier.h"
+#include "../utils/mesh_optimizer.h"
+#include "../utils/vertex_compression.h"
+#include "../utils/profiler.h"
 
 struct BMVertex
 {
@@ -32,6 +37,14 @@ struct BMVertex
 	}
 };
 
+// GPU layout of "BMVertex" with "VertexFormat::PACKED" (16 bytes instead of 32).
+struct PackedBMVertex
+{
+	uint16_t position[4]; // Quantized inside the model AABB, the last one is padding.
+	uint32_t normal; // Octahedral.
+	uint32_t uvs; // Half floats.
+};
+
 struct BMTexture
 {
 	enum class Type { DIFFUSE, SPECULAR };
@@ -40,6 +53,14 @@ struct BMTexture
 	Type type;
 };
 
+// Bounding volumes of the model vertices (in local space), computed once when the model is loaded.
+struct BMBounds
+{
+	AABBBounds aabb;
+	OBBBounds obb;
+	SphereBounds sphere;
+};
+
 namespace std
 {
 	template<> struct hash<BMVertex>
@@ -54,22 +75,61 @@ namespace std
 class BasicModel
 {
 public:
-	BasicModel(const char* filepath);
+	BasicModel(const char* filepath, VertexFormat vertexFormat = VertexFormat::FULL);
 
 	const std::vector<BMVertex>& getVertices();
+	uint32_t getIndexCount(uint32_t lod = 0) const { return lod < lods.size() ? lods[lod].indexCount : 0; }
+	const BMBounds& getBounds() const { return bounds; }
+	uint32_t getVAO() const { return VAO; }
+	uint32_t getMaterialID() const { return textures.empty() ? 0 : textures[0].ID; } // The diffuse texture identifies the material.
+	VertexFormat getVertexFormat() const { return vertexFormat; }
+	uint32_t getIndexType() const { return indexType; } // "GL_UNSIGNED_SHORT" when the model has up to 65536 vertices.
+
+	// Level of detail 0 is the full resolution mesh, every following one has about half of the triangles of the previous.
+	uint32_t getLodCount() const { return uint32_t(lods.size()); }
+	const std::vector<MeshLod>& getLods() const { return lods; }
+
+	// Instance attributes are read starting at "baseInstance" (e.g. the offset of the instances in a stream buffer).
+	void render(ShaderProgram* shader, int instances = 1, uint32_t lod = 0, uint32_t baseInstance = 0);
+
+	// Draws "drawCount" commands read from the buffer bound to "GL_DRAW_INDIRECT_BUFFER", starting at "indirectOffset".
+	void renderIndirect(ShaderProgram* shader, int drawCount, const void* indirectOffset = 0);
 
-	void render(ShaderProgram* shader, int instances = 1);
 	void clean();
 
 	void attachInstanceMatricesVBO(const void* vertices, int size);
 
+	// Streams new instance matrices every frame, attaching the VBO on the first call and only reallocating it when it must grow.
+	void updateInstanceMatricesVBO(const void* vertices, int size);
+
+	// Reads the instance matrices from an external buffer (e.g. written by a compute shader) instead of the model own VBO.
+	void bindInstanceMatricesBuffer(uint32_t buffer);
+
 private:
 	uint32_t VAO, VBO, IBO, instanceMatricesVBO;
+	uint32_t instanceMatricesSource;
+	int instanceMatricesCapacity;
+
+	VertexFormat vertexFormat;
+	PositionQuantization positionQuantization;
+	uint32_t indexType;
 
 	std::vector<BMVertex> vertices;
-	std::vector<uint32_t> indices;
+	std::vector<uint32_t> indices; // Indices of all LODs, one after another.
 	std::vector<BMTexture> textures;
 
+	std::vector<MeshLod> lods;
+
+	BMBounds bounds;
+
+	void computeBounds();
+	void generateLods();
+	void optimizeMesh();
+
+	bool bindTextures(ShaderProgram* shader);
+	void setInstanceMatricesSource(uint32_t buffer);
+
 	void load(const char* filepath);
+	void loadGeometry();
 	void loadTexture(const char* filepath, BMTexture::Type type);
 };
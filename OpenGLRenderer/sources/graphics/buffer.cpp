@@ -7,12 +7,12 @@ VAO::VAO() : ID()
 
 void VAO::bind()
 {
-	glBindVertexArray(ID);
+	GLState::bindVertexArray(ID);
 }
 
 void VAO::unbind()
 {
-	glBindVertexArray(0);
+	GLState::bindVertexArray(0);
 }
 
 void VAO::setVertexAttribute(uint32_t index, int size, int type, bool normalized, int stride, void* pointer, int divisor)
@@ -29,7 +29,7 @@ void VAO::setVertexAttribute(uint32_t index, int size, int type, bool normalized
 
 void VAO::clean()
 {
-	glDeleteVertexArrays(1, &ID);
+	GLState::deleteVertexArrays(1, &ID);
 }
 
 int VAO::retrieveMaxVertexAttributes()
@@ -44,59 +44,170 @@ int VAO::retrieveMaxVertexAttributes()
 VBO::VBO(const void* vertices, int size, GLenum usage) : ID()
 {
 	glGenBuffers(1, &ID);
-	glBindBuffer(GL_ARRAY_BUFFER, ID);
+	GLState::bindBuffer(GL_ARRAY_BUFFER, ID);
 	glBufferData(GL_ARRAY_BUFFER, size, vertices, usage);
-	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	GLState::bindBuffer(GL_ARRAY_BUFFER, 0);
 }
 
 void VBO::bind()
 {
-	glBindBuffer(GL_ARRAY_BUFFER, ID);
+	GLState::bindBuffer(GL_ARRAY_BUFFER, ID);
 }
 
 void VBO::unbind()
 {
-	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	GLState::bindBuffer(GL_ARRAY_BUFFER, 0);
 }
 
 void VBO::update(const void* vertices, int size)
 {
-	glBindBuffer(GL_ARRAY_BUFFER, ID);
+	GLState::bindBuffer(GL_ARRAY_BUFFER, ID);
 	glBufferSubData(GL_ARRAY_BUFFER, 0, size, vertices);
-	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	GLState::bindBuffer(GL_ARRAY_BUFFER, 0);
 }
 
 void VBO::clean()
 {
-	glDeleteBuffers(1, &ID);
+	GLState::deleteBuffers(1, &ID);
 }
 
 IBO::IBO(const uint32_t* indices, int size, GLenum usage) : ID()
 {
 	glGenBuffers(1, &ID);
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ID);
+	GLState::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, ID);
 	glBufferData(GL_ELEMENT_ARRAY_BUFFER, size, indices, usage);
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+	GLState::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
 }
 
 void IBO::bind()
 {
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ID);
+	GLState::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, ID);
 }
 
 void IBO::unbind()
 {
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+	GLState::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
 }
 
 void IBO::update(const uint32_t* indices, int size)
 {
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ID);
+	GLState::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, ID);
 	glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, 0, size, indices);
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+	GLState::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
 }
 
 void IBO::clean()
 {
-	glDeleteBuffers(1, &ID);
+	GLState::deleteBuffers(1, &ID);
+}
+
+StreamBuffer::StreamBuffer(int regionSize, GLenum target)
+	: ID(), target(target), regionSize(regionSize), mappedData(nullptr), fences(), region(0), regionHead(0), stallCount(0)
+{
+	GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+	GLsizeiptr size = GLsizeiptr(regionSize) * NUMBER_OF_REGIONS;
+
+	glGenBuffers(1, &ID);
+	GLState::bindBuffer(target, ID);
+
+	// Immutable storage, which can stay mapped while the GPU reads from it.
+	glBufferStorage(target, size, nullptr, flags);
+
+	mappedData = (unsigned char*)glMapBufferRange(target, 0, size, flags);
+
+	GLState::bindBuffer(target, 0);
+
+	if (!mappedData)
+	{
+		std::cout << "[ERROR] STREAM BUFFER: Failed to map " << size << " bytes." << std::endl;
+	}
+}
+
+void StreamBuffer::beginFrame()
+{
+	// All commands reading the current region were issued before this point.
+	if (regionHead > 0)
+	{
+		fences[region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	}
+
+	region = (region + 1) % NUMBER_OF_REGIONS;
+	regionHead = 0;
+
+	if (fences[region])
+	{
+		GLenum result = glClientWaitSync(fences[region], GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+
+		if (result != GL_ALREADY_SIGNALED && result != GL_CONDITION_SATISFIED)
+		{
+			stallCount += 1;
+
+			do
+			{
+				result = glClientWaitSync(fences[region], GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000); // 1 second.
+			}
+			while (result == GL_TIMEOUT_EXPIRED);
+		}
+
+		glDeleteSync(fences[region]);
+
+		fences[region] = nullptr;
+	}
+}
+
+void* StreamBuffer::allocate(int size, int alignment, int& offset)
+{
+	int regionStart = int(region) * regionSize;
+	int start = regionStart + regionHead;
+
+	if (alignment > 1)
+	{
+		start = (start + alignment - 1) / alignment * alignment;
+	}
+
+	if (!mappedData || start + size > regionStart + regionSize)
+	{
+		std::cout << "[ERROR] STREAM BUFFER: Failed to allocate " << size << " bytes, the region of the frame is full." << std::endl;
+
+		return nullptr;
+	}
+
+	regionHead = start + size - regionStart;
+	offset = start;
+
+	return mappedData + start;
+}
+
+void StreamBuffer::bind()
+{
+	GLState::bindBuffer(target, ID);
+}
+
+void StreamBuffer::unbind()
+{
+	GLState::bindBuffer(target, 0);
+}
+
+void StreamBuffer::clean()
+{
+	for (uint32_t i = 0; i < NUMBER_OF_REGIONS; i++)
+	{
+		if (fences[i])
+		{
+			glDeleteSync(fences[i]);
+
+			fences[i] = nullptr;
+		}
+	}
+
+	if (mappedData)
+	{
+		GLState::bindBuffer(target, ID);
+		glUnmapBuffer(target);
+		GLState::bindBuffer(target, 0);
+
+		mappedData = nullptr;
+	}
+
+	GLState::deleteBuffers(1, &ID);
 }
@@ -1,9 +1,12 @@
 #pragma once
 
 #include <cstdint>
+#include <iostream>
 
 #include <glad/glad.h>
 
+#include "../graphics/gl_state.h"
+
 class VAO
 {
 public:
@@ -53,3 +56,46 @@ public:
 private:
 	uint32_t ID;
 };
+
+// Persistently mapped buffer for data written by the CPU every frame (instance attributes, per frame uniforms, ...).
+//
+// The storage is split in "NUMBER_OF_REGIONS" regions used in turns, one per frame. Data is written in place through the
+// mapped pointer and drawn from the returned offset, without "glBufferSubData" copies or orphaning. The region of a frame is
+// guarded by a fence, so the CPU only waits for the GPU when it gets "NUMBER_OF_REGIONS" frames ahead of it.
+//
+class StreamBuffer
+{
+public:
+	static const uint32_t NUMBER_OF_REGIONS = 3;
+
+	StreamBuffer(int regionSize, GLenum target = GL_ARRAY_BUFFER);
+
+	// Fences the region of the previous frame and moves to the next one. Must be called once per frame, before the first "allocate".
+	void beginFrame();
+
+	// Reserves "size" bytes of the current region, starting at a multiple of "alignment" (any value, not only powers of two).
+	// Returns where to write them and sets "offset" to their position in the buffer, or returns "nullptr" when the region is full.
+	void* allocate(int size, int alignment, int& offset);
+
+	void bind();
+	void unbind();
+
+	uint32_t getID() const { return ID; }
+	int getRegionSize() const { return regionSize; }
+	uint32_t getStallCount() const { return stallCount; } // Frames the CPU had to wait for the GPU.
+
+	void clean();
+
+private:
+	uint32_t ID;
+	GLenum target;
+
+	int regionSize;
+	unsigned char* mappedData;
+
+	GLsync fences[NUMBER_OF_REGIONS];
+	uint32_t region;
+	int regionHead;
+
+	uint32_t stallCount;
+};
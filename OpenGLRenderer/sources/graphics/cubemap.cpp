@@ -6,7 +6,7 @@ CubeMap::CubeMap(const std::array<const char*, 6>& filepaths)
 	stbi_set_flip_vertically_on_load(false);
 
 	glGenTextures(1, &ID);
-	glBindTexture(GL_TEXTURE_CUBE_MAP, ID);
+	GLState::bindTexture(GL_TEXTURE_CUBE_MAP, ID);
 
 	for (uint32_t i = 0; i < 6; i++)
 	{
@@ -40,15 +40,15 @@ CubeMap::CubeMap(const std::array<const char*, 6>& filepaths)
 	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
 	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
 
-	glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
+	GLState::bindTexture(GL_TEXTURE_CUBE_MAP, 0);
 }
 
 void CubeMap::bind(int unit)
 {
 	if (unit >= 0 && unit <= 15)
 	{
-		glActiveTexture(GL_TEXTURE0 + unit);
-		glBindTexture(GL_TEXTURE_CUBE_MAP, ID);
+		GLState::activeTexture(GL_TEXTURE0 + unit);
+		GLState::bindTexture(GL_TEXTURE_CUBE_MAP, ID);
 	}
 	else
 	{
@@ -58,10 +58,10 @@ void CubeMap::bind(int unit)
 
 void CubeMap::unbind()
 {
-	glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
+	GLState::bindTexture(GL_TEXTURE_CUBE_MAP, 0);
 }
 
 void CubeMap::clean()
 {
-	glDeleteTextures(1, &ID);
+	GLState::deleteTextures(1, &ID);
 }
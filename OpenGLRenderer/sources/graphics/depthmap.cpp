@@ -6,10 +6,10 @@ DepthMap::DepthMap(int width, int height)
 	float borderColor[] = { 1.0f, 1.0f, 1.0f, 1.0f };
 
 	glGenFramebuffers(1, &ID);
-	glBindFramebuffer(GL_FRAMEBUFFER, ID);
+	GLState::bindFramebuffer(GL_FRAMEBUFFER, ID);
 
 	glGenTextures(1, &depthBufferID);
-	glBindTexture(GL_TEXTURE_2D, depthBufferID);
+	GLState::bindTexture(GL_TEXTURE_2D, depthBufferID);
 
 	glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT, width, height, 0, GL_DEPTH_COMPONENT, GL_FLOAT, nullptr);
 
@@ -28,26 +28,26 @@ DepthMap::DepthMap(int width, int height)
 	glDrawBuffer(GL_NONE);
 	glReadBuffer(GL_NONE);
 
-	glBindTexture(GL_TEXTURE_2D, 0);
-	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	GLState::bindTexture(GL_TEXTURE_2D, 0);
+	GLState::bindFramebuffer(GL_FRAMEBUFFER, 0);
 }
 
 void DepthMap::bind()
 {
-	glBindFramebuffer(GL_FRAMEBUFFER, ID);
+	GLState::bindFramebuffer(GL_FRAMEBUFFER, ID);
 }
 
 void DepthMap::unbind()
 {
-	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	GLState::bindFramebuffer(GL_FRAMEBUFFER, 0);
 }
 
 void DepthMap::bindDepthBuffer(int unit)
 {
 	if (unit >= 0 && unit <= 15)
 	{
-		glActiveTexture(GL_TEXTURE0 + unit);
-		glBindTexture(GL_TEXTURE_2D, depthBufferID);
+		GLState::activeTexture(GL_TEXTURE0 + unit);
+		GLState::bindTexture(GL_TEXTURE_2D, depthBufferID);
 	}
 	else
 	{
@@ -57,11 +57,11 @@ void DepthMap::bindDepthBuffer(int unit)
 
 void DepthMap::unbindDepthBuffer()
 {
-	glBindTexture(GL_TEXTURE_2D, 0);
+	GLState::bindTexture(GL_TEXTURE_2D, 0);
 }
 
 void DepthMap::clean()
 {
-	glDeleteTextures(1, &depthBufferID);
-	glDeleteFramebuffers(1, &ID);
+	GLState::deleteTextures(1, &depthBufferID);
+	GLState::deleteFramebuffers(1, &ID);
 }
@@ -4,6 +4,8 @@
 
 #include <glad/glad.h>
 
+#include "../graphics/gl_state.h"
+
 class DepthMap
 {
 public:
@@ -4,7 +4,7 @@ FrameBuffer::FrameBuffer(int width, int height, int numberOfColorBuffers, GLenum
 	: ID(), numberOfColorBuffers(numberOfColorBuffers), colorBufferIDs(), depthAndStencilBufferID(), depthAndStencilType(depthAndStencilType)
 {
 	glGenFramebuffers(1, &ID);
-	glBindFramebuffer(GL_FRAMEBUFFER, ID);
+	GLState::bindFramebuffer(GL_FRAMEBUFFER, ID);
 
 	// Note:
 	//
@@ -63,14 +63,14 @@ FrameBuffer::FrameBuffer(int width, int height, int numberOfColorBuffers, GLenum
 		std::cout << "[ERROR] FRAMEBUFFER: Framebuffer is not complete!" << std::endl;
 	}
 
-	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	GLState::bindFramebuffer(GL_FRAMEBUFFER, 0);
 }
 
 FrameBuffer::FrameBuffer(int width, int height, std::vector<ColorBufferConfig> configurations, DepthAndStencilType depthAndStencilType, int samples)
 	: ID(), numberOfColorBuffers(configurations.size()), colorBufferIDs(), depthAndStencilBufferID(), depthAndStencilType(depthAndStencilType)
 {
 	glGenFramebuffers(1, &ID);
-	glBindFramebuffer(GL_FRAMEBUFFER, ID);
+	GLState::bindFramebuffer(GL_FRAMEBUFFER, ID);
 
 	int numberOfColorBuffers = configurations.size();
 
@@ -133,25 +133,25 @@ FrameBuffer::FrameBuffer(int width, int height, std::vector<ColorBufferConfig> c
 		std::cout << "[ERROR] FRAMEBUFFER: Framebuffer is not complete!" << std::endl;
 	}
 
-	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	GLState::bindFramebuffer(GL_FRAMEBUFFER, 0);
 }
 
 void FrameBuffer::bind()
 {
-	glBindFramebuffer(GL_FRAMEBUFFER, ID);
+	GLState::bindFramebuffer(GL_FRAMEBUFFER, ID);
 }
 
 void FrameBuffer::unbind()
 {
-	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	GLState::bindFramebuffer(GL_FRAMEBUFFER, 0);
 }
 
 void FrameBuffer::bindColorBuffer(int unit, int attachmentNumber)
 {
 	if (unit >= 0 && unit <= 15)
 	{
-		glActiveTexture(GL_TEXTURE0 + unit);
-		glBindTexture(GL_TEXTURE_2D, colorBufferIDs[attachmentNumber]);
+		GLState::activeTexture(GL_TEXTURE0 + unit);
+		GLState::bindTexture(GL_TEXTURE_2D, colorBufferIDs[attachmentNumber]);
 	}
 	else
 	{
@@ -165,8 +165,8 @@ void FrameBuffer::bindDepthAndStencilBuffer(int unit)
 	{
 		if (unit >= 0 && unit <= 15)
 		{
-			glActiveTexture(GL_TEXTURE0 + unit);
-			glBindTexture(GL_TEXTURE_2D, depthAndStencilBufferID);
+			GLState::activeTexture(GL_TEXTURE0 + unit);
+			GLState::bindTexture(GL_TEXTURE_2D, depthAndStencilBufferID);
 		}
 		else
 		{
@@ -181,17 +181,17 @@ void FrameBuffer::bindDepthAndStencilBuffer(int unit)
 
 void FrameBuffer::clean()
 {
-	glDeleteFramebuffers(1, &ID);
+	GLState::deleteFramebuffers(1, &ID);
 
 	for (uint32_t i = 0; i < numberOfColorBuffers; i++)
 	{
-		glDeleteTextures(1, &colorBufferIDs[i]);
+		GLState::deleteTextures(1, &colorBufferIDs[i]);
 	}
 
 	switch (depthAndStencilType)
 	{
 	case DepthAndStencilType::TEXTURE:
-		glDeleteTextures(1, &depthAndStencilBufferID);
+		GLState::deleteTextures(1, &depthAndStencilBufferID);
 		break;
 
 	case DepthAndStencilType::RENDER_BUFFER:
@@ -228,7 +228,7 @@ void FrameBuffer::attachTextureAsColorBuffer(int width, int height, int attachme
 			type = GL_FLOAT;
 		}
 
-		glBindTexture(GL_TEXTURE_2D, colorBufferIDs[attachmentNumber]);
+		GLState::bindTexture(GL_TEXTURE_2D, colorBufferIDs[attachmentNumber]);
 
 		glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, width, height, 0, format, type, NULL);
 
@@ -239,11 +239,11 @@ void FrameBuffer::attachTextureAsColorBuffer(int width, int height, int attachme
 
 		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0 + attachmentNumber, GL_TEXTURE_2D, colorBufferIDs[attachmentNumber], 0);
 
-		glBindTexture(GL_TEXTURE_2D, 0);
+		GLState::bindTexture(GL_TEXTURE_2D, 0);
 	}
 	else
 	{
-		glBindTexture(GL_TEXTURE_2D_MULTISAMPLE, colorBufferIDs[attachmentNumber]);
+		GLState::bindTexture(GL_TEXTURE_2D_MULTISAMPLE, colorBufferIDs[attachmentNumber]);
 
 		glTexImage2DMultisample(GL_TEXTURE_2D_MULTISAMPLE, samples, internalFormat, width, height, GL_TRUE);
 
@@ -254,14 +254,14 @@ void FrameBuffer::attachTextureAsColorBuffer(int width, int height, int attachme
 
 		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0 + attachmentNumber, GL_TEXTURE_2D_MULTISAMPLE, colorBufferIDs[attachmentNumber], 0);
 
-		glBindTexture(GL_TEXTURE_2D_MULTISAMPLE, 0);
+		GLState::bindTexture(GL_TEXTURE_2D_MULTISAMPLE, 0);
 	}
 }
 
 void FrameBuffer::attachTextureAsDepthAndStencilBuffer(int width, int height)
 {
 	glGenTextures(1, &depthAndStencilBufferID);
-	glBindTexture(GL_TEXTURE_2D, depthAndStencilBufferID);
+	GLState::bindTexture(GL_TEXTURE_2D, depthAndStencilBufferID);
 
 	glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH24_STENCIL8, width, height, 0, GL_DEPTH_STENCIL, GL_UNSIGNED_INT_24_8, NULL);
 
@@ -270,7 +270,7 @@ void FrameBuffer::attachTextureAsDepthAndStencilBuffer(int width, int height)
 
 	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_TEXTURE_2D, depthAndStencilBufferID, 0);
 
-	glBindTexture(GL_TEXTURE_2D, 0);
+	GLState::bindTexture(GL_TEXTURE_2D, 0);
 }
 
 void FrameBuffer::attachRenderBufferAsDepthAndStencilBuffer(int width, int height, int samples)
@@ -5,6 +5,8 @@
 
 #include <glad/glad.h>
 
+#include "../graphics/gl_state.h"
+
 struct ColorBufferConfig
 {
 	GLenum internalFormat = GL_RGBA;
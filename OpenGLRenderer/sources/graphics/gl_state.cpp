@@ -0,0 +1,457 @@
+#include "gl_state.h"
+
+uint32_t GLState::program = GLState::UNKNOWN;
+uint32_t GLState::vertexArray = GLState::UNKNOWN;
+uint32_t GLState::requestedVertexArray = GLState::UNKNOWN;
+uint32_t GLState::buffers[GLState::NUMBER_OF_BUFFER_TARGETS];
+uint32_t GLState::activeTextureUnit = GLState::UNKNOWN;
+uint32_t GLState::textures[GLState::NUMBER_OF_TEXTURE_UNITS][GLState::NUMBER_OF_TEXTURE_TARGETS];
+uint32_t GLState::drawFramebuffer = GLState::UNKNOWN;
+uint32_t GLState::readFramebuffer = GLState::UNKNOWN;
+
+uint32_t GLState::capabilities[GLState::NUMBER_OF_CAPABILITIES];
+uint32_t GLState::depthFunction = GLState::UNKNOWN;
+uint32_t GLState::depthWriteMask = GLState::UNKNOWN;
+uint32_t GLState::blendSourceFactor = GLState::UNKNOWN;
+uint32_t GLState::blendDestinationFactor = GLState::UNKNOWN;
+
+uint32_t GLState::issuedCalls = 0;
+uint32_t GLState::elidedCalls = 0;
+uint32_t GLState::lastIssuedCalls = 0;
+uint32_t GLState::lastElidedCalls = 0;
+
+// Nothing is known before the first frame.
+static const bool initialized = (GLState::invalidate(), true);
+
+void GLState::beginFrame()
+{
+	lastIssuedCalls = issuedCalls;
+	lastElidedCalls = elidedCalls;
+
+	issuedCalls = 0;
+	elidedCalls = 0;
+
+	invalidate();
+}
+
+void GLState::invalidate()
+{
+	program = UNKNOWN;
+	vertexArray = UNKNOWN;
+	requestedVertexArray = UNKNOWN;
+	activeTextureUnit = UNKNOWN;
+	drawFramebuffer = UNKNOWN;
+	readFramebuffer = UNKNOWN;
+
+	for (uint32_t& buffer : buffers)
+	{
+		buffer = UNKNOWN;
+	}
+
+	for (uint32_t unit = 0; unit < NUMBER_OF_TEXTURE_UNITS; unit++)
+	{
+		for (uint32_t& texture : textures[unit])
+		{
+			texture = UNKNOWN;
+		}
+	}
+
+	for (uint32_t& capability : capabilities)
+	{
+		capability = UNKNOWN;
+	}
+
+	depthFunction = UNKNOWN;
+	depthWriteMask = UNKNOWN;
+	blendSourceFactor = UNKNOWN;
+	blendDestinationFactor = UNKNOWN;
+}
+
+void GLState::useProgram(uint32_t newProgram)
+{
+	if (newProgram == 0 || newProgram == program)
+	{
+		elidedCalls += 1; // Unbinding is deferred.
+
+		return;
+	}
+
+	glUseProgram(newProgram);
+
+	program = newProgram;
+	issuedCalls += 1;
+}
+
+void GLState::bindVertexArray(uint32_t newVertexArray)
+{
+	requestedVertexArray = newVertexArray;
+
+	if (newVertexArray == 0 || newVertexArray == vertexArray)
+	{
+		elidedCalls += 1;
+
+		return;
+	}
+
+	glBindVertexArray(newVertexArray);
+
+	vertexArray = newVertexArray;
+	buffers[getBufferTargetIndex(GL_ELEMENT_ARRAY_BUFFER)] = UNKNOWN; // Comes with the vertex array.
+	issuedCalls += 1;
+}
+
+void GLState::bindBuffer(GLenum target, uint32_t buffer)
+{
+	if (target == GL_ELEMENT_ARRAY_BUFFER)
+	{
+		flushVertexArray();
+	}
+
+	int index = getBufferTargetIndex(target);
+
+	// Only array buffer unbinds can be deferred: buffers left in other targets change the meaning of other calls (e.g. pixel transfers).
+	if (index >= 0 && (buffer == buffers[index] || (buffer == 0 && target == GL_ARRAY_BUFFER)))
+	{
+		elidedCalls += 1;
+
+		return;
+	}
+
+	glBindBuffer(target, buffer);
+
+	if (index >= 0)
+	{
+		buffers[index] = buffer;
+	}
+
+	issuedCalls += 1;
+}
+
+void GLState::bindBufferBase(GLenum target, uint32_t index, uint32_t buffer)
+{
+	// Indexed bindings aren't cached, but they also replace the generic binding of the target.
+	glBindBufferBase(target, index, buffer);
+
+	int targetIndex = getBufferTargetIndex(target);
+
+	if (targetIndex >= 0)
+	{
+		buffers[targetIndex] = buffer;
+	}
+
+	issuedCalls += 1;
+}
+
+void GLState::bindBufferRange(GLenum target, uint32_t index, uint32_t buffer, GLintptr offset, GLsizeiptr size)
+{
+	glBindBufferRange(target, index, buffer, offset, size);
+
+	int targetIndex = getBufferTargetIndex(target);
+
+	if (targetIndex >= 0)
+	{
+		buffers[targetIndex] = buffer;
+	}
+
+	issuedCalls += 1;
+}
+
+void GLState::activeTexture(GLenum unit)
+{
+	if (unit == activeTextureUnit)
+	{
+		elidedCalls += 1;
+
+		return;
+	}
+
+	glActiveTexture(unit);
+
+	activeTextureUnit = unit;
+	issuedCalls += 1;
+}
+
+void GLState::bindTexture(GLenum target, uint32_t texture)
+{
+	int targetIndex = getTextureTargetIndex(target);
+	uint32_t unit = activeTextureUnit - GL_TEXTURE0;
+
+	if (targetIndex >= 0 && unit < NUMBER_OF_TEXTURE_UNITS)
+	{
+		uint32_t& boundTexture = textures[unit][targetIndex];
+
+		if (texture == boundTexture || texture == 0)
+		{
+			elidedCalls += 1;
+
+			return;
+		}
+
+		glBindTexture(target, texture);
+
+		boundTexture = texture;
+	}
+	else
+	{
+		glBindTexture(target, texture);
+	}
+
+	issuedCalls += 1;
+}
+
+void GLState::bindFramebuffer(GLenum target, uint32_t framebuffer)
+{
+	bool drawBound = framebuffer == drawFramebuffer;
+	bool readBound = framebuffer == readFramebuffer;
+
+	if ((target == GL_FRAMEBUFFER && drawBound && readBound) || (target == GL_DRAW_FRAMEBUFFER && drawBound) || (target == GL_READ_FRAMEBUFFER && readBound))
+	{
+		elidedCalls += 1;
+
+		return;
+	}
+
+	glBindFramebuffer(target, framebuffer);
+
+	if (target == GL_FRAMEBUFFER || target == GL_DRAW_FRAMEBUFFER)
+	{
+		drawFramebuffer = framebuffer;
+	}
+
+	if (target == GL_FRAMEBUFFER || target == GL_READ_FRAMEBUFFER)
+	{
+		readFramebuffer = framebuffer;
+	}
+
+	issuedCalls += 1;
+}
+
+void GLState::enable(GLenum capability)
+{
+	setCapability(capability, true);
+}
+
+void GLState::disable(GLenum capability)
+{
+	setCapability(capability, false);
+}
+
+void GLState::depthFunc(GLenum function)
+{
+	if (function == depthFunction)
+	{
+		elidedCalls += 1;
+
+		return;
+	}
+
+	glDepthFunc(function);
+
+	depthFunction = function;
+	issuedCalls += 1;
+}
+
+void GLState::depthMask(bool flag)
+{
+	if (uint32_t(flag) == depthWriteMask)
+	{
+		elidedCalls += 1;
+
+		return;
+	}
+
+	glDepthMask(flag ? GL_TRUE : GL_FALSE);
+
+	depthWriteMask = uint32_t(flag);
+	issuedCalls += 1;
+}
+
+void GLState::blendFunc(GLenum sourceFactor, GLenum destinationFactor)
+{
+	if (sourceFactor == blendSourceFactor && destinationFactor == blendDestinationFactor)
+	{
+		elidedCalls += 1;
+
+		return;
+	}
+
+	glBlendFunc(sourceFactor, destinationFactor);
+
+	blendSourceFactor = sourceFactor;
+	blendDestinationFactor = destinationFactor;
+	issuedCalls += 1;
+}
+
+void GLState::deleteProgram(uint32_t deletedProgram)
+{
+	glDeleteProgram(deletedProgram);
+
+	// A program in use is only deleted when it stops being used, but its name is only reused after that.
+	if (deletedProgram == program)
+	{
+		program = UNKNOWN;
+	}
+}
+
+void GLState::deleteVertexArrays(int count, const uint32_t* vertexArrays)
+{
+	glDeleteVertexArrays(count, vertexArrays);
+
+	// Deleting bound objects reverts their bindings to 0.
+	for (int i = 0; i < count; i++)
+	{
+		if (vertexArrays[i] == vertexArray)
+		{
+			vertexArray = 0;
+			buffers[getBufferTargetIndex(GL_ELEMENT_ARRAY_BUFFER)] = UNKNOWN;
+		}
+
+		if (vertexArrays[i] == requestedVertexArray)
+		{
+			requestedVertexArray = 0;
+		}
+	}
+}
+
+void GLState::deleteBuffers(int count, const uint32_t* deletedBuffers)
+{
+	glDeleteBuffers(count, deletedBuffers);
+
+	for (int i = 0; i < count; i++)
+	{
+		for (uint32_t& buffer : buffers)
+		{
+			if (buffer == deletedBuffers[i])
+			{
+				buffer = 0;
+			}
+		}
+	}
+}
+
+void GLState::deleteTextures(int count, const uint32_t* deletedTextures)
+{
+	glDeleteTextures(count, deletedTextures);
+
+	for (int i = 0; i < count; i++)
+	{
+		for (uint32_t unit = 0; unit < NUMBER_OF_TEXTURE_UNITS; unit++)
+		{
+			for (uint32_t& texture : textures[unit])
+			{
+				if (texture == deletedTextures[i])
+				{
+					texture = 0;
+				}
+			}
+		}
+	}
+}
+
+void GLState::deleteFramebuffers(int count, const uint32_t* framebuffers)
+{
+	glDeleteFramebuffers(count, framebuffers);
+
+	for (int i = 0; i < count; i++)
+	{
+		drawFramebuffer = framebuffers[i] == drawFramebuffer ? 0 : drawFramebuffer;
+		readFramebuffer = framebuffers[i] == readFramebuffer ? 0 : readFramebuffer;
+	}
+}
+
+int GLState::getBufferTargetIndex(GLenum target)
+{
+	switch (target)
+	{
+	case GL_ARRAY_BUFFER: return 0;
+	case GL_ELEMENT_ARRAY_BUFFER: return 1;
+	case GL_UNIFORM_BUFFER: return 2;
+	case GL_SHADER_STORAGE_BUFFER: return 3;
+	case GL_DRAW_INDIRECT_BUFFER: return 4;
+	case GL_DISPATCH_INDIRECT_BUFFER: return 5;
+	case GL_PIXEL_PACK_BUFFER: return 6;
+	case GL_PIXEL_UNPACK_BUFFER: return 7;
+	case GL_COPY_READ_BUFFER: return 8;
+	case GL_COPY_WRITE_BUFFER: return 9;
+	case GL_QUERY_BUFFER: return 10;
+	case GL_ATOMIC_COUNTER_BUFFER: return 11;
+	default: return -1;
+	}
+}
+
+int GLState::getTextureTargetIndex(GLenum target)
+{
+	switch (target)
+	{
+	case GL_TEXTURE_2D: return 0;
+	case GL_TEXTURE_CUBE_MAP: return 1;
+	case GL_TEXTURE_2D_ARRAY: return 2;
+	case GL_TEXTURE_3D: return 3;
+	case GL_TEXTURE_2D_MULTISAMPLE: return 4;
+	default: return -1;
+	}
+}
+
+int GLState::getCapabilityIndex(GLenum capability)
+{
+	if (capability >= GL_CLIP_DISTANCE0 && capability <= GL_CLIP_DISTANCE7)
+	{
+		return int(capability - GL_CLIP_DISTANCE0);
+	}
+
+	switch (capability)
+	{
+	case GL_DEPTH_TEST: return 8;
+	case GL_BLEND: return 9;
+	case GL_CULL_FACE: return 10;
+	case GL_STENCIL_TEST: return 11;
+	case GL_SCISSOR_TEST: return 12;
+	case GL_MULTISAMPLE: return 13;
+	case GL_FRAMEBUFFER_SRGB: return 14;
+	case GL_PROGRAM_POINT_SIZE: return 15;
+	case GL_PRIMITIVE_RESTART: return 16;
+	case GL_POLYGON_OFFSET_FILL: return 17;
+	default: return -1;
+	}
+}
+
+void GLState::flushVertexArray()
+{
+	// The pending unbind must happen before an element array buffer is bound, or it would be attached to the old vertex array.
+	if (requestedVertexArray != vertexArray && requestedVertexArray != UNKNOWN)
+	{
+		glBindVertexArray(requestedVertexArray);
+
+		vertexArray = requestedVertexArray;
+		buffers[getBufferTargetIndex(GL_ELEMENT_ARRAY_BUFFER)] = UNKNOWN;
+		issuedCalls += 1;
+	}
+}
+
+void GLState::setCapability(GLenum capability, bool enabled)
+{
+	int index = getCapabilityIndex(capability);
+
+	if (index >= 0 && capabilities[index] == uint32_t(enabled))
+	{
+		elidedCalls += 1;
+
+		return;
+	}
+
+	if (enabled)
+	{
+		glEnable(capability);
+	}
+	else
+	{
+		glDisable(capability);
+	}
+
+	if (index >= 0)
+	{
+		capabilities[index] = uint32_t(enabled);
+	}
+
+	issuedCalls += 1;
+}
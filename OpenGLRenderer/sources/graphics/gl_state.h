@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstdint>
+
+#include <glad/glad.h>
+
+// Shadow copy of the OpenGL binding and fixed function state.
+//
+// Every bind and state change of the renderer goes through here, so a call that would set the value already
+// current in the context is skipped. Unbinds (binding 0) of programs, vertex arrays, array buffers and textures are
+// deferred: valid code always binds an object before using it, so the old binding can stay in the context until
+// something else replaces it, and a "bind X, unbind, bind X" sequence costs a single call. Element array buffers are
+// part of the vertex array state, so the pending vertex array is bound before one of them.
+//
+// Deleting objects must go through here too, the names of deleted objects are reused by OpenGL.
+//
+class GLState
+{
+public:
+	// Publishes the counters of the frame that ended and invalidates the cache, since other code (e.g. the GUI) may have touched the state.
+	static void beginFrame();
+	static void invalidate();
+
+	static void useProgram(uint32_t program);
+	static void bindVertexArray(uint32_t vertexArray);
+	static void bindBuffer(GLenum target, uint32_t buffer);
+	static void bindBufferBase(GLenum target, uint32_t index, uint32_t buffer);
+	static void bindBufferRange(GLenum target, uint32_t index, uint32_t buffer, GLintptr offset, GLsizeiptr size);
+	static void activeTexture(GLenum unit);
+	static void bindTexture(GLenum target, uint32_t texture);
+	static void bindFramebuffer(GLenum target, uint32_t framebuffer);
+
+	static void enable(GLenum capability);
+	static void disable(GLenum capability);
+	static void depthFunc(GLenum function);
+	static void depthMask(bool flag);
+	static void blendFunc(GLenum sourceFactor, GLenum destinationFactor);
+
+	static void deleteProgram(uint32_t program);
+	static void deleteVertexArrays(int count, const uint32_t* vertexArrays);
+	static void deleteBuffers(int count, const uint32_t* buffers);
+	static void deleteTextures(int count, const uint32_t* textures);
+	static void deleteFramebuffers(int count, const uint32_t* framebuffers);
+
+	// Calls sent to the driver and skipped in the last frame.
+	static uint32_t getIssuedCalls() { return lastIssuedCalls; }
+	static uint32_t getElidedCalls() { return lastElidedCalls; }
+
+private:
+	static const uint32_t UNKNOWN = 0xFFFFFFFF;
+
+	static const uint32_t NUMBER_OF_BUFFER_TARGETS = 12;
+	static const uint32_t NUMBER_OF_TEXTURE_UNITS = 32;
+	static const uint32_t NUMBER_OF_TEXTURE_TARGETS = 5;
+	static const uint32_t NUMBER_OF_CAPABILITIES = 18;
+
+	static uint32_t program;
+	static uint32_t vertexArray, requestedVertexArray;
+	static uint32_t buffers[NUMBER_OF_BUFFER_TARGETS];
+	static uint32_t activeTextureUnit;
+	static uint32_t textures[NUMBER_OF_TEXTURE_UNITS][NUMBER_OF_TEXTURE_TARGETS];
+	static uint32_t drawFramebuffer, readFramebuffer;
+
+	static uint32_t capabilities[NUMBER_OF_CAPABILITIES];
+	static uint32_t depthFunction, depthWriteMask;
+	static uint32_t blendSourceFactor, blendDestinationFactor;
+
+	static uint32_t issuedCalls, elidedCalls;
+	static uint32_t lastIssuedCalls, lastElidedCalls;
+
+	static int getBufferTargetIndex(GLenum target);
+	static int getTextureTargetIndex(GLenum target);
+	static int getCapabilityIndex(GLenum capability);
+
+	static void flushVertexArray();
+	static void setCapability(GLenum capability, bool enabled);
+};
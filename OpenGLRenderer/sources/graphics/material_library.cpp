@@ -0,0 +1,218 @@
+#include "material_library.h"
+
+static int packLayer(int textureArray, int layer)
+{
+	return (textureArray << 16) | layer;
+}
+
+MaterialLibrary::MaterialLibrary()
+	: materialsBuffer(0)
+{
+}
+
+int MaterialLibrary::addTexture(const std::string& filepath)
+{
+	for (uint32_t i = 0; i < images.size(); i++)
+	{
+		if (images[i].filepath == filepath)
+		{
+			return int(i);
+		}
+	}
+
+	Image image{ filepath, 0, 0, nullptr, NO_TEXTURE };
+	int colorChannels = 0;
+
+	stbi_set_flip_vertically_on_load(true);
+
+	// Every layer of an array shares its format, so all images are expanded to RGBA.
+	image.pixels = stbi_load(filepath.c_str(), &image.width, &image.height, &colorChannels, 4);
+
+	if (!image.pixels)
+	{
+		std::cout << "[ERROR] MATERIAL LIBRARY: Failed to load texture \"" << filepath << "\"." << std::endl;
+
+		return NO_TEXTURE;
+	}
+
+	images.push_back(image);
+
+	return int(images.size()) - 1;
+}
+
+uint32_t MaterialLibrary::addMaterial(const Material& material)
+{
+	materials.push_back(material);
+
+	return uint32_t(materials.size()) - 1;
+}
+
+void MaterialLibrary::build()
+{
+	int maxLayers = 256;
+
+	glGetIntegerv(GL_MAX_ARRAY_TEXTURE_LAYERS, &maxLayers);
+
+	// Grouping the images by size, one texture array per group.
+	std::vector<std::pair<int, int>> sizes;
+	std::vector<int> layerCounts;
+
+	for (Image& image : images)
+	{
+		std::pair<int, int> size(image.width, image.height);
+		std::vector<std::pair<int, int>>::iterator it = std::find(sizes.begin(), sizes.end(), size);
+		int textureArray = int(it - sizes.begin());
+
+		if (it == sizes.end())
+		{
+			if (sizes.size() == MAX_TEXTURE_ARRAYS)
+			{
+				std::cout << "[ERROR] MATERIAL LIBRARY: More than " << MAX_TEXTURE_ARRAYS << " texture sizes, \"" << image.filepath << "\" will not be used." << std::endl;
+
+				continue;
+			}
+
+			sizes.push_back(size);
+			layerCounts.push_back(0);
+		}
+
+		if (layerCounts[textureArray] == maxLayers)
+		{
+			std::cout << "[ERROR] MATERIAL LIBRARY: Texture array " << textureArray << " is full, \"" << image.filepath << "\" will not be used." << std::endl;
+
+			continue;
+		}
+
+		image.packedLayer = packLayer(textureArray, layerCounts[textureArray]);
+
+		layerCounts[textureArray] += 1;
+	}
+
+	textureArrays.resize(sizes.size(), 0);
+
+	for (uint32_t textureArray = 0; textureArray < textureArrays.size(); textureArray++)
+	{
+		int width = sizes[textureArray].first, height = sizes[textureArray].second;
+		int levels = 1;
+
+		while ((std::max(width, height) >> levels) > 0)
+		{
+			levels += 1;
+		}
+
+		glGenTextures(1, &textureArrays[textureArray]);
+		GLState::bindTexture(GL_TEXTURE_2D_ARRAY, textureArrays[textureArray]);
+
+		glTexStorage3D(GL_TEXTURE_2D_ARRAY, levels, GL_RGBA8, width, height, layerCounts[textureArray]);
+
+		for (Image& image : images)
+		{
+			if (image.packedLayer != NO_TEXTURE && (image.packedLayer >> 16) == int(textureArray))
+			{
+				glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, image.packedLayer & 0xFFFF, width, height, 1, GL_RGBA, GL_UNSIGNED_BYTE, image.pixels);
+			}
+		}
+
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_REPEAT);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_REPEAT);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+		glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+
+		GLState::bindTexture(GL_TEXTURE_2D_ARRAY, 0);
+	}
+
+	// Replacing the texture slots of the materials by their layers.
+	std::vector<int> packedMaterials;
+
+	packedMaterials.reserve(materials.size() * 4);
+
+	for (Material& material : materials)
+	{
+		int* maps[] = { &material.diffuseMap, &material.specularMap, &material.emissionMap, &material.normalMap };
+
+		for (int* map : maps)
+		{
+			*map = *map != NO_TEXTURE ? images[*map].packedLayer : NO_TEXTURE;
+
+			packedMaterials.push_back(*map);
+		}
+	}
+
+	if (!packedMaterials.empty())
+	{
+		glGenBuffers(1, &materialsBuffer);
+		GLState::bindBuffer(GL_SHADER_STORAGE_BUFFER, materialsBuffer);
+		glBufferData(GL_SHADER_STORAGE_BUFFER, packedMaterials.size() * sizeof(int), packedMaterials.data(), GL_STATIC_DRAW);
+		GLState::bindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+	}
+
+	for (Image& image : images)
+	{
+		stbi_image_free(image.pixels);
+
+		image.pixels = nullptr;
+	}
+
+	std::cout << "[LOG] MATERIAL LIBRARY: " << images.size() << " textures packed into " << textureArrays.size() << " texture arrays, " << materials.size() << " materials." << std::endl;
+}
+
+void MaterialLibrary::bind(ShaderProgram* shader)
+{
+	for (uint32_t textureArray = 0; textureArray < textureArrays.size(); textureArray++)
+	{
+		GLState::activeTexture(GL_TEXTURE0 + textureArray);
+		GLState::bindTexture(GL_TEXTURE_2D_ARRAY, textureArrays[textureArray]);
+	}
+
+	if (materialsBuffer != 0)
+	{
+		GLState::bindBufferBase(GL_SHADER_STORAGE_BUFFER, MATERIALS_BINDING_POINT, materialsBuffer);
+	}
+
+	// Sampler uniforms are part of the program state, and every library uses the same units.
+	if (std::find(configuredPrograms.begin(), configuredPrograms.end(), shader->getID()) == configuredPrograms.end())
+	{
+		UniformHandle samplers = shader->getUniform("uTextureArrays");
+		int units[MAX_TEXTURE_ARRAYS];
+
+		for (uint32_t unit = 0; unit < MAX_TEXTURE_ARRAYS; unit++)
+		{
+			units[unit] = int(unit);
+		}
+
+		// Unused trailing elements are optimized out of the array.
+		shader->setUniform1iv(samplers, units, std::min(int(MAX_TEXTURE_ARRAYS), samplers.size));
+
+		configuredPrograms.push_back(shader->getID());
+	}
+}
+
+void MaterialLibrary::clean()
+{
+	for (Image& image : images)
+	{
+		if (image.pixels)
+		{
+			stbi_image_free(image.pixels);
+		}
+	}
+
+	if (!textureArrays.empty())
+	{
+		GLState::deleteTextures(int(textureArrays.size()), textureArrays.data());
+	}
+
+	if (materialsBuffer != 0)
+	{
+		GLState::deleteBuffers(1, &materialsBuffer);
+
+		materialsBuffer = 0;
+	}
+
+	images.clear();
+	materials.clear();
+	textureArrays.clear();
+	configuredPrograms.clear();
+}
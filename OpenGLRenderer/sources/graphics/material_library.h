@@ -0,0 +1,91 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <iostream>
+#include <algorithm>
+
+#include <glad/glad.h>
+
+#if !defined _STB_IMAGE_INCLUDED
+#define _STB_IMAGE_INCLUDED
+
+#include <stbi/stb_image.h>
+#endif // _STB_IMAGE_INCLUDED
+
+#include "../graphics/shader.h"
+#include "../graphics/gl_state.h"
+
+// Textures and materials of a model, packed so its meshes can be drawn without rebinding textures between them.
+//
+// Textures with the same size become layers of the same "GL_TEXTURE_2D_ARRAY", and all arrays are bound at once to units
+// "0" to "MAX_TEXTURE_ARRAYS - 1". Materials are stored in a shader storage buffer, as the (array, layer) of each of their
+// maps, and a draw only selects its material with the "uMaterialIndex" uniform:
+//
+//   uniform sampler2DArray uTextureArrays[MAX_TEXTURE_ARRAYS];
+//
+//   layout (std430, binding = 1) readonly buffer Materials
+//   {
+//       ivec4 uMaterials[]; // Diffuse, specular, emission and normal maps, as "(array << 16) | layer" or -1 if missing.
+//   };
+//
+//   uniform int uMaterialIndex;
+//
+// When the material index varies inside a draw (e.g. "uMaterialIndex + gl_DrawID" in a multi-draw), it's not dynamically
+// uniform and can't index the sampler array directly: the shaders loop over the arrays and sample with explicit gradients.
+//
+class MaterialLibrary
+{
+public:
+	static const uint32_t MAX_TEXTURE_ARRAYS = 8;
+	static const uint32_t MATERIALS_BINDING_POINT = 1;
+
+	static const int NO_TEXTURE = -1;
+
+	// Texture slots (returned by "addTexture") of each map, replaced by their packed (array, layer) by "build".
+	struct Material
+	{
+		int diffuseMap = NO_TEXTURE;
+		int specularMap = NO_TEXTURE;
+		int emissionMap = NO_TEXTURE;
+		int normalMap = NO_TEXTURE;
+	};
+
+	MaterialLibrary();
+
+	// Decodes the image (only once per file) and returns its texture slot, or "NO_TEXTURE" when it can't be loaded.
+	int addTexture(const std::string& filepath);
+	uint32_t addMaterial(const Material& material);
+
+	// Packs the decoded images into texture arrays and uploads the materials. The images are released afterwards.
+	void build();
+
+	// Binds the texture arrays and the materials buffer, pointing the samplers of the shader to them (once per program).
+	void bind(ShaderProgram* shader);
+
+	uint32_t getID() const { return textureArrays.empty() ? 0 : textureArrays[0]; } // Identifies the texture bindings of the library.
+	uint32_t getTextureArrayCount() const { return uint32_t(textureArrays.size()); }
+	uint32_t getMaterialCount() const { return uint32_t(materials.size()); }
+
+	void clean();
+
+private:
+	struct Image
+	{
+		std::string filepath;
+
+		int width, height;
+		unsigned char* pixels; // RGBA, valid until the library is built.
+
+		int packedLayer; // "(array << 16) | layer".
+	};
+
+	std::vector<Image> images;
+	std::vector<Material> materials;
+
+	std::vector<uint32_t> textureArrays;
+	uint32_t materialsBuffer;
+
+	std::vector<uint32_t> configuredPrograms;
+};
@@ -1,5 +1,7 @@
 #include "model.h"
 
+static constexpr UniformName MATERIAL_INDEX_UNIFORM("uMaterialIndex");
+
 Animation::Animation(const aiAnimation* animation)
 	: duration(0.0f), ticksPerSecond(0.0f), currTime(0.0f)
 {
@@ -49,11 +51,28 @@ Animation::Animation(const aiAnimation* animation)
 
 void Animation::update(float deltaTime)
 {
+	PROFILE_ZONE("Animation::update");
+
 	currTime = std::fmod(currTime + ticksPerSecond * deltaTime, duration);
 
+	sampledNodes.clear();
+
 	for (std::map<std::string, AnimNode>::iterator it = animNodes.begin(); it != animNodes.end(); it++)
 	{
-		it->second.update(currTime);
+		sampledNodes.push_back(&it->second);
+	}
+
+	// Every node interpolates its own keys, only the hierarchy walk of the bones palette must be serial.
+	JobSystem::parallelFor(uint32_t(sampledNodes.size()), 32, sampleNodes, this);
+}
+
+void Animation::sampleNodes(uint32_t begin, uint32_t end, void* data)
+{
+	Animation* animation = (Animation*)data;
+
+	for (uint32_t i = begin; i < end; i++)
+	{
+		animation->sampledNodes[i]->update(animation->currTime);
 	}
 }
 
@@ -63,14 +82,8 @@ void Animation::clean()
 }
 
 Animator::Animator()
-	: currAnimation(0), globalTransformation(1.0f)
+	: currAnimation(0), bonesBuffer(0), bonesBufferCapacity(0), bonesChanged(true), globalTransformation(1.0f)
 {
-	bonesMatrices.reserve(MAX_NUM_BONES);
-
-	for (uint32_t i = 0; i < MAX_NUM_BONES; i++)
-	{
-		bonesMatrices.push_back(glm::mat4(1.0f));
-	}
 }
 
 void Animator::processModelNodes(const aiScene* scene)
@@ -98,12 +111,7 @@ void Animator::processBones(aiMesh* mesh, std::vector<MeshVertex>& vertices)
 
 		if (bones.find(boneName) == bones.end())
 		{
-			Bone bone;
-
-			bone.ID = boneID;
-			bone.offsetMatrix = AssimpGLMHelpers::getGLMMat4(mesh->mBones[i]->mOffsetMatrix);
-
-			bones[boneName] = bone;
+			boneID = addBone(boneName, AssimpGLMHelpers::getGLMMat4(mesh->mBones[i]->mOffsetMatrix));
 		}
 		else
 		{
@@ -129,12 +137,7 @@ void Animator::processMissingBones(const aiScene* scene)
 
 			if (bones.find(boneName) == bones.end())
 			{
-				Bone bone;
-
-				bone.ID = bones.size();
-				bone.offsetMatrix = glm::mat4(1.0f);
-
-				bones[boneName] = bone;
+				addBone(boneName, glm::mat4(1.0f));
 			}
 		}
 	}
@@ -147,6 +150,8 @@ void Animator::update(float deltaTime)
 		animations[currAnimation].update(deltaTime);
 
 		calcBoneTransformation(rootModelNode, glm::mat4(1.0f));
+
+		bonesChanged = true;
 	}
 }
 
@@ -158,7 +163,31 @@ void Animator::clean()
 	}
 
 	bones.clear();
+	bonesMatrices.clear();
 	animations.clear();
+
+	if (bonesBuffer != 0)
+	{
+		GLState::deleteBuffers(1, &bonesBuffer);
+
+		bonesBuffer = 0;
+		bonesBufferCapacity = 0;
+	}
+}
+
+void Animator::bindBonesMatrices(uint32_t bindingPoint)
+{
+	if (bonesMatrices.empty())
+	{
+		return;
+	}
+
+	if (bonesChanged)
+	{
+		uploadBonesMatrices();
+	}
+
+	GLState::bindBufferBase(GL_SHADER_STORAGE_BUFFER, bindingPoint, bonesBuffer);
 }
 
 void Animator::execAnimation(uint32_t number)
@@ -194,6 +223,59 @@ void Animator::execAnimation(const std::string name)
 	}
 }
 
+uint32_t Animator::addBone(const std::string& name, const glm::mat4& offsetMatrix)
+{
+	Bone bone;
+
+	bone.ID = uint32_t(bonesMatrices.size());
+	bone.offsetMatrix = offsetMatrix;
+
+	bones[name] = bone;
+
+	// The palette grows with the skeleton, there is no upper limit on the number of bones.
+	bonesMatrices.push_back(glm::mat4(1.0f));
+	bonesChanged = true;
+
+	return bone.ID;
+}
+
+void Animator::uploadBonesMatrices()
+{
+	GLsizeiptr size = GLsizeiptr(bonesMatrices.size() * sizeof(glm::mat4));
+
+	if (bonesBuffer == 0)
+	{
+		glGenBuffers(1, &bonesBuffer);
+	}
+
+	GLState::bindBuffer(GL_SHADER_STORAGE_BUFFER, bonesBuffer);
+
+	if (bonesBufferCapacity < bonesMatrices.size())
+	{
+		glBufferData(GL_SHADER_STORAGE_BUFFER, size, nullptr, GL_DYNAMIC_DRAW);
+
+		bonesBufferCapacity = uint32_t(bonesMatrices.size());
+	}
+
+	// Invalidating the whole buffer lets the driver hand out fresh memory instead of waiting for the draws still reading the previous palette.
+	void* destination = glMapBufferRange(GL_SHADER_STORAGE_BUFFER, 0, size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+
+	if (destination)
+	{
+		std::memcpy(destination, bonesMatrices.data(), size);
+
+		glUnmapBuffer(GL_SHADER_STORAGE_BUFFER);
+
+		bonesChanged = false;
+	}
+	else
+	{
+		std::cout << "[ERROR] ANIMATOR: Failed to map the bones matrices buffer." << std::endl;
+	}
+
+	GLState::bindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+}
+
 void Animator::readModelNodeHierarchy(const aiNode* source, ModelNode& destination)
 {
 	destination.name = source->mName.data;
@@ -234,117 +316,129 @@ void Animator::calcBoneTransformation(ModelNode& modelNode, const glm::mat4& par
 	}
 }
 
-Mesh::Mesh(const std::vector<MeshVertex>& vertices, const std::vector<uint32_t>& indices, const std::vector<MeshTexture>& textures)
-	: VAO(0), VBO(0), IBO(0), vertices(vertices), indices(indices), textures(textures)
+Mesh::Mesh(const std::vector<MeshVertex>& vertices, const std::vector<uint32_t>& indices, MaterialLibrary* materialLibrary, uint32_t materialIndex)
+	: geometry(), vertices(vertices), indices(indices), materialLibrary(materialLibrary), materialIndex(materialIndex)
 {
-	load();
+	generateLods();
+	optimize();
 }
 
-void Mesh::render(ShaderProgram* shader)
+void Mesh::render(ShaderProgram* shader, uint32_t lod)
 {
-	int unit = 0;
+	materialLibrary->bind(shader);
 
-	for (const MeshTexture& texture : textures)
+	draw(shader, lod);
+}
+
+void Mesh::draw(ShaderProgram* shader, uint32_t lod)
+{
+	if (lods.empty())
 	{
-		switch (texture.type)
-		{
-		case MeshTexture::Type::DIFFUSE:
-			shader->setUniform1i("uMaterial.diffuseMap", unit);
-			break;
-		case MeshTexture::Type::SPECULAR:
-			shader->setUniform1i("uMaterial.specularMap", unit);
-			break;
-		case MeshTexture::Type::EMISSION:
-			shader->setUniform1i("uMaterial.emissionMap", unit);
-			break;
-		case MeshTexture::Type::NORMAL:
-			shader->setUniform1i("uMaterial.normalMap", unit);
-			break;
-		default:
-			break;
-		}
+		return;
+	}
 
-		// Activating and binding texture.
-		if (unit >= 0 && unit <= 15)
-		{
-			glActiveTexture(GL_TEXTURE0 + unit);
-			glBindTexture(GL_TEXTURE_2D, texture.ID);
-		}
-		else
-		{
-			std::cout << "[ERROR] MESH: Failed to bind texture in unit " << unit << "." << std::endl;
+	shader->setUniform1i(MATERIAL_INDEX_UNIFORM, int(materialIndex));
 
-			return;
-		}
+	lod = std::min(lod, getLodCount() - 1);
 
-		unit += 1;
-	}
+	const void* offset = (void*)(size_t(geometry.firstIndex + lods[lod].indexOffset) * getIndexSize(geometry.indexType));
+
+	setVertexFormatUniforms(shader, geometry.vertexFormat, geometry.positionQuantization);
 
-	glBindVertexArray(VAO);
+	GLState::bindVertexArray(geometry.VAO);
 
-	glDrawElements(GL_TRIANGLES, indices.size(), GL_UNSIGNED_INT, 0);
+	glDrawElementsBaseVertex(GL_TRIANGLES, lods[lod].indexCount, geometry.indexType, offset, geometry.baseVertex);
 
-	glBindVertexArray(0);
+	GLState::bindVertexArray(0);
 }
 
 void Mesh::clean()
 {
-	glDeleteVertexArrays(1, &VAO);
-	glDeleteBuffers(1, &VBO);
-	glDeleteBuffers(1, &IBO);
+	// The buffers belong to the model.
+	geometry = Geometry();
+
+	vertices.clear();
+	indices.clear();
+
+	lods.clear();
+}
+
+void Mesh::generateLods()
+{
+	PROFILE_ZONE("Mesh::generateLods");
 
-	for (const MeshTexture& texture : textures)
+	if (indices.empty())
 	{
-		glDeleteTextures(1, &texture.ID);
+		return;
 	}
 
-	vertices.clear();
-	indices.clear();
-	textures.clear();
+	std::vector<glm::vec3> positions;
+
+	positions.reserve(vertices.size());
+
+	for (const MeshVertex& vertex : vertices)
+	{
+		positions.push_back(vertex.position);
+	}
+
+	lods.push_back({ 0, uint32_t(indices.size()), 0.0f });
+
+	MeshSimplifier::buildLodChain(positions, indices, lods);
 }
 
-void Mesh::load()
+void Mesh::optimize()
 {
-	glGenVertexArrays(1, &VAO);
-	glGenBuffers(1, &VBO);
-	glGenBuffers(1, &IBO);
+	PROFILE_ZONE("Mesh::optimize");
 
-	glBindVertexArray(VAO);
-	glBindBuffer(GL_ARRAY_BUFFER, VBO);
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, IBO);
+	if (lods.empty())
+	{
+		return;
+	}
 
-	glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(MeshVertex), &vertices[0], GL_STATIC_DRAW);
-	glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), &indices[0], GL_STATIC_DRAW);
+	std::vector<glm::vec3> positions;
+	float acmrBefore = 0.0f, acmrAfter = 0.0f;
 
-	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(MeshVertex), (void*)(0));
-	glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(MeshVertex), (void*)(offsetof(MeshVertex, normal)));
-	glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(MeshVertex), (void*)(offsetof(MeshVertex, uvs)));
-	glVertexAttribIPointer(3, 4, GL_INT, sizeof(MeshVertex), (void*)(offsetof(MeshVertex, boneIDs))); // glVertexAttribPointer(3, 4, GL_INT, GL_FALSE, sizeof(MeshVertex), (void*)(offsetof(MeshVertex, boneIDs)));
-	glVertexAttribPointer(4, 4, GL_FLOAT, GL_FALSE, sizeof(MeshVertex), (void*)(offsetof(MeshVertex, weights)));
+	positions.reserve(vertices.size());
 
-	glEnableVertexAttribArray(0);
-	glEnableVertexAttribArray(1);
-	glEnableVertexAttribArray(2);
-	glEnableVertexAttribArray(3);
-	glEnableVertexAttribArray(4);
+	for (const MeshVertex& vertex : vertices)
+	{
+		positions.push_back(vertex.position);
+	}
+
+	std::vector<uint32_t> remap = MeshOptimizer::optimize(positions, indices, lods, &acmrBefore, &acmrAfter);
+
+	MeshOptimizer::remapVertices(vertices, remap);
 
-	glBindVertexArray(0); // Unbind the VAO before any other buffer.
-	glBindBuffer(GL_ARRAY_BUFFER, 0);
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+	std::cout << '\t' << "[LOG] MODEL: Mesh vertex cache ACMR " << acmrBefore << " -> " << acmrAfter << " (" << getIndexCount(0) / 3 << " triangles)." << std::endl;
 }
 
-Model::Model(const char* filepath, uint32_t flags)
-	: animator()
+Model::Model(const char* filepath, uint32_t flags, VertexFormat vertexFormat)
+	: animator(), VAO(0), VBO(0), IBO(0), indexType(GL_UNSIGNED_INT), vertexFormat(vertexFormat)
 {
 	load(filepath, flags);
 }
 
-void Model::render(ShaderProgram* shader)
+void Model::render(ShaderProgram* shader, uint32_t lod)
 {
-	for (Mesh& mesh : meshes)
+	if (lodDrawRanges.empty())
 	{
-		mesh.render(shader);
+		return;
 	}
+
+	const DrawRanges& ranges = lodDrawRanges[std::min(lod, uint32_t(lodDrawRanges.size()) - 1)];
+
+	// All meshes sample the same texture arrays, and the draw "gl_DrawID" selects the material of each mesh.
+	materialLibrary.bind(shader);
+
+	shader->setUniform1i(MATERIAL_INDEX_UNIFORM, 0);
+
+	setVertexFormatUniforms(shader, vertexFormat, positionQuantization);
+
+	GLState::bindVertexArray(VAO);
+
+	glMultiDrawElementsBaseVertex(GL_TRIANGLES, ranges.counts.data(), indexType, ranges.offsets.data(), GLsizei(ranges.counts.size()), ranges.baseVertices.data());
+
+	GLState::bindVertexArray(0);
 }
 
 void Model::clean()
@@ -354,13 +448,22 @@ void Model::clean()
 		mesh.clean();
 	}
 
+	GLState::deleteVertexArrays(1, &VAO);
+	GLState::deleteBuffers(1, &VBO);
+	GLState::deleteBuffers(1, &IBO);
+
+	lodDrawRanges.clear();
+
 	animator.clean();
 
-	loadedTextures.clear();
+	materialLibrary.clean();
+	sceneMaterials.clear();
 }
 
 void Model::load(const char* filepath, uint32_t flags)
 {
+	PROFILE_ZONE("Model::load");
+
 	Assimp::Importer importer;
 	std::string fp = filepath;
 
@@ -390,127 +493,198 @@ void Model::load(const char* filepath, uint32_t flags)
 
 	processNode(scene->mRootNode, scene);
 
+	loadGeometry();
+
+	materialLibrary.build();
+
 	animator.processMissingBones(scene); // FIXME: really necessary?
 }
 
-uint32_t Model::loadTexture(const char* filepath, bool gammaCorrection)
+void Model::loadGeometry()
 {
-	stbi_set_flip_vertically_on_load(true);
+	std::vector<MeshVertex> vertices;
+	std::vector<uint32_t> indices;
+	uint32_t lodCount = 0;
+	bool shortIndices = true;
 
-	uint32_t ID;
-	int width, height, colorChannels, internalFormat = GL_RED, format = GL_RED;
-	stbi_uc* data = stbi_load(filepath, &width, &height, &colorChannels, 0);
+	for (const Mesh& mesh : meshes)
+	{
+		vertices.insert(vertices.end(), mesh.getVertices().begin(), mesh.getVertices().end());
+		indices.insert(indices.end(), mesh.getIndices().begin(), mesh.getIndices().end());
 
-	glGenTextures(1, &ID);
-	glBindTexture(GL_TEXTURE_2D, ID);
+		lodCount = std::max(lodCount, mesh.getLodCount());
 
-	// WARNING!
-	// 
-	// We are expecting an image with only 3 or 4 color channels.
-	// Any other format may cause an OpenGL error.
-	//
-	switch (colorChannels)
+		// Indices are relative to their mesh (the base vertex does the rest), so only the size of each mesh matters.
+		shortIndices = shortIndices && canUseShortIndices(uint32_t(mesh.getVertices().size()));
+	}
+
+	if (indices.empty())
+	{
+		return;
+	}
+
+	if (vertexFormat == VertexFormat::PACKED && animator.getBoneCount() > 256)
+	{
+		std::cout << "[WARNING] MODEL: " << animator.getBoneCount() << " bones don't fit in packed vertices, using full precision ones." << std::endl;
+
+		vertexFormat = VertexFormat::FULL;
+	}
+
+	glGenVertexArrays(1, &VAO);
+	glGenBuffers(1, &VBO);
+	glGenBuffers(1, &IBO);
+
+	GLState::bindVertexArray(VAO);
+	GLState::bindBuffer(GL_ARRAY_BUFFER, VBO);
+	GLState::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, IBO);
+
+	if (vertexFormat == VertexFormat::PACKED)
 	{
-	case 3:
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+		std::vector<glm::vec3> positions;
+		std::vector<PackedMeshVertex> packedVertices(vertices.size());
+
+		positions.reserve(vertices.size());
 
-		internalFormat = gammaCorrection ? GL_SRGB : GL_RGB;
-		format = GL_RGB;
+		for (const MeshVertex& vertex : vertices)
+		{
+			positions.push_back(vertex.position);
+		}
 
-		break;
+		positionQuantization = computePositionQuantization(computeAABBBounds(positions));
 
-	case 4:
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+		for (size_t i = 0; i < vertices.size(); i++)
+		{
+			quantizePosition(vertices[i].position, positionQuantization, packedVertices[i].position);
 
-		internalFormat = gammaCorrection ? GL_SRGB_ALPHA : GL_RGBA;
-		format = GL_RGBA;
+			packedVertices[i].position[3] = 0;
+			packedVertices[i].normal = encodeOctahedral(vertices[i].normal);
+			packedVertices[i].uvs = encodeHalf2(vertices[i].uvs);
 
-		break;
+			encodeBoneWeights(vertices[i].boneIDs, vertices[i].weights, MAX_NUM_BONES_PER_VERTEX, packedVertices[i].boneIDs, packedVertices[i].weights);
+		}
 
-	default:
-		std::cerr << "[ERROR] MODEL: Number of color channels not supported." << std::endl;
+		glBufferData(GL_ARRAY_BUFFER, packedVertices.size() * sizeof(PackedMeshVertex), &packedVertices[0], GL_STATIC_DRAW);
+
+		glVertexAttribPointer(0, 3, GL_UNSIGNED_SHORT, GL_TRUE, sizeof(PackedMeshVertex), (void*)(0));
+		glVertexAttribPointer(1, 2, GL_SHORT, GL_TRUE, sizeof(PackedMeshVertex), (void*)(offsetof(PackedMeshVertex, normal)));
+		glVertexAttribPointer(2, 2, GL_HALF_FLOAT, GL_FALSE, sizeof(PackedMeshVertex), (void*)(offsetof(PackedMeshVertex, uvs)));
+		glVertexAttribIPointer(3, 4, GL_UNSIGNED_BYTE, sizeof(PackedMeshVertex), (void*)(offsetof(PackedMeshVertex, boneIDs)));
+		glVertexAttribPointer(4, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(PackedMeshVertex), (void*)(offsetof(PackedMeshVertex, weights)));
 	}
+	else
+	{
+		glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(MeshVertex), &vertices[0], GL_STATIC_DRAW);
 
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(MeshVertex), (void*)(0));
+		glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(MeshVertex), (void*)(offsetof(MeshVertex, normal)));
+		glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(MeshVertex), (void*)(offsetof(MeshVertex, uvs)));
+		glVertexAttribIPointer(3, 4, GL_INT, sizeof(MeshVertex), (void*)(offsetof(MeshVertex, boneIDs))); // glVertexAttribPointer(3, 4, GL_INT, GL_FALSE, sizeof(MeshVertex), (void*)(offsetof(MeshVertex, boneIDs)));
+		glVertexAttribPointer(4, 4, GL_FLOAT, GL_FALSE, sizeof(MeshVertex), (void*)(offsetof(MeshVertex, weights)));
+	}
 
-	if (data)
+	if (shortIndices)
 	{
-		glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, width, height, 0, format, GL_UNSIGNED_BYTE, data);
-		glGenerateMipmap(GL_TEXTURE_2D);
+		std::vector<uint16_t> narrowedIndices = narrowIndices(indices);
+
+		glBufferData(GL_ELEMENT_ARRAY_BUFFER, narrowedIndices.size() * sizeof(uint16_t), &narrowedIndices[0], GL_STATIC_DRAW);
+
+		indexType = GL_UNSIGNED_SHORT;
 	}
 	else
 	{
-		std::cerr << "[ERROR] MODEL: Failed to load texture \"" << filepath << "\"." << std::endl;
+		glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(uint32_t), &indices[0], GL_STATIC_DRAW);
+
+		indexType = GL_UNSIGNED_INT;
 	}
 
-	glBindTexture(GL_TEXTURE_2D, 0);
+	glEnableVertexAttribArray(0);
+	glEnableVertexAttribArray(1);
+	glEnableVertexAttribArray(2);
+	glEnableVertexAttribArray(3);
+	glEnableVertexAttribArray(4);
 
-	stbi_image_free(data);
+	GLState::bindVertexArray(0); // Unbind the VAO before any other buffer.
+	GLState::bindBuffer(GL_ARRAY_BUFFER, 0);
+	GLState::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
 
-	return ID;
-}
+	// Mesh indices stay relative to the mesh, the base vertex moves them to its vertices in the shared buffer.
+	Mesh::Geometry geometry;
 
-std::vector<MeshTexture> Model::loadMaterialTextures(aiMaterial* material, aiTextureType type)
-{
-	std::vector<MeshTexture> textures;
+	geometry.VAO = VAO;
+	geometry.indexType = indexType;
+	geometry.vertexFormat = vertexFormat;
+	geometry.positionQuantization = positionQuantization;
 
-	for (uint32_t i = 0; i < material->GetTextureCount(type); i++)
+	for (Mesh& mesh : meshes)
 	{
-		aiString buffer;
-		material->GetTexture(type, i, &buffer);
+		mesh.setGeometry(geometry);
+
+		geometry.baseVertex += int(mesh.getVertices().size());
+		geometry.firstIndex += uint32_t(mesh.getIndices().size());
+	}
+
+	// Meshes without indices keep an empty draw, so the draw index of every mesh is also its material index.
+	lodDrawRanges.resize(lodCount);
 
-		std::string filepath = buffer.C_Str();
-		bool skip = false;
+	for (uint32_t lod = 0; lod < lodCount; lod++)
+	{
+		DrawRanges& ranges = lodDrawRanges[lod];
 
-		for (uint32_t j = 0; j < loadedTextures.size(); j++)
+		for (const Mesh& mesh : meshes)
 		{
-			if (filepath == loadedTextures[j].filepath)
-			{
-				textures.push_back(loadedTextures[j]);
-				skip = true;
+			uint32_t meshLod = std::min(lod, std::max(mesh.getLodCount(), 1u) - 1);
+			uint32_t indexOffset = mesh.getLodCount() > 0 ? mesh.getLods()[meshLod].indexOffset : 0;
 
-				break;
-			}
+			ranges.counts.push_back(GLsizei(mesh.getIndexCount(meshLod)));
+			ranges.offsets.push_back((const void*)(size_t(mesh.getGeometry().firstIndex + indexOffset) * getIndexSize(indexType)));
+			ranges.baseVertices.push_back(mesh.getGeometry().baseVertex);
 		}
+	}
 
-		if (!skip)
-		{
-			MeshTexture texture;
+	std::cout << "[LOG] MODEL: " << meshes.size() << " meshes packed into " << vertices.size() << " vertices and " << indices.size() << (indexType == GL_UNSIGNED_SHORT ? " 16 bits" : " 32 bits") << " indices." << std::endl;
+}
 
-			texture.ID = loadTexture((directory + "/" + filepath).c_str());
-			texture.filepath = filepath;
+MaterialLibrary::Material Model::loadMaterial(const aiScene* scene, uint32_t sceneMaterial)
+{
+	if (sceneMaterial >= scene->mNumMaterials)
+	{
+		return MaterialLibrary::Material(); // Meshes without a valid material get an empty one (no textures).
+	}
 
-			switch (type)
-			{
-			case aiTextureType_DIFFUSE:
-				texture.type = MeshTexture::Type::DIFFUSE;
-				break;
-			case aiTextureType_SPECULAR:
-				texture.type = MeshTexture::Type::SPECULAR;
-				break;
-			case aiTextureType_AMBIENT:
-				// In most cases, same as DIFFUSE texture.
-				break;
-			case aiTextureType_EMISSIVE:
-				texture.type = MeshTexture::Type::EMISSION;
-				break;
-			case aiTextureType_HEIGHT:
-				texture.type = MeshTexture::Type::NORMAL;
-				break;
-			default:
-				break;
-			}
+	std::map<uint32_t, MaterialLibrary::Material>::iterator it = sceneMaterials.find(sceneMaterial);
+
+	if (it == sceneMaterials.end())
+	{
+		aiMaterial* material = scene->mMaterials[sceneMaterial];
+		MaterialLibrary::Material libraryMaterial;
 
-			std::cout << '\t' << "[LOG] MODEL: Loading material texture \"" << texture.filepath << "\"." << std::endl;
+		libraryMaterial.diffuseMap = loadMaterialTexture(material, aiTextureType_DIFFUSE);
+		libraryMaterial.specularMap = loadMaterialTexture(material, aiTextureType_SPECULAR);
+		libraryMaterial.emissionMap = loadMaterialTexture(material, aiTextureType_EMISSIVE);
+		libraryMaterial.normalMap = loadMaterialTexture(material, aiTextureType_HEIGHT);
 
-			textures.push_back(texture);
-		}
+		it = sceneMaterials.insert({ sceneMaterial, libraryMaterial }).first;
 	}
 
-	return textures;
+	return it->second;
+}
+
+int Model::loadMaterialTexture(aiMaterial* material, aiTextureType type)
+{
+	// A material map is sampled from a single texture, the first one of its type.
+	if (material->GetTextureCount(type) == 0)
+	{
+		return MaterialLibrary::NO_TEXTURE;
+	}
+
+	aiString buffer;
+	material->GetTexture(type, 0, &buffer);
+
+	std::string filepath = buffer.C_Str();
+
+	std::cout << '\t' << "[LOG] MODEL: Loading material texture \"" << filepath << "\"." << std::endl;
+
+	return materialLibrary.addTexture(directory + "/" + filepath);
 }
 
 void Model::processNode(aiNode* node, const aiScene* scene)
@@ -534,7 +708,6 @@ Mesh Model::processMesh(aiMesh* mesh, const aiScene* scene)
 {
 	std::vector<MeshVertex> vertices;
 	std::vector<uint32_t> indices;
-	std::vector<MeshTexture> textures;
 
 	// Process vertex positions, normals and texture coordinates.
 	for (uint32_t i = 0; i < mesh->mNumVertices; i++)
@@ -574,24 +747,9 @@ Mesh Model::processMesh(aiMesh* mesh, const aiScene* scene)
 	}
 
 	// Process material.
-	if (mesh->mMaterialIndex >= 0)
-	{
-		aiMaterial* material = scene->mMaterials[mesh->mMaterialIndex];
-
-		std::vector<MeshTexture> diffuseMaps = loadMaterialTextures(material, aiTextureType_DIFFUSE);
-		textures.insert(textures.end(), diffuseMaps.begin(), diffuseMaps.end());
-
-		std::vector<MeshTexture> specularMaps = loadMaterialTextures(material, aiTextureType_SPECULAR);
-		textures.insert(textures.end(), specularMaps.begin(), specularMaps.end());
-
-		std::vector<MeshTexture> emissionMaps = loadMaterialTextures(material, aiTextureType_EMISSIVE);
-		textures.insert(textures.end(), emissionMaps.begin(), emissionMaps.end());
-
-		std::vector<MeshTexture> normalMaps = loadMaterialTextures(material, aiTextureType_HEIGHT);
-		textures.insert(textures.end(), normalMaps.begin(), normalMaps.end());
-	}
+	uint32_t materialIndex = materialLibrary.addMaterial(loadMaterial(scene, mesh->mMaterialIndex));
 
 	animator.processBones(mesh, vertices);
 
-	return Mesh(vertices, indices, textures);
+	return Mesh(vertices, indices, &materialLibrary, materialIndex);
 }
@@ -3,6 +3,7 @@
 #include <map>
 #include <vector>
 #include <string>
+#include <cstring>
 #include <iostream>
 
 #include <glad/glad.h>
@@ -21,8 +22,13 @@
 #include <assimp/postprocess.h>
 
 #include "../graphics/shader.h"
+#include "../graphics/material_library.h"
+#include "../utils/mesh_simplifier.h"
+#include "../utils/mesh_optimizer.h"
+#include "../utils/vertex_compression.h"
+#include "../systems/job_system.h"
+#include "../utils/profiler.h"
 
-#define MAX_NUM_BONES 100
 #define MAX_NUM_BONES_PER_VERTEX 4
 
 struct ModelNode
@@ -216,14 +222,15 @@ struct MeshVertex
     }
 };
 
-struct MeshTexture
+// GPU layout of "MeshVertex" with "VertexFormat::PACKED" (24 bytes instead of 64).
+struct PackedMeshVertex
 {
-    enum class Type { DIFFUSE, SPECULAR, EMISSION, NORMAL };
+    uint16_t position[4]; // Quantized inside the model AABB, the last one is padding.
+    uint32_t normal; // Octahedral.
+    uint32_t uvs; // Half floats.
 
-    uint32_t ID;
-    Type type;
-
-    std::string filepath;
+    uint8_t boneIDs[MAX_NUM_BONES_PER_VERTEX];
+    uint8_t weights[MAX_NUM_BONES_PER_VERTEX]; // Normalized, adding up to 255.
 };
 
 class Animation
@@ -246,15 +253,24 @@ private:
     float currTime;
 
     std::map<std::string, AnimNode> animNodes;
+
+    // Nodes sampled by the worker threads (rebuilt every update, the map is copied with the animation).
+    std::vector<AnimNode*> sampledNodes;
+
+    static void sampleNodes(uint32_t begin, uint32_t end, void* data);
 };
 
 class Animator
 {
 public:
+    // Shader storage binding point of the bones matrices palette.
+    static const uint32_t BONES_BINDING_POINT = 0;
+
     Animator();
 
     uint32_t getCurrAnimation() { return currAnimation; }
     const std::vector<glm::mat4>& getBonesMatrices() { return bonesMatrices; }
+    uint32_t getBoneCount() const { return uint32_t(bonesMatrices.size()); }
     const std::vector<Animation>& getAnimations() { return animations; }
 
     void processModelNodes(const aiScene* scene);
@@ -265,12 +281,20 @@ public:
     void update(float deltaTime);
     void clean();
 
+    // Uploads the palette (when it changed since the last upload) and binds it as a shader storage buffer.
+    void bindBonesMatrices(uint32_t bindingPoint = BONES_BINDING_POINT);
+
     void execAnimation(uint32_t number);
     void execAnimation(const std::string name);
 
 private:
     uint32_t currAnimation;
 
+    // Palette storage, grown to fit the skeleton.
+    uint32_t bonesBuffer;
+    uint32_t bonesBufferCapacity;
+    bool bonesChanged;
+
     ModelNode rootModelNode;
     glm::mat4 globalTransformation;
 
@@ -279,6 +303,9 @@ private:
 
     std::vector<Animation> animations;
 
+    uint32_t addBone(const std::string& name, const glm::mat4& offsetMatrix);
+    void uploadBonesMatrices();
+
     void readModelNodeHierarchy(const aiNode* source, ModelNode& destination);
     void calcBoneTransformation(ModelNode& boneNode, const glm::mat4& parentTransformation);
 };
@@ -286,40 +313,103 @@ private:
 class Mesh
 {
 public:
-    Mesh(const std::vector<MeshVertex>& vertices, const std::vector<uint32_t>& indices, const std::vector<MeshTexture>& textures);
+    Mesh(const std::vector<MeshVertex>& vertices, const std::vector<uint32_t>& indices, MaterialLibrary* materialLibrary, uint32_t materialIndex);
+
+    const std::vector<MeshVertex>& getVertices() const { return vertices; }
+    const std::vector<uint32_t>& getIndices() const { return indices; } // All LODs, the LOD 0 are the first "getIndexCount(0)" indices.
+    uint32_t getIndexCount(uint32_t lod = 0) const { return lod < lods.size() ? lods[lod].indexCount : 0; }
+
+    uint32_t getLodCount() const { return uint32_t(lods.size()); }
+    const std::vector<MeshLod>& getLods() const { return lods; }
+
+    // Where the mesh is in the vertex and index buffers shared by all meshes of its model, and how they are encoded.
+    struct Geometry
+    {
+        uint32_t VAO = 0;
+        int baseVertex = 0;
+        uint32_t firstIndex = 0;
+        uint32_t indexType = GL_UNSIGNED_INT;
+
+        VertexFormat vertexFormat = VertexFormat::FULL;
+        PositionQuantization positionQuantization;
+    };
+
+    uint32_t getVAO() const { return geometry.VAO; } // Shared by all meshes of the model.
+    uint32_t getMaterialID() const { return materialLibrary->getID(); } // Meshes of a model share their texture bindings.
+    uint32_t getMaterialIndex() const { return materialIndex; }
+
+    const Geometry& getGeometry() const { return geometry; }
+    void setGeometry(const Geometry& newGeometry) { geometry = newGeometry; }
 
-    void render(ShaderProgram* shader);
+    // Binds the material library of the model and draws the mesh.
+    void render(ShaderProgram* shader, uint32_t lod = 0);
+
+    // Same as "render", but expects the material library to be bound already: only the mesh material index is set.
+    void draw(ShaderProgram* shader, uint32_t lod = 0);
     void clean();
 
 private:
-    uint32_t VAO, VBO, IBO;
+    Geometry geometry;
 
     std::vector<MeshVertex> vertices;
     std::vector<uint32_t> indices;
-    std::vector<MeshTexture> textures;
 
-    void load();
+    MaterialLibrary* materialLibrary;
+    uint32_t materialIndex;
+
+    std::vector<MeshLod> lods;
+
+    void generateLods();
+    void optimize();
 };
 
 class Model
 {
 public:
-    Model(const char* filepath, uint32_t flags = aiProcess_Triangulate | aiProcess_FlipUVs);
+    Model(const char* filepath, uint32_t flags = aiProcess_Triangulate | aiProcess_FlipUVs, VertexFormat vertexFormat = VertexFormat::FULL);
 
-    void render(ShaderProgram* shader);
+    const std::vector<Mesh>& getMeshes() const { return meshes; }
+    std::vector<Mesh>& getMeshes() { return meshes; }
+
+    // Meshes with fewer LODs than "lod" are drawn with their coarsest one. All meshes go in a single multi-draw call.
+    void render(ShaderProgram* shader, uint32_t lod = 0);
     void clean();
 
+    const MaterialLibrary& getMaterialLibrary() const { return materialLibrary; }
+    VertexFormat getVertexFormat() const { return vertexFormat; }
+
     Animator animator; // FIXME: should be private?
 
 private:
+    // Arguments of "glMultiDrawElementsBaseVertex" drawing every mesh at a given LOD, one draw per mesh (in order).
+    struct DrawRanges
+    {
+        std::vector<GLsizei> counts;
+        std::vector<const void*> offsets;
+        std::vector<GLint> baseVertices;
+    };
+
     std::vector<Mesh> meshes;
-    std::vector<MeshTexture> loadedTextures;
     std::string directory;
 
+    // Vertices and indices of all meshes.
+    uint32_t VAO, VBO, IBO;
+    uint32_t indexType;
+
+    VertexFormat vertexFormat;
+    PositionQuantization positionQuantization;
+
+    std::vector<DrawRanges> lodDrawRanges;
+
+    // Each mesh has its own library material (with the same index of the mesh), so a multi-draw can select it with "gl_DrawID".
+    MaterialLibrary materialLibrary;
+    std::map<uint32_t, MaterialLibrary::Material> sceneMaterials; // Scene materials already loaded.
+
     void load(const char* filepath, uint32_t flags);
-    uint32_t loadTexture(const char* filepath, bool gammaCorrection = false);
+    void loadGeometry();
 
-    std::vector<MeshTexture> loadMaterialTextures(aiMaterial* material, aiTextureType type);
+    MaterialLibrary::Material loadMaterial(const aiScene* scene, uint32_t sceneMaterial);
+    int loadMaterialTexture(aiMaterial* material, aiTextureType type);
 
     void processNode(aiNode* node, const aiScene* scene);
     Mesh processMesh(aiMesh* mesh, const aiScene* scene);
@@ -1,5 +1,34 @@
 #include "shader.h"
 
+ShaderProgram::ShaderProgram(const char* csFilepath) : ID()
+{
+	int success;
+	char infoLog[512];
+
+	uint32_t csID = createShader(csFilepath, GL_COMPUTE_SHADER);
+
+	ID = glCreateProgram();
+
+	glAttachShader(ID, csID);
+
+	glLinkProgram(ID);
+
+	glGetProgramiv(ID, GL_LINK_STATUS, &success);
+
+	if (!success)
+	{
+		glGetProgramInfoLog(ID, 512, NULL, infoLog);
+
+		std::cout << "[ERROR] SHADER PROGRAM: Linkage failed!\n" << infoLog << std::endl;
+	}
+	else
+	{
+		reflect();
+	}
+
+	glDeleteShader(csID);
+}
+
 ShaderProgram::ShaderProgram(const char* vsFilepath, const char* fsFilepath) : ID()
 {
 	int success;
@@ -23,6 +52,10 @@ ShaderProgram::ShaderProgram(const char* vsFilepath, const char* fsFilepath) : I
 
 		std::cout << "[ERROR] SHADER PROGRAM: Linkage failed!\n" << infoLog << std::endl;
 	}
+	else
+	{
+		reflect();
+	}
 
 	glDeleteShader(vsID);
 	glDeleteShader(fsID);
@@ -53,6 +86,10 @@ ShaderProgram::ShaderProgram(const char* vsFilepath, const char* gsFilepath, con
 
 		std::cout << "[ERROR] SHADER PROGRAM: Linkage failed!\n" << infoLog << std::endl;
 	}
+	else
+	{
+		reflect();
+	}
 
 	glDeleteShader(vsID);
 	glDeleteShader(gsID);
@@ -86,6 +123,10 @@ ShaderProgram::ShaderProgram(const char* vsFilepath, const char* tcsFilepath, co
 
 		std::cout << "[ERROR] SHADER PROGRAM: Linkage failed!\n" << infoLog << std::endl;
 	}
+	else
+	{
+		reflect();
+	}
 
 	glDeleteShader(vsID);
 	glDeleteShader(tcsID);
@@ -95,103 +136,296 @@ ShaderProgram::ShaderProgram(const char* vsFilepath, const char* tcsFilepath, co
 
 void ShaderProgram::bind()
 {
-	glUseProgram(ID);
+	GLState::useProgram(ID);
 }
 
 void ShaderProgram::unbind()
 {
-	glUseProgram(0);
+	GLState::useProgram(0);
 }
 
-void ShaderProgram::setUniform1i(const char* uniformName, int data)
+UniformHandle ShaderProgram::getUniform(const UniformName& uniformName)
 {
-	int uniformLocation = getUniformLocation(uniformName);
+	UniformHandle uniform = findUniform(uniformName);
+
+	if (uniform.isValid())
+	{
+		return uniform;
+	}
 
-	if (uniformLocation > -1)
+#ifdef _DEBUG
+	if (std::find(reportedUniforms.begin(), reportedUniforms.end(), uniformName.hash) == reportedUniforms.end())
 	{
-		glUniform1i(uniformLocation, data);
+		std::cout << "[ERROR] SHADER PROGRAM: Uniform \"" << uniformName.string << "\" is not active in program " << ID << " (misspelled or optimized out)." << std::endl;
+
+		reportedUniforms.push_back(uniformName.hash);
 	}
+#endif
+
+	return UniformHandle();
 }
 
-void ShaderProgram::setUniform1f(const char* uniformName, float data)
+UniformHandle ShaderProgram::findUniform(const UniformName& uniformName) const
 {
-	int uniformLocation = getUniformLocation(uniformName);
+	std::vector<UniformInfo>::const_iterator it = std::lower_bound(uniforms.begin(), uniforms.end(), uniformName.hash,
+		[](const UniformInfo& info, uint32_t hash) { return info.hash < hash; });
 
-	if (uniformLocation > -1)
+	if (it != uniforms.end() && it->hash == uniformName.hash)
 	{
-		glUniform1f(uniformLocation, data);
+		return it->handle;
 	}
+
+	return UniformHandle();
 }
 
-void ShaderProgram::setUniform3f(const char* uniformName, const glm::vec3& data)
+const UniformBlockInfo* ShaderProgram::getUniformBlock(const UniformName& blockName) const
 {
-	int uniformLocation = getUniformLocation(uniformName);
-
-	if (uniformLocation > -1)
+	for (const UniformBlockInfo& block : uniformBlocks)
 	{
-		glUniform3f(uniformLocation, data.x, data.y, data.z);
+		if (block.hash == blockName.hash)
+		{
+			return &block;
+		}
 	}
+
+	return nullptr;
 }
 
-void ShaderProgram::setUniform4f(const char* uniformName, const glm::vec4& data)
+void ShaderProgram::setUniform1i(const UniformHandle& uniform, int data)
 {
-	int uniformLocation = getUniformLocation(uniformName);
+	if (uniform.isValid())
+	{
+#ifdef _DEBUG
+		checkUniform(uniform, GL_INT, 1);
+#endif
 
-	if (uniformLocation > -1)
+		glUniform1i(uniform.location, data);
+	}
+}
+
+void ShaderProgram::setUniform1iv(const UniformHandle& uniform, const int* data, int count)
+{
+	if (uniform.isValid())
 	{
-		glUniform4f(uniformLocation, data.x, data.y, data.z, data.w);
+#ifdef _DEBUG
+		checkUniform(uniform, GL_INT, count);
+#endif
+
+		glUniform1iv(uniform.location, count, data);
 	}
 }
 
-void ShaderProgram::setUniformMatrix3fv(const char* uniformName, const glm::mat3& data)
+void ShaderProgram::setUniform1f(const UniformHandle& uniform, float data)
 {
-	int uniformLocation = getUniformLocation(uniformName);
+	if (uniform.isValid())
+	{
+#ifdef _DEBUG
+		checkUniform(uniform, GL_FLOAT, 1);
+#endif
+
+		glUniform1f(uniform.location, data);
+	}
+}
 
-	if (uniformLocation > -1)
+void ShaderProgram::setUniform3f(const UniformHandle& uniform, const glm::vec3& data)
+{
+	if (uniform.isValid())
 	{
-		glUniformMatrix3fv(uniformLocation, 1, GL_FALSE, glm::value_ptr(data));
+#ifdef _DEBUG
+		checkUniform(uniform, GL_FLOAT_VEC3, 1);
+#endif
+
+		glUniform3f(uniform.location, data.x, data.y, data.z);
 	}
 }
 
-void ShaderProgram::setUniformMatrix4fv(const char* uniformName, const glm::mat4& data)
+void ShaderProgram::setUniform4f(const UniformHandle& uniform, const glm::vec4& data)
 {
-	int uniformLocation = getUniformLocation(uniformName);
+	if (uniform.isValid())
+	{
+#ifdef _DEBUG
+		checkUniform(uniform, GL_FLOAT_VEC4, 1);
+#endif
 
-	if (uniformLocation > -1)
+		glUniform4f(uniform.location, data.x, data.y, data.z, data.w);
+	}
+}
+
+void ShaderProgram::setUniform4fv(const UniformHandle& uniform, const glm::vec4* data, int count)
+{
+	if (uniform.isValid())
 	{
-		glUniformMatrix4fv(uniformLocation, 1, GL_FALSE, glm::value_ptr(data));
+#ifdef _DEBUG
+		checkUniform(uniform, GL_FLOAT_VEC4, count);
+#endif
+
+		glUniform4fv(uniform.location, count, glm::value_ptr(data[0]));
 	}
 }
 
-void ShaderProgram::clean()
+void ShaderProgram::setUniformMatrix3fv(const UniformHandle& uniform, const glm::mat3& data)
 {
-	glDeleteProgram(ID);
+	if (uniform.isValid())
+	{
+#ifdef _DEBUG
+		checkUniform(uniform, GL_FLOAT_MAT3, 1);
+#endif
+
+		glUniformMatrix3fv(uniform.location, 1, GL_FALSE, glm::value_ptr(data));
+	}
 }
 
-int ShaderProgram::getUniformLocation(const char* uniformName)
+void ShaderProgram::setUniformMatrix4fv(const UniformHandle& uniform, const glm::mat4& data)
 {
-	std::map<std::string, int>::iterator it = uniformsLocations.find(uniformName);
+	if (uniform.isValid())
+	{
+#ifdef _DEBUG
+		checkUniform(uniform, GL_FLOAT_MAT4, 1);
+#endif
+
+		glUniformMatrix4fv(uniform.location, 1, GL_FALSE, glm::value_ptr(data));
+	}
+}
 
-	if (it != uniformsLocations.end())
+void ShaderProgram::setUniformMatrix4fv(const UniformHandle& uniform, const glm::mat4* data, int count)
+{
+	if (uniform.isValid())
 	{
-		return it->second;
+#ifdef _DEBUG
+		checkUniform(uniform, GL_FLOAT_MAT4, count);
+#endif
+
+		glUniformMatrix4fv(uniform.location, count, GL_FALSE, glm::value_ptr(data[0]));
 	}
-	else
+}
+
+void ShaderProgram::clean()
+{
+	GLState::deleteProgram(ID);
+}
+
+void ShaderProgram::reflect()
+{
+	int uniformCount = 0, blockCount = 0, maxNameLength = 0, maxBlockNameLength = 0;
+
+	glGetProgramiv(ID, GL_ACTIVE_UNIFORMS, &uniformCount);
+	glGetProgramiv(ID, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxNameLength);
+	glGetProgramiv(ID, GL_ACTIVE_UNIFORM_BLOCKS, &blockCount);
+	glGetProgramiv(ID, GL_ACTIVE_UNIFORM_BLOCK_MAX_NAME_LENGTH, &maxBlockNameLength);
+
+	std::vector<char> name(std::max(std::max(maxNameLength, maxBlockNameLength), 1));
+	std::vector<std::string> names; // Only needed to detect hash collisions.
+
+	uniforms.clear();
+	uniformBlocks.clear();
+
+	for (uint32_t index = 0; index < uint32_t(uniformCount); index++)
 	{
-		int uniformLocation = glGetUniformLocation(ID, uniformName);
+		int blockIndex = -1, length = 0, size = 0;
+		GLenum type = GL_NONE;
+
+		// Members of uniform blocks have no location, their data comes from buffers.
+		glGetActiveUniformsiv(ID, 1, &index, GL_UNIFORM_BLOCK_INDEX, &blockIndex);
+
+		if (blockIndex > -1)
+		{
+			continue;
+		}
 
-		if (uniformLocation > -1)
+		glGetActiveUniform(ID, index, GLsizei(name.size()), &length, &size, &type, name.data());
+
+		UniformHandle handle;
+		handle.location = glGetUniformLocation(ID, name.data());
+		handle.type = type;
+		handle.size = size;
+
+		if (handle.location < 0)
 		{
-			uniformsLocations.insert({ uniformName, uniformLocation });
+			continue; // Built-in variables ("gl_*").
 		}
-		else
+
+		std::string uniformName(name.data(), length);
+
+		uniforms.push_back({ hashUniformName(uniformName.c_str()), handle });
+		names.push_back(uniformName);
+
+		// Arrays are reported as "name[0]", but can be looked up by their base name too.
+		if (uniformName.size() > 3 && uniformName.compare(uniformName.size() - 3, 3, "[0]") == 0)
 		{
-			std::cout << "[ERROR] SHADER PROGRAM: Failed to get location of uniform \"" << uniformName << "\"." << std::endl;
+			uniformName.resize(uniformName.size() - 3);
+
+			uniforms.push_back({ hashUniformName(uniformName.c_str()), handle });
+			names.push_back(uniformName);
 		}
-		
-		return uniformLocation;
+	}
+
+	// Sorting the names together with the table, so collisions can be reported by name.
+	std::vector<uint32_t> order(uniforms.size());
+
+	for (uint32_t i = 0; i < uint32_t(order.size()); i++)
+	{
+		order[i] = i;
+	}
+
+	std::sort(order.begin(), order.end(), [this](uint32_t a, uint32_t b) { return uniforms[a].hash < uniforms[b].hash; });
+
+	std::vector<UniformInfo> sortedUniforms(uniforms.size());
+
+	for (uint32_t i = 0; i < uint32_t(order.size()); i++)
+	{
+		sortedUniforms[i] = uniforms[order[i]];
+
+		if (i > 0 && sortedUniforms[i].hash == sortedUniforms[i - 1].hash)
+		{
+			std::cout << "[ERROR] SHADER PROGRAM: Uniforms \"" << names[order[i - 1]] << "\" and \"" << names[order[i]] << "\" have the same name hash." << std::endl;
+		}
+	}
+
+	uniforms.swap(sortedUniforms);
+
+	for (uint32_t index = 0; index < uint32_t(blockCount); index++)
+	{
+		int length = 0, binding = 0, dataSize = 0;
+
+		glGetActiveUniformBlockName(ID, index, GLsizei(name.size()), &length, name.data());
+		glGetActiveUniformBlockiv(ID, index, GL_UNIFORM_BLOCK_BINDING, &binding);
+		glGetActiveUniformBlockiv(ID, index, GL_UNIFORM_BLOCK_DATA_SIZE, &dataSize);
+
+		uniformBlocks.push_back({ hashUniformName(std::string(name.data(), length).c_str()), index, binding, dataSize });
+	}
+}
+
+#ifdef _DEBUG
+static bool isFloatUniformType(uint32_t type)
+{
+	switch (type)
+	{
+	case GL_FLOAT: case GL_FLOAT_VEC2: case GL_FLOAT_VEC3: case GL_FLOAT_VEC4:
+	case GL_FLOAT_MAT2: case GL_FLOAT_MAT3: case GL_FLOAT_MAT4:
+		return true;
+
+	default:
+		return false;
+	}
+}
+
+void ShaderProgram::checkUniform(const UniformHandle& uniform, uint32_t expectedType, int count)
+{
+	// Integer setters are also used for booleans, samplers and images.
+	bool compatible = expectedType == GL_INT ? !isFloatUniformType(uniform.type) : uniform.type == expectedType;
+
+	if (!compatible)
+	{
+		std::cout << "[ERROR] SHADER PROGRAM: Uniform at location " << uniform.location << " of program " << ID << " has type 0x" << std::hex << uniform.type << std::dec
+			<< ", but was set as 0x" << std::hex << expectedType << std::dec << "." << std::endl;
+	}
+
+	if (count > uniform.size)
+	{
+		std::cout << "[ERROR] SHADER PROGRAM: Uniform at location " << uniform.location << " of program " << ID << " has " << uniform.size << " elements, but " << count << " were set." << std::endl;
 	}
 }
+#endif
 
 uint32_t ShaderProgram::createShader(const char* filepath, int shaderType)
 {
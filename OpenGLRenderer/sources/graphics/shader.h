@@ -1,6 +1,9 @@
 #pragma once
 
-#include <map>
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <algorithm>
 #include <fstream>
 #include <sstream>
 #include <iostream>
@@ -11,33 +14,117 @@
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 
+#include "../graphics/gl_state.h"
 #include "../utils/debug.h"
 
+// FNV-1a hash of a uniform name. Being "constexpr", names known at compile time can be hashed by the compiler.
+constexpr uint32_t hashUniformName(const char* name)
+{
+	uint32_t hash = 2166136261u;
+
+	while (*name != '\0')
+	{
+		hash = (hash ^ uint32_t(uint8_t(*name))) * 16777619u;
+		name++;
+	}
+
+	return hash;
+}
+
+// Uniform name and its hash. Only a "static constexpr" declaration guarantees the hash is computed by the compiler, a literal
+// passed to a setter is hashed at run time unless the optimizer folds it. Per frame call sites declare their names once per file.
+struct UniformName
+{
+	uint32_t hash;
+	const char* string;
+
+	constexpr UniformName(const char* name) : hash(hashUniformName(name)), string(name) {}
+};
+
+// Location of an active uniform, resolved once by the call site. Invalid handles (misspelled or optimized out uniforms) are ignored by the setters.
+struct UniformHandle
+{
+	int location = -1;
+	uint32_t type = GL_NONE;
+	int size = 0; // Number of elements of arrays, 1 otherwise.
+
+	bool isValid() const { return location > -1; }
+};
+
+// Active uniform block of the program, as declared in the shaders.
+struct UniformBlockInfo
+{
+	uint32_t hash;
+	uint32_t index;
+	int binding;
+	int dataSize;
+};
+
 class ShaderProgram
 {
 public:
+	ShaderProgram(const char* csFilepath); // Compute shader program.
 	ShaderProgram(const char* vsFilepath, const char* fsFilepath);
 	ShaderProgram(const char* vsFilepath, const char* gsFilepath, const char* fsFilepath);
 	ShaderProgram(const char* vsFilepath, const char* tcsFilepath, const char* tesFilepath, const char* fsFilepath);
 
+	uint32_t getID() const { return ID; }
+
 	void bind();
 	void unbind();
 
-	void setUniform1i(const char* uniformName, int data);
-	void setUniform1f(const char* uniformName, float data);
-	void setUniform3f(const char* uniformName, const glm::vec3& data);
-	void setUniform4f(const char* uniformName, const glm::vec4& data);
-	void setUniformMatrix3fv(const char* uniformName, const glm::mat3& data);
-	void setUniformMatrix4fv(const char* uniformName, const glm::mat4& data);
+	// Looks up the uniform in the table built when the program was linked. Array uniforms can be found with or without the "[0]" suffix.
+	UniformHandle getUniform(const UniformName& uniformName);
+
+	// Same as "getUniform", but missing uniforms are expected (e.g. optional uniforms only some programs declare) and never reported.
+	UniformHandle findUniform(const UniformName& uniformName) const;
+	const UniformBlockInfo* getUniformBlock(const UniformName& blockName) const;
+
+	const std::vector<UniformBlockInfo>& getUniformBlocks() const { return uniformBlocks; }
+	uint32_t getActiveUniformCount() const { return uint32_t(uniforms.size()); }
+
+	void setUniform1i(const UniformHandle& uniform, int data);
+	void setUniform1iv(const UniformHandle& uniform, const int* data, int count);
+	void setUniform1f(const UniformHandle& uniform, float data);
+	void setUniform3f(const UniformHandle& uniform, const glm::vec3& data);
+	void setUniform4f(const UniformHandle& uniform, const glm::vec4& data);
+	void setUniform4fv(const UniformHandle& uniform, const glm::vec4* data, int count);
+	void setUniformMatrix3fv(const UniformHandle& uniform, const glm::mat3& data);
+	void setUniformMatrix4fv(const UniformHandle& uniform, const glm::mat4& data);
+	void setUniformMatrix4fv(const UniformHandle& uniform, const glm::mat4* data, int count);
+
+	void setUniform1i(const UniformName& uniformName, int data) { setUniform1i(getUniform(uniformName), data); }
+	void setUniform1iv(const UniformName& uniformName, const int* data, int count) { setUniform1iv(getUniform(uniformName), data, count); }
+	void setUniform1f(const UniformName& uniformName, float data) { setUniform1f(getUniform(uniformName), data); }
+	void setUniform3f(const UniformName& uniformName, const glm::vec3& data) { setUniform3f(getUniform(uniformName), data); }
+	void setUniform4f(const UniformName& uniformName, const glm::vec4& data) { setUniform4f(getUniform(uniformName), data); }
+	void setUniform4fv(const UniformName& uniformName, const glm::vec4* data, int count) { setUniform4fv(getUniform(uniformName), data, count); }
+	void setUniformMatrix3fv(const UniformName& uniformName, const glm::mat3& data) { setUniformMatrix3fv(getUniform(uniformName), data); }
+	void setUniformMatrix4fv(const UniformName& uniformName, const glm::mat4& data) { setUniformMatrix4fv(getUniform(uniformName), data); }
+	void setUniformMatrix4fv(const UniformName& uniformName, const glm::mat4* data, int count) { setUniformMatrix4fv(getUniform(uniformName), data, count); }
 
 	void clean();
 
 private:
+	struct UniformInfo
+	{
+		uint32_t hash;
+		UniformHandle handle;
+	};
+
 	uint32_t ID;
 
-	std::map<std::string, int> uniformsLocations;
+	// Active uniforms of the default block and active uniform blocks, sorted by name hash.
+	std::vector<UniformInfo> uniforms;
+	std::vector<UniformBlockInfo> uniformBlocks;
+
+#ifdef _DEBUG
+	std::vector<uint32_t> reportedUniforms; // Missing uniforms already reported, so each one is only reported once.
+
+	void checkUniform(const UniformHandle& uniform, uint32_t expectedType, int count);
+#endif
 
-	int getUniformLocation(const char* uniformName);
+	void reflect();
 
 	uint32_t createShader(const char* filepath, int shaderType);
 };
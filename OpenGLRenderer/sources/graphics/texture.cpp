@@ -11,7 +11,7 @@ Texture::Texture(const char* filepath, GLenum filter, GLenum clampMode, bool gam
 	stbi_uc* data = stbi_load(filepath, &width, &height, &colorChannels, 0);
 
 	glGenTextures(1, &ID);
-	glBindTexture(GL_TEXTURE_2D, ID);
+	GLState::bindTexture(GL_TEXTURE_2D, ID);
 
 	// WARNING!
 	// 
@@ -83,7 +83,7 @@ Texture::Texture(const char* filepath, GLenum filter, GLenum clampMode, bool gam
 		std::cerr << "[ERROR] TEXTURE: Failed to load texture \"" << filepath << "\"." << std::endl;
 	}
 
-	glBindTexture(GL_TEXTURE_2D, 0);
+	GLState::bindTexture(GL_TEXTURE_2D, 0);
 
 	std::cout << '\t' << "[LOG] TEXTURE: (colorChannels, " << colorChannels << ") (internalFormat, 0x" << std::hex << internalFormat << ") (format, 0x" << std::hex << format << ")." << std::endl;
 	std::cout << std::dec;
@@ -95,7 +95,7 @@ Texture::Texture(unsigned char* data, int width, int height, int internalFormat,
 	: ID(), width(width), height(height)
 {
 	glGenTextures(1, &ID);
-	glBindTexture(GL_TEXTURE_2D, ID);
+	GLState::bindTexture(GL_TEXTURE_2D, ID);
 
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
@@ -104,15 +104,15 @@ Texture::Texture(unsigned char* data, int width, int height, int internalFormat,
 
 	glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, width, height, 0, format, GL_UNSIGNED_BYTE, data);
 
-	glBindTexture(GL_TEXTURE_2D, 0);
+	GLState::bindTexture(GL_TEXTURE_2D, 0);
 }
 
 void Texture::bind(int unit)
 {
 	if (unit >= 0 && unit <= 15)
 	{
-		glActiveTexture(GL_TEXTURE0 + unit);
-		glBindTexture(GL_TEXTURE_2D, ID);
+		GLState::activeTexture(GL_TEXTURE0 + unit);
+		GLState::bindTexture(GL_TEXTURE_2D, ID);
 	}
 	else
 	{
@@ -122,10 +122,10 @@ void Texture::bind(int unit)
 
 void Texture::unbind()
 {
-	glBindTexture(GL_TEXTURE_2D, 0);
+	GLState::bindTexture(GL_TEXTURE_2D, 0);
 }
 
 void Texture::clean()
 {
-	glDeleteTextures(1, &ID);
+	GLState::deleteTextures(1, &ID);
 }
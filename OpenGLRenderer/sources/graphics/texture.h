@@ -4,6 +4,8 @@
 
 #include <glad/glad.h>
 
+#include "../graphics/gl_state.h"
+
 #if !defined _STB_IMAGE_INCLUDED
 #define _STB_IMAGE_INCLUDED
 
@@ -0,0 +1,61 @@
+#include "view_uniform_buffer.h"
+
+static_assert(sizeof(ViewUniforms) == 3 * 64 + 2 * 16, "ViewUniforms must match the std140 layout of the shader block.");
+
+ViewUniformBuffer::ViewUniformBuffer(uint32_t maxViews)
+	: stream(nullptr), maxViews(maxViews), stride(), frameOffset(0)
+{
+	int alignment = 256;
+
+	glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+
+	stride = (uint32_t(sizeof(ViewUniforms)) + uint32_t(alignment) - 1) / uint32_t(alignment) * uint32_t(alignment);
+
+	blocks.resize(size_t(stride) * maxViews, 0);
+
+	// The region size is a multiple of the alignment, so every region starts aligned.
+	stream = new StreamBuffer(int(blocks.size()), GL_UNIFORM_BUFFER);
+}
+
+void ViewUniformBuffer::setView(uint32_t view, const ViewUniforms& uniforms)
+{
+	if (view >= maxViews)
+	{
+		std::cout << "[ERROR] VIEW UNIFORM BUFFER: View " << view << " out of range." << std::endl;
+
+		return;
+	}
+
+	std::memcpy(&blocks[size_t(view) * stride], &uniforms, sizeof(ViewUniforms));
+}
+
+void ViewUniformBuffer::setView(uint32_t view, const Camera& camera, float time, const glm::vec4& clipPlane, const glm::mat4& lightSpaceMatrix)
+{
+	setView(view, { camera.getProjectionMatrix(), camera.getViewMatrix(), lightSpaceMatrix, glm::vec4(camera.getPosition(), time), clipPlane });
+}
+
+void ViewUniformBuffer::upload()
+{
+	stream->beginFrame();
+
+	void* destination = stream->allocate(int(blocks.size()), int(stride), frameOffset);
+
+	if (destination)
+	{
+		std::memcpy(destination, blocks.data(), blocks.size());
+	}
+}
+
+void ViewUniformBuffer::bindView(uint32_t view)
+{
+	GLState::bindBufferRange(GL_UNIFORM_BUFFER, BINDING_POINT, stream->getID(), GLintptr(frameOffset) + GLintptr(view) * stride, sizeof(ViewUniforms));
+}
+
+void ViewUniformBuffer::clean()
+{
+	stream->clean();
+
+	delete stream;
+
+	stream = nullptr;
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+
+#include <glad/glad.h>
+
+#include <glm/glm.hpp>
+
+#include "../camera.h"
+#include "../graphics/gl_state.h"
+#include "../graphics/buffer.h"
+
+// Per view data shared by all programs, with the same (std140) layout of the "ViewUniforms" block in the shaders:
+//
+//   layout (std140, binding = 0) uniform ViewUniforms
+//   {
+//       mat4 uProjectionMatrix;
+//       mat4 uViewMatrix;
+//       mat4 uLightSpaceMatrix;
+//       vec4 uViewPosition; // w: time in seconds.
+//       vec4 uClipPlane;
+//   };
+//
+struct ViewUniforms
+{
+	glm::mat4 projectionMatrix;
+	glm::mat4 viewMatrix;
+	glm::mat4 lightSpaceMatrix; // Of the shadow view, so the other views can sample its shadow map.
+	glm::vec4 viewPosition;
+	glm::vec4 clipPlane;
+};
+
+// One uniform buffer holding the blocks of every view of a frame (e.g. main, reflection, refraction and shadow views).
+// The blocks are uploaded at once, and switching views only rebinds a range of the buffer to "BINDING_POINT",
+// instead of setting the camera uniforms of every program in every pass. Each frame writes its blocks into its own region of a stream buffer.
+class ViewUniformBuffer
+{
+public:
+	static const uint32_t BINDING_POINT = 0;
+
+	ViewUniformBuffer(uint32_t maxViews = 1);
+
+	void setView(uint32_t view, const ViewUniforms& uniforms);
+	void setView(uint32_t view, const Camera& camera, float time = 0.0f, const glm::vec4& clipPlane = glm::vec4(0.0f), const glm::mat4& lightSpaceMatrix = glm::mat4(1.0f));
+
+	// Sends the blocks of all views to the GPU. Must be called once per frame.
+	void upload();
+
+	void bindView(uint32_t view);
+
+	void clean();
+
+private:
+	StreamBuffer* stream;
+
+	uint32_t maxViews;
+	uint32_t stride; // Size of a block rounded up to the uniform buffer offset alignment.
+	int frameOffset; // Where the blocks of the current frame start in the stream buffer.
+
+	std::vector<unsigned char> blocks;
+};
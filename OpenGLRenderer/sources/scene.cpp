@@ -1 +1,31 @@
 #include "scene.h"
+
+const char* getSceneTypeName(SceneTypes type)
+{
+	switch (type)
+	{
+	case SceneTypes::INSTANCING:
+		return "instancing";
+
+	case SceneTypes::FRUSTUM_CULLING:
+		return "frustum_culling";
+
+	case SceneTypes::GRASS:
+		return "grass";
+
+	case SceneTypes::PARTICLES:
+		return "particles";
+
+	case SceneTypes::SKELETAL_ANIMATION:
+		return "skeletal_animation";
+
+	case SceneTypes::WATER:
+		return "water";
+
+	case SceneTypes::TESSELLATION:
+		return "tessellation";
+
+	default:
+		return "unknown";
+	}
+}
@@ -1,11 +1,13 @@
 #pragma once
 
-#include <list>
+#include <vector>
+#include <string>
 
 #include <imgui/imgui.h>
 
 #include "camera.h"
 #include "entity.h"
+#include "systems/entity_pool.h"
 
 enum class SceneTypes
 {
@@ -15,13 +17,18 @@ enum class SceneTypes
 	PARTICLES,
 	SKELETAL_ANIMATION,
 	WATER,
-	TESSELLATION
+	TESSELLATION,
+	NUMBER_OF_SCENE_TYPES
 };
 
+// Lowercase name of the scene (e.g. "frustum_culling"), used by the benchmark options and results.
+const char* getSceneTypeName(SceneTypes type);
+
 class Scene
 {
 public:
 	Scene() = default;
+	virtual ~Scene() = default;
 
 	virtual void setup() = 0;
 	virtual void clean() = 0;
@@ -31,6 +38,13 @@ public:
 
 	virtual void processGUI() = 0;
 
+	// Overrides a scale parameter (e.g. the number of instances) before "setup". Returns false for unknown parameters.
+	virtual bool setParameter(const std::string& /*name*/, float /*value*/) { return false; }
+
 protected:
-	std::list<std::unique_ptr<Entity>> entities;
+	TransformHierarchy transformHierarchy;
+
+	EntityPool entityPool;
+
+	std::vector<Entity*> entities; // Root entities.
 };
@@ -1,41 +1,117 @@
 #include "frustum_culling_scene.h"
 
 FrustumCullingScene::FrustumCullingScene()
-	: Scene(), modelRenderShader(nullptr), marsModel(nullptr)
+	: Scene(), modelRenderShader(nullptr), instancingModelRenderShader(nullptr), indirectModelRenderShader(nullptr), viewUniformBuffer(nullptr), marsModel(nullptr),
+	  cullingMode(CullingMode::BATCH), cullerMode(FrustumCuller::getBestMode()), boundingVolumeType(BoundingVolumeType::SPHERE),
+	  totalEntities(0), displayedEntities(0), nodesVisited(0), drawCalls(0), trianglesDrawn(0), cullingTime(0.0f),
+	  vertexVisibleEntities(0), volumeVisibleEntities{ 0, 0, 0 }, volumeFalsePositives{ 0, 0, 0 }, volumeMissedEntities{ 0, 0, 0 },
+	  instancedBatching(true), lodSelection(true), measureEfficiency(false), rotateEntities(false)
 {
 }
 
 void FrustumCullingScene::setup()
 {
 	modelRenderShader = new ShaderProgram("sources/shaders/1_render_model_vs.glsl", "sources/shaders/1_render_model_fs.glsl");
-	marsModel = new BasicModel("resources/models/mars/mars.obj");
+	instancingModelRenderShader = new ShaderProgram("sources/shaders/2_render_model_with_instancing_vs.glsl", "sources/shaders/2_render_model_with_instancing_fs.glsl");
+	indirectModelRenderShader = new ShaderProgram("sources/shaders/12_render_model_indirect_vs.glsl", "sources/shaders/12_render_model_indirect_fs.glsl");
+
+	viewUniformBuffer = new ViewUniformBuffer();
+	marsModel = new BasicModel("resources/models/mars/mars.obj", VertexFormat::PACKED);
 
 	// Generating scene entities.
+	entityPool.reserve(20 * 20);
+
 	for (int x = 0; x < 20; ++x)
 	{
 		for (int z = 0; z < 20; ++z)
 		{
-			entities.push_back(std::make_unique<Entity>(marsModel));
+			Entity* entity = entityPool.create(&transformHierarchy, nullptr, marsModel);
 
-			Entity* entity = entities.back().get();
+			entities.push_back(entity);
 
 			entity->transform.setLocalPosition({ x * 10.f - 100.f,  0.f, z * 10.f - 100.f });
-			entity->updateSelfAndChildren();
 		}
 	}
+
+	nodeEntities.resize(transformHierarchy.getSize(), nullptr);
+	globalSpheres.resize(transformHierarchy.getSize());
+	entityLods.resize(transformHierarchy.getSize(), 0);
+
+	// The pool holds every entity (not only the roots).
+	for (uint32_t handle = 0; handle < entityPool.getSize(); handle++)
+	{
+		Entity* entity = entityPool.get(handle);
+
+		nodeEntities[entity->transform.getIndex()] = entity;
+	}
+
+	transformHierarchy.update();
+
+	updateGlobalSpheres();
+
+	bvh.build(globalSpheres);
+
+	std::vector<BasicModel*> entityModels;
+
+	for (Entity* entity : nodeEntities)
+	{
+		entityModels.push_back(entity->model);
+	}
+
+	gpuCuller.setup(entityModels);
+	instanceBatcher.setup(transformHierarchy.getSize());
+	gpuCuller.updateEntities(globalSpheres, transformHierarchy.getModelMatrices());
 }
 
 void FrustumCullingScene::clean()
 {
 	modelRenderShader->clean();
+	instancingModelRenderShader->clean();
+	indirectModelRenderShader->clean();
+	viewUniformBuffer->clean();
 	marsModel->clean();
 
+	gpuCuller.clean();
+	instanceBatcher.clean();
+
+	// Every entity goes away at once, with its chunk.
+	entities.clear();
+	nodeEntities.clear();
+	entityPool.release();
+	transformHierarchy.clear();
+
 	delete modelRenderShader;
+	delete instancingModelRenderShader;
+	delete indirectModelRenderShader;
+	delete viewUniformBuffer;
 	delete marsModel;
 }
 
 void FrustumCullingScene::update(float deltaTime)
 {
+	if (rotateEntities)
+	{
+		for (Entity* entity : entities)
+		{
+			glm::vec3 eulerRotation = entity->transform.getLocalEulerRotation();
+
+			eulerRotation.y = std::fmod(eulerRotation.y + 45.0f * deltaTime, 360.0f);
+
+			entity->transform.setLocalEulerRotation(eulerRotation);
+		}
+	}
+
+	transformHierarchy.update();
+
+	if (transformHierarchy.getRecomputedCount() > 0)
+	{
+		updateGlobalSpheres();
+
+		// Moved entities only grow or shrink the boxes above them, the tree itself is kept.
+		bvh.refit(globalSpheres);
+
+		gpuCuller.updateEntities(globalSpheres, transformHierarchy.getModelMatrices());
+	}
 }
 
 void FrustumCullingScene::render(const Camera& camera, float deltaTime)
@@ -48,23 +124,381 @@ void FrustumCullingScene::render(const Camera& camera, float deltaTime)
 	glClearColor(0.25f, 0.5f, 0.75f, 1.0f);
 	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-	modelRenderShader->bind();
+	viewUniformBuffer->setView(0, camera);
+	viewUniformBuffer->upload();
+	viewUniformBuffer->bindView(0);
 
-	modelRenderShader->setUniformMatrix4fv("uProjectionMatrix", camera.getProjectionMatrix());
-	modelRenderShader->setUniformMatrix4fv("uViewMatrix", camera.getViewMatrix());
+	totalEntities = 0;
+	displayedEntities = 0;
 
-	uint32_t total = 0, display = 0;
+	nodesVisited = 0;
+	trianglesDrawn = 0;
+
+	if (measureEfficiency)
+	{
+		measureCullingEfficiency(cameraFrustum);
+	}
 
-	for (std::unique_ptr<Entity>& entity : entities)
+	if (cullingMode == CullingMode::PER_ENTITY)
 	{
-		entity->renderSelfAndChildren(modelRenderShader, cameraFrustum, display, total);
+		modelRenderShader->bind();
+
+		// Scalar fallback: every entity tests its own bounding volume while the hierarchy is traversed.
+		for (Entity* entity : entities)
+		{
+			entity->renderSelfAndChildren(modelRenderShader, cameraFrustum, displayedEntities, totalEntities);
+		}
+
+		modelRenderShader->unbind();
+
+		drawCalls = displayedEntities;
+
+		return;
 	}
 
-	std::cout << "Entities in CPU: " << total << " / Entities sent to GPU: " << display << std::endl;
+	if (cullingMode == CullingMode::GPU)
+	{
+		indirectModelRenderShader->bind();
+
+		// Culling and draws never leave the GPU: no per entity loop nor uniform upload.
+		gpuCuller.cull(cameraFrustum);
+		gpuCuller.render(indirectModelRenderShader);
+
+		indirectModelRenderShader->unbind();
+
+		totalEntities = globalSpheres.getSize();
+		displayedEntities = gpuCuller.getVisibleCount();
+
+		drawCalls = gpuCuller.getDrawCommandCount();
+
+		return;
+	}
+
+	std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+
+	if (cullingMode == CullingMode::BATCH)
+	{
+		FrustumCuller::cullToBitmask(cameraFrustum, globalSpheres, visibilityMask, cullerMode);
+		FrustumCuller::compactBitmask(visibilityMask, globalSpheres.getSize(), visibleIndices);
+	}
+	else
+	{
+		bvh.cull(cameraFrustum, globalSpheres, visibleIndices);
 
-	modelRenderShader->unbind();
+		nodesVisited = bvh.getNodesVisited();
+	}
+
+	cullingTime = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+
+	totalEntities = globalSpheres.getSize();
+	displayedEntities = uint32_t(visibleIndices.size());
+
+	buildDrawList(camera);
+
+	if (instancedBatching)
+	{
+		instancingModelRenderShader->bind();
+
+		instanceBatcher.begin();
+
+		for (const EntityDraw& draw : drawList)
+		{
+			instanceBatcher.add(draw.model, draw.modelMatrix, draw.lod);
+		}
+
+		instanceBatcher.render(instancingModelRenderShader);
+
+		instancingModelRenderShader->unbind();
+
+		drawCalls = instanceBatcher.getDrawCalls();
+		trianglesDrawn = instanceBatcher.getTriangleCount();
+	}
+	else
+	{
+		modelRenderShader->bind();
+
+		UniformHandle modelMatrix = modelRenderShader->getUniform("uModelMatrix");
+
+		for (const EntityDraw& draw : drawList)
+		{
+			modelRenderShader->setUniformMatrix4fv(modelMatrix, draw.modelMatrix);
+
+			draw.model->render(modelRenderShader, 1, draw.lod);
+
+			trianglesDrawn += draw.model->getIndexCount(draw.lod) / 3;
+		}
+
+		modelRenderShader->unbind();
+
+		drawCalls = displayedEntities;
+	}
 }
 
 void FrustumCullingScene::processGUI()
 {
+	bool dialogOpen = true;
+	ImGui::Begin("Frustum Culling Dialog", &dialogOpen);
+
+	ImGui::Text("Entities in CPU: %u / Entities sent to GPU: %u / BVH nodes visited: %u", totalEntities, displayedEntities, nodesVisited);
+	ImGui::Text("Draw calls: %u / Triangles: %u", drawCalls, trianglesDrawn);
+	ImGui::Text("Model matrices recomputed: %u", transformHierarchy.getRecomputedCount());
+
+	ImGui::SeparatorText("Culling");
+
+	const char* cullingItems[] = { "Per Entity (Scalar)", "Batch (SoA)", "BVH", "GPU (Compute + Indirect)" };
+	int cullingSelectedItem = int(cullingMode);
+
+	if (ImGui::Combo("Culling Mode", &cullingSelectedItem, cullingItems, 4))
+	{
+		cullingMode = CullingMode(cullingSelectedItem);
+	}
+
+	if (cullingMode == CullingMode::PER_ENTITY)
+	{
+		const char* volumeItems[] = { "Sphere (Ritter)", "AABB", "OBB (PCA)" };
+		int volumeSelectedItem = int(boundingVolumeType);
+
+		if (ImGui::Combo("Bounding Volume", &volumeSelectedItem, volumeItems, 3))
+		{
+			boundingVolumeType = BoundingVolumeType(volumeSelectedItem);
+
+			for (Entity* entity : nodeEntities)
+			{
+				entity->setBoundingVolumeType(boundingVolumeType);
+			}
+		}
+	}
+
+	if (cullingMode == CullingMode::BATCH)
+	{
+		const char* kernelItems[] = { "Scalar", "SSE (4-wide)", "AVX (8-wide)" };
+		int kernelSelectedItem = int(cullerMode);
+
+		if (ImGui::Combo("Kernel", &kernelSelectedItem, kernelItems, 3))
+		{
+			if (FrustumCuller::isModeSupported(FrustumCuller::Mode(kernelSelectedItem)))
+			{
+				cullerMode = FrustumCuller::Mode(kernelSelectedItem);
+			}
+		}
+
+	}
+
+	if (cullingMode == CullingMode::BVH)
+	{
+		ImGui::Text("BVH nodes: %u / Rebuilds: %u", uint32_t(bvh.getNodes().size()), bvh.getRebuildCount());
+	}
+
+	if (cullingMode == CullingMode::GPU)
+	{
+		ImGui::Text("Visible entities are read back one frame late.");
+	}
+
+	if (cullingMode == CullingMode::BATCH || cullingMode == CullingMode::BVH)
+	{
+		ImGui::Text("Culling time: %.4f ms", cullingTime);
+
+		ImGui::SeparatorText("Rendering");
+
+		// Visible entities sharing a model (and a LOD) are drawn with a single instanced call.
+		ImGui::Checkbox("Instanced Batching", &instancedBatching);
+
+		ImGui::SeparatorText("Level of Detail");
+
+		ImGui::Checkbox("LOD Selection", &lodSelection);
+
+		if (lodSelection)
+		{
+			float baseScreenSize = lodSelector.getBaseScreenSize();
+			float hysteresis = lodSelector.getHysteresis();
+
+			if (ImGui::SliderFloat("Base Screen Size", &baseScreenSize, 0.01f, 1.0f))
+			{
+				lodSelector.setBaseScreenSize(baseScreenSize);
+			}
+
+			if (ImGui::SliderFloat("Hysteresis", &hysteresis, 0.0f, 0.5f))
+			{
+				lodSelector.setHysteresis(hysteresis);
+			}
+
+			for (uint32_t lod = 0; lod < lodEntityCounts.size(); lod++)
+			{
+				ImGui::Text("LOD %u (%u triangles): %u entities", lod, marsModel->getIndexCount(lod) / 3, lodEntityCounts[lod]);
+			}
+		}
+	}
+
+	ImGui::SeparatorText("Culling Efficiency");
+
+	// Entities accepted by each volume that the exact test (against the transformed vertices) rejects.
+	ImGui::Checkbox("Measure Culling Efficiency", &measureEfficiency);
+
+	if (measureEfficiency)
+	{
+		const char* volumeNames[] = { "Sphere", "AABB", "OBB" };
+
+		ImGui::Text("Vertices: %u visible", vertexVisibleEntities);
+
+		for (uint32_t i = 0; i < 3; i++)
+		{
+			float falsePositiveRate = volumeVisibleEntities[i] > 0 ? 100.0f * float(volumeFalsePositives[i]) / float(volumeVisibleEntities[i]) : 0.0f;
+
+			ImGui::Text("%s: %u visible, at least %u false positives (%.1f%%), %u missed (non-conservative)", volumeNames[i], volumeVisibleEntities[i],
+				volumeFalsePositives[i], falsePositiveRate, volumeMissedEntities[i]);
+		}
+	}
+
+	ImGui::SeparatorText("Entities");
+
+	ImGui::Checkbox("Rotate Entities", &rotateEntities);
+
+	ImGui::SeparatorText("Dev");
+
+	if (ImGui::Button("Run Transform Benchmark"))
+	{
+		benchmarkTransformUpdate();
+	}
+
+	if (ImGui::Button("Run Culling Benchmark"))
+	{
+		benchmarkFrustumCulling();
+	}
+
+	if (ImGui::Button("Run Entity Allocation Benchmark"))
+	{
+		benchmarkEntityAllocation(marsModel);
+	}
+
+	if (ImGui::Button("Run Vertex Compression Benchmark"))
+	{
+		benchmarkVertexCompression(marsModel);
+	}
+
+	ImGui::End();
+}
+
+void FrustumCullingScene::updateGlobalSpheres()
+{
+	JobSystem::parallelFor(uint32_t(nodeEntities.size()), BATCH_SIZE, updateGlobalSpheresJob, this);
+}
+
+void FrustumCullingScene::buildDrawList(const Camera& camera)
+{
+	lodSelector.setCamera(camera.getPosition(), camera.getProjectionProperties().fov);
+
+	drawList.resize(visibleIndices.size());
+
+	JobSystem::parallelFor(uint32_t(visibleIndices.size()), BATCH_SIZE, buildDrawListJob, this);
+
+	lodEntityCounts.assign(marsModel->getLodCount(), 0);
+
+	for (const EntityDraw& draw : drawList)
+	{
+		if (draw.lod < lodEntityCounts.size())
+		{
+			lodEntityCounts[draw.lod] += 1;
+		}
+	}
+}
+
+void FrustumCullingScene::measureCullingEfficiency(const Frustum& frustum)
+{
+	glm::vec4 planes[FrustumCuller::NUMBER_OF_PLANES];
+
+	FrustumCuller::getPlanes(frustum, planes);
+
+	vertexVisibleEntities = 0;
+
+	for (uint32_t i = 0; i < 3; i++)
+	{
+		volumeVisibleEntities[i] = 0;
+		volumeFalsePositives[i] = 0;
+		volumeMissedEntities[i] = 0;
+	}
+
+	for (uint32_t index = 0; index < nodeEntities.size(); index++)
+	{
+		Entity* entity = nodeEntities[index];
+		const glm::mat4& modelMatrix = transformHierarchy.getModelMatrix(index);
+
+		bool volumeVisible[3] = {
+			Sphere(entity->model).computeGlobalSphere(modelMatrix).BoundingVolume::isOnFrustum(frustum),
+			AABB(entity->model).computeGlobalAABB(modelMatrix).BoundingVolume::isOnFrustum(frustum),
+			OBB(entity->model).computeGlobalOBB(modelMatrix).BoundingVolume::isOnFrustum(frustum)
+		};
+
+		// The mesh is culled only when all of its vertices are behind the same plane. Still conservative, not exact: a mesh
+		// outside the frustum but near one of its corners (in front of every plane) is counted as visible.
+		bool visible = true;
+
+		for (uint32_t p = 0; p < FrustumCuller::NUMBER_OF_PLANES && visible; p++)
+		{
+			// Moving the plane to local space ("dot(plane, M * v) == dot(transpose(M) * plane, v)") instead of transforming every vertex.
+			glm::vec4 localPlane = glm::transpose(modelMatrix) * planes[p];
+			bool forward = false;
+
+			for (const BMVertex& vertex : entity->model->getVertices())
+			{
+				if (glm::dot(localPlane, glm::vec4(vertex.position, 1.0f)) > 0.0f)
+				{
+					forward = true;
+
+					break;
+				}
+			}
+
+			visible = forward;
+		}
+
+		vertexVisibleEntities += visible ? 1 : 0;
+
+		for (uint32_t i = 0; i < 3; i++)
+		{
+			volumeVisibleEntities[i] += volumeVisible[i] ? 1 : 0;
+			volumeFalsePositives[i] += volumeVisible[i] && !visible ? 1 : 0;
+			volumeMissedEntities[i] += !volumeVisible[i] && visible ? 1 : 0;
+		}
+	}
+}
+
+void FrustumCullingScene::updateGlobalSpheresJob(uint32_t begin, uint32_t end, void* data)
+{
+	FrustumCullingScene* scene = (FrustumCullingScene*)data;
+
+	// Only entities whose model matrix changed need a new world space sphere (and a new global scale).
+	for (uint32_t index = begin; index < end; index++)
+	{
+		if (scene->transformHierarchy.wasUpdated(index))
+		{
+			Sphere globalSphere = Sphere(scene->nodeEntities[index]->model).computeGlobalSphere(scene->transformHierarchy.getModelMatrix(index));
+
+			scene->globalSpheres.set(index, globalSphere.center, globalSphere.radius);
+		}
+	}
+}
+
+void FrustumCullingScene::buildDrawListJob(uint32_t begin, uint32_t end, void* data)
+{
+	FrustumCullingScene* scene = (FrustumCullingScene*)data;
+
+	for (uint32_t i = begin; i < end; i++)
+	{
+		uint32_t index = scene->visibleIndices[i];
+		BasicModel* model = scene->nodeEntities[index]->model;
+
+		if (scene->lodSelection)
+		{
+			// Entities culled for a while resume from their old LOD, "select" moves across as many LODs as needed at once.
+			float screenSize = scene->lodSelector.computeScreenSize(scene->globalSpheres.getCenter(index), scene->globalSpheres.radii[index]);
+
+			scene->entityLods[index] = scene->lodSelector.select(screenSize, scene->entityLods[index], model->getLodCount());
+		}
+		else
+		{
+			scene->entityLods[index] = 0;
+		}
+
+		scene->drawList[i] = { model, scene->transformHierarchy.getModelMatrix(index), scene->entityLods[index] };
+	}
 }
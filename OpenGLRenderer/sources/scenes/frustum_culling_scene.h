@@ -1,10 +1,19 @@
 #pragma once
 
 #include <memory>
+#include <chrono>
 
 #include "../graphics/shader.h"
 #include "../graphics/basic_model.h"
+#include "../graphics/view_uniform_buffer.h"
+#include "../systems/frustum_culler.h"
+#include "../systems/bvh.h"
+#include "../systems/instance_batcher.h"
+#include "../systems/gpu_culler.h"
+#include "../systems/lod_selector.h"
+#include "../systems/job_system.h"
 #include "../scene.h"
+#include "../utils/dev/benchmark.h"
 
 class FrustumCullingScene : public Scene
 {
@@ -19,7 +28,69 @@ public:
 
 	void processGUI();
 
+	enum class CullingMode { PER_ENTITY, BATCH, BVH, GPU };
+
 private:
 	ShaderProgram* modelRenderShader;
+	ShaderProgram* instancingModelRenderShader;
+	ShaderProgram* indirectModelRenderShader;
+	ViewUniformBuffer* viewUniformBuffer;
 	BasicModel* marsModel;
+
+	CullingMode cullingMode;
+	FrustumCuller::Mode cullerMode;
+	BoundingVolumeType boundingVolumeType;
+
+	// Entities and their world space bounding spheres, indexed by transform hierarchy node.
+	std::vector<Entity*> nodeEntities;
+	SphereBatch globalSpheres;
+
+	BoundingVolumeHierarchy bvh;
+
+	InstanceBatcher instanceBatcher;
+	GPUCuller gpuCuller;
+
+	// LOD drawn by every entity in the last frame (indexed by transform hierarchy node), needed by the hysteresis.
+	LodSelector lodSelector;
+	std::vector<uint32_t> entityLods;
+	std::vector<uint32_t> lodEntityCounts;
+
+	std::vector<uint32_t> visibilityMask;
+	std::vector<uint32_t> visibleIndices;
+
+	// Draws of the visible entities, gathered by the worker threads. The GL thread only walks it.
+	struct EntityDraw
+	{
+		BasicModel* model;
+		glm::mat4 modelMatrix;
+		uint32_t lod;
+	};
+
+	std::vector<EntityDraw> drawList;
+
+	uint32_t totalEntities, displayedEntities, nodesVisited, drawCalls, trianglesDrawn;
+	float cullingTime;
+
+	// Culling efficiency of every bounding volume type (sphere, AABB and OBB) against a per vertex test. The vertex test is also
+	// conservative, so the false positives are a lower bound. Missed entities are culled by a volume but kept by the vertex test:
+	// the volume doesn't contain its mesh.
+	uint32_t vertexVisibleEntities;
+	uint32_t volumeVisibleEntities[3];
+	uint32_t volumeFalsePositives[3];
+	uint32_t volumeMissedEntities[3];
+
+	bool instancedBatching;
+	bool lodSelection;
+	bool measureEfficiency;
+	bool rotateEntities;
+
+	// Entities per job.
+	static const uint32_t BATCH_SIZE = 64;
+
+	void updateGlobalSpheres();
+	void buildDrawList(const Camera& camera);
+	void measureCullingEfficiency(const Frustum& frustum);
+
+	static void updateGlobalSpheresJob(uint32_t begin, uint32_t end, void* data);
+	static void buildDrawListJob(uint32_t begin, uint32_t end, void* data);
 };
@@ -1,7 +1,29 @@
 #include "grass_scene.h"
 
+// Names of the uniforms set every frame, hashed by the compiler.
+static constexpr UniformName TEXTURE_UNIFORM("uTexture");
+static constexpr UniformName WIND_DIRECTION_UNIFORM("uWindDirection");
+static constexpr UniformName WIND_INTENSITY_UNIFORM("uWindIntensity");
+static constexpr UniformName TIME_UNIFORM("uTime");
+static constexpr UniformName WIND_EFFECT_UNIFORM("uWindEffect");
+static constexpr UniformName NOISE_SCALE_UNIFORM("uNoiseScale");
+static constexpr UniformName NOISE_STRENGTH_UNIFORM("uNoiseStrength");
+static constexpr UniformName NOISE_TEX_UNIFORM("uNoiseTex");
+static constexpr UniformName MODEL_MATRIX_UNIFORM("uModelMatrix");
+static constexpr UniformName LIGHT_AMBIENT_UNIFORM("uLight.ambient");
+static constexpr UniformName LIGHT_DIFFUSE_UNIFORM("uLight.diffuse");
+static constexpr UniformName LIGHT_SPECULAR_UNIFORM("uLight.specular");
+static constexpr UniformName LIGHT_POSITION_UNIFORM("uLight.position");
+static constexpr UniformName MATERIAL_DIFFUSE_UNIFORM("uMaterial.diffuse");
+static constexpr UniformName MATERIAL_SPECULAR_UNIFORM("uMaterial.specular");
+static constexpr UniformName MATERIAL_SHININESS_UNIFORM("uMaterial.shininess");
+static constexpr UniformName SHADOW_MAP_UNIFORM("uShadowMap");
+static constexpr UniformName SHADOW_BIAS_FACTOR_UNIFORM("uShadowBiasFactor");
+static constexpr UniformName MAX_SHADOW_BIAS_UNIFORM("uMaxShadowBias");
+
 GrassScene::GrassScene()
 	: Scene(), currGrassType(GrassType::MONOCHROMATIC), nextGrassType(GrassType::MONOCHROMATIC),
+	  viewUniformBuffer(nullptr),
 	  grassRenderShader(nullptr),
 	  grassVAO(nullptr), grassVBO(nullptr), instanceMatricesVBO(nullptr),
 	  modelMatrices(nullptr), instances(1000000),
@@ -91,7 +113,7 @@ void GrassScene::setup()
 		 0.0f,  1.0f,  0.0f,  0.0f,  0.0f,  1.0f, // top
 	};
 
-	std::srand(std::time(NULL));
+	viewUniformBuffer = new ViewUniformBuffer(NUMBER_OF_VIEWS);
 
 	if (currGrassType == GrassType::TEXTURIZED)
 	{
@@ -312,6 +334,10 @@ void GrassScene::clean()
 
 		delete[] modelMatrices;
 	}
+
+	viewUniformBuffer->clean();
+
+	delete viewUniformBuffer;
 }
 
 void GrassScene::update(float deltaTime)
@@ -346,22 +372,28 @@ void GrassScene::render(const Camera& camera, float deltaTime)
 {
 	if (currGrassType == GrassType::TEXTURIZED)
 	{
+		viewUniformBuffer->setView(MAIN_VIEW, camera, time);
+		viewUniformBuffer->upload();
+		viewUniformBuffer->bindView(MAIN_VIEW);
+
 		grassRenderShader->bind();
 		colorMapTex->bind(0);
 		grassVAO->bind();
 
-		grassRenderShader->setUniformMatrix4fv("uProjectionMatrix", camera.getProjectionMatrix());
-		grassRenderShader->setUniformMatrix4fv("uViewMatrix", camera.getViewMatrix());
-		grassRenderShader->setUniform1i("uTexture", 0);
-		grassRenderShader->setUniform3f("uWindDirection", glm::normalize(windDirection));
-		grassRenderShader->setUniform1f("uWindIntensity", windIntensity);
-		grassRenderShader->setUniform1f("uTime", time);
+		grassRenderShader->setUniform1i(TEXTURE_UNIFORM, 0);
+		grassRenderShader->setUniform3f(WIND_DIRECTION_UNIFORM, glm::normalize(windDirection));
+		grassRenderShader->setUniform1f(WIND_INTENSITY_UNIFORM, windIntensity);
+		grassRenderShader->setUniform1f(TIME_UNIFORM, time);
 
 		glClearColor(0.25f, 0.5f, 0.75f, 1.0f);
 		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
+		GPUTimer::begin("Grass");
+
 		glDrawArraysInstanced(GL_TRIANGLES, 0, 12, instances);
 
+		GPUTimer::end();
+
 		grassVAO->unbind();
 		colorMapTex->unbind();
 		grassRenderShader->unbind();
@@ -378,10 +410,18 @@ void GrassScene::render(const Camera& camera, float deltaTime)
 		glm::mat4 lightViewMatrix = glm::lookAt(lightPosition, glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
 		glm::mat4 lightSpaceMatrix = lightProjectionMatrix * lightViewMatrix;
 
+		viewUniformBuffer->setView(MAIN_VIEW, camera, time, glm::vec4(0.0f), lightSpaceMatrix);
+		viewUniformBuffer->setView(SHADOW_VIEW, { lightProjectionMatrix, lightViewMatrix, lightSpaceMatrix, glm::vec4(lightPosition, time), glm::vec4(0.0f) });
+		viewUniformBuffer->upload();
+
 		shadowMap->bindDepthBuffer(0);
 		noiseTex->bind(1);
 
 		// Render shadow map.
+		GPUTimer::begin("Shadow Map");
+
+		viewUniformBuffer->bindView(SHADOW_VIEW);
+
 		grassVAO->bind();
 		shadowMap->bind();
 		shadowMapRender->bind();
@@ -391,15 +431,14 @@ void GrassScene::render(const Camera& camera, float deltaTime)
 
 		glClear(GL_DEPTH_BUFFER_BIT);
 
-		shadowMapRender->setUniformMatrix4fv("uLightSpaceMatrix", lightSpaceMatrix);
-		shadowMapRender->setUniform1i("uWindEffect", int(windEffect));
-		shadowMapRender->setUniform3f("uWindDirection", glm::normalize(windDirection));
-		shadowMapRender->setUniform1f("uWindIntensity", windIntensity);
-		shadowMapRender->setUniform1f("uNoiseScale", noiseScale);
-		shadowMapRender->setUniform1f("uNoiseStrength", noiseStrength);
-		shadowMapRender->setUniform1f("uTime", time);
+		shadowMapRender->setUniform1i(WIND_EFFECT_UNIFORM, int(windEffect));
+		shadowMapRender->setUniform3f(WIND_DIRECTION_UNIFORM, glm::normalize(windDirection));
+		shadowMapRender->setUniform1f(WIND_INTENSITY_UNIFORM, windIntensity);
+		shadowMapRender->setUniform1f(NOISE_SCALE_UNIFORM, noiseScale);
+		shadowMapRender->setUniform1f(NOISE_STRENGTH_UNIFORM, noiseStrength);
+		shadowMapRender->setUniform1f(TIME_UNIFORM, time);
 
-		shadowMapRender->setUniform1i("uNoiseTex", 1);
+		shadowMapRender->setUniform1i(NOISE_TEX_UNIFORM, 1);
 
 		glDrawArraysInstanced(GL_TRIANGLES, 0, 15, instances);
 
@@ -407,73 +446,77 @@ void GrassScene::render(const Camera& camera, float deltaTime)
 		shadowMap->unbind();
 		grassVAO->unbind();
 
+		GPUTimer::end();
+
 		// Render scene.
 		glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
 
+		viewUniformBuffer->bindView(MAIN_VIEW);
+
 		glClearColor(clearColor.r, clearColor.g, clearColor.b, 1.0f);
 		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
 		// Draw ground.
 		{
+			GPUTimer::begin("Ground");
+
 			glm::mat4 modelMatrix(1.0f);
 			modelMatrix = glm::scale(modelMatrix, glm::vec3(1000.0f, 1.0f, 1000.0f));
 
 			groundVAO->bind();
 			genericModelRenderShader->bind();
 
-			genericModelRenderShader->setUniformMatrix4fv("uProjectionMatrix", camera.getProjectionMatrix());
-			genericModelRenderShader->setUniformMatrix4fv("uViewMatrix", camera.getViewMatrix());
-			genericModelRenderShader->setUniformMatrix4fv("uModelMatrix", modelMatrix);
-			genericModelRenderShader->setUniformMatrix4fv("uLightSpaceMatrix", lightSpaceMatrix);
-
-			genericModelRenderShader->setUniform3f("uLight.ambient", lightAmbientComp);
-			genericModelRenderShader->setUniform3f("uLight.diffuse", lightDiffuseComp);
-			genericModelRenderShader->setUniform3f("uLight.specular", lightSpecularComp);
-			genericModelRenderShader->setUniform3f("uLight.position", lightPosition);
-			genericModelRenderShader->setUniform3f("uMaterial.diffuse", grassDiffuseComp);
-			genericModelRenderShader->setUniform3f("uMaterial.specular", grassSpecularComp);
-			genericModelRenderShader->setUniform1f("uMaterial.shininess", grassSpecularShininess);
-			genericModelRenderShader->setUniform1i("uShadowMap", 0);
-			genericModelRenderShader->setUniform3f("uViewPos", camera.getPosition());
-			genericModelRenderShader->setUniform1f("uShadowBiasFactor", 0.0005f);
-			genericModelRenderShader->setUniform1f("uMaxShadowBias", 0.00005f);
+			genericModelRenderShader->setUniformMatrix4fv(MODEL_MATRIX_UNIFORM, modelMatrix);
+
+			genericModelRenderShader->setUniform3f(LIGHT_AMBIENT_UNIFORM, lightAmbientComp);
+			genericModelRenderShader->setUniform3f(LIGHT_DIFFUSE_UNIFORM, lightDiffuseComp);
+			genericModelRenderShader->setUniform3f(LIGHT_SPECULAR_UNIFORM, lightSpecularComp);
+			genericModelRenderShader->setUniform3f(LIGHT_POSITION_UNIFORM, lightPosition);
+			genericModelRenderShader->setUniform3f(MATERIAL_DIFFUSE_UNIFORM, grassDiffuseComp);
+			genericModelRenderShader->setUniform3f(MATERIAL_SPECULAR_UNIFORM, grassSpecularComp);
+			genericModelRenderShader->setUniform1f(MATERIAL_SHININESS_UNIFORM, grassSpecularShininess);
+			genericModelRenderShader->setUniform1i(SHADOW_MAP_UNIFORM, 0);
+			genericModelRenderShader->setUniform1f(SHADOW_BIAS_FACTOR_UNIFORM, 0.0005f);
+			genericModelRenderShader->setUniform1f(MAX_SHADOW_BIAS_UNIFORM, 0.00005f);
 
 			glDrawArrays(GL_TRIANGLES, 0, 6);
 
 			genericModelRenderShader->unbind();
 			groundVAO->unbind();
+
+			GPUTimer::end();
 		}
 
 		// Draw grass.
 		{
+			GPUTimer::begin("Grass");
+
 			grassVAO->bind();
 			grassRenderShader->bind();
 
-			grassRenderShader->setUniformMatrix4fv("uProjectionMatrix", camera.getProjectionMatrix());
-			grassRenderShader->setUniformMatrix4fv("uViewMatrix", camera.getViewMatrix());
-			grassRenderShader->setUniformMatrix4fv("uLightSpaceMatrix", lightSpaceMatrix);
-			grassRenderShader->setUniform1i("uWindEffect", int(windEffect));
-			grassRenderShader->setUniform3f("uWindDirection", windDirection);
-			grassRenderShader->setUniform1f("uWindIntensity", windIntensity);
-			grassRenderShader->setUniform1f("uNoiseScale", noiseScale);
-			grassRenderShader->setUniform1f("uNoiseStrength", noiseStrength);
-			grassRenderShader->setUniform1f("uTime", time);
-
-			grassRenderShader->setUniform3f("uLight.ambient", lightAmbientComp);
-			grassRenderShader->setUniform3f("uLight.diffuse", lightDiffuseComp);
-			grassRenderShader->setUniform3f("uLight.specular", lightSpecularComp);
-			grassRenderShader->setUniform3f("uLight.position", lightPosition);
-			grassRenderShader->setUniform3f("uMaterial.diffuse", grassDiffuseComp);
-			grassRenderShader->setUniform3f("uMaterial.specular", grassSpecularComp);
-			grassRenderShader->setUniform1f("uMaterial.shininess", grassSpecularShininess);
-			grassRenderShader->setUniform1i("uShadowMap", 0);
-			grassRenderShader->setUniform1i("uNoiseTex", 1);
-			grassRenderShader->setUniform3f("uViewPos", camera.getPosition());
+			grassRenderShader->setUniform1i(WIND_EFFECT_UNIFORM, int(windEffect));
+			grassRenderShader->setUniform3f(WIND_DIRECTION_UNIFORM, windDirection);
+			grassRenderShader->setUniform1f(WIND_INTENSITY_UNIFORM, windIntensity);
+			grassRenderShader->setUniform1f(NOISE_SCALE_UNIFORM, noiseScale);
+			grassRenderShader->setUniform1f(NOISE_STRENGTH_UNIFORM, noiseStrength);
+			grassRenderShader->setUniform1f(TIME_UNIFORM, time);
+
+			grassRenderShader->setUniform3f(LIGHT_AMBIENT_UNIFORM, lightAmbientComp);
+			grassRenderShader->setUniform3f(LIGHT_DIFFUSE_UNIFORM, lightDiffuseComp);
+			grassRenderShader->setUniform3f(LIGHT_SPECULAR_UNIFORM, lightSpecularComp);
+			grassRenderShader->setUniform3f(LIGHT_POSITION_UNIFORM, lightPosition);
+			grassRenderShader->setUniform3f(MATERIAL_DIFFUSE_UNIFORM, grassDiffuseComp);
+			grassRenderShader->setUniform3f(MATERIAL_SPECULAR_UNIFORM, grassSpecularComp);
+			grassRenderShader->setUniform1f(MATERIAL_SHININESS_UNIFORM, grassSpecularShininess);
+			grassRenderShader->setUniform1i(SHADOW_MAP_UNIFORM, 0);
+			grassRenderShader->setUniform1i(NOISE_TEX_UNIFORM, 1);
 
 			glDrawArraysInstanced(GL_TRIANGLES, 0, 15, instances);
 
 			grassRenderShader->unbind();
 			grassVAO->unbind();
+
+			GPUTimer::end();
 		}
 
 		// Draw sphere.
@@ -484,22 +527,18 @@ void GrassScene::render(const Camera& camera, float deltaTime)
 			sphereVAO->bind();
 			genericModelRenderShader->bind();
 
-			genericModelRenderShader->setUniformMatrix4fv("uProjectionMatrix", camera.getProjectionMatrix());
-			genericModelRenderShader->setUniformMatrix4fv("uViewMatrix", camera.getViewMatrix());
-			genericModelRenderShader->setUniformMatrix4fv("uModelMatrix", modelMatrix);
-			genericModelRenderShader->setUniformMatrix4fv("uLightSpaceMatrix", lightSpaceMatrix);
-
-			genericModelRenderShader->setUniform3f("uLight.ambient", lightAmbientComp);
-			genericModelRenderShader->setUniform3f("uLight.diffuse", lightDiffuseComp);
-			genericModelRenderShader->setUniform3f("uLight.specular", lightSpecularComp);
-			genericModelRenderShader->setUniform3f("uLight.position", lightPosition);
-			genericModelRenderShader->setUniform3f("uMaterial.diffuse", glm::vec3(0.6f, 0.6f, 0.6f));
-			genericModelRenderShader->setUniform3f("uMaterial.specular", glm::vec3(0.0f, 0.0f, 0.0f));
-			genericModelRenderShader->setUniform1f("uMaterial.shininess", 64.0f);
-			genericModelRenderShader->setUniform1i("uShadowMap", 0);
-			genericModelRenderShader->setUniform3f("uViewPos", camera.getPosition());
-			genericModelRenderShader->setUniform1f("uShadowBiasFactor", 0.0005f);
-			genericModelRenderShader->setUniform1f("uMaxShadowBias", 0.00005f);
+			genericModelRenderShader->setUniformMatrix4fv(MODEL_MATRIX_UNIFORM, modelMatrix);
+
+			genericModelRenderShader->setUniform3f(LIGHT_AMBIENT_UNIFORM, lightAmbientComp);
+			genericModelRenderShader->setUniform3f(LIGHT_DIFFUSE_UNIFORM, lightDiffuseComp);
+			genericModelRenderShader->setUniform3f(LIGHT_SPECULAR_UNIFORM, lightSpecularComp);
+			genericModelRenderShader->setUniform3f(LIGHT_POSITION_UNIFORM, lightPosition);
+			genericModelRenderShader->setUniform3f(MATERIAL_DIFFUSE_UNIFORM, glm::vec3(0.6f, 0.6f, 0.6f));
+			genericModelRenderShader->setUniform3f(MATERIAL_SPECULAR_UNIFORM, glm::vec3(0.0f, 0.0f, 0.0f));
+			genericModelRenderShader->setUniform1f(MATERIAL_SHININESS_UNIFORM, 64.0f);
+			genericModelRenderShader->setUniform1i(SHADOW_MAP_UNIFORM, 0);
+			genericModelRenderShader->setUniform1f(SHADOW_BIAS_FACTOR_UNIFORM, 0.0005f);
+			genericModelRenderShader->setUniform1f(MAX_SHADOW_BIAS_UNIFORM, 0.00005f);
 
 			// glDrawElements(GL_TRIANGLES, sphereIndices.size(), GL_UNSIGNED_INT, 0);
 
@@ -666,3 +705,18 @@ void GrassScene::generateSphereObject(float radius, int slices, int stacks, std:
 		}
 	}
 }
+
+bool GrassScene::setParameter(const std::string& name, float value)
+{
+	if (name == "instances")
+	{
+		// The blades are laid out on a square grid.
+		int side = std::max(int(std::round(std::sqrt(value))), 1);
+
+		instances = side * side;
+
+		return true;
+	}
+
+	return false;
+}
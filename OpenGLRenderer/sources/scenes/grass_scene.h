@@ -10,7 +10,9 @@
 #include "../graphics/buffer.h"
 #include "../graphics/texture.h"
 #include "../graphics/depthmap.h"
+#include "../graphics/view_uniform_buffer.h"
 #include "../scene.h"
+#include "../utils/gpu_timer.h"
 #include "../utils/noise_generator.h"
 #include "../utils/dev/quad_renderer.h"
 
@@ -27,12 +29,20 @@ public:
 
 	void processGUI();
 
+	// "instances" (rounded to a square number).
+	bool setParameter(const std::string& name, float value);
+
 	enum class GrassType { TEXTURIZED, MONOCHROMATIC };
 	enum class WindEffect { SIMPLE, NOISED };
 
 private:
+	// The shadow view is the light (orthographic), the main view also carries the light space matrix to sample the shadow map.
+	enum View { MAIN_VIEW, SHADOW_VIEW, NUMBER_OF_VIEWS };
+
 	GrassType currGrassType, nextGrassType;
 
+	ViewUniformBuffer* viewUniformBuffer;
+
 	ShaderProgram* grassRenderShader;
 
 	VAO* grassVAO;
@@ -1,7 +1,7 @@
 #include "instancing_scene.h"
 
 InstancingScene::InstancingScene()
-	: Scene(), instancingModelRenderShader(nullptr), marsModel(nullptr), modelMatrices(nullptr), instances(400)
+	: Scene(), instancingModelRenderShader(nullptr), viewUniformBuffer(nullptr), marsModel(nullptr), modelMatrices(nullptr), instances(400)
 {
 }
 
@@ -10,6 +10,8 @@ void InstancingScene::setup()
 	int axisLim = int(std::sqrtf(float(instances)));
 
 	instancingModelRenderShader = new ShaderProgram("sources/shaders/2_render_model_with_instancing_vs.glsl", "sources/shaders/2_render_model_with_instancing_fs.glsl");
+
+	viewUniformBuffer = new ViewUniformBuffer();
 	marsModel = new BasicModel("resources/models/mars/mars.obj");
 
 	modelMatrices = new glm::mat4[instances];
@@ -35,9 +37,11 @@ void InstancingScene::setup()
 void InstancingScene::clean()
 {
 	instancingModelRenderShader->clean();
+	viewUniformBuffer->clean();
 	marsModel->clean();
 
 	delete instancingModelRenderShader;
+	delete viewUniformBuffer;
 	delete marsModel;
 
 	delete[] modelMatrices;
@@ -52,10 +56,11 @@ void InstancingScene::render(const Camera& camera, float deltaTime)
 	glClearColor(0.25f, 0.5f, 0.75f, 1.0f);
 	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-	instancingModelRenderShader->bind();
+	viewUniformBuffer->setView(0, camera);
+	viewUniformBuffer->upload();
+	viewUniformBuffer->bindView(0);
 
-	instancingModelRenderShader->setUniformMatrix4fv("uProjectionMatrix", camera.getProjectionMatrix());
-	instancingModelRenderShader->setUniformMatrix4fv("uViewMatrix", camera.getViewMatrix());
+	instancingModelRenderShader->bind();
 
 	marsModel->render(instancingModelRenderShader, instances);
 
@@ -4,6 +4,7 @@
 
 #include "../graphics/shader.h"
 #include "../graphics/basic_model.h"
+#include "../graphics/view_uniform_buffer.h"
 #include "../scene.h"
 
 class InstancingScene : public Scene
@@ -21,6 +22,7 @@ public:
 
 private:
 	ShaderProgram* instancingModelRenderShader;
+	ViewUniformBuffer* viewUniformBuffer;
 	BasicModel* marsModel;
 
 	glm::mat4* modelMatrices;
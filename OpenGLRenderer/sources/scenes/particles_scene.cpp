@@ -1,7 +1,7 @@
 #include "particles_scene.h"
 
 ParticlesScene::ParticlesScene()
-	: maxParticles(1000), particleSystem(), baseParticleProps(), billboardParticles(false), clearColor(0.1f, 0.5f, 0.7f)
+	: maxParticles(1000), particleSystem(), viewUniformBuffer(nullptr), baseParticleProps(), billboardParticles(false), clearColor(0.1f, 0.5f, 0.7f)
 {
 	baseParticleProps.position = glm::vec3(0.0f, -2.5f, -15.0f);
 	baseParticleProps.linearVelocity = glm::vec3(5.0f, 10.0f, 5.0f);
@@ -21,11 +21,16 @@ ParticlesScene::ParticlesScene()
 void ParticlesScene::setup()
 {
 	particleSystem.setup(maxParticles, "sources/shaders/7_render_particles_vs.glsl", "sources/shaders/7_render_particles_fs.glsl");
+
+	viewUniformBuffer = new ViewUniformBuffer();
 }
 
 void ParticlesScene::clean()
 {
 	particleSystem.clean();
+	viewUniformBuffer->clean();
+
+	delete viewUniformBuffer;
 }
 
 void ParticlesScene::update(float deltaTime)
@@ -66,6 +71,10 @@ void ParticlesScene::render(const Camera& camera, float deltaTime)
 	glClearColor(clearColor.r, clearColor.g, clearColor.b, 1.0f);
 	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
+	viewUniformBuffer->setView(0, camera);
+	viewUniformBuffer->upload();
+	viewUniformBuffer->bindView(0);
+
 	particleSystem.render(camera, deltaTime);
 }
 
@@ -99,3 +108,15 @@ void ParticlesScene::processGUI()
 
 	ImGui::End();
 }
+
+bool ParticlesScene::setParameter(const std::string& name, float value)
+{
+	if (name == "maxParticles")
+	{
+		maxParticles = int(std::max(value, 1.0f));
+
+		return true;
+	}
+
+	return false;
+}
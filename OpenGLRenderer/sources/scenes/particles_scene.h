@@ -2,6 +2,7 @@
 
 #include <glm/glm.hpp>
 
+#include "../graphics/view_uniform_buffer.h"
 #include "../scene.h"
 #include "../systems/particle_system.h"
 
@@ -18,11 +19,16 @@ public:
 
 	void processGUI();
 
+	// "maxParticles".
+	bool setParameter(const std::string& name, float value);
+
 private:
 	int maxParticles;
 
 	ParticleSystem particleSystem;
 
+	ViewUniformBuffer* viewUniformBuffer;
+
 	ParticleProps baseParticleProps;
 
 	bool billboardParticles;
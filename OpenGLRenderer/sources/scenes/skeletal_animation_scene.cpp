@@ -1,5 +1,16 @@
 #include "skeletal_animation_scene.h"
 
+// Names of the uniforms set every frame, hashed by the compiler.
+static constexpr UniformName MODEL_MATRIX_UNIFORM("uModelMatrix");
+static constexpr UniformName LIGHT_AMBIENT_UNIFORM("uLight.ambient");
+static constexpr UniformName LIGHT_DIFFUSE_UNIFORM("uLight.diffuse");
+static constexpr UniformName LIGHT_SPECULAR_UNIFORM("uLight.specular");
+static constexpr UniformName LIGHT_POSITION_UNIFORM("uLight.position");
+static constexpr UniformName MATERIAL_SHININESS_UNIFORM("uMaterial.shininess");
+static constexpr UniformName SCREEN_TEX_UNIFORM("uScreenTex");
+static constexpr UniformName GAMMA_CORRECTION_UNIFORM("uGammaCorrection");
+static constexpr UniformName EXPOSURE_UNIFORM("uExposure");
+
 float quadVertices[] = {
 	// positions		 // texture coords
 	-1.0f,  1.0f,  0.0f,  0.0f,  1.0f,
@@ -9,8 +20,8 @@ float quadVertices[] = {
 };
 
 SkeletalAnimationScene::SkeletalAnimationScene()
-	: Scene(), renderModelShader(nullptr), renderScreenShader(nullptr),
-	  model(nullptr), screenFrameBuffer(nullptr),
+	: Scene(), renderModelShader(nullptr), renderScreenShader(nullptr), viewUniformBuffer(nullptr),
+	  model(nullptr), colorTarget(0), brightnessTarget(0), depthTarget(0),
 	  quadVAO(nullptr), quadVBO(nullptr),
 	  lightAmbientComp(0.5f, 0.5f, 0.5f), lightDiffuseComp(0.5f, 0.5f, 0.5f), lightSpecularComp(1.0f, 1.0f, 1.0f),
 	  gammaCorrection(false), hdrExposure(1.0f)
@@ -26,10 +37,30 @@ void SkeletalAnimationScene::setup()
 
 	renderModelShader = new ShaderProgram("sources/shaders/8_render_color_and_brightness_vs.glsl", "sources/shaders/8_render_color_and_brightness_fs.glsl");
 	renderScreenShader = new ShaderProgram("sources/shaders/9_render_hdr_screen_vs.glsl", "sources/shaders/9_render_hdr_screen_fs.glsl");
+
+	viewUniformBuffer = new ViewUniformBuffer();
 	
-	model = new Model("resources/models/vampire/dancing_vampire.dae", modelLoaderFlags);
+	model = new Model("resources/models/vampire/dancing_vampire.dae", modelLoaderFlags, VertexFormat::PACKED);
 	
-	screenFrameBuffer = new FrameBuffer(viewport[2] - viewport[0], viewport[3] - viewport[1], 2, GL_RGBA16F);
+	RenderTargetDesc hdrDesc{ viewport[2] - viewport[0], viewport[3] - viewport[1], GL_RGBA16F, GL_LINEAR, GL_CLAMP_TO_EDGE };
+	RenderTargetDesc depthDesc{ viewport[2] - viewport[0], viewport[3] - viewport[1], GL_DEPTH24_STENCIL8, GL_LINEAR, GL_CLAMP_TO_EDGE };
+
+	colorTarget = renderGraph.createTarget("Color", hdrDesc);
+	brightnessTarget = renderGraph.createTarget("Brightness", hdrDesc);
+	depthTarget = renderGraph.createTarget("Depth", depthDesc);
+
+	uint32_t scenePass = renderGraph.addPass("Scene", executeScenePass, this);
+
+	renderGraph.write(scenePass, colorTarget);
+	renderGraph.write(scenePass, brightnessTarget);
+	renderGraph.write(scenePass, depthTarget);
+
+	uint32_t tonemapPass = renderGraph.addPass("Tonemap", executeTonemapPass, this);
+
+	renderGraph.read(tonemapPass, colorTarget);
+	renderGraph.write(tonemapPass, RenderGraph::BACK_BUFFER);
+
+	renderGraph.compile();
 
 	quadVAO = new VAO();
 	quadVBO = new VBO(quadVertices, sizeof(quadVertices));
@@ -48,15 +79,16 @@ void SkeletalAnimationScene::clean()
 {
 	renderModelShader->clean();
 	renderScreenShader->clean();
+	viewUniformBuffer->clean();
 	model->clean();
-	screenFrameBuffer->clean();
+	renderGraph.clean();
 	quadVAO->clean();
 	quadVBO->clean();
 
 	delete renderModelShader;
 	delete renderScreenShader;
+	delete viewUniformBuffer;
 	delete model;
-	delete screenFrameBuffer;
 	delete quadVAO;
 	delete quadVBO;
 }
@@ -68,8 +100,17 @@ void SkeletalAnimationScene::update(float deltaTime)
 
 void SkeletalAnimationScene::render(const Camera& camera, float deltaTime)
 {
-	// Step 1: render color and brightness.
-	screenFrameBuffer->bind();
+	viewUniformBuffer->setView(0, camera);
+	viewUniformBuffer->upload();
+
+	renderGraph.execute();
+}
+
+void SkeletalAnimationScene::executeScenePass(RenderGraph& /*graph*/, void* data)
+{
+	SkeletalAnimationScene* scene = (SkeletalAnimationScene*)data;
+
+	scene->viewUniformBuffer->bindView(0);
 
 	glClearColor(0.25f, 0.25f, 0.25f, 1.0f);
 	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
@@ -77,56 +118,49 @@ void SkeletalAnimationScene::render(const Camera& camera, float deltaTime)
 	glm::mat4 modelMatrix(1.0f);
 	modelMatrix = glm::scale(modelMatrix, glm::vec3(0.0001f));
 
-	renderModelShader->bind();
-
-	renderModelShader->setUniformMatrix4fv("uProjectionMatrix", camera.getProjectionMatrix());
-	renderModelShader->setUniformMatrix4fv("uViewMatrix", camera.getViewMatrix());
-	renderModelShader->setUniformMatrix4fv("uModelMatrix", modelMatrix);
-
-	renderModelShader->setUniform3f("uViewPos", camera.getPosition());
+	scene->renderModelShader->bind();
 
-	renderModelShader->setUniform3f("uLight.ambient", lightAmbientComp);
-	renderModelShader->setUniform3f("uLight.diffuse", lightDiffuseComp);
-	renderModelShader->setUniform3f("uLight.specular", lightSpecularComp);
-	renderModelShader->setUniform3f("uLight.position", glm::vec3(0.0f, 2.5f, 5.0f));
+	scene->renderModelShader->setUniformMatrix4fv(MODEL_MATRIX_UNIFORM, modelMatrix);
 
-	renderModelShader->setUniform1f("uMaterial.shininess", 64.0f);
+	scene->renderModelShader->setUniform3f(LIGHT_AMBIENT_UNIFORM, scene->lightAmbientComp);
+	scene->renderModelShader->setUniform3f(LIGHT_DIFFUSE_UNIFORM, scene->lightDiffuseComp);
+	scene->renderModelShader->setUniform3f(LIGHT_SPECULAR_UNIFORM, scene->lightSpecularComp);
+	scene->renderModelShader->setUniform3f(LIGHT_POSITION_UNIFORM, glm::vec3(0.0f, 2.5f, 5.0f));
 
-	const std::vector<glm::mat4>& transforms = model->animator.getBonesMatrices();
+	scene->renderModelShader->setUniform1f(MATERIAL_SHININESS_UNIFORM, 64.0f);
 
-	for (uint32_t index = 0; index < transforms.size(); index++)
-	{
-		renderModelShader->setUniformMatrix4fv(("uBonesMatrices[" + std::to_string(index) + "]").c_str(), transforms[index]);
-	}
+	scene->model->animator.bindBonesMatrices();
 
-	model->render(renderModelShader);
+	scene->model->render(scene->renderModelShader);
 
-	renderModelShader->unbind();
+	scene->renderModelShader->unbind();
+}
 
-	screenFrameBuffer->unbind();
+void SkeletalAnimationScene::executeTonemapPass(RenderGraph& graph, void* data)
+{
+	SkeletalAnimationScene* scene = (SkeletalAnimationScene*)data;
 
-	// Step 2: render screen.
-	quadVAO->bind();
+	scene->quadVAO->bind();
 
 	glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
 	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-	renderScreenShader->bind();
+	scene->renderScreenShader->bind();
 
-	renderScreenShader->setUniform1i("uScreenTex", 8);
+	scene->renderScreenShader->setUniform1i(SCREEN_TEX_UNIFORM, 8);
 
-	renderScreenShader->setUniform1i("uGammaCorrection", gammaCorrection);
-	renderScreenShader->setUniform1f("uExposure", hdrExposure);
+	scene->renderScreenShader->setUniform1i(GAMMA_CORRECTION_UNIFORM, scene->gammaCorrection);
+	scene->renderScreenShader->setUniform1f(EXPOSURE_UNIFORM, scene->hdrExposure);
 
-	screenFrameBuffer->bindColorBuffer(8, 0);
+	graph.bindTexture(scene->colorTarget, 8);
 
-	// glEnable(GL_FRAMEBUFFER_SRGB); // Enable gamma correction.
+	// GLState::enable(GL_FRAMEBUFFER_SRGB); // Enable gamma correction.
 	glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
-	// glDisable(GL_FRAMEBUFFER_SRGB);
+	// GLState::disable(GL_FRAMEBUFFER_SRGB);
 
-	renderScreenShader->unbind();
+	scene->renderScreenShader->unbind();
 
-	quadVAO->unbind();
+	scene->quadVAO->unbind();
 }
 
 void SkeletalAnimationScene::processGUI()
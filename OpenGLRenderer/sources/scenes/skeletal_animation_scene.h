@@ -3,9 +3,10 @@
 #include <glm/glm.hpp>
 
 #include "../graphics/model.h"
-#include "../graphics/framebuffer.h"
 #include "../graphics/buffer.h"
+#include "../graphics/view_uniform_buffer.h"
 #include "../scene.h"
+#include "../systems/render_graph.h"
 
 class SkeletalAnimationScene : public Scene
 {
@@ -24,9 +25,14 @@ private:
 	ShaderProgram* renderModelShader;
 	ShaderProgram* renderScreenShader;
 
+	ViewUniformBuffer* viewUniformBuffer;
+
 	Model* model;
 
-	FrameBuffer* screenFrameBuffer;
+	// The scene is rendered to HDR targets, then tonemapped to the back buffer.
+	RenderGraph renderGraph;
+
+	uint32_t colorTarget, brightnessTarget, depthTarget;
 
 	VAO* quadVAO;
 	VBO* quadVBO;
@@ -37,4 +43,7 @@ private:
 
 	bool gammaCorrection;
 	float hdrExposure;
+
+	static void executeScenePass(RenderGraph& graph, void* data);
+	static void executeTonemapPass(RenderGraph& graph, void* data);
 };
@@ -1,7 +1,11 @@
 #include "tessellation_scene.h"
 
+// Names of the uniforms set every frame, hashed by the compiler.
+static constexpr UniformName MODEL_MATRIX_UNIFORM("uModelMatrix");
+static constexpr UniformName HEIGHT_MAP_UNIFORM("uHeightMap");
+
 TessellationScene::TessellationScene()
-	: renderMeshShader(nullptr), heightMapTex(nullptr),
+	: renderMeshShader(nullptr), viewUniformBuffer(nullptr), heightMapTex(nullptr),
       meshVAO(nullptr), meshVBO(nullptr),
       numPatches(20),
       renderWireframe(false)
@@ -17,6 +21,8 @@ void TessellationScene::setup()
 
     renderMeshShader = new ShaderProgram("sources/shaders/11_render_mesh_vs.glsl", "sources/shaders/11_render_mesh_tcs.glsl", "sources/shaders/11_render_mesh_tes.glsl", "sources/shaders/11_render_mesh_fs.glsl");
 
+    viewUniformBuffer = new ViewUniformBuffer();
+
     heightMapTex = new Texture("resources/textures/iceland_heightmap.png");
 
     heightMapTex->bind(0);
@@ -75,11 +81,13 @@ void TessellationScene::setup()
 void TessellationScene::clean()
 {
     renderMeshShader->clean();
+    viewUniformBuffer->clean();
     heightMapTex->clean();
     meshVAO->clean();
     meshVBO->clean();
 
     delete renderMeshShader;
+    delete viewUniformBuffer;
     delete heightMapTex;
     delete meshVAO;
     delete meshVBO;
@@ -91,6 +99,10 @@ void TessellationScene::update(float deltaTime)
 
 void TessellationScene::render(const Camera& camera, float deltaTime)
 {
+    viewUniformBuffer->setView(0, camera);
+    viewUniformBuffer->upload();
+    viewUniformBuffer->bindView(0);
+
     glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
@@ -109,11 +121,9 @@ void TessellationScene::render(const Camera& camera, float deltaTime)
     meshVAO->bind();
     renderMeshShader->bind();
 
-    renderMeshShader->setUniformMatrix4fv("uProjectionMatrix", camera.getProjectionMatrix());
-    renderMeshShader->setUniformMatrix4fv("uViewMatrix", camera.getViewMatrix());
-    renderMeshShader->setUniformMatrix4fv("uModelMatrix", modelMatrix);
+    renderMeshShader->setUniformMatrix4fv(MODEL_MATRIX_UNIFORM, modelMatrix);
 
-    renderMeshShader->setUniform1i("uHeightMap", 0);
+    renderMeshShader->setUniform1i(HEIGHT_MAP_UNIFORM, 0);
 
     glDrawArrays(GL_PATCHES, 0, 4 * numPatches * numPatches);
 
@@ -3,6 +3,7 @@
 #include "../graphics/shader.h"
 #include "../graphics/texture.h"
 #include "../graphics/buffer.h"
+#include "../graphics/view_uniform_buffer.h"
 #include "../scene.h"
 
 class TessellationScene : public Scene
@@ -21,6 +22,8 @@ public:
 private:
 	ShaderProgram* renderMeshShader;
 
+	ViewUniformBuffer* viewUniformBuffer;
+
 	Texture* heightMapTex;
 
 	VAO* meshVAO;
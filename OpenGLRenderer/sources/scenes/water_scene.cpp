@@ -1,14 +1,40 @@
 #include "water_scene.h"
 
+// Names of the uniforms set every frame, hashed by the compiler.
+static constexpr UniformName LIGHT_AMBIENT_UNIFORM("uLight.ambient");
+static constexpr UniformName LIGHT_DIFFUSE_UNIFORM("uLight.diffuse");
+static constexpr UniformName LIGHT_SPECULAR_UNIFORM("uLight.specular");
+static constexpr UniformName LIGHT_POSITION_UNIFORM("uLight.position");
+static constexpr UniformName MATERIAL_SHININESS_UNIFORM("uMaterial.shininess");
+static constexpr UniformName MODEL_MATRIX_UNIFORM("uModelMatrix");
+static constexpr UniformName LIGHT_POS_UNIFORM("uLightPos");
+static constexpr UniformName LIGHT_COLOR_UNIFORM("uLightColor");
+static constexpr UniformName WATER_COLOR_UNIFORM("uWaterColor");
+static constexpr UniformName REFLECTION_TEX_UNIFORM("uReflectionTex");
+static constexpr UniformName REFRACTION_TEX_UNIFORM("uRefractionTex");
+static constexpr UniformName DEPTH_MAP_UNIFORM("uDepthMap");
+static constexpr UniformName DU_DV_MAP_UNIFORM("uDuDvMap");
+static constexpr UniformName NORMAL_MAP_UNIFORM("uNormalMap");
+static constexpr UniformName HALF_MESH_SIZE_UNIFORM("uHalfMeshSize");
+static constexpr UniformName TILING_FACTOR_UNIFORM("uTilingFactor");
+static constexpr UniformName WAVE_STRENGTH_UNIFORM("uWaveStrength");
+static constexpr UniformName WAVE_STRIDE_UNIFORM("uWaveStride");
+static constexpr UniformName SHININESS_UNIFORM("uShininess");
+static constexpr UniformName REFLECTIVITY_UNIFORM("uReflectivity");
+static constexpr UniformName CUBE_MAP_UNIFORM("uCubeMap");
+
 WaterScene::WaterScene()
-	: Scene(), renderSkyBoxShader(nullptr), renderWaterShader(nullptr), renderStaticModelShader(nullptr),
+	: Scene(), renderSkyBoxShader(nullptr), renderWaterShader(nullptr), renderStaticModelShader(nullptr), viewUniformBuffer(nullptr),
 	  skyBoxCM(nullptr), skyBoxVAO(nullptr), skyBoxVBO(nullptr),
 	  waterMeshVAO(nullptr), waterMeshVBO(nullptr), waterMeshIBO(nullptr),
-	  reflectionFBWidth(1280), reflectionFBHeight(720), refractionFBWidth(1280), refractionFBHeight(720), reflectionFB(nullptr), refractionFB(nullptr),
+	  reflectionFBWidth(1280), reflectionFBHeight(720), refractionFBWidth(1280), refractionFBHeight(720),
+	  reflectionColorTarget(0), reflectionDepthTarget(0), refractionColorTarget(0), refractionDepthTarget(0), viewCameras(), viewClipPlanes(), frameDeltaTime(0.0f),
 	  waterDuDvMapTex(nullptr), waterNormalMapTex(nullptr),
 	  marsModel(nullptr), terrainModel(nullptr),
 	  meshSize(500),
 	  debugQuadRenderer(nullptr),
+	  marsBoundingSphere(0.0f), terrainBoundingSphere(0.0f), marsModelMatrix(1.0f), terrainModelMatrix(1.0f),
+	  occlusionCulling(true), scatterProps(false), visibleObjects(0), occludedObjects(0), occluderTriangles(0), occlusionCullingTime(0.0f),
 	  waterPosition(0.0f, 0.0f, 0.0f), waterColor(0.0f, 0.3f, 0.5f), terrainPosition(-150.0f, -10.0f, 150.0f), lightPosition(15.0f, 300.0f, 15.0f), lightColor(1.0f, 1.0f, 1.0f),
 	  tilingFactor(4.0f), waveStrength(0.04f), waveSpeed(0.025f), waveStride(0.0f), shininess(20.0f), reflectivity(0.5f),
 	  time(0.0f)
@@ -77,6 +103,8 @@ void WaterScene::setup()
 	renderWaterShader = new ShaderProgram("sources/shaders/10_render_water_vs.glsl", "sources/shaders/10_render_water_fs.glsl");
 	renderStaticModelShader = new ShaderProgram("sources/shaders/10_render_static_model_vs.glsl", "sources/shaders/10_render_static_model_fs.glsl");
 
+	viewUniformBuffer = new ViewUniformBuffer(NUMBER_OF_VIEWS);
+
 	// Setup skybox cubemap.
 	std::array<const char*, 6> skyBoxFaces = {
 		"resources/textures/skybox/right.jpg",
@@ -118,9 +146,8 @@ void WaterScene::setup()
 	waterMeshVBO->unbind();
 	waterMeshIBO->unbind();
 
-	// Setup framebuffers.
-	reflectionFB = new FrameBuffer(reflectionFBWidth, reflectionFBHeight, 1, GL_RGB, GL_LINEAR, GL_REPEAT);
-	refractionFB = new FrameBuffer(refractionFBWidth, refractionFBHeight, 1, GL_RGB, GL_LINEAR, GL_REPEAT, DepthAndStencilType::TEXTURE);
+	// Setup render passes.
+	setupRenderGraph();
 
 	// Setup textures.
 	waterDuDvMapTex = new Texture("resources/textures/water_dudv1.png", GL_LINEAR, GL_REPEAT);
@@ -129,8 +156,14 @@ void WaterScene::setup()
 	// Setup models.
 	uint32_t modelLoaderFlags = aiProcess_Triangulate | aiProcess_GenNormals;
 
-	marsModel = new Model("resources/models/mars/mars.obj", modelLoaderFlags);
-	terrainModel = new Model("resources/models/terrain/terrain.gltf", modelLoaderFlags);
+	marsModel = new Model("resources/models/mars/mars.obj", modelLoaderFlags, VertexFormat::PACKED);
+	terrainModel = new Model("resources/models/terrain/terrain.gltf", modelLoaderFlags, VertexFormat::PACKED);
+
+	// Setup occlusion culling.
+	setupOccluder(marsModel, marsOccluder, marsBoundingSphere);
+	setupOccluder(terrainModel, terrainOccluder, terrainBoundingSphere);
+
+	genProps(10);
 
 	// Setup debug tools.
 	debugQuadRenderer = new QuadRenderer();
@@ -143,13 +176,13 @@ void WaterScene::clean()
 	renderSkyBoxShader->clean();
 	renderWaterShader->clean();
 	renderStaticModelShader->clean();
+	viewUniformBuffer->clean();
 	skyBoxCM->clean();
 	skyBoxVAO->clean();
 	skyBoxVBO->clean();
 	waterMeshVAO->clean();
 	waterMeshVBO->clean();
-	reflectionFB->clean();
-	refractionFB->clean();
+	renderGraph.clean();
 	waterDuDvMapTex->clean();
 	waterNormalMapTex->clean();
 	marsModel->clean();
@@ -159,13 +192,12 @@ void WaterScene::clean()
 	delete renderSkyBoxShader;
 	delete renderWaterShader;
 	delete renderStaticModelShader;
+	delete viewUniformBuffer;
 	delete skyBoxCM;
 	delete skyBoxVAO;
 	delete skyBoxVBO;
 	delete waterMeshVAO;
 	delete waterMeshVBO;
-	delete reflectionFB;
-	delete refractionFB;
 	delete waterDuDvMapTex;
 	delete waterNormalMapTex;
 	delete marsModel;
@@ -183,45 +215,43 @@ void WaterScene::update(float deltaTime)
 	{
 		waveStride = waveStride - 1.0f;
 	}
+
+	marsModelMatrix = glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 25.0f, 0.0f));
+
+	terrainModelMatrix = glm::mat4(1.0f);
+	terrainModelMatrix = glm::translate(terrainModelMatrix, terrainPosition);
+	terrainModelMatrix = glm::rotate(terrainModelMatrix, glm::radians(-90.0f), glm::vec3(1.0f, 0.0f, 0.0f));
+	terrainModelMatrix = glm::scale(terrainModelMatrix, glm::vec3(0.25f));
 }
 
 void WaterScene::render(const Camera& camera, float deltaTime)
 {
-	int viewport[4];
-	glGetIntegerv(GL_VIEWPORT, viewport); // Save current viewport.
-
-	glViewport(0, 0, reflectionFBWidth, reflectionFBHeight);
-
 	glm::vec3 reflectionCameraPos = glm::vec3(camera.getPosition().x, -1.0f * camera.getPosition().y, camera.getPosition().z);
 	glm::vec3 reflectionCameraDir = glm::normalize(glm::reflect(camera.getDirection(), glm::vec3(0.0f, 1.0f, 0.0f)));
 
 	Camera reflectionCamera(reflectionCameraPos, reflectionCameraDir, glm::vec3(0.0f, 1.0f, 0.0f), { float(reflectionFBWidth) / float(reflectionFBHeight) });
 
-	reflectionFB->bind();
-	renderScene(reflectionCamera, deltaTime, glm::vec4(0.0f, 1.0f, 0.0f, waterPosition.y));
-	reflectionFB->unbind();
+	glm::vec4 reflectionClipPlane(0.0f, 1.0f, 0.0f, waterPosition.y);
+	glm::vec4 refractionClipPlane(0.0f, -1.0f, 0.0f, waterPosition.y);
 
-	glViewport(0, 0, refractionFBWidth, refractionFBHeight);
+	// The camera data of all passes goes to the GPU at once, each pass only selects its block.
+	viewUniformBuffer->setView(MAIN_VIEW, camera, time);
+	viewUniformBuffer->setView(REFLECTION_VIEW, reflectionCamera, time, reflectionClipPlane);
+	viewUniformBuffer->setView(REFRACTION_VIEW, camera, time, refractionClipPlane);
+	viewUniformBuffer->upload();
 
-	refractionFB->bind();
-	renderScene(camera, deltaTime, glm::vec4(0.0f, -1.0f, 0.0f, waterPosition.y));
-	refractionFB->unbind();
+	viewCameras[MAIN_VIEW] = &camera;
+	viewCameras[REFLECTION_VIEW] = &reflectionCamera;
+	viewCameras[REFRACTION_VIEW] = &camera;
 
-	glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
-
-	renderScene(camera, deltaTime);
-
-	ProjectionProperties cameraProps = camera.getProjectionProperties();
-
-	reflectionFB->bindColorBuffer(0);
-	refractionFB->bindColorBuffer(1);
-	refractionFB->bindDepthAndStencilBuffer(2);
+	viewClipPlanes[MAIN_VIEW] = glm::vec4(0.0f);
+	viewClipPlanes[REFLECTION_VIEW] = reflectionClipPlane;
+	viewClipPlanes[REFRACTION_VIEW] = refractionClipPlane;
 
-	debugQuadRenderer->render(viewport[2] - 16 - 256, viewport[3] - 16 - 144, 256, 144, 0, 3);
-	debugQuadRenderer->render(viewport[2] - 16 - 256, viewport[3] - 32 - 288, 256, 144, 1, 3);
-	debugQuadRenderer->render(viewport[2] - 16 - 256, viewport[3] - 48 - 432, 256, 144, 2, 1, true, cameraProps.zNear, cameraProps.zFar);
+	frameDeltaTime = deltaTime;
 
-	glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+	// Framebuffers and viewports of the passes are handled by the graph.
+	renderGraph.execute();
 }
 
 void WaterScene::processGUI()
@@ -243,6 +273,30 @@ void WaterScene::processGUI()
 	ImGui::DragFloat("Wave Strength", &waveStrength, 0.005f, 0.0f, 1.0f, "%.3f");
 	ImGui::DragFloat("Wave Speed", &waveSpeed, 0.0005f, 0.0f, 1.0f, "%.4f");
 
+	ImGui::SeparatorText("Occlusion Culling");
+
+	ImGui::Checkbox("Enable Occlusion Culling", &occlusionCulling);
+	ImGui::Checkbox("Scatter Props", &scatterProps);
+
+	if (occlusionCulling)
+	{
+		ImGui::Text("Visible objects: %u / Occluded objects: %u", visibleObjects, occludedObjects);
+		ImGui::Text("Occluder triangles rasterized: %u", occluderTriangles);
+		ImGui::Text("Culling time: %.4f ms", occlusionCullingTime);
+	}
+
+	ImGui::SeparatorText("Render Queue");
+
+	// Counters of the last pass (the main one).
+	ImGui::Text("Packets: %u / Program changes: %u", renderQueue.getPacketCount(), renderQueue.getProgramChanges());
+
+	ImGui::SeparatorText("Render Graph");
+
+	ImGui::Text("Passes: %u / Executed: %u", renderGraph.getPassCount(), renderGraph.getExecutedPassCount());
+	ImGui::Text("Targets: %u / Textures: %u", renderGraph.getTargetCount(), renderGraph.getTextureCount());
+	ImGui::Text("Target memory: %.2f MB (%.2f MB without aliasing)", renderGraph.getAllocatedBytes() / (1024.0f * 1024.0f), renderGraph.getRequestedBytes() / (1024.0f * 1024.0f));
+	ImGui::Text("Framebuffer changes: %u / Viewport changes: %u", renderGraph.getFramebufferChanges(), renderGraph.getViewportChanges());
+
 	ImGui::SeparatorText("Light");
 
 	ImGui::DragFloat3("Light Position", glm::value_ptr(lightPosition), 0.1f, -1000.0f, 1000.0f, "%.1f");
@@ -280,6 +334,45 @@ void WaterScene::genWaterMesh(uint32_t size)
 	}
 }
 
+void WaterScene::setupRenderGraph()
+{
+	RenderTargetDesc reflectionColorDesc{ reflectionFBWidth, reflectionFBHeight, GL_RGB8, GL_LINEAR, GL_REPEAT };
+	RenderTargetDesc refractionColorDesc{ refractionFBWidth, refractionFBHeight, GL_RGB8, GL_LINEAR, GL_REPEAT };
+	RenderTargetDesc reflectionDepthDesc{ reflectionFBWidth, reflectionFBHeight, GL_DEPTH24_STENCIL8, GL_LINEAR, GL_CLAMP_TO_EDGE };
+	RenderTargetDesc refractionDepthDesc{ refractionFBWidth, refractionFBHeight, GL_DEPTH24_STENCIL8, GL_LINEAR, GL_CLAMP_TO_EDGE };
+
+	reflectionColorTarget = renderGraph.createTarget("Reflection Color", reflectionColorDesc);
+	reflectionDepthTarget = renderGraph.createTarget("Reflection Depth", reflectionDepthDesc);
+	refractionColorTarget = renderGraph.createTarget("Refraction Color", refractionColorDesc);
+	refractionDepthTarget = renderGraph.createTarget("Refraction Depth", refractionDepthDesc);
+
+	uint32_t reflectionPass = renderGraph.addPass("Reflection", executeReflectionPass, this);
+
+	renderGraph.write(reflectionPass, reflectionColorTarget);
+	renderGraph.write(reflectionPass, reflectionDepthTarget);
+
+	uint32_t refractionPass = renderGraph.addPass("Refraction", executeRefractionPass, this);
+
+	renderGraph.write(refractionPass, refractionColorTarget);
+	renderGraph.write(refractionPass, refractionDepthTarget);
+
+	uint32_t mainPass = renderGraph.addPass("Main", executeMainPass, this);
+
+	renderGraph.read(mainPass, reflectionColorTarget);
+	renderGraph.read(mainPass, refractionColorTarget);
+	renderGraph.read(mainPass, refractionDepthTarget);
+	renderGraph.write(mainPass, RenderGraph::BACK_BUFFER);
+
+	uint32_t debugPass = renderGraph.addPass("Debug", executeDebugPass, this);
+
+	renderGraph.read(debugPass, reflectionColorTarget);
+	renderGraph.read(debugPass, refractionColorTarget);
+	renderGraph.read(debugPass, refractionDepthTarget);
+	renderGraph.write(debugPass, RenderGraph::BACK_BUFFER);
+
+	renderGraph.compile();
+}
+
 void WaterScene::renderScene(const Camera& camera, float deltaTime, const glm::vec4& clipPlane)
 {
 	glClearColor(0.75f, 0.75f, 0.75f, 1.0f);
@@ -287,61 +380,67 @@ void WaterScene::renderScene(const Camera& camera, float deltaTime, const glm::v
 
 	if (glm::length(clipPlane) == 0.0f)
 	{
-		glDisable(GL_CLIP_DISTANCE0);
+		GLState::disable(GL_CLIP_DISTANCE0);
 	}
 	else
 	{
-		glEnable(GL_CLIP_DISTANCE0);
+		GLState::enable(GL_CLIP_DISTANCE0);
 	}
 
 	// Render models.
 	renderStaticModelShader->bind();
 
-	renderStaticModelShader->setUniformMatrix4fv("uProjectionMatrix", camera.getProjectionMatrix());
-	renderStaticModelShader->setUniformMatrix4fv("uViewMatrix", camera.getViewMatrix());
-
-	renderStaticModelShader->setUniform3f("uViewPos", camera.getPosition());
-
-	renderStaticModelShader->setUniform3f("uLight.ambient", glm::vec3(1.0f));
-	renderStaticModelShader->setUniform3f("uLight.diffuse", glm::vec3(0.0f)); // Disabled.
-	renderStaticModelShader->setUniform3f("uLight.specular", glm::vec3(0.0f)); // Disabled.
-	renderStaticModelShader->setUniform3f("uLight.position", glm::vec3(0.0f));
-
-	renderStaticModelShader->setUniform1f("uMaterial.shininess", 64.0f);
+	renderStaticModelShader->setUniform3f(LIGHT_AMBIENT_UNIFORM, glm::vec3(1.0f));
+	renderStaticModelShader->setUniform3f(LIGHT_DIFFUSE_UNIFORM, glm::vec3(0.0f)); // Disabled.
+	renderStaticModelShader->setUniform3f(LIGHT_SPECULAR_UNIFORM, glm::vec3(0.0f)); // Disabled.
+	renderStaticModelShader->setUniform3f(LIGHT_POSITION_UNIFORM, glm::vec3(0.0f));
 
-	renderStaticModelShader->setUniform4f("uClipPlane", clipPlane);
+	renderStaticModelShader->setUniform1f(MATERIAL_SHININESS_UNIFORM, 64.0f);
 
-	// Render mars model.
+	// Only the main pass is culled: clipped passes may cut away parts of the occluders.
+	if (occlusionCulling && glm::length(clipPlane) == 0.0f)
 	{
-		glm::mat4 marsModelMatrix(1.0f);
-		marsModelMatrix = glm::translate(marsModelMatrix, glm::vec3(0.0f, 25.0f, 0.0f));
+		cullOccludedObjects(camera);
+	}
+	else
+	{
+		objectsVisibility.assign(2 + (scatterProps ? propModelMatrices.size() : 0), true);
+	}
 
-		renderStaticModelShader->setUniformMatrix4fv("uModelMatrix", marsModelMatrix);
+	// Models are drawn through the queue, grouped by mesh state and front-to-back.
+	renderQueue.begin(camera);
 
-		marsModel->render(renderStaticModelShader);
+	if (objectsVisibility[0])
+	{
+		renderQueue.submit(0, RenderQueue::Layer::OPAQUE_LAYER, renderStaticModelShader, marsModel, marsModelMatrix);
 	}
 
-	// Render terrain model.
+	if (objectsVisibility[1])
 	{
-		glm::mat4 terrainModelMatrix(1.0f);
-		terrainModelMatrix = glm::translate(terrainModelMatrix, terrainPosition);
-		terrainModelMatrix = glm::rotate(terrainModelMatrix, glm::radians(-90.0f), glm::vec3(1.0f, 0.0f, 0.0f));
-		terrainModelMatrix = glm::scale(terrainModelMatrix, glm::vec3(0.25f));
-
-		renderStaticModelShader->setUniformMatrix4fv("uModelMatrix", terrainModelMatrix);
+		renderQueue.submit(0, RenderQueue::Layer::OPAQUE_LAYER, renderStaticModelShader, terrainModel, terrainModelMatrix);
+	}
 
-		terrainModel->render(renderStaticModelShader);
+	for (uint32_t i = 2; i < objectsVisibility.size(); i++)
+	{
+		if (objectsVisibility[i])
+		{
+			renderQueue.submit(0, RenderQueue::Layer::OPAQUE_LAYER, renderStaticModelShader, marsModel, propModelMatrices[i - 2]);
+		}
 	}
 
-	renderStaticModelShader->unbind();
+	renderQueue.execute();
 
 	// Render water.
 	renderWaterShader->bind();
 	waterMeshVAO->bind();
 
-	reflectionFB->bindColorBuffer(0);
-	refractionFB->bindColorBuffer(1);
-	refractionFB->bindDepthAndStencilBuffer(2);
+	// Only the main pass draws the water, its targets are not bound while they are being written.
+	if (glm::length(clipPlane) == 0.0f)
+	{
+		renderGraph.bindTexture(reflectionColorTarget, 0);
+		renderGraph.bindTexture(refractionColorTarget, 1);
+		renderGraph.bindTexture(refractionDepthTarget, 2);
+	}
 
 	waterDuDvMapTex->bind(3);
 	waterNormalMapTex->bind(4);
@@ -349,28 +448,24 @@ void WaterScene::renderScene(const Camera& camera, float deltaTime, const glm::v
 	glm::mat4 waterModelMatrix(1.0f);
 	waterModelMatrix = glm::translate(waterModelMatrix, waterPosition);
 
-	renderWaterShader->setUniformMatrix4fv("uProjectionMatrix", camera.getProjectionMatrix());
-	renderWaterShader->setUniformMatrix4fv("uViewMatrix", camera.getViewMatrix());
-	renderWaterShader->setUniformMatrix4fv("uModelMatrix", waterModelMatrix);
-
-	renderWaterShader->setUniform3f("uCameraPos", camera.getPosition());
-	renderWaterShader->setUniform3f("uLightPos", lightPosition);
-	renderWaterShader->setUniform3f("uLightColor", lightColor);
-	renderWaterShader->setUniform3f("uWaterColor", waterColor);
-
-	renderWaterShader->setUniform1i("uReflectionTex", 0);
-	renderWaterShader->setUniform1i("uRefractionTex", 1);
-	renderWaterShader->setUniform1i("uDepthMap", 2);
-	renderWaterShader->setUniform1i("uDuDvMap", 3);
-	renderWaterShader->setUniform1i("uNormalMap", 4);
-
-	renderWaterShader->setUniform1f("uHalfMeshSize", static_cast<float>(meshSize) / 2.0f);
-	renderWaterShader->setUniform1f("uTilingFactor", tilingFactor);
-	renderWaterShader->setUniform1f("uWaveStrength", waveStrength);
-	renderWaterShader->setUniform1f("uWaveStride", waveStride);
-	renderWaterShader->setUniform1f("uShininess", shininess);
-	renderWaterShader->setUniform1f("uReflectivity", reflectivity);
-	renderWaterShader->setUniform1f("uReflectivity", reflectivity);
+	renderWaterShader->setUniformMatrix4fv(MODEL_MATRIX_UNIFORM, waterModelMatrix);
+
+	renderWaterShader->setUniform3f(LIGHT_POS_UNIFORM, lightPosition);
+	renderWaterShader->setUniform3f(LIGHT_COLOR_UNIFORM, lightColor);
+	renderWaterShader->setUniform3f(WATER_COLOR_UNIFORM, waterColor);
+
+	renderWaterShader->setUniform1i(REFLECTION_TEX_UNIFORM, 0);
+	renderWaterShader->setUniform1i(REFRACTION_TEX_UNIFORM, 1);
+	renderWaterShader->setUniform1i(DEPTH_MAP_UNIFORM, 2);
+	renderWaterShader->setUniform1i(DU_DV_MAP_UNIFORM, 3);
+	renderWaterShader->setUniform1i(NORMAL_MAP_UNIFORM, 4);
+
+	renderWaterShader->setUniform1f(HALF_MESH_SIZE_UNIFORM, static_cast<float>(meshSize) / 2.0f);
+	renderWaterShader->setUniform1f(TILING_FACTOR_UNIFORM, tilingFactor);
+	renderWaterShader->setUniform1f(WAVE_STRENGTH_UNIFORM, waveStrength);
+	renderWaterShader->setUniform1f(WAVE_STRIDE_UNIFORM, waveStride);
+	renderWaterShader->setUniform1f(SHININESS_UNIFORM, shininess);
+	renderWaterShader->setUniform1f(REFLECTIVITY_UNIFORM, reflectivity);
 
 	if (glm::length(clipPlane) == 0.0f)
 	{
@@ -390,17 +485,171 @@ void WaterScene::renderScene(const Camera& camera, float deltaTime, const glm::v
 
 	skyBoxCM->bind(0);
 
-	renderSkyBoxShader->setUniformMatrix4fv("uProjectionMatrix", camera.getProjectionMatrix());
-	renderSkyBoxShader->setUniformMatrix4fv("uViewMatrix", camera.getViewMatrix());
-
-	renderSkyBoxShader->setUniform1i("uCubeMap", 0);
+	renderSkyBoxShader->setUniform1i(CUBE_MAP_UNIFORM, 0);
 
-	glDepthFunc(GL_LEQUAL);
+	GLState::depthFunc(GL_LEQUAL);
 
 	glDrawArrays(GL_TRIANGLES, 0, 36);
 
-	glDepthFunc(GL_LESS);
+	GLState::depthFunc(GL_LESS);
 
 	skyBoxVAO->unbind();
 	renderSkyBoxShader->unbind();
 }
+
+void WaterScene::genProps(uint32_t gridSize)
+{
+	float spacing = 40.0f;
+	float gridOffset = spacing * (gridSize - 1) * 0.5f;
+
+	for (uint32_t z = 0; z < gridSize; z++)
+	{
+		for (uint32_t x = 0; x < gridSize; x++)
+		{
+			glm::mat4 propModelMatrix(1.0f);
+			propModelMatrix = glm::translate(propModelMatrix, glm::vec3(x * spacing - gridOffset, 2.5f, z * spacing - gridOffset));
+			propModelMatrix = glm::scale(propModelMatrix, glm::vec3(0.1f));
+
+			propModelMatrices.push_back(propModelMatrix);
+		}
+	}
+}
+
+void WaterScene::setupOccluder(const Model* model, OccluderMesh& occluder, glm::vec4& boundingSphere)
+{
+	std::vector<glm::vec3> positions;
+	std::vector<uint32_t> indices;
+
+	for (const Mesh& mesh : model->getMeshes())
+	{
+		uint32_t baseVertex = uint32_t(positions.size());
+
+		for (const MeshVertex& vertex : mesh.getVertices())
+		{
+			positions.push_back(vertex.position);
+		}
+
+		for (uint32_t i = 0; i < mesh.getIndexCount(); i++)
+		{
+			indices.push_back(baseVertex + mesh.getIndices()[i]);
+		}
+	}
+
+	if (positions.empty())
+	{
+		std::cout << "[ERROR] WATER SCENE: Failed to create occluder, model has no geometry." << std::endl;
+
+		return;
+	}
+
+	glm::vec3 minAABB = positions[0], maxAABB = positions[0];
+
+	for (const glm::vec3& position : positions)
+	{
+		minAABB = glm::min(minAABB, position);
+		maxAABB = glm::max(maxAABB, position);
+	}
+
+	glm::vec3 center = (minAABB + maxAABB) * 0.5f;
+	float radius = 0.0f;
+
+	for (const glm::vec3& position : positions)
+	{
+		radius = std::max(radius, glm::length(position - center));
+	}
+
+	boundingSphere = glm::vec4(center, radius);
+
+	occluder = OcclusionCuller::createOccluder(positions, indices, 32);
+}
+
+void WaterScene::cullOccludedObjects(const Camera& camera)
+{
+	std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+
+	occlusionCuller.begin(camera.getProjectionMatrix() * camera.getViewMatrix());
+
+	occlusionCuller.rasterizeOccluder(terrainOccluder, terrainModelMatrix);
+	occlusionCuller.rasterizeOccluder(marsOccluder, marsModelMatrix);
+
+	occlusionCuller.finish();
+
+	const glm::mat4* modelMatrices[2] = { &marsModelMatrix, &terrainModelMatrix };
+	const glm::vec4* boundingSpheres[2] = { &marsBoundingSphere, &terrainBoundingSphere };
+
+	objectsVisibility.resize(2 + (scatterProps ? propModelMatrices.size() : 0));
+
+	for (uint32_t i = 0; i < objectsVisibility.size(); i++)
+	{
+		const glm::mat4& modelMatrix = i < 2 ? *modelMatrices[i] : propModelMatrices[i - 2];
+		const glm::vec4& boundingSphere = i < 2 ? *boundingSpheres[i] : marsBoundingSphere;
+
+		float maxScale = std::max(std::max(glm::length(modelMatrix[0]), glm::length(modelMatrix[1])), glm::length(modelMatrix[2]));
+		glm::vec3 center = glm::vec3(modelMatrix * glm::vec4(glm::vec3(boundingSphere), 1.0f));
+
+		objectsVisibility[i] = occlusionCuller.isSphereVisible(center, boundingSphere.w * maxScale);
+	}
+
+	visibleObjects = occlusionCuller.getVisibleCount();
+	occludedObjects = occlusionCuller.getOccludedCount();
+	occluderTriangles = occlusionCuller.getRasterizedTriangles();
+
+	occlusionCullingTime = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+void WaterScene::executeReflectionPass(RenderGraph& /*graph*/, void* data)
+{
+	WaterScene* scene = (WaterScene*)data;
+
+	scene->viewUniformBuffer->bindView(REFLECTION_VIEW);
+	scene->renderScene(*scene->viewCameras[REFLECTION_VIEW], scene->frameDeltaTime, scene->viewClipPlanes[REFLECTION_VIEW]);
+}
+
+void WaterScene::executeRefractionPass(RenderGraph& /*graph*/, void* data)
+{
+	WaterScene* scene = (WaterScene*)data;
+
+	scene->viewUniformBuffer->bindView(REFRACTION_VIEW);
+	scene->renderScene(*scene->viewCameras[REFRACTION_VIEW], scene->frameDeltaTime, scene->viewClipPlanes[REFRACTION_VIEW]);
+}
+
+void WaterScene::executeMainPass(RenderGraph& /*graph*/, void* data)
+{
+	WaterScene* scene = (WaterScene*)data;
+
+	scene->viewUniformBuffer->bindView(MAIN_VIEW);
+	scene->renderScene(*scene->viewCameras[MAIN_VIEW], scene->frameDeltaTime, scene->viewClipPlanes[MAIN_VIEW]);
+}
+
+void WaterScene::executeDebugPass(RenderGraph& graph, void* data)
+{
+	WaterScene* scene = (WaterScene*)data;
+
+	int viewport[4];
+	glGetIntegerv(GL_VIEWPORT, viewport);
+
+	ProjectionProperties cameraProps = scene->viewCameras[MAIN_VIEW]->getProjectionProperties();
+
+	graph.bindTexture(scene->reflectionColorTarget, 0);
+	graph.bindTexture(scene->refractionColorTarget, 1);
+	graph.bindTexture(scene->refractionDepthTarget, 2);
+
+	scene->debugQuadRenderer->render(viewport[2] - 16 - 256, viewport[3] - 16 - 144, 256, 144, 0, 3);
+	scene->debugQuadRenderer->render(viewport[2] - 16 - 256, viewport[3] - 32 - 288, 256, 144, 1, 3);
+	scene->debugQuadRenderer->render(viewport[2] - 16 - 256, viewport[3] - 48 - 432, 256, 144, 2, 1, true, cameraProps.zNear, cameraProps.zFar);
+
+	// The quad renderer changes the viewport.
+	glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+}
+
+bool WaterScene::setParameter(const std::string& name, float value)
+{
+	if (name == "meshSize")
+	{
+		meshSize = uint32_t(std::max(value, 2.0f)); // Vertices per side.
+
+		return true;
+	}
+
+	return false;
+}
@@ -1,13 +1,18 @@
 #pragma once
 
+#include <chrono>
+
 #include <glm/glm.hpp>
 
 #include "../graphics/buffer.h"
 #include "../graphics/cubemap.h"
-#include "../graphics/framebuffer.h"
 #include "../graphics/model.h"
 #include "../graphics/texture.h"
+#include "../graphics/view_uniform_buffer.h"
 #include "../scene.h"
+#include "../systems/occlusion_culler.h"
+#include "../systems/render_graph.h"
+#include "../systems/render_queue.h"
 #include "../utils/dev/quad_renderer.h"
 
 class WaterScene : public Scene
@@ -23,11 +28,19 @@ public:
 
 	void processGUI();
 
+	// "meshSize".
+	bool setParameter(const std::string& name, float value);
+
 private:
 	ShaderProgram* renderSkyBoxShader;
 	ShaderProgram* renderWaterShader;
 	ShaderProgram* renderStaticModelShader;
 
+	// Main, reflection and refraction views.
+	enum View { MAIN_VIEW, REFLECTION_VIEW, REFRACTION_VIEW, NUMBER_OF_VIEWS };
+
+	ViewUniformBuffer* viewUniformBuffer;
+
 	CubeMap* skyBoxCM;
 
 	VAO* skyBoxVAO;
@@ -40,8 +53,16 @@ private:
 	int reflectionFBWidth, reflectionFBHeight;
 	int refractionFBWidth, refractionFBHeight;
 
-	FrameBuffer* reflectionFB;
-	FrameBuffer* refractionFB;
+	// Reflection and refraction passes render into transient targets, their depth buffers share the same texture.
+	RenderGraph renderGraph;
+
+	uint32_t reflectionColorTarget, reflectionDepthTarget;
+	uint32_t refractionColorTarget, refractionDepthTarget;
+
+	// Cameras and clip planes of the frame being executed by the graph.
+	const Camera* viewCameras[NUMBER_OF_VIEWS];
+	glm::vec4 viewClipPlanes[NUMBER_OF_VIEWS];
+	float frameDeltaTime;
 
 	Texture* waterDuDvMapTex;
 	Texture* waterNormalMapTex;
@@ -51,6 +72,25 @@ private:
 
 	QuadRenderer* debugQuadRenderer;
 
+	RenderQueue renderQueue;
+
+	OcclusionCuller occlusionCuller;
+	OccluderMesh marsOccluder, terrainOccluder;
+
+	// Local space bounding spheres (center and radius).
+	glm::vec4 marsBoundingSphere, terrainBoundingSphere;
+
+	glm::mat4 marsModelMatrix, terrainModelMatrix;
+	std::vector<glm::mat4> propModelMatrices;
+
+	// Visibility of the mars model, the terrain and the props (in this order) in the current pass.
+	std::vector<bool> objectsVisibility;
+
+	bool occlusionCulling, scatterProps;
+
+	uint32_t visibleObjects, occludedObjects, occluderTriangles;
+	float occlusionCullingTime;
+
 	uint32_t meshSize;
 	std::vector<float> meshVertices;
 	std::vector<uint32_t> meshIndices;
@@ -65,5 +105,17 @@ private:
 	float time;
 
 	void genWaterMesh(uint32_t gridSize);
+	void genProps(uint32_t gridSize);
+
+	void setupOccluder(const Model* model, OccluderMesh& occluder, glm::vec4& boundingSphere);
+	void cullOccludedObjects(const Camera& camera);
+
+	void setupRenderGraph();
+
 	void renderScene(const Camera& camera, float deltaTime, const glm::vec4& clipPlane = glm::vec4(0.0f));
+
+	static void executeReflectionPass(RenderGraph& graph, void* data);
+	static void executeRefractionPass(RenderGraph& graph, void* data);
+	static void executeMainPass(RenderGraph& graph, void* data);
+	static void executeDebugPass(RenderGraph& graph, void* data);
 };
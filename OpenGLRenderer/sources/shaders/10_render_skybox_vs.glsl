@@ -4,8 +4,14 @@ layout (location = 0) in vec3 aPos;
 
 out vec3 ioTexCoords;
 
-uniform mat4 uViewMatrix;
-uniform mat4 uProjectionMatrix;
+layout (std140, binding = 0) uniform ViewUniforms
+{
+    mat4 uProjectionMatrix;
+    mat4 uViewMatrix;
+    mat4 uLightSpaceMatrix;
+    vec4 uViewPosition; // w: time in seconds.
+    vec4 uClipPlane;
+};
 
 void main()
 {
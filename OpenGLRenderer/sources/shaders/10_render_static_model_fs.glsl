@@ -10,8 +10,6 @@ struct Light
 
 struct Material
 {
-    sampler2D diffuseMap;
-    sampler2D specularMap;
     float shininess;
 };
 
@@ -19,25 +17,72 @@ in VS_OUT {
     vec2 texCoords;
     vec3 fragPos;
     vec3 fragNormal;
+    flat int materialIndex;
 } fs_in;
 
 uniform Light uLight;
 uniform Material uMaterial;
-uniform vec3 uViewPos;
+
+const int MAX_TEXTURE_ARRAYS = 8;
+const int NO_TEXTURE = -1;
+
+uniform sampler2DArray uTextureArrays[MAX_TEXTURE_ARRAYS];
+
+// Diffuse, specular, emission and normal maps of each material, as "(array << 16) | layer".
+layout (std430, binding = 1) readonly buffer Materials
+{
+    ivec4 uMaterials[];
+};
+
+layout (std140, binding = 0) uniform ViewUniforms
+{
+    mat4 uProjectionMatrix;
+    mat4 uViewMatrix;
+    mat4 uLightSpaceMatrix;
+    vec4 uViewPosition; // w: time in seconds.
+    vec4 uClipPlane;
+};
 
 out vec4 oFragColor;
 
+// The material index comes from "gl_DrawID", so it's not dynamically uniform inside a multi-draw: the sampler array is only
+// indexed by the loop counter, and the gradients are taken by the caller, outside the branches.
+vec4 sampleMaterialMap(int map, vec2 texCoords, vec2 dx, vec2 dy, vec4 fallback)
+{
+    if(map == NO_TEXTURE)
+    {
+        return fallback;
+    }
+
+    vec3 coords = vec3(texCoords, float(map & 0xFFFF));
+
+    for(int i = 0; i < MAX_TEXTURE_ARRAYS; i++)
+    {
+        if(i == (map >> 16))
+        {
+            return textureGrad(uTextureArrays[i], coords, dx, dy);
+        }
+    }
+
+    return fallback;
+}
+
 void main()
 {
     vec3 lightDir = normalize(uLight.position - fs_in.fragPos);
-    vec3 viewDir = normalize(uViewPos - fs_in.fragPos);
+    vec3 viewDir = normalize(uViewPosition.xyz - fs_in.fragPos);
     vec3 halfwayDir = normalize(lightDir + viewDir);
 
     float diffuseStr = max(dot(fs_in.fragNormal, lightDir), 0.0);
     float specularStr = pow(max(dot(fs_in.fragNormal, halfwayDir), 0.0), uMaterial.shininess);
 
-    vec3 diffuseColor = vec3(texture(uMaterial.diffuseMap, fs_in.texCoords));
-    vec3 specularColor = vec3(texture(uMaterial.specularMap, fs_in.texCoords));
+    ivec4 material = uMaterials[fs_in.materialIndex];
+
+    vec2 dx = dFdx(fs_in.texCoords);
+    vec2 dy = dFdy(fs_in.texCoords);
+
+    vec3 diffuseColor = vec3(sampleMaterialMap(material.x, fs_in.texCoords, dx, dy, vec4(1.0)));
+    vec3 specularColor = vec3(sampleMaterialMap(material.y, fs_in.texCoords, dx, dy, vec4(0.0)));
 
     // Calculating Blinn-Phong lighting components.
     vec3 ambient = uLight.ambient * diffuseColor;
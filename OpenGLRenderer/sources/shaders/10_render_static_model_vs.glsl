@@ -5,24 +5,52 @@ layout (location = 1) in vec3 aNormal;
 layout (location = 2) in vec2 aTexCoords;
 
 uniform mat4 uModelMatrix;
-uniform mat4 uViewMatrix;
-uniform mat4 uProjectionMatrix;
 
-uniform vec4 uClipPlane;
+// Packed vertices: positions quantized inside the model AABB (identity for full precision vertices) and octahedral normals.
+uniform vec3 uPositionOrigin;
+uniform vec3 uPositionScale;
+uniform bool uOctahedralNormals;
+
+vec3 decodeOctahedral(vec2 encoded)
+{
+    vec3 normal = vec3(encoded, 1.0 - abs(encoded.x) - abs(encoded.y));
+    float t = max(-normal.z, 0.0);
+
+    normal.xy -= t * vec2(normal.x >= 0.0 ? 1.0 : -1.0, normal.y >= 0.0 ? 1.0 : -1.0);
+
+    return normalize(normal);
+}
+
+// Material of the first mesh of the draw, meshes of a multi-draw follow it in order.
+uniform int uMaterialIndex;
+
+layout (std140, binding = 0) uniform ViewUniforms
+{
+    mat4 uProjectionMatrix;
+    mat4 uViewMatrix;
+    mat4 uLightSpaceMatrix;
+    vec4 uViewPosition; // w: time in seconds.
+    vec4 uClipPlane;
+};
 
 out VS_OUT {
     vec2 texCoords;
     vec3 fragPos;
     vec3 fragNormal;
+    flat int materialIndex;
 } vs_out;
 
 void main()
 {
+    vec3 position = uPositionOrigin + aPos * uPositionScale;
+    vec3 normal = uOctahedralNormals ? decodeOctahedral(aNormal.xy) : aNormal;
+
     mat3 normalMatrix = transpose(inverse(mat3(uModelMatrix)));
 
     vs_out.texCoords = aTexCoords;
-    vs_out.fragPos = vec3(uModelMatrix * vec4(aPos, 1.0));
-    vs_out.fragNormal = normalize(normalMatrix * aNormal);
+    vs_out.materialIndex = uMaterialIndex + gl_DrawID;
+    vs_out.fragPos = vec3(uModelMatrix * vec4(position, 1.0));
+    vs_out.fragNormal = normalize(normalMatrix * normal);
 
     gl_ClipDistance[0] = dot(uClipPlane, vec4(vs_out.fragPos, 1.0));
 
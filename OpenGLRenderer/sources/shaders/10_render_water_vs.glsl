@@ -2,14 +2,20 @@
 
 layout (location = 0) in vec3 aPos;
 
-uniform mat4 uProjectionMatrix;
-uniform mat4 uViewMatrix;
+layout (std140, binding = 0) uniform ViewUniforms
+{
+    mat4 uProjectionMatrix;
+    mat4 uViewMatrix;
+    mat4 uLightSpaceMatrix;
+    vec4 uViewPosition; // w: time in seconds.
+    vec4 uClipPlane;
+};
+
 uniform mat4 uModelMatrix;
 
 uniform float uHalfMeshSize;
 uniform float uTilingFactor;
 
-uniform vec3 uCameraPos;
 uniform vec3 uLightPos;
 
 out vec4 oiCSPos;
@@ -23,7 +29,7 @@ void main()
 
     oiCSPos = uProjectionMatrix * uViewMatrix * wPos;
     oiTexCoords = vec2(0.5 + (aPos.x / uHalfMeshSize) / 2.0, 0.5 + (aPos.z / uHalfMeshSize) / 2.0) * uTilingFactor;
-    oiCameraDir = normalize(uCameraPos - wPos.xyz);
+    oiCameraDir = normalize(uViewPosition.xyz - wPos.xyz);
     oiLightInvDir = normalize(wPos.xyz - uLightPos);
 
     gl_Position = oiCSPos;
@@ -2,9 +2,17 @@
 
 layout (vertices=4) out;
 
-uniform mat4 uViewMatrix;
 uniform mat4 uModelMatrix;
 
+layout (std140, binding = 0) uniform ViewUniforms
+{
+    mat4 uProjectionMatrix;
+    mat4 uViewMatrix;
+    mat4 uLightSpaceMatrix;
+    vec4 uViewPosition; // w: time in seconds.
+    vec4 uClipPlane;
+};
+
 in vec2 oiVSTexCoords[]; // Varying input from vertex shader.
 
 out vec2 oiTCSTexCoords[]; // Varying output to evaluation shader.
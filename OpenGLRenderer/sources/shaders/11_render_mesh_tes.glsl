@@ -2,10 +2,17 @@
 
 layout (quads, fractional_odd_spacing, ccw) in;
 
-uniform mat4 uProjectionMatrix;
-uniform mat4 uViewMatrix;
 uniform mat4 uModelMatrix;
 
+layout (std140, binding = 0) uniform ViewUniforms
+{
+    mat4 uProjectionMatrix;
+    mat4 uViewMatrix;
+    mat4 uLightSpaceMatrix;
+    vec4 uViewPosition; // w: time in seconds.
+    vec4 uClipPlane;
+};
+
 uniform sampler2D uHeightMap;
 
 in vec2 oiTCSTexCoords[];
@@ -0,0 +1,48 @@
+#version 450 core
+
+layout (local_size_x = 64) in;
+
+// Same layout of "DrawElementsIndirectCommand".
+struct DrawCommand
+{
+    uint count;
+    uint instanceCount;
+    uint firstIndex;
+    int baseVertex;
+    uint baseInstance;
+};
+
+layout (std430, binding = 0) readonly buffer Spheres { vec4 spheres[]; }; // World space center (xyz) and radius (w).
+layout (std430, binding = 1) readonly buffer ModelMatrices { mat4 modelMatrices[]; };
+layout (std430, binding = 2) readonly buffer DrawIndices { uint drawIndices[]; }; // Draw command of every entity (one per model).
+layout (std430, binding = 3) buffer DrawCommands { DrawCommand drawCommands[]; };
+layout (std430, binding = 4) writeonly buffer VisibleMatrices { mat4 visibleMatrices[]; };
+
+uniform vec4 uFrustumPlanes[6];
+uniform int uEntityCount;
+
+void main()
+{
+    uint index = gl_GlobalInvocationID.x;
+
+    if(index >= uint(uEntityCount))
+    {
+        return;
+    }
+
+    vec4 sphere = spheres[index];
+
+    for(int i = 0; i < 6; i++)
+    {
+        if(dot(uFrustumPlanes[i].xyz, sphere.xyz) + uFrustumPlanes[i].w + sphere.w <= 0.0)
+        {
+            return;
+        }
+    }
+
+    uint drawIndex = drawIndices[index];
+    uint slot = atomicAdd(drawCommands[drawIndex].instanceCount, 1u);
+
+    // Every draw command owns a range of the visible matrices, starting at its base instance.
+    visibleMatrices[drawCommands[drawIndex].baseInstance + slot] = modelMatrices[index];
+}
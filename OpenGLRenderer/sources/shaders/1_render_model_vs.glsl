@@ -6,14 +6,39 @@ layout (location = 2) in vec2 aTexCoords;
 layout (location = 3) in ivec4 aBoneIDs;
 layout (location = 4) in vec4 aWeights;
 
-const int MAX_NUM_BONES = 100;
 const int MAX_NUM_BONES_PER_VERTEX = 4;
 
 uniform mat4 uModelMatrix;
-uniform mat4 uViewMatrix;
-uniform mat4 uProjectionMatrix;
 
-uniform mat4 uBonesMatrices[MAX_NUM_BONES];
+// Packed vertices: positions quantized inside the model AABB (identity for full precision vertices) and octahedral normals.
+uniform vec3 uPositionOrigin;
+uniform vec3 uPositionScale;
+uniform bool uOctahedralNormals;
+
+vec3 decodeOctahedral(vec2 encoded)
+{
+    vec3 normal = vec3(encoded, 1.0 - abs(encoded.x) - abs(encoded.y));
+    float t = max(-normal.z, 0.0);
+
+    normal.xy -= t * vec2(normal.x >= 0.0 ? 1.0 : -1.0, normal.y >= 0.0 ? 1.0 : -1.0);
+
+    return normalize(normal);
+}
+
+layout (std140, binding = 0) uniform ViewUniforms
+{
+    mat4 uProjectionMatrix;
+    mat4 uViewMatrix;
+    mat4 uLightSpaceMatrix;
+    vec4 uViewPosition; // w: time in seconds.
+    vec4 uClipPlane;
+};
+
+// Palette of the animated model, sized by its skeleton.
+layout (std430, binding = 0) readonly buffer BonesMatrices
+{
+    mat4 uBonesMatrices[];
+};
 
 out VS_OUT {
     vec2 texCoords;
@@ -23,6 +48,9 @@ out VS_OUT {
 
 void main()
 {
+    vec3 position = uPositionOrigin + aPos * uPositionScale;
+    vec3 normal = uOctahedralNormals ? decodeOctahedral(aNormal.xy) : aNormal;
+
     mat4 bonesMatrix = mat4(0.0);
 
     for(int i = 0; i < MAX_NUM_BONES_PER_VERTEX; i++)
@@ -32,7 +60,7 @@ void main()
             continue;
         }
 
-        if(aBoneIDs[i] >= MAX_NUM_BONES)
+        if(aBoneIDs[i] >= uBonesMatrices.length())
         {
             bonesMatrix = mat4(1.0);
 
@@ -46,8 +74,8 @@ void main()
     mat3 normalMatrix = transpose(inverse(mat3(mbMatrix)));
 
     vs_out.texCoords = aTexCoords;
-    vs_out.fragPos = vec3(mbMatrix * vec4(aPos, 1.0));
-    vs_out.fragNormal = normalize(normalMatrix * aNormal);
+    vs_out.fragPos = vec3(mbMatrix * vec4(position, 1.0));
+    vs_out.fragNormal = normalize(normalMatrix * normal);
 
     gl_Position = uProjectionMatrix * uViewMatrix * vec4(vs_out.fragPos, 1.0);
 }
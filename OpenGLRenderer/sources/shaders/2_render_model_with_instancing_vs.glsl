@@ -5,14 +5,26 @@ layout (location = 1) in vec3 aNormal;
 layout (location = 2) in vec2 aTexCoords;
 layout (location = 3) in mat4 aInstanceMatrix; // a.k.a. model matrix.
 
-uniform mat4 uViewMatrix;
-uniform mat4 uProjectionMatrix;
+// Packed vertices: positions quantized inside the model AABB (identity for full precision vertices).
+uniform vec3 uPositionOrigin;
+uniform vec3 uPositionScale;
+
+layout (std140, binding = 0) uniform ViewUniforms
+{
+    mat4 uProjectionMatrix;
+    mat4 uViewMatrix;
+    mat4 uLightSpaceMatrix;
+    vec4 uViewPosition; // w: time in seconds.
+    vec4 uClipPlane;
+};
 
 out vec2 ioTexCoords;
 
 void main()
 {
-    gl_Position = uProjectionMatrix * uViewMatrix * aInstanceMatrix * vec4(aPos, 1.0);
+    vec3 position = uPositionOrigin + aPos * uPositionScale;
+
+    gl_Position = uProjectionMatrix * uViewMatrix * aInstanceMatrix * vec4(position, 1.0);
 
     ioTexCoords = aTexCoords;
 }
@@ -4,8 +4,15 @@ layout (location = 0) in vec3 aPos;
 layout (location = 1) in vec2 aTexCoords;
 layout (location = 2) in mat4 aInstanceMatrix; // a.k.a. model matrix.
 
-uniform mat4 uProjectionMatrix;
-uniform mat4 uViewMatrix;
+layout (std140, binding = 0) uniform ViewUniforms
+{
+    mat4 uProjectionMatrix;
+    mat4 uViewMatrix;
+    mat4 uLightSpaceMatrix;
+    vec4 uViewPosition; // w: time in seconds.
+    vec4 uClipPlane;
+};
+
 uniform vec3 uWindDirection;
 
 uniform float uWindIntensity;
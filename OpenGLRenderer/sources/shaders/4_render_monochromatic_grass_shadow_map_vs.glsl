@@ -4,7 +4,16 @@ layout (location = 0) in vec3 aPos;
 layout (location = 1) in vec3 aNormal;
 layout (location = 2) in mat4 aInstanceMatrix; // a.k.a. model matrix.
 
-uniform mat4 uLightSpaceMatrix;
+// Shadow view: the camera is the light.
+layout (std140, binding = 0) uniform ViewUniforms
+{
+    mat4 uProjectionMatrix;
+    mat4 uViewMatrix;
+    mat4 uLightSpaceMatrix;
+    vec4 uViewPosition; // w: time in seconds.
+    vec4 uClipPlane;
+};
+
 uniform vec3 uWindDirection;
 
 uniform sampler2D uNoiseTex;
@@ -71,5 +80,5 @@ void main()
         break;
     }
 
-    gl_Position = uLightSpaceMatrix * vec4(newPos, 1.0);
+    gl_Position = uProjectionMatrix * uViewMatrix * vec4(newPos, 1.0);
 }
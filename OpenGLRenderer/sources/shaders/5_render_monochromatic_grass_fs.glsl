@@ -25,7 +25,15 @@ in VS_OUT {
 uniform Light uLight;
 uniform Material uMaterial;
 uniform sampler2D uShadowMap;
-uniform vec3 uViewPos;
+
+layout (std140, binding = 0) uniform ViewUniforms
+{
+    mat4 uProjectionMatrix;
+    mat4 uViewMatrix;
+    mat4 uLightSpaceMatrix;
+    vec4 uViewPosition; // w: time in seconds.
+    vec4 uClipPlane;
+};
 
 out vec4 oFragColor;
 
@@ -82,7 +90,7 @@ void main()
 {
     vec3 fragNormal = normalize(fs_in.normal);
     vec3 lightDir = normalize(uLight.position - fs_in.fragPos);
-    vec3 viewDir = normalize(uViewPos - fs_in.fragPos);
+    vec3 viewDir = normalize(uViewPosition.xyz - fs_in.fragPos);
     vec3 halfwayDir = normalize(lightDir + viewDir);
 
     float diffuseStr = max(dot(fragNormal, lightDir), 0.0);
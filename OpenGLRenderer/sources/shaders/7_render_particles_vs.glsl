@@ -5,9 +5,15 @@ layout (location = 1) in vec3 aModelPos;
 layout (location = 2) in vec2 aModelRotationAndScale;
 layout (location = 3) in vec4 aColor;
 
-uniform mat4 uViewMatrix;
-uniform mat4 uProjectionMatrix;
-uniform vec3 uCameraPos;
+layout (std140, binding = 0) uniform ViewUniforms
+{
+    mat4 uProjectionMatrix;
+    mat4 uViewMatrix;
+    mat4 uLightSpaceMatrix;
+    vec4 uViewPosition; // w: time in seconds.
+    vec4 uClipPlane;
+};
+
 uniform bool uBuillboarding = false;
 
 out vec4 ioColor;
@@ -40,7 +46,7 @@ mat4 calcModelMatrix(bool billboarding = false)
 {
     if (billboarding)
     {
-        vec3 axis = normalize(uCameraPos - aModelPos);
+        vec3 axis = normalize(uViewPosition.xyz - aModelPos);
 
         // Rotation matrix.
         mat4 R = calcGeneralRotationMatrix(axis, aModelRotationAndScale[0]);
@@ -70,7 +76,7 @@ mat4 calcModelMatrix(bool billboarding = false)
 
 mat4 calcBillboardingMatrix()
 {
-    vec3 pD = normalize(uCameraPos - aModelPos);
+    vec3 pD = normalize(uViewPosition.xyz - aModelPos);
     vec3 pR = normalize(cross(vec3(0.0, 1.0, 0.0), pD));
     vec3 pU = normalize(cross(pD, pR));
 
@@ -84,7 +90,7 @@ mat4 calcBillboardingMatrix()
 
 vec3 calcBillboardingPos(vec3 worldPos)
 {
-    vec3 pD = normalize(uCameraPos - aModelPos);
+    vec3 pD = normalize(uViewPosition.xyz - aModelPos);
     vec3 pR = normalize(cross(vec3(0.0, 1.0, 0.0), pD));
     vec3 pU = normalize(cross(pD, pR));
 
@@ -0,0 +1,264 @@
+#include "bvh.h"
+
+// Refitting may let the boxes grow (and overlap) as spheres move apart; past this growth a rebuild is cheaper than traversing a loose tree.
+static const float REBUILD_SURFACE_AREA_RATIO = 2.0f;
+
+static float computeSurfaceArea(const glm::vec3& minAABB, const glm::vec3& maxAABB)
+{
+	glm::vec3 extent = maxAABB - minAABB;
+
+	return 2.0f * (extent.x * extent.y + extent.y * extent.z + extent.z * extent.x);
+}
+
+BoundingVolumeHierarchy::BoundingVolumeHierarchy()
+	: builtSurfaceArea(0.0f), nodesVisited(0), rebuildCount(0)
+{
+}
+
+void BoundingVolumeHierarchy::build(const SphereBatch& spheres)
+{
+	uint32_t size = spheres.getSize();
+
+	clear();
+
+	if (size == 0)
+	{
+		return;
+	}
+
+	primitives.resize(size);
+	centroids.resize(size);
+
+	for (uint32_t i = 0; i < size; i++)
+	{
+		primitives[i] = i;
+		centroids[i] = glm::vec3(spheres.centersX[i], spheres.centersY[i], spheres.centersZ[i]);
+	}
+
+	// A binary tree with at most "MAX_LEAF_SIZE" primitives per leaf has less than "2 * size" nodes.
+	nodes.reserve(2 * size);
+	nodes.push_back({ glm::vec3(0.0f), glm::vec3(0.0f), 0, size, INVALID_INDEX });
+
+	subdivide(0);
+
+	for (uint32_t i = uint32_t(nodes.size()); i-- > 0;)
+	{
+		updateBounds(i, spheres);
+	}
+
+	builtSurfaceArea = computeTotalSurfaceArea();
+
+	centroids.clear();
+}
+
+void BoundingVolumeHierarchy::clear()
+{
+	nodes.clear();
+	primitives.clear();
+
+	builtSurfaceArea = 0.0f;
+}
+
+void BoundingVolumeHierarchy::refit(const SphereBatch& spheres)
+{
+	if (spheres.getSize() != primitives.size())
+	{
+		build(spheres);
+
+		return;
+	}
+
+	// Children are stored after their parents, so a reverse pass always refits the children first.
+	for (uint32_t i = uint32_t(nodes.size()); i-- > 0;)
+	{
+		updateBounds(i, spheres);
+	}
+
+	if (computeTotalSurfaceArea() > builtSurfaceArea * REBUILD_SURFACE_AREA_RATIO)
+	{
+		build(spheres);
+
+		rebuildCount += 1;
+	}
+}
+
+void BoundingVolumeHierarchy::cull(const Frustum& frustum, const SphereBatch& spheres, std::vector<uint32_t>& visibleIndices)
+{
+	const uint32_t ALL_PLANES = (1u << FrustumCuller::NUMBER_OF_PLANES) - 1u;
+
+	glm::vec4 planes[FrustumCuller::NUMBER_OF_PLANES];
+
+	FrustumCuller::getPlanes(frustum, planes);
+
+	visibleIndices.clear();
+	nodesVisited = 0;
+
+	if (nodes.empty())
+	{
+		return;
+	}
+
+	// Every entry keeps the planes that still need to be tested: a plane is dropped once a box is fully forward it.
+	std::pair<uint32_t, uint32_t> stack[64];
+	uint32_t stackSize = 0;
+
+	stack[stackSize++] = { 0, ALL_PLANES };
+
+	while (stackSize > 0)
+	{
+		uint32_t nodeIndex = stack[stackSize - 1].first;
+		uint32_t planeMask = stack[stackSize - 1].second;
+
+		stackSize -= 1;
+
+		const Node& node = nodes[nodeIndex];
+		bool outside = false;
+
+		nodesVisited += 1;
+
+		for (uint32_t p = 0; p < FrustumCuller::NUMBER_OF_PLANES && !outside; p++)
+		{
+			if ((planeMask & (1u << p)) == 0)
+			{
+				continue;
+			}
+
+			const glm::vec4& plane = planes[p];
+
+			// Corners of the box nearest to and farthest from the plane, along its normal.
+			glm::vec3 nearCorner(plane.x >= 0.0f ? node.minAABB.x : node.maxAABB.x, plane.y >= 0.0f ? node.minAABB.y : node.maxAABB.y, plane.z >= 0.0f ? node.minAABB.z : node.maxAABB.z);
+			glm::vec3 farCorner(plane.x >= 0.0f ? node.maxAABB.x : node.minAABB.x, plane.y >= 0.0f ? node.maxAABB.y : node.minAABB.y, plane.z >= 0.0f ? node.maxAABB.z : node.minAABB.z);
+
+			if (glm::dot(glm::vec3(plane), farCorner) + plane.w <= 0.0f)
+			{
+				outside = true;
+			}
+			else if (glm::dot(glm::vec3(plane), nearCorner) + plane.w > 0.0f)
+			{
+				planeMask &= ~(1u << p);
+			}
+		}
+
+		if (outside)
+		{
+			continue;
+		}
+
+		if (planeMask == 0)
+		{
+			// Fully inside: the whole subtree is accepted without visiting it.
+			visibleIndices.insert(visibleIndices.end(), primitives.begin() + node.firstPrimitive, primitives.begin() + node.firstPrimitive + node.primitiveCount);
+		}
+		else if (node.isLeaf())
+		{
+			for (uint32_t i = node.firstPrimitive; i < node.firstPrimitive + node.primitiveCount; i++)
+			{
+				uint32_t index = primitives[i];
+				bool visible = true;
+
+				for (uint32_t p = 0; p < FrustumCuller::NUMBER_OF_PLANES && visible; p++)
+				{
+					if (planeMask & (1u << p))
+					{
+						const glm::vec4& plane = planes[p];
+
+						visible = plane.x * spheres.centersX[index] + plane.y * spheres.centersY[index] + plane.z * spheres.centersZ[index] + plane.w + spheres.radii[index] > 0.0f;
+					}
+				}
+
+				if (visible)
+				{
+					visibleIndices.push_back(index);
+				}
+			}
+		}
+		else
+		{
+			stack[stackSize++] = { node.leftChild + 1, planeMask };
+			stack[stackSize++] = { node.leftChild, planeMask };
+		}
+	}
+}
+
+void BoundingVolumeHierarchy::subdivide(uint32_t nodeIndex)
+{
+	uint32_t first = nodes[nodeIndex].firstPrimitive;
+	uint32_t count = nodes[nodeIndex].primitiveCount;
+
+	if (count <= MAX_LEAF_SIZE)
+	{
+		return;
+	}
+
+	glm::vec3 minCentroid = centroids[primitives[first]];
+	glm::vec3 maxCentroid = minCentroid;
+
+	for (uint32_t i = first + 1; i < first + count; i++)
+	{
+		minCentroid = glm::min(minCentroid, centroids[primitives[i]]);
+		maxCentroid = glm::max(maxCentroid, centroids[primitives[i]]);
+	}
+
+	// Median split on the axis where the centroids are spread the most, which keeps the tree balanced (and its depth logarithmic).
+	glm::vec3 extent = maxCentroid - minCentroid;
+	uint32_t axis = extent.y > extent.x ? 1 : 0;
+
+	axis = extent.z > extent[axis] ? 2 : axis;
+
+	uint32_t half = count / 2;
+
+	std::nth_element(primitives.begin() + first, primitives.begin() + first + half, primitives.begin() + first + count,
+		[this, axis](uint32_t a, uint32_t b) { return centroids[a][axis] < centroids[b][axis]; });
+
+	uint32_t leftChild = uint32_t(nodes.size());
+
+	nodes.push_back({ glm::vec3(0.0f), glm::vec3(0.0f), first, half, INVALID_INDEX });
+	nodes.push_back({ glm::vec3(0.0f), glm::vec3(0.0f), first + half, count - half, INVALID_INDEX });
+
+	nodes[nodeIndex].leftChild = leftChild;
+
+	subdivide(leftChild);
+	subdivide(leftChild + 1);
+}
+
+void BoundingVolumeHierarchy::updateBounds(uint32_t nodeIndex, const SphereBatch& spheres)
+{
+	Node& node = nodes[nodeIndex];
+
+	if (node.isLeaf())
+	{
+		node.minAABB = glm::vec3(std::numeric_limits<float>::max());
+		node.maxAABB = glm::vec3(-std::numeric_limits<float>::max());
+
+		for (uint32_t i = node.firstPrimitive; i < node.firstPrimitive + node.primitiveCount; i++)
+		{
+			uint32_t index = primitives[i];
+
+			glm::vec3 center(spheres.centersX[index], spheres.centersY[index], spheres.centersZ[index]);
+			glm::vec3 radius(spheres.radii[index]);
+
+			node.minAABB = glm::min(node.minAABB, center - radius);
+			node.maxAABB = glm::max(node.maxAABB, center + radius);
+		}
+	}
+	else
+	{
+		const Node& left = nodes[node.leftChild];
+		const Node& right = nodes[node.leftChild + 1];
+
+		node.minAABB = glm::min(left.minAABB, right.minAABB);
+		node.maxAABB = glm::max(left.maxAABB, right.maxAABB);
+	}
+}
+
+float BoundingVolumeHierarchy::computeTotalSurfaceArea() const
+{
+	float surfaceArea = 0.0f;
+
+	for (const Node& node : nodes)
+	{
+		surfaceArea += computeSurfaceArea(node.minAABB, node.maxAABB);
+	}
+
+	return surfaceArea;
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+#include <limits>
+#include <utility>
+
+#include <glm/glm.hpp>
+
+#include "frustum_culler.h"
+
+// Refittable bounding volume hierarchy over a sphere batch.
+//
+// Nodes are axis aligned boxes stored in a flat array; the children of a node are always stored after it (and next to each other),
+// so the boxes can be refitted bottom-up with a single reverse pass. Every node covers a contiguous range of the primitive array,
+// which lets a subtree fully inside the frustum be accepted at once, without visiting its nodes.
+//
+class BoundingVolumeHierarchy
+{
+public:
+	static const uint32_t INVALID_INDEX = 0xFFFFFFFF;
+	static const uint32_t MAX_LEAF_SIZE = 4;
+
+	struct Node
+	{
+		glm::vec3 minAABB, maxAABB;
+
+		uint32_t firstPrimitive, primitiveCount;
+		uint32_t leftChild; // The right child is always "leftChild + 1". Leaves have no children.
+
+		bool isLeaf() const { return leftChild == INVALID_INDEX; }
+	};
+
+	BoundingVolumeHierarchy();
+
+	void build(const SphereBatch& spheres);
+	void clear();
+
+	// Recomputes the boxes after spheres moved, keeping the tree topology.
+	// Rebuilds the tree instead when refitting degraded it too much (measured by the growth of the total surface area).
+	void refit(const SphereBatch& spheres);
+
+	// Writes the indices of the visible spheres into "visibleIndices" (not sorted).
+	void cull(const Frustum& frustum, const SphereBatch& spheres, std::vector<uint32_t>& visibleIndices);
+
+	const std::vector<Node>& getNodes() const { return nodes; }
+	uint32_t getNodesVisited() const { return nodesVisited; }
+	uint32_t getRebuildCount() const { return rebuildCount; }
+
+private:
+	std::vector<Node> nodes;
+	std::vector<uint32_t> primitives;
+
+	// Used only during the build.
+	std::vector<glm::vec3> centroids;
+
+	float builtSurfaceArea;
+
+	uint32_t nodesVisited;
+	uint32_t rebuildCount;
+
+	void subdivide(uint32_t nodeIndex);
+	void updateBounds(uint32_t nodeIndex, const SphereBatch& spheres);
+
+	float computeTotalSurfaceArea() const;
+};
@@ -0,0 +1,64 @@
+#include "entity_pool.h"
+
+EntityPool::EntityPool()
+	: size(0)
+{
+}
+
+EntityPool::~EntityPool()
+{
+	clear();
+}
+
+Entity* EntityPool::create(TransformHierarchy* hierarchy, Entity* parent, BasicModel* model)
+{
+	if (size == chunks.size() * CHUNK_SIZE)
+	{
+		chunks.emplace_back(new EntityStorage[CHUNK_SIZE]);
+	}
+
+	Entity* entity = new (&chunks[size / CHUNK_SIZE][size % CHUNK_SIZE]) Entity(this, hierarchy, parent, model);
+
+	size += 1;
+
+	if (parent)
+	{
+		if (parent->lastChild)
+		{
+			parent->lastChild->nextSibling = entity;
+		}
+		else
+		{
+			parent->firstChild = entity;
+		}
+
+		parent->lastChild = entity;
+	}
+
+	return entity;
+}
+
+void EntityPool::reserve(uint32_t capacity)
+{
+	while (chunks.size() * CHUNK_SIZE < capacity)
+	{
+		chunks.emplace_back(new EntityStorage[CHUNK_SIZE]);
+	}
+}
+
+void EntityPool::clear()
+{
+	for (uint32_t handle = 0; handle < size; handle++)
+	{
+		get(handle)->~Entity();
+	}
+
+	size = 0;
+}
+
+void EntityPool::release()
+{
+	clear();
+
+	chunks.clear();
+}
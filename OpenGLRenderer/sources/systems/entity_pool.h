@@ -0,0 +1,49 @@
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include <type_traits>
+
+#include "../entity.h"
+
+// Scene owned storage of entities.
+//
+// Entities are constructed in place inside fixed size chunks, so creating one costs no heap allocation (besides a new chunk
+// every "CHUNK_SIZE" entities) and they are never moved: pointers and handles stay valid until the pool is cleared.
+// Entities are stored in creation order, and a child is always created after its parent, so a linear pass over the pool
+// visits parents before their children. Clearing destroys every entity at once, without walking the hierarchy.
+//
+class EntityPool
+{
+public:
+	static const uint32_t CHUNK_SIZE = 1024;
+
+	EntityPool();
+	~EntityPool();
+
+	EntityPool(const EntityPool&) = delete;
+	EntityPool& operator=(const EntityPool&) = delete;
+
+	// Creates an entity (and its transform hierarchy node), linking it as the last child of "parent".
+	Entity* create(TransformHierarchy* hierarchy, Entity* parent, BasicModel* model);
+
+	// Handles are the creation order of the entities.
+	Entity* get(uint32_t handle) const { return reinterpret_cast<Entity*>(&chunks[handle / CHUNK_SIZE][handle % CHUNK_SIZE]); }
+	uint32_t getSize() const { return size; }
+
+	void reserve(uint32_t capacity);
+
+	// Destroys all entities. The chunks are kept to be reused by the next entities.
+	void clear();
+
+	// Destroys all entities and frees the chunks.
+	void release();
+
+private:
+	typedef std::aligned_storage<sizeof(Entity), alignof(Entity)>::type EntityStorage;
+
+	std::vector<std::unique_ptr<EntityStorage[]>> chunks;
+
+	uint32_t size;
+};
@@ -0,0 +1,301 @@
+#include "frustum_culler.h"
+
+#if defined(FRUSTUM_CULLER_X86)
+#include <immintrin.h>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+
+#define FRUSTUM_CULLER_AVX_TARGET
+#else
+#define FRUSTUM_CULLER_AVX_TARGET __attribute__((target("avx")))
+#endif
+#endif
+
+static uint32_t countTrailingZeros(uint32_t value)
+{
+#if defined(_MSC_VER)
+	unsigned long index;
+
+	_BitScanForward(&index, value);
+
+	return uint32_t(index);
+#else
+	return uint32_t(__builtin_ctz(value));
+#endif
+}
+
+static bool isSphereVisible(const glm::vec4* planes, const SphereBatch& spheres, uint32_t index)
+{
+	for (uint32_t p = 0; p < FrustumCuller::NUMBER_OF_PLANES; p++)
+	{
+		float distance = planes[p].x * spheres.centersX[index] + planes[p].y * spheres.centersY[index] + planes[p].z * spheres.centersZ[index] + planes[p].w;
+
+		if (distance + spheres.radii[index] <= 0.0f)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void FrustumCuller::getPlanes(const Frustum& frustum, glm::vec4* planes)
+{
+	// Tested in the order that most likely rejects a sphere first.
+	const Plane* faces[NUMBER_OF_PLANES] = { &frustum.leftFace, &frustum.rightFace, &frustum.farFace, &frustum.nearFace, &frustum.topFace, &frustum.bottomFace };
+
+	// A sphere is on or forward a plane when "dot(normal, center) - distance + radius > 0".
+	for (uint32_t i = 0; i < NUMBER_OF_PLANES; i++)
+	{
+		planes[i] = glm::vec4(faces[i]->normal, -faces[i]->distance);
+	}
+}
+
+void SphereBatch::resize(uint32_t size)
+{
+	centersX.resize(size, 0.0f);
+	centersY.resize(size, 0.0f);
+	centersZ.resize(size, 0.0f);
+	radii.resize(size, 0.0f);
+}
+
+void SphereBatch::clear()
+{
+	centersX.clear();
+	centersY.clear();
+	centersZ.clear();
+	radii.clear();
+}
+
+void SphereBatch::set(uint32_t index, const glm::vec3& center, float radius)
+{
+	centersX[index] = center.x;
+	centersY[index] = center.y;
+	centersZ[index] = center.z;
+	radii[index] = radius;
+}
+
+FrustumCuller::Mode FrustumCuller::getBestMode()
+{
+	static Mode bestMode = isModeSupported(Mode::AVX) ? Mode::AVX : isModeSupported(Mode::SSE) ? Mode::SSE : Mode::SCALAR;
+
+	return bestMode;
+}
+
+bool FrustumCuller::isModeSupported(Mode mode)
+{
+	switch (mode)
+	{
+	case Mode::SCALAR:
+		return true;
+
+#if defined(FRUSTUM_CULLER_X86)
+	case Mode::SSE:
+		return true; // SSE2 is part of every x64 CPU (and the default target for x86 builds).
+
+	case Mode::AVX:
+#if defined(_MSC_VER)
+	{
+		int info[4];
+
+		__cpuid(info, 1);
+
+		// The CPU must support AVX and the OS must save the YMM registers (OSXSAVE + XCR0).
+		bool avx = (info[2] & (1 << 28)) != 0;
+		bool osxsave = (info[2] & (1 << 27)) != 0;
+
+		return avx && osxsave && (_xgetbv(0) & 0x6) == 0x6;
+	}
+#else
+		return __builtin_cpu_supports("avx");
+#endif
+#endif
+
+	default:
+		return false;
+	}
+}
+
+void FrustumCuller::cull(const Frustum& frustum, const SphereBatch& spheres, std::vector<uint32_t>& visibleIndices, Mode mode)
+{
+	std::vector<uint32_t> visibilityMask;
+
+	cullToBitmask(frustum, spheres, visibilityMask, mode);
+	compactBitmask(visibilityMask, spheres.getSize(), visibleIndices);
+}
+
+void FrustumCuller::cullToBitmask(const Frustum& frustum, const SphereBatch& spheres, std::vector<uint32_t>& visibilityMask, Mode mode)
+{
+	CullJobData data;
+
+	getPlanes(frustum, data.planes);
+
+	visibilityMask.assign((spheres.getSize() + 31) / 32, 0);
+
+	data.spheres = &spheres;
+	data.mask = visibilityMask.data();
+	data.mode = isModeSupported(mode) ? mode : getBestMode();
+
+	JobSystem::parallelFor(spheres.getSize(), BATCH_SIZE, cullJob, &data);
+}
+
+void FrustumCuller::cullJob(uint32_t begin, uint32_t end, void* data)
+{
+	const CullJobData& job = *(const CullJobData*)data;
+
+	switch (job.mode)
+	{
+	case Mode::SSE:
+		cullSSE(job.planes, *job.spheres, begin, end, job.mask);
+		break;
+
+	case Mode::AVX:
+		cullAVX(job.planes, *job.spheres, begin, end, job.mask);
+		break;
+
+	default:
+		cullScalar(job.planes, *job.spheres, begin, end, job.mask);
+		break;
+	}
+}
+
+void FrustumCuller::compactBitmask(const std::vector<uint32_t>& visibilityMask, uint32_t size, std::vector<uint32_t>& visibleIndices)
+{
+	visibleIndices.clear();
+
+	for (uint32_t word = 0; word < visibilityMask.size(); word++)
+	{
+		uint32_t bits = visibilityMask[word];
+
+		while (bits != 0)
+		{
+			uint32_t index = word * 32 + countTrailingZeros(bits);
+
+			if (index < size)
+			{
+				visibleIndices.push_back(index);
+			}
+
+			bits &= bits - 1; // Clear the lowest set bit.
+		}
+	}
+}
+
+void FrustumCuller::cullScalar(const glm::vec4* planes, const SphereBatch& spheres, uint32_t begin, uint32_t end, uint32_t* mask)
+{
+	for (uint32_t i = begin; i < end; i++)
+	{
+		if (isSphereVisible(planes, spheres, i))
+		{
+			mask[i >> 5] |= 1u << (i & 31);
+		}
+	}
+}
+
+void FrustumCuller::cullSSE(const glm::vec4* planes, const SphereBatch& spheres, uint32_t begin, uint32_t end, uint32_t* mask)
+{
+#if defined(FRUSTUM_CULLER_X86)
+	uint32_t batchedEnd = begin + ((end - begin) & ~3u);
+
+	__m128 planesX[NUMBER_OF_PLANES], planesY[NUMBER_OF_PLANES], planesZ[NUMBER_OF_PLANES], planesW[NUMBER_OF_PLANES];
+
+	for (uint32_t p = 0; p < NUMBER_OF_PLANES; p++)
+	{
+		planesX[p] = _mm_set1_ps(planes[p].x);
+		planesY[p] = _mm_set1_ps(planes[p].y);
+		planesZ[p] = _mm_set1_ps(planes[p].z);
+		planesW[p] = _mm_set1_ps(planes[p].w);
+	}
+
+	const __m128 zero = _mm_setzero_ps();
+
+	for (uint32_t i = begin; i < batchedEnd; i += 4)
+	{
+		__m128 centersX = _mm_loadu_ps(&spheres.centersX[i]);
+		__m128 centersY = _mm_loadu_ps(&spheres.centersY[i]);
+		__m128 centersZ = _mm_loadu_ps(&spheres.centersZ[i]);
+		__m128 radii = _mm_loadu_ps(&spheres.radii[i]);
+
+		__m128 visible = _mm_cmpeq_ps(zero, zero); // All bits set.
+
+		for (uint32_t p = 0; p < NUMBER_OF_PLANES; p++)
+		{
+			__m128 distance = _mm_add_ps(_mm_mul_ps(planesX[p], centersX), _mm_mul_ps(planesY[p], centersY));
+			distance = _mm_add_ps(distance, _mm_mul_ps(planesZ[p], centersZ));
+			distance = _mm_add_ps(distance, _mm_add_ps(planesW[p], radii));
+
+			visible = _mm_and_ps(visible, _mm_cmpgt_ps(distance, zero));
+		}
+
+		mask[i >> 5] |= uint32_t(_mm_movemask_ps(visible)) << (i & 31);
+	}
+
+	// Remaining spheres.
+	for (uint32_t i = batchedEnd; i < end; i++)
+	{
+		if (isSphereVisible(planes, spheres, i))
+		{
+			mask[i >> 5] |= 1u << (i & 31);
+		}
+	}
+#else
+	cullScalar(planes, spheres, begin, end, mask);
+#endif
+}
+
+#if defined(FRUSTUM_CULLER_X86)
+FRUSTUM_CULLER_AVX_TARGET
+#endif
+void FrustumCuller::cullAVX(const glm::vec4* planes, const SphereBatch& spheres, uint32_t begin, uint32_t end, uint32_t* mask)
+{
+#if defined(FRUSTUM_CULLER_X86)
+	uint32_t batchedEnd = begin + ((end - begin) & ~7u);
+
+	__m256 planesX[NUMBER_OF_PLANES], planesY[NUMBER_OF_PLANES], planesZ[NUMBER_OF_PLANES], planesW[NUMBER_OF_PLANES];
+
+	for (uint32_t p = 0; p < NUMBER_OF_PLANES; p++)
+	{
+		planesX[p] = _mm256_set1_ps(planes[p].x);
+		planesY[p] = _mm256_set1_ps(planes[p].y);
+		planesZ[p] = _mm256_set1_ps(planes[p].z);
+		planesW[p] = _mm256_set1_ps(planes[p].w);
+	}
+
+	const __m256 zero = _mm256_setzero_ps();
+
+	for (uint32_t i = begin; i < batchedEnd; i += 8)
+	{
+		__m256 centersX = _mm256_loadu_ps(&spheres.centersX[i]);
+		__m256 centersY = _mm256_loadu_ps(&spheres.centersY[i]);
+		__m256 centersZ = _mm256_loadu_ps(&spheres.centersZ[i]);
+		__m256 radii = _mm256_loadu_ps(&spheres.radii[i]);
+
+		__m256 visible = _mm256_cmp_ps(zero, zero, _CMP_EQ_OQ); // All bits set.
+
+		for (uint32_t p = 0; p < NUMBER_OF_PLANES; p++)
+		{
+			__m256 distance = _mm256_add_ps(_mm256_mul_ps(planesX[p], centersX), _mm256_mul_ps(planesY[p], centersY));
+			distance = _mm256_add_ps(distance, _mm256_mul_ps(planesZ[p], centersZ));
+			distance = _mm256_add_ps(distance, _mm256_add_ps(planesW[p], radii));
+
+			visible = _mm256_and_ps(visible, _mm256_cmp_ps(distance, zero, _CMP_GT_OQ));
+		}
+
+		mask[i >> 5] |= uint32_t(_mm256_movemask_ps(visible)) << (i & 31);
+	}
+
+	// Remaining spheres.
+	for (uint32_t i = batchedEnd; i < end; i++)
+	{
+		if (isSphereVisible(planes, spheres, i))
+		{
+			mask[i >> 5] |= 1u << (i & 31);
+		}
+	}
+
+	_mm256_zeroupper();
+#else
+	cullScalar(planes, spheres, begin, end, mask);
+#endif
+}
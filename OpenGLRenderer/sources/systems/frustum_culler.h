@@ -0,0 +1,72 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+
+#include <glm/glm.hpp>
+
+#include "../entity.h"
+#include "job_system.h"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define FRUSTUM_CULLER_X86
+#endif
+
+// World space bounding spheres stored as a structure of arrays, so several spheres can be loaded into a single SIMD register.
+struct SphereBatch
+{
+	std::vector<float> centersX, centersY, centersZ, radii;
+
+	void resize(uint32_t size);
+	void clear();
+
+	void set(uint32_t index, const glm::vec3& center, float radius);
+
+	glm::vec3 getCenter(uint32_t index) const { return glm::vec3(centersX[index], centersY[index], centersZ[index]); }
+	uint32_t getSize() const { return uint32_t(radii.size()); }
+};
+
+// Batch frustum culling of bounding spheres. Tests 4 (SSE) or 8 (AVX) spheres at once against all six planes of the frustum,
+// spreading batches of spheres across the job system workers.
+class FrustumCuller
+{
+public:
+	enum class Mode { SCALAR, SSE, AVX };
+
+	static const uint32_t NUMBER_OF_PLANES = 6;
+
+	// Spheres per job. A multiple of 32, so every job writes its own words of the mask.
+	static const uint32_t BATCH_SIZE = 32 * 64;
+
+	// Frustum faces as "(normal, -distance)", so a point is forward a plane when "dot(plane, vec4(point, 1)) > 0".
+	static void getPlanes(const Frustum& frustum, glm::vec4* planes);
+
+	// Best kernel supported by the running CPU.
+	static Mode getBestMode();
+	static bool isModeSupported(Mode mode);
+
+	// Writes the indices of the visible spheres (in ascending order) into "visibleIndices".
+	static void cull(const Frustum& frustum, const SphereBatch& spheres, std::vector<uint32_t>& visibleIndices, Mode mode = getBestMode());
+
+	// Writes one bit per sphere (set when visible) into "visibilityMask", 32 spheres per word.
+	static void cullToBitmask(const Frustum& frustum, const SphereBatch& spheres, std::vector<uint32_t>& visibilityMask, Mode mode = getBestMode());
+
+	static void compactBitmask(const std::vector<uint32_t>& visibilityMask, uint32_t size, std::vector<uint32_t>& visibleIndices);
+
+private:
+	struct CullJobData
+	{
+		glm::vec4 planes[NUMBER_OF_PLANES];
+		const SphereBatch* spheres;
+		uint32_t* mask;
+		Mode mode;
+	};
+
+	static void cullJob(uint32_t begin, uint32_t end, void* data);
+
+	// Kernels OR the results of the spheres in ["begin", "end") into a zeroed mask of "(size + 31) / 32" words. "begin" must be a
+	// multiple of 32.
+	static void cullScalar(const glm::vec4* planes, const SphereBatch& spheres, uint32_t begin, uint32_t end, uint32_t* mask);
+	static void cullSSE(const glm::vec4* planes, const SphereBatch& spheres, uint32_t begin, uint32_t end, uint32_t* mask);
+	static void cullAVX(const glm::vec4* planes, const SphereBatch& spheres, uint32_t begin, uint32_t end, uint32_t* mask);
+};
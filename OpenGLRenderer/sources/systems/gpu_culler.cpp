@@ -0,0 +1,245 @@
+#include "gpu_culler.h"
+
+// Names of the uniforms set every frame, hashed by the compiler.
+static constexpr UniformName FRUSTUM_PLANES_UNIFORM("uFrustumPlanes");
+static constexpr UniformName ENTITY_COUNT_UNIFORM("uEntityCount");
+
+static const uint32_t WORK_GROUP_SIZE = 64;
+
+const uint32_t GPUCuller::READBACK_BUFFERS;
+
+GPUCuller::GPUCuller()
+	: cullingShader(nullptr), spheresSSBO(0), modelMatricesSSBO(0), drawIndicesSSBO(0), drawCommandsBuffer(0), visibleMatricesBuffer(0),
+	  readbackBuffers(), readbackFences(), nextReadback(0), entityCount(0), visibleCount(0)
+{
+}
+
+void GPUCuller::setup(const std::vector<BasicModel*>& entityModels)
+{
+	std::unordered_map<BasicModel*, uint32_t> drawIndexOf;
+	std::vector<uint32_t> drawIndices;
+
+	entityCount = uint32_t(entityModels.size());
+
+	cullingShader = new ShaderProgram("sources/shaders/12_cull_entities_cs.glsl");
+
+	// One draw command per model, each one owning a range of the visible matrices large enough to hold all its entities.
+	for (BasicModel* model : entityModels)
+	{
+		std::unordered_map<BasicModel*, uint32_t>::iterator it = drawIndexOf.find(model);
+
+		if (it == drawIndexOf.end())
+		{
+			it = drawIndexOf.insert({ model, uint32_t(drawCommands.size()) }).first;
+
+			models.push_back(model);
+			drawCommands.push_back({ model->getIndexCount(), 0, 0, 0, 0 });
+		}
+
+		drawIndices.push_back(it->second);
+
+		drawCommands[it->second].baseInstance += 1; // Counting the entities of every model first.
+	}
+
+	uint32_t baseInstance = 0;
+
+	for (DrawElementsIndirectCommand& command : drawCommands)
+	{
+		uint32_t modelEntities = command.baseInstance;
+
+		command.baseInstance = baseInstance;
+
+		baseInstance += modelEntities;
+	}
+
+	glGenBuffers(1, &spheresSSBO);
+	GLState::bindBuffer(GL_SHADER_STORAGE_BUFFER, spheresSSBO);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, entityCount * sizeof(glm::vec4), nullptr, GL_DYNAMIC_DRAW);
+
+	glGenBuffers(1, &modelMatricesSSBO);
+	GLState::bindBuffer(GL_SHADER_STORAGE_BUFFER, modelMatricesSSBO);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, entityCount * sizeof(glm::mat4), nullptr, GL_DYNAMIC_DRAW);
+
+	glGenBuffers(1, &drawIndicesSSBO);
+	GLState::bindBuffer(GL_SHADER_STORAGE_BUFFER, drawIndicesSSBO);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, entityCount * sizeof(uint32_t), drawIndices.data(), GL_STATIC_DRAW);
+
+	glGenBuffers(1, &visibleMatricesBuffer);
+	GLState::bindBuffer(GL_SHADER_STORAGE_BUFFER, visibleMatricesBuffer);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, entityCount * sizeof(glm::mat4), nullptr, GL_DYNAMIC_COPY);
+
+	GLState::bindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+	glGenBuffers(1, &drawCommandsBuffer);
+	GLState::bindBuffer(GL_DRAW_INDIRECT_BUFFER, drawCommandsBuffer);
+	glBufferData(GL_DRAW_INDIRECT_BUFFER, drawCommands.size() * sizeof(DrawElementsIndirectCommand), drawCommands.data(), GL_DYNAMIC_DRAW);
+	GLState::bindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+
+	glGenBuffers(READBACK_BUFFERS, readbackBuffers);
+
+	for (uint32_t i = 0; i < READBACK_BUFFERS; i++)
+	{
+		GLState::bindBuffer(GL_COPY_WRITE_BUFFER, readbackBuffers[i]);
+		glBufferData(GL_COPY_WRITE_BUFFER, drawCommands.size() * sizeof(DrawElementsIndirectCommand), nullptr, GL_STREAM_READ);
+	}
+
+	GLState::bindBuffer(GL_COPY_WRITE_BUFFER, 0);
+}
+
+void GPUCuller::clean()
+{
+	if (cullingShader)
+	{
+		cullingShader->clean();
+
+		delete cullingShader;
+
+		cullingShader = nullptr;
+	}
+
+	GLState::deleteBuffers(1, &spheresSSBO);
+	GLState::deleteBuffers(1, &modelMatricesSSBO);
+	GLState::deleteBuffers(1, &drawIndicesSSBO);
+	GLState::deleteBuffers(1, &drawCommandsBuffer);
+	GLState::deleteBuffers(1, &visibleMatricesBuffer);
+	GLState::deleteBuffers(READBACK_BUFFERS, readbackBuffers);
+
+	for (uint32_t i = 0; i < READBACK_BUFFERS; i++)
+	{
+		if (readbackFences[i] != nullptr)
+		{
+			glDeleteSync(readbackFences[i]);
+
+			readbackFences[i] = nullptr;
+		}
+	}
+
+	models.clear();
+	drawCommands.clear();
+
+	nextReadback = 0;
+	entityCount = 0;
+	visibleCount = 0;
+}
+
+void GPUCuller::updateEntities(const SphereBatch& spheres, const std::vector<glm::mat4>& modelMatrices)
+{
+	packedSpheres.resize(entityCount);
+
+	for (uint32_t i = 0; i < entityCount; i++)
+	{
+		packedSpheres[i] = glm::vec4(spheres.centersX[i], spheres.centersY[i], spheres.centersZ[i], spheres.radii[i]);
+	}
+
+	GLState::bindBuffer(GL_SHADER_STORAGE_BUFFER, spheresSSBO);
+	glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, entityCount * sizeof(glm::vec4), packedSpheres.data());
+
+	GLState::bindBuffer(GL_SHADER_STORAGE_BUFFER, modelMatricesSSBO);
+	glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, entityCount * sizeof(glm::mat4), modelMatrices.data());
+
+	GLState::bindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+}
+
+void GPUCuller::cull(const Frustum& frustum)
+{
+	if (entityCount == 0)
+	{
+		return;
+	}
+
+	readVisibleCount();
+
+	glm::vec4 planes[FrustumCuller::NUMBER_OF_PLANES];
+
+	FrustumCuller::getPlanes(frustum, planes);
+
+	// Resetting the instance counters of the commands (their "instanceCount" is zero in the CPU copy).
+	GLState::bindBuffer(GL_DRAW_INDIRECT_BUFFER, drawCommandsBuffer);
+	glBufferSubData(GL_DRAW_INDIRECT_BUFFER, 0, drawCommands.size() * sizeof(DrawElementsIndirectCommand), drawCommands.data());
+	GLState::bindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+
+	cullingShader->bind();
+
+	cullingShader->setUniform4fv(FRUSTUM_PLANES_UNIFORM, planes, FrustumCuller::NUMBER_OF_PLANES);
+
+	cullingShader->setUniform1i(ENTITY_COUNT_UNIFORM, int(entityCount));
+
+	GLState::bindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, spheresSSBO);
+	GLState::bindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, modelMatricesSSBO);
+	GLState::bindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, drawIndicesSSBO);
+	GLState::bindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, drawCommandsBuffer);
+	GLState::bindBufferBase(GL_SHADER_STORAGE_BUFFER, 4, visibleMatricesBuffer);
+
+	glDispatchCompute((entityCount + WORK_GROUP_SIZE - 1) / WORK_GROUP_SIZE, 1, 1);
+
+	// The draws read the commands and the instance attributes written by the compute shader, and the copy below reads the commands.
+	glMemoryBarrier(GL_COMMAND_BARRIER_BIT | GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT | GL_BUFFER_UPDATE_BARRIER_BIT);
+
+	cullingShader->unbind();
+
+	// Keeping a copy of the counters, read once the GPU is done with it (skipped when the GPU is too far behind).
+	if (readbackFences[nextReadback] == nullptr)
+	{
+		GLState::bindBuffer(GL_COPY_READ_BUFFER, drawCommandsBuffer);
+		GLState::bindBuffer(GL_COPY_WRITE_BUFFER, readbackBuffers[nextReadback]);
+		glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, drawCommands.size() * sizeof(DrawElementsIndirectCommand));
+		GLState::bindBuffer(GL_COPY_READ_BUFFER, 0);
+		GLState::bindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+		readbackFences[nextReadback] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+		nextReadback = (nextReadback + 1) % READBACK_BUFFERS;
+	}
+}
+
+void GPUCuller::render(ShaderProgram* shader)
+{
+	GLState::bindBuffer(GL_DRAW_INDIRECT_BUFFER, drawCommandsBuffer);
+
+	// Every model has its own vertex array, so each one takes its own command (a shared geometry buffer would allow a single call).
+	for (uint32_t i = 0; i < models.size(); i++)
+	{
+		models[i]->bindInstanceMatricesBuffer(visibleMatricesBuffer);
+		models[i]->renderIndirect(shader, 1, (const void*)(i * sizeof(DrawElementsIndirectCommand)));
+	}
+
+	GLState::bindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+}
+
+void GPUCuller::readVisibleCount()
+{
+	std::vector<DrawElementsIndirectCommand> commands(drawCommands.size());
+
+	// From the oldest copy: polling the fences without waiting, the first one not signaled yet ends the search.
+	for (uint32_t i = 0; i < READBACK_BUFFERS; i++)
+	{
+		uint32_t readback = (nextReadback + i) % READBACK_BUFFERS;
+
+		if (readbackFences[readback] == nullptr)
+		{
+			continue;
+		}
+
+		GLenum status = glClientWaitSync(readbackFences[readback], 0, 0);
+
+		if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED)
+		{
+			break;
+		}
+
+		glDeleteSync(readbackFences[readback]);
+
+		readbackFences[readback] = nullptr;
+
+		GLState::bindBuffer(GL_COPY_READ_BUFFER, readbackBuffers[readback]);
+		glGetBufferSubData(GL_COPY_READ_BUFFER, 0, commands.size() * sizeof(DrawElementsIndirectCommand), commands.data());
+		GLState::bindBuffer(GL_COPY_READ_BUFFER, 0);
+
+		visibleCount = 0;
+
+		for (const DrawElementsIndirectCommand& command : commands)
+		{
+			visibleCount += command.instanceCount;
+		}
+	}
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <unordered_map>
+#include <cstdint>
+
+#include <glad/glad.h>
+
+#include <glm/glm.hpp>
+
+#include "../graphics/shader.h"
+#include "../graphics/basic_model.h"
+#include "frustum_culler.h"
+
+// GPU driven frustum culling.
+//
+// A compute shader tests the entity spheres against the frustum and appends the model matrices of the visible ones into a buffer,
+// counting them directly into the "instanceCount" of one indirect draw command per model. The draws are then issued with
+// "glMultiDrawElementsIndirect", so neither the visibility nor the matrices of the entities go through the CPU.
+// The matrices buffer is read as the instance attribute of the models, offset by the "baseInstance" of every command.
+//
+// Requires OpenGL 4.3 (compute shaders, SSBOs and multi draw indirect).
+//
+class GPUCuller
+{
+public:
+	GPUCuller();
+
+	// One model per entity, in the same order of the spheres and model matrices.
+	void setup(const std::vector<BasicModel*>& entityModels);
+	void clean();
+
+	// Uploads the entities world space spheres and model matrices. Only needed after they change.
+	void updateEntities(const SphereBatch& spheres, const std::vector<glm::mat4>& modelMatrices);
+
+	void cull(const Frustum& frustum);
+	void render(ShaderProgram* shader);
+
+	// Visible entities of a previous cull, read back (a few frames late) only once its fence is signaled, to not stall the pipeline.
+	uint32_t getVisibleCount() const { return visibleCount; }
+	uint32_t getDrawCommandCount() const { return uint32_t(drawCommands.size()); }
+
+private:
+	// Copies of the counters in flight. A cull whose readback buffer is still in use skips its copy.
+	static const uint32_t READBACK_BUFFERS = 3;
+
+	struct DrawElementsIndirectCommand
+	{
+		uint32_t count;
+		uint32_t instanceCount;
+		uint32_t firstIndex;
+		int32_t baseVertex;
+		uint32_t baseInstance;
+	};
+
+	ShaderProgram* cullingShader;
+
+	uint32_t spheresSSBO, modelMatricesSSBO, drawIndicesSSBO, drawCommandsBuffer, visibleMatricesBuffer;
+
+	uint32_t readbackBuffers[READBACK_BUFFERS];
+	GLsync readbackFences[READBACK_BUFFERS]; // Null when the buffer is free.
+	uint32_t nextReadback;
+
+	std::vector<BasicModel*> models;
+	std::vector<DrawElementsIndirectCommand> drawCommands;
+
+	std::vector<glm::vec4> packedSpheres;
+
+	uint32_t entityCount;
+	uint32_t visibleCount;
+
+	void readVisibleCount();
+};
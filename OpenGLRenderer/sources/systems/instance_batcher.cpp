@@ -0,0 +1,94 @@
+#include "instance_batcher.h"
+
+InstanceBatcher::InstanceBatcher()
+	: matricesStream(nullptr), drawCalls(0), instanceCount(0), triangleCount(0)
+{
+}
+
+void InstanceBatcher::setup(uint32_t maxInstances)
+{
+	matricesStream = new StreamBuffer(int(maxInstances * sizeof(glm::mat4)));
+}
+
+void InstanceBatcher::clean()
+{
+	if (matricesStream)
+	{
+		matricesStream->clean();
+
+		delete matricesStream;
+
+		matricesStream = nullptr;
+	}
+
+	batches.clear();
+	batchIndices.clear();
+}
+
+void InstanceBatcher::begin()
+{
+	for (Batch& batch : batches)
+	{
+		batch.modelMatrices.clear();
+	}
+
+	instanceCount = 0;
+}
+
+void InstanceBatcher::add(BasicModel* model, const glm::mat4& modelMatrix, uint32_t lod)
+{
+	std::pair<BasicModel*, uint32_t> key(model, lod);
+	std::map<std::pair<BasicModel*, uint32_t>, uint32_t>::iterator it = batchIndices.find(key);
+
+	if (it == batchIndices.end())
+	{
+		it = batchIndices.insert({ key, uint32_t(batches.size()) }).first;
+
+		batches.push_back({ model, lod, {} });
+	}
+
+	batches[it->second].modelMatrices.push_back(modelMatrix);
+
+	instanceCount += 1;
+}
+
+void InstanceBatcher::render(ShaderProgram* shader)
+{
+	drawCalls = 0;
+	triangleCount = 0;
+
+	if (matricesStream)
+	{
+		matricesStream->beginFrame();
+	}
+
+	for (Batch& batch : batches)
+	{
+		if (batch.modelMatrices.empty())
+		{
+			continue;
+		}
+
+		int instances = int(batch.modelMatrices.size());
+		int size = instances * int(sizeof(glm::mat4));
+		int offset = 0;
+
+		void* destination = matricesStream ? matricesStream->allocate(size, int(sizeof(glm::mat4)), offset) : nullptr;
+
+		if (destination)
+		{
+			std::memcpy(destination, batch.modelMatrices.data(), size);
+
+			batch.model->bindInstanceMatricesBuffer(matricesStream->getID());
+			batch.model->render(shader, instances, batch.lod, uint32_t(offset / int(sizeof(glm::mat4))));
+		}
+		else
+		{
+			batch.model->updateInstanceMatricesVBO(&batch.modelMatrices[0], size);
+			batch.model->render(shader, instances, batch.lod);
+		}
+
+		drawCalls += 1;
+		triangleCount += batch.model->getIndexCount(batch.lod) / 3 * instances;
+	}
+}
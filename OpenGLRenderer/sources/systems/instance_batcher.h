@@ -0,0 +1,54 @@
+#pragma once
+
+#include <map>
+#include <vector>
+#include <utility>
+#include <cstdint>
+#include <cstring>
+
+#include <glm/glm.hpp>
+
+#include "../graphics/shader.h"
+#include "../graphics/basic_model.h"
+#include "../graphics/buffer.h"
+
+// Collects the model matrices of the entities to be drawn in a frame, grouped by model and LOD, and draws every group with a single instanced call.
+// The shader must read the model matrix from the instance attribute (locations 3 to 6) set up by "BasicModel::attachInstanceMatricesVBO".
+//
+// After "setup", the matrices of all batches are written into a stream buffer and every batch draws from its own offset.
+// Without it (or when a frame has more instances than "maxInstances"), each model streams its matrices into its own VBO.
+class InstanceBatcher
+{
+public:
+	InstanceBatcher();
+
+	void setup(uint32_t maxInstances);
+	void clean();
+
+	void begin();
+	void add(BasicModel* model, const glm::mat4& modelMatrix, uint32_t lod = 0);
+	void render(ShaderProgram* shader);
+
+	uint32_t getDrawCalls() const { return drawCalls; }
+	uint32_t getInstanceCount() const { return instanceCount; }
+	uint32_t getTriangleCount() const { return triangleCount; }
+
+private:
+	struct Batch
+	{
+		BasicModel* model;
+		uint32_t lod;
+
+		std::vector<glm::mat4> modelMatrices;
+	};
+
+	// Batches are kept between frames (only their matrices are cleared), so steady scenes don't allocate.
+	std::vector<Batch> batches;
+	std::map<std::pair<BasicModel*, uint32_t>, uint32_t> batchIndices;
+
+	StreamBuffer* matricesStream;
+
+	uint32_t drawCalls;
+	uint32_t instanceCount;
+	uint32_t triangleCount;
+};
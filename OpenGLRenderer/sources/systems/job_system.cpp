@@ -0,0 +1,169 @@
+#include "job_system.h"
+
+std::vector<std::thread> JobSystem::workers;
+std::deque<JobSystem::Job> JobSystem::jobs;
+
+std::mutex JobSystem::mutex;
+std::condition_variable JobSystem::jobQueued;
+std::condition_variable JobSystem::jobFinished;
+
+bool JobSystem::running = false;
+
+uint32_t JobSystem::getDefaultWorkerCount()
+{
+	uint32_t cores = std::thread::hardware_concurrency(); // May be 0 when unknown.
+
+	return cores > 1 ? cores - 1 : 0;
+}
+
+void JobSystem::setup(uint32_t workerCount)
+{
+	if (running)
+	{
+		std::cout << "[WARNING] JOB SYSTEM: Already running with " << workers.size() << " workers." << std::endl;
+
+		return;
+	}
+
+	running = true;
+
+	for (uint32_t i = 0; i < workerCount; i++)
+	{
+		workers.push_back(std::thread(workerLoop));
+	}
+
+	std::cout << "[LOG] JOB SYSTEM: " << workerCount << " worker threads." << std::endl;
+}
+
+void JobSystem::clean()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+
+		running = false;
+	}
+
+	jobQueued.notify_all();
+
+	for (std::thread& worker : workers)
+	{
+		worker.join();
+	}
+
+	workers.clear();
+	jobs.clear();
+}
+
+void JobSystem::dispatch(uint32_t count, uint32_t batchSize, JobFunction function, void* data, Counter& counter)
+{
+	batchSize = std::max(batchSize, 1u);
+
+	uint32_t batchCount = (count + batchSize - 1) / batchSize;
+
+	if (batchCount == 0)
+	{
+		return;
+	}
+
+	if (workers.empty())
+	{
+		function(0, count, data);
+
+		return;
+	}
+
+	counter.pending += batchCount;
+
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+
+		for (uint32_t begin = 0; begin < count; begin += batchSize)
+		{
+			jobs.push_back({ function, data, begin, std::min(begin + batchSize, count), &counter });
+		}
+	}
+
+	jobQueued.notify_all();
+}
+
+void JobSystem::wait(Counter& counter)
+{
+	std::unique_lock<std::mutex> lock(mutex);
+
+	while (counter.pending > 0)
+	{
+		// Helping the workers instead of sleeping (the jobs may belong to another counter).
+		if (!jobs.empty())
+		{
+			Job job = jobs.front();
+			jobs.pop_front();
+
+			lock.unlock();
+			runJob(job);
+			lock.lock();
+		}
+		else
+		{
+			jobFinished.wait(lock, [&counter]() { return counter.pending == 0 || !jobs.empty(); });
+		}
+	}
+}
+
+void JobSystem::parallelFor(uint32_t count, uint32_t batchSize, JobFunction function, void* data)
+{
+	if (count <= batchSize || workers.empty())
+	{
+		if (count > 0)
+		{
+			function(0, count, data);
+		}
+
+		return;
+	}
+
+	Counter counter;
+
+	dispatch(count, batchSize, function, data, counter);
+	wait(counter);
+}
+
+void JobSystem::workerLoop()
+{
+	PROFILE_THREAD_NAME("Worker");
+
+	std::unique_lock<std::mutex> lock(mutex);
+
+	while (true)
+	{
+		jobQueued.wait(lock, []() { return !running || !jobs.empty(); });
+
+		if (!running)
+		{
+			return;
+		}
+
+		Job job = jobs.front();
+		jobs.pop_front();
+
+		lock.unlock();
+		runJob(job);
+		lock.lock();
+	}
+}
+
+void JobSystem::runJob(const Job& job)
+{
+	{
+		PROFILE_ZONE("Job");
+
+		job.function(job.begin, job.end, job.data);
+	}
+
+	if (--job.counter->pending == 0)
+	{
+		// Notified under the lock, so a thread checking the counter in "wait" can't miss it.
+		std::lock_guard<std::mutex> lock(mutex);
+
+		jobFinished.notify_all();
+	}
+}
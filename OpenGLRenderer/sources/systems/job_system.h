@@ -0,0 +1,70 @@
+#pragma once
+
+#include <deque>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <cstdint>
+#include <algorithm>
+#include <iostream>
+
+#include "../utils/profiler.h"
+
+// Pool of worker threads for the CPU side of a frame (culling, LOD selection, instance packing, animation sampling...).
+//
+// Work is split into batches of "[begin, end)" items, which are run by the workers and by the thread waiting for them.
+// Jobs must not issue GL calls: they only fill plain data (draw lists) that the GL thread submits afterwards.
+//
+// Without "setup" (or with no workers) every job runs on the calling thread, so the results are the same either way.
+//
+class JobSystem
+{
+public:
+	typedef void (*JobFunction)(uint32_t begin, uint32_t end, void* data);
+
+	// Batches of a dispatch still to be finished.
+	struct Counter
+	{
+		std::atomic<uint32_t> pending{ 0 };
+	};
+
+	// One worker per core, except the one of the GL thread.
+	static uint32_t getDefaultWorkerCount();
+
+	static void setup(uint32_t workerCount = getDefaultWorkerCount());
+	static void clean();
+
+	// Queues "function" over "count" items, "batchSize" items per job. Returns right away.
+	static void dispatch(uint32_t count, uint32_t batchSize, JobFunction function, void* data, Counter& counter);
+
+	// Runs queued jobs until every batch of the counter is finished.
+	static void wait(Counter& counter);
+
+	// Dispatch and wait. A single batch runs inline, without touching the queue.
+	static void parallelFor(uint32_t count, uint32_t batchSize, JobFunction function, void* data);
+
+	static uint32_t getWorkerCount() { return uint32_t(workers.size()); }
+
+private:
+	struct Job
+	{
+		JobFunction function;
+		void* data;
+
+		uint32_t begin, end;
+		Counter* counter;
+	};
+
+	static std::vector<std::thread> workers;
+	static std::deque<Job> jobs;
+
+	static std::mutex mutex;
+	static std::condition_variable jobQueued, jobFinished;
+
+	static bool running;
+
+	static void workerLoop();
+	static void runJob(const Job& job);
+};
@@ -0,0 +1,47 @@
+#include "lod_selector.h"
+
+LodSelector::LodSelector(float baseScreenSize, float hysteresis)
+	: baseScreenSize(baseScreenSize), hysteresis(hysteresis), cameraPosition(0.0f), tanHalfFov(1.0f)
+{
+}
+
+void LodSelector::setCamera(const glm::vec3& position, float fov)
+{
+	cameraPosition = position;
+	tanHalfFov = std::tan(glm::radians(fov) * 0.5f);
+}
+
+float LodSelector::computeScreenSize(const glm::vec3& center, float radius) const
+{
+	float distance = glm::length(center - cameraPosition);
+
+	if (distance <= radius)
+	{
+		return std::numeric_limits<float>::max(); // Camera inside the sphere.
+	}
+
+	return radius / (distance * tanHalfFov);
+}
+
+uint32_t LodSelector::select(float screenSize, uint32_t currentLod, uint32_t lodCount) const
+{
+	if (lodCount == 0)
+	{
+		return 0;
+	}
+
+	uint32_t lod = std::min(currentLod, lodCount - 1);
+
+	// Moving to a coarser LOD only when the size is clearly below the threshold, and to a finer one only when it is clearly above.
+	while (lod + 1 < lodCount && screenSize < getThreshold(lod) * (1.0f - hysteresis))
+	{
+		lod += 1;
+	}
+
+	while (lod > 0 && screenSize > getThreshold(lod - 1) * (1.0f + hysteresis))
+	{
+		lod -= 1;
+	}
+
+	return lod;
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cmath>
+#include <algorithm>
+#include <limits>
+
+#include <glm/glm.hpp>
+
+// Picks a level of detail by the projected size of the bounding sphere (its radius over the half height of the screen).
+//
+// The LOD "i + 1" is used below "baseScreenSize / 2^i", so every coarser LOD (with about half of the triangles) covers
+// half of the screen size of the previous one. A band of "hysteresis" around each threshold keeps the current LOD when
+// the size oscillates near a threshold, so entities don't pop back and forth between two LODs.
+//
+class LodSelector
+{
+public:
+	LodSelector(float baseScreenSize = 0.25f, float hysteresis = 0.15f);
+
+	void setBaseScreenSize(float newBaseScreenSize) { baseScreenSize = newBaseScreenSize; }
+	void setHysteresis(float newHysteresis) { hysteresis = newHysteresis; }
+
+	float getBaseScreenSize() const { return baseScreenSize; }
+	float getHysteresis() const { return hysteresis; }
+
+	// Call once per frame, before "select".
+	void setCamera(const glm::vec3& position, float fov);
+
+	float computeScreenSize(const glm::vec3& center, float radius) const;
+
+	// New LOD of an entity drawn with "currentLod" in the last frame.
+	uint32_t select(float screenSize, uint32_t currentLod, uint32_t lodCount) const;
+
+private:
+	float baseScreenSize;
+	float hysteresis;
+
+	glm::vec3 cameraPosition;
+	float tanHalfFov;
+
+	float getThreshold(uint32_t lod) const { return baseScreenSize / float(1u << std::min(lod, 31u)); }
+};
@@ -0,0 +1,439 @@
+#include "occlusion_culler.h"
+
+// In front of the near plane (clip space "z >= -w"), where the projected depth is in [0, 1].
+static bool isInsideNearPlane(const glm::vec4& clip)
+{
+	return clip.z >= -clip.w;
+}
+
+OcclusionCuller::OcclusionCuller(uint32_t width, uint32_t height)
+	: width(0), height(0), tilesX(0), tilesY(0), viewProjectionMatrix(1.0f), rasterizedTriangles(0), visibleCount(0), occludedCount(0)
+{
+	resize(width, height);
+}
+
+void OcclusionCuller::resize(uint32_t newWidth, uint32_t newHeight)
+{
+	// Rounding up to whole tiles, so every tile covers the same number of pixels.
+	tilesX = (newWidth + TILE_SIZE - 1) / TILE_SIZE;
+	tilesY = (newHeight + TILE_SIZE - 1) / TILE_SIZE;
+
+	width = tilesX * TILE_SIZE;
+	height = tilesY * TILE_SIZE;
+
+	depthBuffer.assign(width * height, 1.0f);
+	tileMinDepths.assign(tilesX * tilesY, 1.0f);
+	tileMaxDepths.assign(tilesX * tilesY, 1.0f);
+}
+
+void OcclusionCuller::begin(const glm::mat4& newViewProjectionMatrix)
+{
+	viewProjectionMatrix = newViewProjectionMatrix;
+
+	std::fill(depthBuffer.begin(), depthBuffer.end(), 1.0f);
+
+	rasterizedTriangles = 0;
+	visibleCount = 0;
+	occludedCount = 0;
+}
+
+void OcclusionCuller::rasterizeOccluder(const OccluderMesh& occluder, const glm::mat4& modelMatrix)
+{
+	glm::mat4 mvp = viewProjectionMatrix * modelMatrix;
+
+	std::vector<glm::vec4> clipPositions(occluder.positions.size());
+
+	for (uint32_t i = 0; i < occluder.positions.size(); i++)
+	{
+		clipPositions[i] = mvp * glm::vec4(occluder.positions[i], 1.0f);
+	}
+
+	for (uint32_t i = 0; i + 2 < occluder.indices.size(); i += 3)
+	{
+		const glm::vec4& c0 = clipPositions[occluder.indices[i + 0]];
+		const glm::vec4& c1 = clipPositions[occluder.indices[i + 1]];
+		const glm::vec4& c2 = clipPositions[occluder.indices[i + 2]];
+
+		// Skipping (instead of clipping) triangles crossing the near plane only makes the occluders smaller, which is still conservative.
+		if (!isInsideNearPlane(c0) || !isInsideNearPlane(c1) || !isInsideNearPlane(c2))
+		{
+			continue;
+		}
+
+		glm::vec3 v[3];
+		const glm::vec4* clips[3] = { &c0, &c1, &c2 };
+
+		for (uint32_t j = 0; j < 3; j++)
+		{
+			glm::vec3 ndc = glm::vec3(*clips[j]) / clips[j]->w;
+
+			v[j] = glm::vec3((ndc.x * 0.5f + 0.5f) * width, (ndc.y * 0.5f + 0.5f) * height, ndc.z * 0.5f + 0.5f);
+		}
+
+		rasterizeTriangle(v[0], v[1], v[2]);
+	}
+}
+
+void OcclusionCuller::finish()
+{
+	for (uint32_t ty = 0; ty < tilesY; ty++)
+	{
+		for (uint32_t tx = 0; tx < tilesX; tx++)
+		{
+			float minDepth = 1.0f, maxDepth = 0.0f;
+
+			for (uint32_t y = ty * TILE_SIZE; y < (ty + 1) * TILE_SIZE; y++)
+			{
+				const float* row = &depthBuffer[y * width + tx * TILE_SIZE];
+
+				for (uint32_t x = 0; x < TILE_SIZE; x++)
+				{
+					minDepth = std::min(minDepth, row[x]);
+					maxDepth = std::max(maxDepth, row[x]);
+				}
+			}
+
+			tileMinDepths[ty * tilesX + tx] = minDepth;
+			tileMaxDepths[ty * tilesX + tx] = maxDepth;
+		}
+	}
+}
+
+bool OcclusionCuller::isSphereVisible(const glm::vec3& center, float radius)
+{
+	return isBoxVisible(center - glm::vec3(radius), center + glm::vec3(radius));
+}
+
+bool OcclusionCuller::isBoxVisible(const glm::vec3& minAABB, const glm::vec3& maxAABB)
+{
+	float minX = float(width), minY = float(height), maxX = 0.0f, maxY = 0.0f;
+	float nearestDepth = 1.0f;
+
+	// The screen rectangle and nearest depth of the eight projected corners bound the projection of anything inside the box.
+	for (uint32_t i = 0; i < 8; i++)
+	{
+		glm::vec3 corner((i & 1) ? maxAABB.x : minAABB.x, (i & 2) ? maxAABB.y : minAABB.y, (i & 4) ? maxAABB.z : minAABB.z);
+		glm::vec4 clip = viewProjectionMatrix * glm::vec4(corner, 1.0f);
+
+		if (!isInsideNearPlane(clip))
+		{
+			visibleCount += 1; // Crossing the near plane: it can't be behind anything.
+
+			return true;
+		}
+
+		glm::vec3 ndc = glm::vec3(clip) / clip.w;
+
+		float x = (ndc.x * 0.5f + 0.5f) * width;
+		float y = (ndc.y * 0.5f + 0.5f) * height;
+
+		minX = std::min(minX, x);
+		minY = std::min(minY, y);
+		maxX = std::max(maxX, x);
+		maxY = std::max(maxY, y);
+
+		nearestDepth = std::min(nearestDepth, ndc.z * 0.5f + 0.5f);
+	}
+
+	bool visible = isRectVisible(minX, minY, maxX, maxY, nearestDepth);
+
+	if (visible)
+	{
+		visibleCount += 1;
+	}
+	else
+	{
+		occludedCount += 1;
+	}
+
+	return visible;
+}
+
+OccluderMesh OcclusionCuller::createOccluder(const std::vector<glm::vec3>& positions, const std::vector<uint32_t>& indices, uint32_t gridResolution)
+{
+	OccluderMesh occluder;
+
+	if (positions.empty() || gridResolution == 0)
+	{
+		return occluder;
+	}
+
+	glm::vec3 minAABB = positions[0], maxAABB = positions[0];
+
+	for (const glm::vec3& position : positions)
+	{
+		minAABB = glm::min(minAABB, position);
+		maxAABB = glm::max(maxAABB, position);
+	}
+
+	// Cubic cells, so a cell facing mostly along an axis has a slope of at most 1 cell per cell along it.
+	glm::vec3 cellScale = glm::vec3(float(gridResolution) / std::max(glm::compMax(maxAABB - minAABB), 1e-6f));
+
+	std::unordered_map<uint32_t, uint32_t> cellIndices;
+	std::vector<glm::ivec3> cells;
+	std::vector<std::vector<uint32_t>> cellMembers; // Original vertices of every cell.
+	std::vector<uint32_t> remap(positions.size());
+
+	for (uint32_t i = 0; i < positions.size(); i++)
+	{
+		glm::uvec3 cell = glm::min(glm::uvec3((positions[i] - minAABB) * cellScale), glm::uvec3(gridResolution - 1));
+		uint32_t key = (cell.z * gridResolution + cell.y) * gridResolution + cell.x;
+
+		std::unordered_map<uint32_t, uint32_t>::iterator it = cellIndices.find(key);
+
+		if (it == cellIndices.end())
+		{
+			it = cellIndices.insert({ key, uint32_t(cells.size()) }).first;
+
+			cells.push_back(glm::ivec3(cell));
+			cellMembers.push_back({});
+		}
+
+		cellMembers[it->second].push_back(i);
+		remap[i] = it->second;
+	}
+
+	// Outward normal of every cell (area weighted, counter-clockwise front faces).
+	std::vector<glm::vec3> cellNormals(cells.size(), glm::vec3(0.0f));
+
+	for (uint32_t i = 0; i + 2 < indices.size(); i += 3)
+	{
+		const glm::vec3& p0 = positions[indices[i + 0]];
+		glm::vec3 normal = glm::cross(positions[indices[i + 1]] - p0, positions[indices[i + 2]] - p0);
+
+		for (uint32_t j = 0; j < 3; j++)
+		{
+			cellNormals[remap[indices[i + j]]] += normal;
+		}
+	}
+
+	// Averaging the vertices of a cell would put the simplified surface in front of the original one wherever it is concave
+	// (e.g. bridging a valley), hiding objects that are visible. Instead every cell is treated as a piece of a height field
+	// along the dominant axis of its normal: the cell vertex keeps the average position on the other two axes, but its height
+	// is the lowest of the vertices in the 3x3 columns around it (within the reach of a slope of 1, and not on the back side).
+	// A simplified triangle only joins cells of neighbouring columns, so its footprint stays inside the columns of each of its
+	// vertices, and it is never above the original surface it replaces. Cells where the surface turns towards another axis
+	// (steep or folded parts) are left out: the occluder gets holes there, which is still conservative.
+	std::vector<uint32_t> cellAxes(cells.size()); // Dominant axis * 2 + (1 when facing the negative direction).
+	std::vector<int32_t> cellVertices(cells.size(), -1);
+
+	int32_t resolution = int32_t(gridResolution);
+
+	for (uint32_t i = 0; i < cells.size(); i++)
+	{
+		glm::vec3 normal = glm::abs(cellNormals[i]);
+		uint32_t axis = normal.x >= normal.y && normal.x >= normal.z ? 0 : (normal.y >= normal.z ? 1 : 2);
+
+		cellAxes[i] = axis * 2 + (cellNormals[i][axis] < 0.0f ? 1 : 0);
+	}
+
+	for (uint32_t i = 0; i < cells.size(); i++)
+	{
+		uint32_t axis = cellAxes[i] / 2;
+
+		if (std::abs(cellNormals[i][axis]) < 1e-12f)
+		{
+			continue; // Opposite faces cancel out (thin parts): no side is "behind", the cell is left out.
+		}
+
+		float direction = (cellAxes[i] & 1) ? -1.0f : 1.0f;
+
+		glm::vec3 center(0.0f);
+
+		for (uint32_t member : cellMembers[i])
+		{
+			center += positions[member];
+		}
+
+		center /= float(cellMembers[i].size());
+
+		float height = center[axis] * direction;
+		bool heightField = true;
+
+		glm::ivec3 reach(1);
+		reach[axis] = 3;
+
+		glm::ivec3 minCell = glm::max(cells[i] - reach, glm::ivec3(0)), maxCell = glm::min(cells[i] + reach, glm::ivec3(resolution - 1));
+
+		for (int32_t z = minCell.z; z <= maxCell.z; z++)
+		{
+			for (int32_t y = minCell.y; y <= maxCell.y; y++)
+			{
+				for (int32_t x = minCell.x; x <= maxCell.x; x++)
+				{
+					std::unordered_map<uint32_t, uint32_t>::const_iterator it = cellIndices.find(uint32_t((z * resolution + y) * resolution + x));
+
+					if (it == cellIndices.end() || cellNormals[it->second][axis] * direction < 0.0f)
+					{
+						continue; // Empty, or on the back side.
+					}
+
+					if (cellAxes[it->second] != cellAxes[i])
+					{
+						heightField = false; // The surface folds over: there's no "behind" along a single axis.
+					}
+
+					for (uint32_t member : cellMembers[it->second])
+					{
+						height = std::min(height, positions[member][axis] * direction);
+					}
+				}
+			}
+		}
+
+		if (!heightField)
+		{
+			continue;
+		}
+
+		center[axis] = height * direction;
+
+		cellVertices[i] = int32_t(occluder.positions.size());
+		occluder.positions.push_back(center);
+	}
+
+	for (uint32_t i = 0; i + 2 < indices.size(); i += 3)
+	{
+		uint32_t a = remap[indices[i + 0]], b = remap[indices[i + 1]], c = remap[indices[i + 2]];
+
+		if (a == b || b == c || c == a || cellVertices[a] < 0 || cellVertices[b] < 0 || cellVertices[c] < 0)
+		{
+			continue;
+		}
+
+		// Joining cells of the same height field and of the same or neighbouring columns only (any distance along the height axis).
+		if (cellAxes[a] != cellAxes[b] || cellAxes[a] != cellAxes[c])
+		{
+			continue;
+		}
+
+		glm::ivec3 ab = glm::abs(cells[a] - cells[b]), bc = glm::abs(cells[b] - cells[c]), ca = glm::abs(cells[c] - cells[a]);
+		glm::ivec3 distance = glm::max(glm::max(ab, bc), ca);
+
+		distance[cellAxes[a] / 2] = 0;
+
+		if (glm::compMax(distance) > 1)
+		{
+			continue;
+		}
+
+		occluder.indices.push_back(uint32_t(cellVertices[a]));
+		occluder.indices.push_back(uint32_t(cellVertices[b]));
+		occluder.indices.push_back(uint32_t(cellVertices[c]));
+	}
+
+	return occluder;
+}
+
+void OcclusionCuller::rasterizeTriangle(const glm::vec3& v0, const glm::vec3& v1, const glm::vec3& v2)
+{
+	// Twice the signed area. Occluders are rasterized from both sides, so the winding is just normalized.
+	float area = (v1.x - v0.x) * (v2.y - v0.y) - (v1.y - v0.y) * (v2.x - v0.x);
+
+	if (std::abs(area) < 1e-8f)
+	{
+		return;
+	}
+
+	const glm::vec3& a = v0;
+	const glm::vec3& b = area > 0.0f ? v1 : v2;
+	const glm::vec3& c = area > 0.0f ? v2 : v1;
+
+	area = std::abs(area);
+
+	int minX = std::max(0, int(std::floor(std::min(std::min(a.x, b.x), c.x))));
+	int minY = std::max(0, int(std::floor(std::min(std::min(a.y, b.y), c.y))));
+	int maxX = std::min(int(width) - 1, int(std::ceil(std::max(std::max(a.x, b.x), c.x))));
+	int maxY = std::min(int(height) - 1, int(std::ceil(std::max(std::max(a.y, b.y), c.y))));
+
+	if (minX > maxX || minY > maxY)
+	{
+		return;
+	}
+
+	rasterizedTriangles += 1;
+
+	// Edge functions "e(p) = A * p.x + B * p.y + C", positive inside the triangle. They step by "A" along a row.
+	float a0 = b.y - c.y, b0 = c.x - b.x, c0 = b.x * c.y - b.y * c.x;
+	float a1 = c.y - a.y, b1 = a.x - c.x, c1 = c.x * a.y - c.y * a.x;
+	float a2 = a.y - b.y, b2 = b.x - a.x, c2 = a.x * b.y - a.y * b.x;
+
+	// Depth is affine in screen space, so it's also interpolated with a plane equation.
+	float zA = (a0 * a.z + a1 * b.z + a2 * c.z) / area;
+	float zB = (b0 * a.z + b1 * b.z + b2 * c.z) / area;
+	float zC = (c0 * a.z + c1 * b.z + c2 * c.z) / area;
+
+	for (int y = minY; y <= maxY; y++)
+	{
+		float px = float(minX) + 0.5f;
+		float py = float(y) + 0.5f;
+
+		float w0 = a0 * px + b0 * py + c0;
+		float w1 = a1 * px + b1 * py + c1;
+		float w2 = a2 * px + b2 * py + c2;
+		float z = zA * px + zB * py + zC;
+
+		float* row = &depthBuffer[y * width];
+
+		for (int x = minX; x <= maxX; x++)
+		{
+			if (w0 >= 0.0f && w1 >= 0.0f && w2 >= 0.0f)
+			{
+				row[x] = std::min(row[x], z);
+			}
+
+			w0 += a0;
+			w1 += a1;
+			w2 += a2;
+			z += zA;
+		}
+	}
+}
+
+bool OcclusionCuller::isRectVisible(float minX, float minY, float maxX, float maxY, float nearestDepth) const
+{
+	int x0 = std::max(0, int(std::floor(minX)));
+	int y0 = std::max(0, int(std::floor(minY)));
+	int x1 = std::min(int(width) - 1, int(std::ceil(maxX)));
+	int y1 = std::min(int(height) - 1, int(std::ceil(maxY)));
+
+	if (x0 > x1 || y0 > y1)
+	{
+		return true; // Outside the screen, left to the frustum culling.
+	}
+
+	for (int ty = y0 / int(TILE_SIZE); ty <= y1 / int(TILE_SIZE); ty++)
+	{
+		for (int tx = x0 / int(TILE_SIZE); tx <= x1 / int(TILE_SIZE); tx++)
+		{
+			uint32_t tile = ty * tilesX + tx;
+
+			if (nearestDepth > tileMaxDepths[tile])
+			{
+				continue; // Fully behind this tile.
+			}
+
+			if (nearestDepth <= tileMinDepths[tile])
+			{
+				return true; // In front of every pixel of this tile.
+			}
+
+			// Partially covered tile: testing the pixels of the rectangle inside it.
+			int px0 = std::max(x0, tx * int(TILE_SIZE)), px1 = std::min(x1, (tx + 1) * int(TILE_SIZE) - 1);
+			int py0 = std::max(y0, ty * int(TILE_SIZE)), py1 = std::min(y1, (ty + 1) * int(TILE_SIZE) - 1);
+
+			for (int y = py0; y <= py1; y++)
+			{
+				for (int x = px0; x <= px1; x++)
+				{
+					if (nearestDepth <= depthBuffer[y * width + x])
+					{
+						return true;
+					}
+				}
+			}
+		}
+	}
+
+	return false;
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+#include <algorithm>
+
+#include <glm/glm.hpp>
+#include <glm/gtx/component_wise.hpp>
+
+// Simplified triangle mesh rasterized into the occlusion depth buffer.
+struct OccluderMesh
+{
+	std::vector<glm::vec3> positions;
+	std::vector<uint32_t> indices;
+
+	uint32_t getTriangleCount() const { return uint32_t(indices.size() / 3); }
+};
+
+// CPU software occlusion culling.
+//
+// A few large occluders are rasterized (depth only) into a low resolution buffer, then the bounding volumes of the objects are
+// tested against it before their draws are submitted. The buffer is split into tiles holding their nearest and farthest depth,
+// so most tests are solved per tile and only tiles partially covered by an occluder need to be tested per pixel.
+//
+// Depths are stored in [0, 1] (like the OpenGL depth buffer), in contiguous rows padded to whole tiles. The rasterizer and the tests
+// are scalar. No OpenGL context is needed.
+//
+class OcclusionCuller
+{
+public:
+	static const uint32_t TILE_SIZE = 8;
+
+	OcclusionCuller(uint32_t width = 256, uint32_t height = 128);
+
+	void resize(uint32_t width, uint32_t height);
+
+	// Clears the depth buffer and sets the camera of the frame.
+	void begin(const glm::mat4& viewProjectionMatrix);
+	void rasterizeOccluder(const OccluderMesh& occluder, const glm::mat4& modelMatrix);
+
+	// Builds the tiles depth bounds. Must be called after all occluders were rasterized and before the tests.
+	void finish();
+
+	// Conservative tests: false only when the volume is certainly behind the occluders.
+	bool isSphereVisible(const glm::vec3& center, float radius);
+	bool isBoxVisible(const glm::vec3& minAABB, const glm::vec3& maxAABB);
+
+	uint32_t getWidth() const { return width; }
+	uint32_t getHeight() const { return height; }
+	const std::vector<float>& getDepthBuffer() const { return depthBuffer; }
+
+	uint32_t getTilesX() const { return tilesX; }
+	uint32_t getTilesY() const { return tilesY; }
+	const std::vector<float>& getTileMinDepths() const { return tileMinDepths; }
+	const std::vector<float>& getTileMaxDepths() const { return tileMaxDepths; }
+
+	uint32_t getRasterizedTriangles() const { return rasterizedTriangles; }
+	uint32_t getVisibleCount() const { return visibleCount; }
+	uint32_t getOccludedCount() const { return occludedCount; }
+
+	// Vertex clustering simplification: vertices falling in the same cell of a "gridResolution"^3 grid are merged and degenerate triangles removed.
+	// Merged vertices are moved behind the original surface (see the .cpp), so the occluder never covers more than the mesh.
+	static OccluderMesh createOccluder(const std::vector<glm::vec3>& positions, const std::vector<uint32_t>& indices, uint32_t gridResolution = 16);
+
+private:
+	uint32_t width, height;
+	uint32_t tilesX, tilesY;
+
+	std::vector<float> depthBuffer;
+	std::vector<float> tileMinDepths, tileMaxDepths;
+
+	glm::mat4 viewProjectionMatrix;
+
+	uint32_t rasterizedTriangles;
+	uint32_t visibleCount, occludedCount;
+
+	void rasterizeTriangle(const glm::vec3& v0, const glm::vec3& v1, const glm::vec3& v2);
+	bool isRectVisible(float minX, float minY, float maxX, float maxY, float nearestDepth) const;
+};
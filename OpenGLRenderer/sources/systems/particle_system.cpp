@@ -1,7 +1,10 @@
 #include "particle_system.h"
 
+// Names of the uniforms set every frame, hashed by the compiler.
+static constexpr UniformName BUILLBOARDING_UNIFORM("uBuillboarding");
+
 ParticleSystem::ParticleSystem()
-	: vao(nullptr), vbo(nullptr), ibo(nullptr), instancesVBO(nullptr), particleRenderShader(nullptr)
+	: vao(nullptr), vbo(nullptr), ibo(nullptr), instancesStream(nullptr), particleRenderShader(nullptr)
 {
 }
 
@@ -24,7 +27,7 @@ void ParticleSystem::setup(uint32_t poolSize, const char* vsFilepath, const char
 	vao = new VAO();
 	vbo = new VBO(vertices, sizeof(vertices));
 	ibo = new IBO(indices, sizeof(indices));
-	instancesVBO = new VBO(NULL, 9 * poolSize * sizeof(float), GL_STREAM_DRAW);
+	instancesStream = new StreamBuffer(int(INSTANCE_SIZE * poolSize));
 
 	vao->bind();
 	vbo->bind();
@@ -32,20 +35,18 @@ void ParticleSystem::setup(uint32_t poolSize, const char* vsFilepath, const char
 
 	vao->setVertexAttribute(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)(0));
 
-	instancesVBO->bind();
+	instancesStream->bind();
 
-	vao->setVertexAttribute(1, 3, GL_FLOAT, GL_FALSE, 9 * sizeof(float), (void*)(0), 1);
-	vao->setVertexAttribute(2, 2, GL_FLOAT, GL_FALSE, 9 * sizeof(float), (void*)(3 * sizeof(float)), 1);
-	vao->setVertexAttribute(3, 4, GL_FLOAT, GL_FALSE, 9 * sizeof(float), (void*)(5 * sizeof(float)), 1);
+	vao->setVertexAttribute(1, 3, GL_FLOAT, GL_FALSE, INSTANCE_SIZE, (void*)(0), 1);
+	vao->setVertexAttribute(2, 2, GL_FLOAT, GL_FALSE, INSTANCE_SIZE, (void*)(3 * sizeof(float)), 1);
+	vao->setVertexAttribute(3, 4, GL_FLOAT, GL_FALSE, INSTANCE_SIZE, (void*)(5 * sizeof(float)), 1);
 
 	vao->unbind(); // Unbind VAO before another buffer.
 	vbo->unbind();
 	ibo->unbind();
-	instancesVBO->unbind();
+	instancesStream->unbind();
 
 	particleRenderShader = new ShaderProgram(vsFilepath, fsFilepath);
-
-	instancesBuffer.resize(9 * poolSize);
 }
 
 void ParticleSystem::clean()
@@ -53,23 +54,23 @@ void ParticleSystem::clean()
 	particlePool.clear();
 	poolIndex = -1;
 
-	instancesBuffer.clear();
-
 	vao->clean();
 	vbo->clean();
 	ibo->clean();
-	instancesVBO->clean();
+	instancesStream->clean();
 	particleRenderShader->clean();
 
 	delete vao;
 	delete vbo;
 	delete ibo;
-	delete instancesVBO;
+	delete instancesStream;
 	delete particleRenderShader;
 }
 
 void ParticleSystem::update(float deltaTime)
 {
+	PROFILE_ZONE("ParticleSystem::update");
+
 	for (Particle& particle : particlePool)
 	{
 		if (particle.lifeRemaining <= 0.0f)
@@ -86,72 +87,64 @@ void ParticleSystem::update(float deltaTime)
 	}
 }
 
-void ParticleSystem::render(const Camera& camera, float deltaTime)
+void ParticleSystem::prepare(const Camera& camera)
 {
-	bool hasNoActiveParticles = true;
-	int activeParticles = 0;
+	PROFILE_ZONE("ParticleSystem::prepare");
 
-	for (Particle& particle : particlePool)
-	{
-		if (particle.lifeRemaining <= 0.0f)
-		{
-			continue;
-		}
+	drawList.cameraPosition = camera.getPosition();
 
-		particle.cameraDistance = glm::length(particle.position - camera.getPosition());
+	JobSystem::parallelFor(uint32_t(particlePool.size()), BATCH_SIZE, computeCameraDistances, this);
 
-		hasNoActiveParticles = false;
-	}
+	// Dead particles have a negative distance, so the alive ones end up first.
+	sortPool();
+
+	drawList.instanceCount = 0;
 
-	if (hasNoActiveParticles)
+	while (drawList.instanceCount < particlePool.size() && particlePool[drawList.instanceCount].lifeRemaining > 0.0f)
 	{
-		return;
+		drawList.instanceCount += 1;
 	}
 
-	sortPool();
-
-	for (Particle& particle : particlePool)
-	{
-		if (particle.lifeRemaining <= 0.0f)
-		{
-			continue;
-		}
+}
 
-		float lifeFactor = particle.lifeRemaining / particle.lifeTime;
-		float scale = glm::lerp(particle.finalSize, particle.initialSize, lifeFactor);
-		glm::vec4 color = glm::lerp(particle.finalColor, particle.initialColor, lifeFactor);
+void ParticleSystem::submit()
+{
+	int instancesOffset = 0;
 
-		instancesBuffer[9 * activeParticles + 0] = particle.position.x;
-		instancesBuffer[9 * activeParticles + 1] = particle.position.y;
-		instancesBuffer[9 * activeParticles + 2] = particle.position.z;
+	instancesStream->beginFrame();
 
-		instancesBuffer[9 * activeParticles + 3] = particle.rotation;
-		instancesBuffer[9 * activeParticles + 4] = scale;
+	if (drawList.instanceCount == 0)
+	{
+		return;
+	}
 
-		instancesBuffer[9 * activeParticles + 5] = color.r;
-		instancesBuffer[9 * activeParticles + 6] = color.g;
-		instancesBuffer[9 * activeParticles + 7] = color.b;
-		instancesBuffer[9 * activeParticles + 8] = color.a;
+	// The workers write straight into the mapped region of this frame, which needs no GL calls.
+	drawList.instances = (float*)instancesStream->allocate(drawList.instanceCount * INSTANCE_SIZE, INSTANCE_SIZE, instancesOffset);
 
-		activeParticles += 1;
+	if (!drawList.instances)
+	{
+		return;
 	}
 
-	instancesVBO->update(&instancesBuffer[0], 9 * activeParticles * sizeof(float));
+	JobSystem::parallelFor(drawList.instanceCount, BATCH_SIZE, packInstances, this);
 
 	vao->bind();
 	particleRenderShader->bind();
 
-	particleRenderShader->setUniformMatrix4fv("uProjectionMatrix", camera.getProjectionMatrix());
-	particleRenderShader->setUniformMatrix4fv("uViewMatrix", camera.getViewMatrix());
-	particleRenderShader->setUniform3f("uCameraPos", camera.getPosition());
-	particleRenderShader->setUniform1i("uBuillboarding", 1);
+	particleRenderShader->setUniform1i(BUILLBOARDING_UNIFORM, 1);
 
-	glDrawElementsInstanced(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0, activeParticles);
+	glDrawElementsInstancedBaseInstance(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0, drawList.instanceCount, instancesOffset / INSTANCE_SIZE);
 
 	particleRenderShader->unbind();
 	vao->unbind();
 }
 
+void ParticleSystem::render(const Camera& camera, float deltaTime)
+{
+	prepare(camera);
+	submit();
+}
+
 void ParticleSystem::emitParticle(const ParticleProps& particleProps)
 {
 	updatePoolIndex();
@@ -201,5 +194,46 @@ void ParticleSystem::updatePoolIndex()
 
 void ParticleSystem::sortPool()
 {
+	PROFILE_ZONE("ParticleSystem::sortPool");
+
 	std::sort(particlePool.begin(), particlePool.end());
 }
+
+void ParticleSystem::computeCameraDistances(uint32_t begin, uint32_t end, void* data)
+{
+	ParticleSystem* system = (ParticleSystem*)data;
+
+	for (uint32_t i = begin; i < end; i++)
+	{
+		Particle& particle = system->particlePool[i];
+
+		particle.cameraDistance = particle.lifeRemaining > 0.0f ? glm::length(particle.position - system->drawList.cameraPosition) : -1.0f;
+	}
+}
+
+void ParticleSystem::packInstances(uint32_t begin, uint32_t end, void* data)
+{
+	ParticleSystem* system = (ParticleSystem*)data;
+	float* instances = system->drawList.instances;
+
+	for (uint32_t i = begin; i < end; i++)
+	{
+		const Particle& particle = system->particlePool[i];
+
+		float lifeFactor = particle.lifeRemaining / particle.lifeTime;
+		float scale = glm::lerp(particle.finalSize, particle.initialSize, lifeFactor);
+		glm::vec4 color = glm::lerp(particle.finalColor, particle.initialColor, lifeFactor);
+
+		instances[9 * i + 0] = particle.position.x;
+		instances[9 * i + 1] = particle.position.y;
+		instances[9 * i + 2] = particle.position.z;
+
+		instances[9 * i + 3] = particle.rotation;
+		instances[9 * i + 4] = scale;
+
+		instances[9 * i + 5] = color.r;
+		instances[9 * i + 6] = color.g;
+		instances[9 * i + 7] = color.b;
+		instances[9 * i + 8] = color.a;
+	}
+}
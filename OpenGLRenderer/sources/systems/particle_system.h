@@ -9,6 +9,8 @@
 #include "../graphics/shader.h"
 #include "../graphics/buffer.h"
 #include "../camera.h"
+#include "../systems/job_system.h"
+#include "../utils/profiler.h"
 
 struct ParticleProps
 {
@@ -36,31 +38,57 @@ struct Particle
 	}
 };
 
+// Everything needed to draw the particles of a frame. The sorted count is built by "ParticleSystem::prepare" without GL calls, the
+// instances are packed by "ParticleSystem::submit". The camera matrices come from the "ViewUniforms" block bound by the scene.
+struct ParticleDrawList
+{
+	float* instances = nullptr; // Mapped stream buffer region of the frame, "ParticleSystem::INSTANCE_SIZE" bytes per particle, back to front.
+	uint32_t instanceCount = 0;
+
+	glm::vec3 cameraPosition;
+};
+
 class ParticleSystem
 {
 public:
+	// Position (3), rotation, scale and color (4) of a particle.
+	static const int INSTANCE_SIZE = 9 * sizeof(float);
+
 	ParticleSystem();
 
 	void setup(uint32_t poolSize, const char* vsFilepath, const char* fsFilepath);
 	void clean();
 
 	void update(float deltaTime);
+
+	// Sorts the particles by camera distance and counts the alive ones, without GL calls.
+	void prepare(const Camera& camera);
+
+	// Packs the instances of the last "prepare" in worker threads, straight into the mapped stream buffer, and draws them (GL thread).
+	void submit();
+
 	void render(const Camera& camera, float deltaTime);
 
 	void emitParticle(const ParticleProps& particleProps);
 
 private:
+	// Particles per job of "prepare" and "submit".
+	static const uint32_t BATCH_SIZE = 256;
+
 	std::vector<Particle> particlePool;
 	int poolIndex = -1;
 
+	ParticleDrawList drawList;
+
 	VAO* vao;
 	VBO* vbo;
 	IBO* ibo;
-	VBO* instancesVBO;
+	StreamBuffer* instancesStream;
 	ShaderProgram* particleRenderShader;
 
-	std::vector<float> instancesBuffer;
-
 	void updatePoolIndex();
 	void sortPool();
+
+	static void computeCameraDistances(uint32_t begin, uint32_t end, void* data);
+	static void packInstances(uint32_t begin, uint32_t end, void* data);
 };
@@ -0,0 +1,517 @@
+#include "render_graph.h"
+
+const uint32_t RenderGraph::BACK_BUFFER;
+
+static const uint32_t NO_TEXTURE = 0xFFFFFFFF;
+
+RenderGraph::RenderGraph()
+	: allocatedBytes(0), requestedBytes(0), framebufferChanges(0), viewportChanges(0)
+{
+}
+
+uint32_t RenderGraph::createTarget(const std::string& name, const RenderTargetDesc& desc)
+{
+	targets.push_back({ name, desc, false, NO_TEXTURE });
+
+	return uint32_t(targets.size()) - 1;
+}
+
+uint32_t RenderGraph::addPass(const std::string& name, ExecuteFunction execute, void* data)
+{
+	passes.push_back({ name, execute, data, {}, {}, 0, 0, 0 });
+
+	return uint32_t(passes.size()) - 1;
+}
+
+void RenderGraph::read(uint32_t pass, uint32_t target)
+{
+	passes[pass].reads.push_back(target);
+}
+
+void RenderGraph::write(uint32_t pass, uint32_t target)
+{
+	passes[pass].writes.push_back(target);
+}
+
+void RenderGraph::markOutput(uint32_t target)
+{
+	targets[target].output = true;
+}
+
+void RenderGraph::compile()
+{
+	deleteGLObjects();
+
+	executionOrder.clear();
+
+	if (!sortPasses(executionOrder))
+	{
+		std::cout << "[ERROR] RENDER GRAPH: The passes have a dependency cycle, running them in declaration order." << std::endl;
+
+		executionOrder.clear();
+
+		for (uint32_t pass = 0; pass < passes.size(); pass++)
+		{
+			executionOrder.push_back(pass);
+		}
+	}
+
+	cullPasses(executionOrder);
+	assignTextures();
+	createFramebuffers();
+
+	std::cout << "[LOG] RENDER GRAPH: " << executionOrder.size() << " of " << passes.size() << " passes, " << targets.size() << " targets in "
+		<< textures.size() << " textures (" << allocatedBytes / 1024 << " KB instead of " << requestedBytes / 1024 << " KB)." << std::endl;
+}
+
+void RenderGraph::execute()
+{
+	int backBufferViewport[4];
+	glGetIntegerv(GL_VIEWPORT, backBufferViewport);
+
+	int viewport[4] = { backBufferViewport[0], backBufferViewport[1], backBufferViewport[2], backBufferViewport[3] };
+	uint32_t framebuffer = 0;
+
+	framebufferChanges = 0;
+	viewportChanges = 0;
+
+	for (uint32_t pass : executionOrder)
+	{
+		const Pass& current = passes[pass];
+
+		if (current.framebuffer != framebuffer)
+		{
+			GLState::bindFramebuffer(GL_FRAMEBUFFER, current.framebuffer);
+
+			framebuffer = current.framebuffer;
+			framebufferChanges += 1;
+		}
+
+		int passViewport[4] = { 0, 0, current.width, current.height };
+
+		if (current.framebuffer == 0)
+		{
+			std::copy(backBufferViewport, backBufferViewport + 4, passViewport);
+		}
+
+		if (!std::equal(passViewport, passViewport + 4, viewport))
+		{
+			glViewport(passViewport[0], passViewport[1], passViewport[2], passViewport[3]);
+
+			std::copy(passViewport, passViewport + 4, viewport);
+			viewportChanges += 1;
+		}
+
+		GPUTimer::begin(current.name.c_str());
+
+		current.execute(*this, current.data);
+
+		GPUTimer::end();
+	}
+
+	// Leaving the context as we found it (passes may have changed the viewport themselves).
+	GLState::bindFramebuffer(GL_FRAMEBUFFER, 0);
+
+	glViewport(backBufferViewport[0], backBufferViewport[1], backBufferViewport[2], backBufferViewport[3]);
+}
+
+void RenderGraph::bindTexture(uint32_t target, int unit) const
+{
+	GLState::activeTexture(GL_TEXTURE0 + unit);
+	GLState::bindTexture(GL_TEXTURE_2D, getTexture(target));
+}
+
+uint32_t RenderGraph::getTexture(uint32_t target) const
+{
+	// Targets of culled passes have no texture.
+	return targets[target].texture != NO_TEXTURE ? textures[targets[target].texture].ID : 0;
+}
+
+void RenderGraph::clean()
+{
+	deleteGLObjects();
+
+	targets.clear();
+	passes.clear();
+	executionOrder.clear();
+}
+
+bool RenderGraph::isDepthFormat(GLenum internalFormat) const
+{
+	switch (internalFormat)
+	{
+	case GL_DEPTH_COMPONENT16:
+	case GL_DEPTH_COMPONENT24:
+	case GL_DEPTH_COMPONENT32:
+	case GL_DEPTH_COMPONENT32F:
+	case GL_DEPTH24_STENCIL8:
+	case GL_DEPTH32F_STENCIL8:
+		return true;
+
+	default:
+		return false;
+	}
+}
+
+size_t RenderGraph::getBytesPerPixel(GLenum internalFormat) const
+{
+	switch (internalFormat)
+	{
+	case GL_R8:
+		return 1;
+
+	case GL_R16F:
+	case GL_DEPTH_COMPONENT16:
+		return 2;
+
+	case GL_RGB16F: // Three channels formats are padded to four by most drivers.
+	case GL_RGBA16F:
+	case GL_RG32F:
+	case GL_DEPTH32F_STENCIL8:
+		return 8;
+
+	case GL_RGB32F:
+	case GL_RGBA32F:
+		return 16;
+
+	default:
+		return 4;
+	}
+}
+
+bool RenderGraph::sortPasses(std::vector<uint32_t>& order) const
+{
+	uint32_t passCount = uint32_t(passes.size());
+
+	std::vector<std::vector<uint32_t>> dependents(passCount);
+	std::vector<uint32_t> dependencyCounts(passCount, 0);
+
+	for (uint32_t pass = 0; pass < passCount; pass++)
+	{
+		for (uint32_t other = 0; other < passCount; other++)
+		{
+			if (other == pass)
+			{
+				continue;
+			}
+
+			bool dependency = false;
+
+			// Readers wait for the writers declared before them (or any writer, when the target is only written later).
+			for (uint32_t target : passes[pass].reads)
+			{
+				bool writes = std::find(passes[other].writes.begin(), passes[other].writes.end(), target) != passes[other].writes.end();
+				bool earlierWriter = false;
+
+				for (uint32_t previous = 0; previous < pass && !earlierWriter; previous++)
+				{
+					earlierWriter = std::find(passes[previous].writes.begin(), passes[previous].writes.end(), target) != passes[previous].writes.end();
+				}
+
+				dependency = dependency || (writes && (other < pass || !earlierWriter));
+			}
+
+			// Writers of the same target keep their declaration order.
+			for (uint32_t target : passes[pass].writes)
+			{
+				bool writes = std::find(passes[other].writes.begin(), passes[other].writes.end(), target) != passes[other].writes.end();
+
+				dependency = dependency || (writes && other < pass);
+			}
+
+			if (dependency)
+			{
+				dependents[other].push_back(pass);
+				dependencyCounts[pass] += 1;
+			}
+		}
+	}
+
+	// Kahn's algorithm, always taking the first ready pass in declaration order.
+	std::vector<bool> done(passCount, false);
+
+	while (order.size() < passCount)
+	{
+		uint32_t next = passCount;
+
+		for (uint32_t pass = 0; pass < passCount && next == passCount; pass++)
+		{
+			if (!done[pass] && dependencyCounts[pass] == 0)
+			{
+				next = pass;
+			}
+		}
+
+		if (next == passCount)
+		{
+			return false;
+		}
+
+		done[next] = true;
+		order.push_back(next);
+
+		for (uint32_t dependent : dependents[next])
+		{
+			dependencyCounts[dependent] -= 1;
+		}
+	}
+
+	return true;
+}
+
+void RenderGraph::cullPasses(std::vector<uint32_t>& order) const
+{
+	std::vector<bool> neededTargets(targets.size(), false);
+	std::vector<bool> livePasses(passes.size(), false);
+
+	for (uint32_t target = 0; target < targets.size(); target++)
+	{
+		neededTargets[target] = targets[target].output;
+	}
+
+	// Walking back from the last pass: a pass is needed when it writes something needed later, and then its reads are needed too.
+	for (std::vector<uint32_t>::const_reverse_iterator it = order.rbegin(); it != order.rend(); it++)
+	{
+		const Pass& pass = passes[*it];
+
+		for (uint32_t target : pass.writes)
+		{
+			if (target == BACK_BUFFER || neededTargets[target])
+			{
+				livePasses[*it] = true;
+			}
+		}
+
+		if (livePasses[*it])
+		{
+			for (uint32_t target : pass.reads)
+			{
+				neededTargets[target] = true;
+			}
+		}
+	}
+
+	order.erase(std::remove_if(order.begin(), order.end(), [&livePasses](uint32_t pass) { return !livePasses[pass]; }), order.end());
+}
+
+void RenderGraph::assignTextures()
+{
+	uint32_t passCount = uint32_t(executionOrder.size());
+
+	// Lifetime of every target, as positions in the execution order.
+	std::vector<uint32_t> firstUses(targets.size(), passCount), lastUses(targets.size(), 0);
+
+	for (uint32_t position = 0; position < passCount; position++)
+	{
+		const Pass& pass = passes[executionOrder[position]];
+
+		for (const std::vector<uint32_t>* uses : { &pass.reads, &pass.writes })
+		{
+			for (uint32_t target : *uses)
+			{
+				if (target != BACK_BUFFER)
+				{
+					firstUses[target] = std::min(firstUses[target], position);
+					lastUses[target] = std::max(lastUses[target], position);
+				}
+			}
+		}
+	}
+
+	std::vector<uint32_t> sortedTargets;
+
+	for (uint32_t target = 0; target < targets.size(); target++)
+	{
+		targets[target].texture = NO_TEXTURE;
+
+		if (firstUses[target] < passCount)
+		{
+			// Outputs are read after the graph, they must survive until its end.
+			lastUses[target] = targets[target].output ? passCount : lastUses[target];
+
+			sortedTargets.push_back(target);
+		}
+	}
+
+	std::stable_sort(sortedTargets.begin(), sortedTargets.end(), [&firstUses](uint32_t a, uint32_t b) { return firstUses[a] < firstUses[b]; });
+
+	// Greedy allocation: a texture is reused once the last pass of its previous target ran.
+	for (uint32_t target : sortedTargets)
+	{
+		Target& current = targets[target];
+
+		requestedBytes += size_t(current.desc.width) * size_t(current.desc.height) * getBytesPerPixel(current.desc.internalFormat);
+
+		for (uint32_t texture = 0; texture < textures.size() && current.texture == NO_TEXTURE; texture++)
+		{
+			if (textures[texture].desc == current.desc && textures[texture].lastUse < firstUses[target])
+			{
+				current.texture = texture;
+			}
+		}
+
+		if (current.texture == NO_TEXTURE)
+		{
+			current.texture = createTexture(current.desc);
+		}
+
+		textures[current.texture].lastUse = lastUses[target];
+	}
+}
+
+void RenderGraph::createFramebuffers()
+{
+	for (uint32_t passIndex : executionOrder)
+	{
+		Pass& pass = passes[passIndex];
+
+		std::vector<uint32_t> colorAttachments;
+		uint32_t depthAttachment = 0;
+		GLenum depthAttachmentPoint = GL_DEPTH_ATTACHMENT;
+
+		pass.framebuffer = 0;
+		pass.width = 0;
+		pass.height = 0;
+
+		if (std::find(pass.writes.begin(), pass.writes.end(), BACK_BUFFER) != pass.writes.end())
+		{
+			if (pass.writes.size() > 1)
+			{
+				std::cout << "[ERROR] RENDER GRAPH: Pass \"" << pass.name << "\" writes the back buffer and other targets, only the back buffer is used." << std::endl;
+			}
+
+			continue;
+		}
+
+		for (uint32_t target : pass.writes)
+		{
+			const RenderTargetDesc& desc = targets[target].desc;
+
+			if (pass.width == 0)
+			{
+				pass.width = desc.width;
+				pass.height = desc.height;
+			}
+			else if (pass.width != desc.width || pass.height != desc.height)
+			{
+				std::cout << "[ERROR] RENDER GRAPH: Targets of pass \"" << pass.name << "\" have different sizes." << std::endl;
+			}
+
+			if (isDepthFormat(desc.internalFormat))
+			{
+				depthAttachment = getTexture(target);
+				depthAttachmentPoint = desc.internalFormat == GL_DEPTH24_STENCIL8 || desc.internalFormat == GL_DEPTH32F_STENCIL8 ? GL_DEPTH_STENCIL_ATTACHMENT : GL_DEPTH_ATTACHMENT;
+			}
+			else
+			{
+				colorAttachments.push_back(getTexture(target));
+			}
+		}
+
+		std::vector<uint32_t> attachments(colorAttachments);
+
+		attachments.push_back(depthAttachment);
+
+		// Passes writing the same textures share their framebuffer.
+		for (const Framebuffer& framebuffer : framebuffers)
+		{
+			if (framebuffer.attachments == attachments)
+			{
+				pass.framebuffer = framebuffer.ID;
+			}
+		}
+
+		if (pass.framebuffer != 0)
+		{
+			continue;
+		}
+
+		Framebuffer framebuffer{ 0, attachments };
+
+		glGenFramebuffers(1, &framebuffer.ID);
+		GLState::bindFramebuffer(GL_FRAMEBUFFER, framebuffer.ID);
+
+		std::vector<GLenum> drawBuffers;
+
+		for (uint32_t i = 0; i < colorAttachments.size(); i++)
+		{
+			glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0 + i, GL_TEXTURE_2D, colorAttachments[i], 0);
+
+			drawBuffers.push_back(GL_COLOR_ATTACHMENT0 + i);
+		}
+
+		if (depthAttachment != 0)
+		{
+			glFramebufferTexture2D(GL_FRAMEBUFFER, depthAttachmentPoint, GL_TEXTURE_2D, depthAttachment, 0);
+		}
+
+		if (drawBuffers.empty())
+		{
+			glDrawBuffer(GL_NONE);
+			glReadBuffer(GL_NONE);
+		}
+		else
+		{
+			glDrawBuffers(int(drawBuffers.size()), drawBuffers.data());
+		}
+
+		if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+		{
+			std::cout << "[ERROR] RENDER GRAPH: Framebuffer of pass \"" << pass.name << "\" is not complete!" << std::endl;
+		}
+
+		GLState::bindFramebuffer(GL_FRAMEBUFFER, 0);
+
+		framebuffers.push_back(framebuffer);
+
+		pass.framebuffer = framebuffer.ID;
+	}
+}
+
+uint32_t RenderGraph::createTexture(const RenderTargetDesc& desc)
+{
+	Texture texture{ 0, desc, 0 };
+
+	glGenTextures(1, &texture.ID);
+	GLState::bindTexture(GL_TEXTURE_2D, texture.ID);
+
+	// Immutable storage: the internal format must be sized (e.g. "GL_RGB8" instead of "GL_RGB").
+	glTexStorage2D(GL_TEXTURE_2D, 1, desc.internalFormat, desc.width, desc.height);
+
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, desc.filter);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, desc.filter);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, desc.clampMode);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, desc.clampMode);
+
+	GLState::bindTexture(GL_TEXTURE_2D, 0);
+
+	textures.push_back(texture);
+
+	allocatedBytes += size_t(desc.width) * size_t(desc.height) * getBytesPerPixel(desc.internalFormat);
+
+	return uint32_t(textures.size()) - 1;
+}
+
+void RenderGraph::deleteGLObjects()
+{
+	for (const Framebuffer& framebuffer : framebuffers)
+	{
+		GLState::deleteFramebuffers(1, &framebuffer.ID);
+	}
+
+	for (const Texture& texture : textures)
+	{
+		GLState::deleteTextures(1, &texture.ID);
+	}
+
+	framebuffers.clear();
+	textures.clear();
+
+	for (Target& target : targets)
+	{
+		target.texture = NO_TEXTURE;
+	}
+
+	allocatedBytes = 0;
+	requestedBytes = 0;
+}
@@ -0,0 +1,143 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <iostream>
+#include <algorithm>
+
+#include <glad/glad.h>
+
+#include "../graphics/gl_state.h"
+#include "../utils/gpu_timer.h"
+
+// Texture a pass renders to (or samples). Depth formats ("GL_DEPTH24_STENCIL8", "GL_DEPTH_COMPONENT*") are attached as depth.
+struct RenderTargetDesc
+{
+	int width = 0, height = 0;
+
+	GLenum internalFormat = GL_RGBA8;
+	GLenum filter = GL_LINEAR;
+	GLenum clampMode = GL_CLAMP_TO_EDGE;
+
+	bool operator==(const RenderTargetDesc& other) const
+	{
+		return width == other.width && height == other.height && internalFormat == other.internalFormat && filter == other.filter && clampMode == other.clampMode;
+	}
+};
+
+// Frame graph of the render passes of a scene.
+//
+// Passes declare the targets they read and write, and "compile" works out the rest:
+//
+//   - Order: a pass runs after the passes writing what it reads (declaration order otherwise).
+//   - Culling: passes whose writes never reach the back buffer (or a target marked as output) are dropped.
+//   - Aliasing: targets are transient, they only live from the first to the last pass using them. Targets with the same
+//     description and disjoint lifetimes share the same texture.
+//   - Framebuffers: one per set of written targets, created once. Passes writing the back buffer use the default one.
+//
+// "execute" binds the framebuffer of each pass and only changes the viewport when the size of its targets changes.
+// Every pass is timed on the GPU under its name (see "GPUTimer").
+// Passes bind the textures they read with "bindTexture" and do their own clears.
+//
+class RenderGraph
+{
+public:
+	typedef void (*ExecuteFunction)(RenderGraph& graph, void* data);
+
+	static const uint32_t BACK_BUFFER = 0xFFFFFFFF;
+
+	RenderGraph();
+
+	uint32_t createTarget(const std::string& name, const RenderTargetDesc& desc);
+	uint32_t addPass(const std::string& name, ExecuteFunction execute, void* data);
+
+	// Color targets are attached in the order they are written.
+	void read(uint32_t pass, uint32_t target);
+	void write(uint32_t pass, uint32_t target);
+
+	// Keeps the target (and the passes writing it) alive until the end of the frame, e.g. to be shown by the GUI.
+	void markOutput(uint32_t target);
+
+	// Must be called after changing the graph, before the next "execute".
+	void compile();
+	void execute();
+
+	void bindTexture(uint32_t target, int unit) const;
+	uint32_t getTexture(uint32_t target) const;
+
+	uint32_t getPassCount() const { return uint32_t(passes.size()); }
+	uint32_t getExecutedPassCount() const { return uint32_t(executionOrder.size()); }
+	uint32_t getTargetCount() const { return uint32_t(targets.size()); }
+	uint32_t getTextureCount() const { return uint32_t(textures.size()); }
+
+	// Memory of the textures created, against one texture per target.
+	size_t getAllocatedBytes() const { return allocatedBytes; }
+	size_t getRequestedBytes() const { return requestedBytes; }
+
+	// Framebuffer and viewport changes of the last "execute".
+	uint32_t getFramebufferChanges() const { return framebufferChanges; }
+	uint32_t getViewportChanges() const { return viewportChanges; }
+
+	// Removes all passes and targets, deleting their GL objects.
+	void clean();
+
+private:
+	struct Target
+	{
+		std::string name;
+		RenderTargetDesc desc;
+
+		bool output;
+		uint32_t texture; // Index in "textures", assigned by "compile".
+	};
+
+	struct Pass
+	{
+		std::string name;
+
+		ExecuteFunction execute;
+		void* data;
+
+		std::vector<uint32_t> reads, writes;
+
+		uint32_t framebuffer; // GL name, 0 for the back buffer.
+		int width, height; // Size of the written targets, 0 for the back buffer.
+	};
+
+	struct Texture
+	{
+		uint32_t ID;
+		RenderTargetDesc desc;
+
+		uint32_t lastUse; // Position in the execution order of the last pass using the texture (during "compile").
+	};
+
+	struct Framebuffer
+	{
+		uint32_t ID;
+		std::vector<uint32_t> attachments; // Textures (GL names), colors first.
+	};
+
+	std::vector<Target> targets;
+	std::vector<Pass> passes;
+
+	std::vector<Texture> textures;
+	std::vector<Framebuffer> framebuffers;
+
+	std::vector<uint32_t> executionOrder;
+
+	size_t allocatedBytes, requestedBytes;
+	uint32_t framebufferChanges, viewportChanges;
+
+	bool isDepthFormat(GLenum internalFormat) const;
+	size_t getBytesPerPixel(GLenum internalFormat) const;
+
+	bool sortPasses(std::vector<uint32_t>& order) const;
+	void cullPasses(std::vector<uint32_t>& order) const;
+	void assignTextures();
+	void createFramebuffers();
+
+	uint32_t createTexture(const RenderTargetDesc& desc);
+	void deleteGLObjects();
+};
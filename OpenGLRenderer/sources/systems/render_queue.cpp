@@ -0,0 +1,167 @@
+#include "render_queue.h"
+
+static const uint32_t PASS_BITS = 4;
+static const uint32_t PROGRAM_BITS = 11;
+static const uint32_t MATERIAL_BITS = 12;
+static const uint32_t VERTEX_ARRAY_BITS = 12;
+static const uint32_t DEPTH_BITS = 24;
+
+RenderQueue::RenderQueue()
+	: cameraPosition(0.0f), cameraDirection(0.0f, 0.0f, -1.0f), zFar(1.0f), packetCount(0), programChanges(0)
+{
+}
+
+void RenderQueue::begin(const Camera& camera)
+{
+	cameraPosition = camera.getPosition();
+	cameraDirection = camera.getDirection();
+	zFar = camera.getProjectionProperties().zFar;
+
+	packets.clear();
+	items.clear();
+}
+
+void RenderQueue::submit(uint64_t key, const RenderPacket& packet)
+{
+	items.push_back({ key, uint32_t(packets.size()) });
+	packets.push_back(packet);
+}
+
+void RenderQueue::submit(uint32_t pass, Layer layer, ShaderProgram* shader, Model* model, const glm::mat4& modelMatrix, uint32_t lod)
+{
+	float depth = computeDepth(glm::vec3(modelMatrix[3]));
+
+	for (Mesh& mesh : model->getMeshes())
+	{
+		uint64_t key = makeKey(pass, layer, shader->getID(), mesh.getMaterialID(), mesh.getVAO(), depth);
+
+		submit(key, { drawMesh, shader, &mesh, modelMatrix, lod });
+	}
+}
+
+void RenderQueue::submit(uint32_t pass, Layer layer, ShaderProgram* shader, BasicModel* model, const glm::mat4& modelMatrix, uint32_t lod)
+{
+	float depth = computeDepth(glm::vec3(modelMatrix[3]));
+	uint64_t key = makeKey(pass, layer, shader->getID(), model->getMaterialID(), model->getVAO(), depth);
+
+	submit(key, { drawBasicModel, shader, model, modelMatrix, lod });
+}
+
+void RenderQueue::execute()
+{
+	sort();
+
+	ShaderProgram* boundShader = nullptr;
+
+	packetCount = uint32_t(items.size());
+	programChanges = 0;
+
+	UniformHandle modelMatrix;
+
+	for (const SortItem& item : items)
+	{
+		const RenderPacket& packet = packets[item.packet];
+
+		if (packet.shader != boundShader)
+		{
+			packet.shader->bind();
+
+			boundShader = packet.shader;
+			programChanges += 1;
+
+			// Packets are sorted by program, so the lookup happens once per program change.
+			modelMatrix = packet.shader->getUniform("uModelMatrix");
+		}
+
+		packet.shader->setUniformMatrix4fv(modelMatrix, packet.modelMatrix);
+
+		packet.draw(packet, packet.shader);
+	}
+
+	if (boundShader)
+	{
+		boundShader->unbind();
+	}
+
+	packets.clear();
+	items.clear();
+}
+
+float RenderQueue::computeDepth(const glm::vec3& position) const
+{
+	return glm::clamp(glm::dot(position - cameraPosition, cameraDirection) / zFar, 0.0f, 1.0f);
+}
+
+uint64_t RenderQueue::makeKey(uint32_t pass, Layer layer, uint32_t program, uint32_t material, uint32_t vertexArray, float depth)
+{
+	uint64_t depthBits = uint64_t(glm::clamp(depth, 0.0f, 1.0f) * float((1u << DEPTH_BITS) - 1));
+	uint64_t stateBits = (uint64_t(program & ((1u << PROGRAM_BITS) - 1)) << (MATERIAL_BITS + VERTEX_ARRAY_BITS))
+		| (uint64_t(material & ((1u << MATERIAL_BITS) - 1)) << VERTEX_ARRAY_BITS)
+		| uint64_t(vertexArray & ((1u << VERTEX_ARRAY_BITS) - 1));
+
+	uint64_t key = uint64_t(pass & ((1u << PASS_BITS) - 1)) << 60;
+
+	if (layer == Layer::OPAQUE_LAYER)
+	{
+		key |= stateBits << DEPTH_BITS | depthBits;
+	}
+	else
+	{
+		uint64_t invertedDepthBits = ((1u << DEPTH_BITS) - 1) - depthBits;
+
+		key |= uint64_t(1) << 59 | invertedDepthBits << (PROGRAM_BITS + MATERIAL_BITS + VERTEX_ARRAY_BITS) | stateBits;
+	}
+
+	return key;
+}
+
+void RenderQueue::sort()
+{
+	// LSD radix sort over the 8 bytes of the keys (stable, so equal keys keep the submission order).
+	// Bytes that are the same in every key (e.g. the pass of a single pass queue) are skipped.
+	uint32_t size = uint32_t(items.size());
+
+	sortBuffer.resize(size);
+
+	for (uint32_t shift = 0; shift < 64; shift += 8)
+	{
+		uint32_t histogram[256] = {};
+
+		for (const SortItem& item : items)
+		{
+			histogram[(item.key >> shift) & 0xFF] += 1;
+		}
+
+		if (size == 0 || histogram[(items[0].key >> shift) & 0xFF] == size)
+		{
+			continue;
+		}
+
+		uint32_t offset = 0;
+
+		for (uint32_t i = 0; i < 256; i++)
+		{
+			uint32_t count = histogram[i];
+
+			histogram[i] = offset;
+			offset += count;
+		}
+
+		for (const SortItem& item : items)
+		{
+			sortBuffer[histogram[(item.key >> shift) & 0xFF]++] = item;
+		}
+
+		items.swap(sortBuffer);
+	}
+}
+
+void RenderQueue::drawMesh(const RenderPacket& packet, ShaderProgram* shader)
+{
+	static_cast<Mesh*>(packet.object)->render(shader, packet.lod);
+}
+
+void RenderQueue::drawBasicModel(const RenderPacket& packet, ShaderProgram* shader)
+{
+	static_cast<BasicModel*>(packet.object)->render(shader, 1, packet.lod);
+}
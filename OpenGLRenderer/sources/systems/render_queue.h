@@ -0,0 +1,89 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+
+#include <glm/glm.hpp>
+
+#include "../camera.h"
+#include "../graphics/shader.h"
+#include "../graphics/basic_model.h"
+#include "../graphics/model.h"
+
+// A single draw, executed by "RenderQueue::execute". The queue binds "shader" (when it differs from the previous packet one)
+// and sets its "uModelMatrix" before calling "draw", which only has to issue the draw of "object".
+struct RenderPacket
+{
+	typedef void (*DrawFunction)(const RenderPacket& packet, ShaderProgram* shader);
+
+	DrawFunction draw;
+	ShaderProgram* shader;
+	void* object;
+
+	glm::mat4 modelMatrix;
+	uint32_t lod;
+};
+
+// Sort keyed render queue.
+//
+// Scenes submit packets with a 64 bits key instead of drawing right away. The keys are radix sorted and the packets are executed
+// in that order, so draws sharing the program, the material and the vertex array run one after another.
+//
+// Key layout, from the most to the least significant bits:
+//   opaque:      pass (4) | layer (1) | program (11) | material (12) | vertex array (12) | depth (24)
+//   transparent: pass (4) | layer (1) | inverted depth (24) | program (11) | material (12) | vertex array (12)
+//
+// Opaque draws are grouped by state and then drawn front-to-back (for early depth rejection). Transparent draws must blend
+// in order, so the depth (back-to-front) wins over the state. Per pass uniforms (camera, lights, etc.) are set by the scene
+// in every program before "execute", they are kept by the program objects.
+//
+class RenderQueue
+{
+public:
+	enum class Layer { OPAQUE_LAYER = 0, TRANSPARENT_LAYER = 1 };
+
+	RenderQueue();
+
+	// Starts a new frame (or pass), the camera is used to compute the depth of the packets.
+	void begin(const Camera& camera);
+
+	void submit(uint64_t key, const RenderPacket& packet);
+
+	// One packet per mesh of the model.
+	void submit(uint32_t pass, Layer layer, ShaderProgram* shader, Model* model, const glm::mat4& modelMatrix, uint32_t lod = 0);
+	void submit(uint32_t pass, Layer layer, ShaderProgram* shader, BasicModel* model, const glm::mat4& modelMatrix, uint32_t lod = 0);
+
+	// Sorts and draws all submitted packets, leaving the queue empty.
+	void execute();
+
+	// Normalized view depth of a point (0 at the camera and 1 at the far plane).
+	float computeDepth(const glm::vec3& position) const;
+
+	static uint64_t makeKey(uint32_t pass, Layer layer, uint32_t program, uint32_t material, uint32_t vertexArray, float depth);
+
+	uint32_t getPacketCount() const { return packetCount; }
+	uint32_t getProgramChanges() const { return programChanges; }
+
+private:
+	struct SortItem
+	{
+		uint64_t key;
+		uint32_t packet;
+	};
+
+	std::vector<RenderPacket> packets;
+	std::vector<SortItem> items, sortBuffer;
+
+	glm::vec3 cameraPosition;
+	glm::vec3 cameraDirection;
+	float zFar;
+
+	uint32_t packetCount;
+	uint32_t programChanges;
+
+	void sort();
+
+	static void drawMesh(const RenderPacket& packet, ShaderProgram* shader);
+	static void drawBasicModel(const RenderPacket& packet, ShaderProgram* shader);
+};
@@ -0,0 +1,156 @@
+#include "transform_hierarchy.h"
+
+TransformHierarchy::TransformHierarchy()
+	: firstDirtyIndex(INVALID_INDEX), updateCounter(1), recomputedCount(0)
+{
+}
+
+uint32_t TransformHierarchy::createNode(uint32_t parent)
+{
+	uint32_t index = uint32_t(parents.size());
+
+	positions.push_back(glm::vec3(0.0f));
+	eulerRotations.push_back(glm::vec3(0.0f));
+	scales.push_back(glm::vec3(1.0f));
+
+	parents.push_back(parent);
+
+	if (parent != INVALID_INDEX)
+	{
+		modelMatrices.push_back(modelMatrices[parent]);
+	}
+	else
+	{
+		modelMatrices.push_back(glm::mat4(1.0f));
+	}
+
+	dirtyFlags.push_back(0);
+	updateStamps.push_back(0);
+
+	markDirty(index);
+
+	return index;
+}
+
+void TransformHierarchy::reserve(uint32_t capacity)
+{
+	positions.reserve(capacity);
+	eulerRotations.reserve(capacity);
+	scales.reserve(capacity);
+
+	parents.reserve(capacity);
+
+	modelMatrices.reserve(capacity);
+
+	dirtyFlags.reserve(capacity);
+	updateStamps.reserve(capacity);
+}
+
+void TransformHierarchy::clear()
+{
+	positions.clear();
+	eulerRotations.clear();
+	scales.clear();
+
+	parents.clear();
+
+	modelMatrices.clear();
+
+	dirtyFlags.clear();
+	updateStamps.clear();
+
+	firstDirtyIndex = INVALID_INDEX;
+	recomputedCount = 0;
+}
+
+void TransformHierarchy::update()
+{
+	uint32_t size = getSize();
+
+	// A new stamp invalidates the "updated" state of the previous pass without touching the arrays.
+	updateCounter += 1;
+	recomputedCount = 0;
+
+	if (firstDirtyIndex == INVALID_INDEX)
+	{
+		return; // Nothing has changed since the last pass.
+	}
+
+	// Parents always come before their children, so their model matrices are already resolved when we reach a child.
+	// Nodes before the first dirty one can't be affected by any change.
+	for (uint32_t index = firstDirtyIndex; index < size; index++)
+	{
+		uint32_t parent = parents[index];
+		bool parentUpdated = parent != INVALID_INDEX && updateStamps[parent] == updateCounter;
+
+		if (!dirtyFlags[index] && !parentUpdated)
+		{
+			continue;
+		}
+
+		glm::mat4 localModelMatrix = computeLocalModelMatrix(positions[index], eulerRotations[index], scales[index]);
+
+		if (parent != INVALID_INDEX)
+		{
+			modelMatrices[index] = modelMatrices[parent] * localModelMatrix;
+		}
+		else
+		{
+			modelMatrices[index] = localModelMatrix;
+		}
+
+		dirtyFlags[index] = 0;
+		updateStamps[index] = updateCounter;
+
+		recomputedCount += 1;
+	}
+
+	firstDirtyIndex = INVALID_INDEX;
+}
+
+void TransformHierarchy::setLocalPosition(uint32_t index, const glm::vec3& newPosition)
+{
+	positions[index] = newPosition;
+
+	markDirty(index);
+}
+
+void TransformHierarchy::setLocalEulerRotation(uint32_t index, const glm::vec3& newEulerRotation)
+{
+	eulerRotations[index] = newEulerRotation;
+
+	markDirty(index);
+}
+
+void TransformHierarchy::setLocalScale(uint32_t index, const glm::vec3& newScale)
+{
+	scales[index] = newScale;
+
+	markDirty(index);
+}
+
+void TransformHierarchy::markDirty(uint32_t index)
+{
+	dirtyFlags[index] = 1;
+
+	firstDirtyIndex = firstDirtyIndex == INVALID_INDEX ? index : std::min(firstDirtyIndex, index);
+}
+
+glm::mat4 TransformHierarchy::computeLocalModelMatrix(const glm::vec3& position, const glm::vec3& eulerRotation, const glm::vec3& scale)
+{
+	// Same result of "translation * (Y * X * Z) * scale", but expanded by hand to avoid three rotation matrices and four 4x4 products per node.
+	const glm::vec3 radians = glm::radians(eulerRotation);
+
+	const float sx = glm::sin(radians.x), cx = glm::cos(radians.x);
+	const float sy = glm::sin(radians.y), cy = glm::cos(radians.y);
+	const float sz = glm::sin(radians.z), cz = glm::cos(radians.z);
+
+	glm::mat4 modelMatrix;
+
+	modelMatrix[0] = glm::vec4(cy * cz + sy * sx * sz, cx * sz, cy * sx * sz - sy * cz, 0.0f) * scale.x;
+	modelMatrix[1] = glm::vec4(sy * sx * cz - cy * sz, cx * cz, sy * sz + cy * sx * cz, 0.0f) * scale.y;
+	modelMatrix[2] = glm::vec4(sy * cx, -sx, cy * cx, 0.0f) * scale.z;
+	modelMatrix[3] = glm::vec4(position, 1.0f);
+
+	return modelMatrix;
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+// Flattened transform hierarchy.
+//
+// Every node lives in contiguous arrays (local TRS data, parent indices and model matrices) instead of being scattered through the heap.
+// A node is always created after its parent, so parents are always stored before their children and the whole hierarchy
+// can be resolved with one linear pass over the arrays, without recursion or pointer chasing.
+//
+// Only nodes that changed (or whose parent was recomputed in the same pass) get their model matrices recomputed.
+// A change in a node marks it as dirty, the update pass propagates it to the subtree and clears it afterwards.
+//
+class TransformHierarchy
+{
+public:
+	static const uint32_t INVALID_INDEX = 0xFFFFFFFF;
+
+	TransformHierarchy();
+
+	uint32_t createNode(uint32_t parent = INVALID_INDEX);
+
+	void reserve(uint32_t capacity);
+	void clear();
+
+	void update();
+
+	void setLocalPosition(uint32_t index, const glm::vec3& newPosition);
+	void setLocalEulerRotation(uint32_t index, const glm::vec3& newEulerRotation);
+	void setLocalScale(uint32_t index, const glm::vec3& newScale);
+
+	const glm::vec3& getLocalPosition(uint32_t index) const { return positions[index]; }
+	const glm::vec3& getLocalEulerRotation(uint32_t index) const { return eulerRotations[index]; }
+	const glm::vec3& getLocalScale(uint32_t index) const { return scales[index]; }
+	const glm::mat4& getModelMatrix(uint32_t index) const { return modelMatrices[index]; }
+	uint32_t getParent(uint32_t index) const { return parents[index]; }
+
+	// Was the node model matrix recomputed by the last update pass?
+	bool wasUpdated(uint32_t index) const { return updateStamps[index] == updateCounter; }
+
+	const std::vector<glm::mat4>& getModelMatrices() const { return modelMatrices; }
+	uint32_t getSize() const { return uint32_t(parents.size()); }
+	uint32_t getRecomputedCount() const { return recomputedCount; }
+
+	static glm::mat4 computeLocalModelMatrix(const glm::vec3& position, const glm::vec3& eulerRotation, const glm::vec3& scale);
+
+private:
+	// Local space information.
+	std::vector<glm::vec3> positions;
+	std::vector<glm::vec3> eulerRotations;
+	std::vector<glm::vec3> scales;
+
+	std::vector<uint32_t> parents;
+
+	// Global space information.
+	std::vector<glm::mat4> modelMatrices;
+
+	// Change tracking.
+	std::vector<uint8_t> dirtyFlags;
+	std::vector<uint32_t> updateStamps;
+
+	uint32_t firstDirtyIndex;
+	uint32_t updateCounter;
+	uint32_t recomputedCount;
+
+	void markDirty(uint32_t index);
+};
@@ -0,0 +1,195 @@
+#include "bounds.h"
+
+// Eigen decomposition of a symmetric 3x3 matrix with cyclic Jacobi rotations. Eigenvectors are returned as columns.
+static void computeSymmetricEigenvectors(glm::mat3 matrix, glm::mat3& eigenvectors)
+{
+	const uint32_t MAX_SWEEPS = 32;
+
+	eigenvectors = glm::mat3(1.0f);
+
+	for (uint32_t sweep = 0; sweep < MAX_SWEEPS; sweep++)
+	{
+		float offDiagonal = matrix[1][0] * matrix[1][0] + matrix[2][0] * matrix[2][0] + matrix[2][1] * matrix[2][1];
+
+		if (offDiagonal < 1e-12f)
+		{
+			break;
+		}
+
+		for (int p = 0; p < 2; p++)
+		{
+			for (int q = p + 1; q < 3; q++)
+			{
+				float apq = matrix[q][p];
+
+				if (std::abs(apq) < 1e-12f)
+				{
+					continue;
+				}
+
+				// Rotation that zeroes the (p, q) entry.
+				float theta = (matrix[q][q] - matrix[p][p]) / (2.0f * apq);
+				float t = (theta >= 0.0f ? 1.0f : -1.0f) / (std::abs(theta) + std::sqrt(theta * theta + 1.0f));
+				float c = 1.0f / std::sqrt(t * t + 1.0f);
+				float s = t * c;
+
+				glm::mat3 rotation(1.0f);
+
+				rotation[p][p] = c;
+				rotation[q][q] = c;
+				rotation[q][p] = s;
+				rotation[p][q] = -s;
+
+				matrix = glm::transpose(rotation) * matrix * rotation;
+				eigenvectors = eigenvectors * rotation;
+			}
+		}
+	}
+}
+
+AABBBounds computeAABBBounds(const std::vector<glm::vec3>& points)
+{
+	AABBBounds bounds;
+
+	if (points.empty())
+	{
+		return bounds;
+	}
+
+	glm::vec3 minAABB = glm::vec3(std::numeric_limits<float>::max());
+	glm::vec3 maxAABB = glm::vec3(std::numeric_limits<float>::lowest());
+
+	for (const glm::vec3& point : points)
+	{
+		minAABB = glm::min(minAABB, point);
+		maxAABB = glm::max(maxAABB, point);
+	}
+
+	bounds.center = (maxAABB + minAABB) * 0.5f;
+	bounds.extents = (maxAABB - minAABB) * 0.5f;
+
+	return bounds;
+}
+
+OBBBounds computeOBBBounds(const std::vector<glm::vec3>& points)
+{
+	OBBBounds bounds;
+
+	if (points.empty())
+	{
+		return bounds;
+	}
+
+	glm::vec3 mean(0.0f);
+
+	for (const glm::vec3& point : points)
+	{
+		mean += point;
+	}
+
+	mean /= float(points.size());
+
+	glm::mat3 covariance(0.0f);
+
+	for (const glm::vec3& point : points)
+	{
+		glm::vec3 d = point - mean;
+
+		covariance += glm::outerProduct(d, d);
+	}
+
+	covariance /= float(points.size());
+
+	glm::mat3 axes;
+
+	computeSymmetricEigenvectors(covariance, axes);
+
+	for (int i = 0; i < 3; i++)
+	{
+		axes[i] = glm::normalize(axes[i]);
+	}
+
+	glm::vec3 minProjection = glm::vec3(std::numeric_limits<float>::max());
+	glm::vec3 maxProjection = glm::vec3(std::numeric_limits<float>::lowest());
+
+	for (const glm::vec3& point : points)
+	{
+		glm::vec3 projection = glm::transpose(axes) * point;
+
+		minProjection = glm::min(minProjection, projection);
+		maxProjection = glm::max(maxProjection, projection);
+	}
+
+	bounds.axes = axes;
+	bounds.center = axes * ((minProjection + maxProjection) * 0.5f);
+	bounds.extents = (maxProjection - minProjection) * 0.5f;
+
+	AABBBounds aabb = computeAABBBounds(points);
+
+	if (aabb.extents.x * aabb.extents.y * aabb.extents.z <= bounds.extents.x * bounds.extents.y * bounds.extents.z)
+	{
+		bounds.axes = glm::mat3(1.0f);
+		bounds.center = aabb.center;
+		bounds.extents = aabb.extents;
+	}
+
+	return bounds;
+}
+
+SphereBounds computeSphereBounds(const std::vector<glm::vec3>& points)
+{
+	SphereBounds bounds;
+
+	if (points.empty())
+	{
+		return bounds;
+	}
+
+	// Starting with the sphere between a point "y" far from an arbitrary point "x" and the point "z" farthest from "y".
+	const glm::vec3& x = points[0];
+	glm::vec3 y = x, z = x;
+	float maxDistance = -1.0f;
+
+	for (const glm::vec3& point : points)
+	{
+		float distance = glm::dot(point - x, point - x);
+
+		if (distance > maxDistance)
+		{
+			maxDistance = distance;
+			y = point;
+		}
+	}
+
+	maxDistance = -1.0f;
+
+	for (const glm::vec3& point : points)
+	{
+		float distance = glm::dot(point - y, point - y);
+
+		if (distance > maxDistance)
+		{
+			maxDistance = distance;
+			z = point;
+		}
+	}
+
+	bounds.center = (y + z) * 0.5f;
+	bounds.radius = glm::length(z - y) * 0.5f;
+
+	// Growing the sphere just enough to enclose every point left outside.
+	for (const glm::vec3& point : points)
+	{
+		float distance = glm::length(point - bounds.center);
+
+		if (distance > bounds.radius)
+		{
+			float newRadius = (bounds.radius + distance) * 0.5f;
+
+			bounds.center += (point - bounds.center) * ((newRadius - bounds.radius) / distance);
+			bounds.radius = newRadius;
+		}
+	}
+
+	return bounds;
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <vector>
+#include <cmath>
+#include <algorithm>
+#include <limits>
+
+#include <glm/glm.hpp>
+
+// Local space bounding volumes of a set of points, computed once (e.g. when a model is loaded).
+
+struct AABBBounds
+{
+	glm::vec3 center = { 0.0f, 0.0f, 0.0f };
+	glm::vec3 extents = { 0.0f, 0.0f, 0.0f }; // Half sizes.
+};
+
+struct OBBBounds
+{
+	glm::vec3 center = { 0.0f, 0.0f, 0.0f };
+	glm::mat3 axes = glm::mat3(1.0f); // Orthonormal axes, one per column.
+	glm::vec3 extents = { 0.0f, 0.0f, 0.0f }; // Half sizes along the axes.
+};
+
+struct SphereBounds
+{
+	glm::vec3 center = { 0.0f, 0.0f, 0.0f };
+	float radius = 0.0f;
+};
+
+AABBBounds computeAABBBounds(const std::vector<glm::vec3>& points);
+
+// Axes from the principal components (eigenvectors of the covariance matrix) of the points.
+// Falls back to the AABB when it is smaller, which happens with shapes that have no dominant direction.
+OBBBounds computeOBBBounds(const std::vector<glm::vec3>& points);
+
+// Ritter's approximation of the minimal bounding sphere (at most ~5% larger than the optimal one).
+SphereBounds computeSphereBounds(const std::vector<glm::vec3>& points);
@@ -0,0 +1,349 @@
+#include "benchmark.h"
+
+// Replica of the recursive, pointer-based entity node (children kept in a list of heap allocated nodes), used as the baseline.
+struct LegacyTransformNode
+{
+	glm::vec3 position = { 0.0f, 0.0f, 0.0f };
+	glm::vec3 eulerRotation = { 0.0f, 0.0f, 0.0f };
+	glm::vec3 scale = { 1.0f, 1.0f, 1.0f };
+
+	glm::mat4 modelMatrix = glm::mat4(1.0f);
+
+	std::list<std::unique_ptr<LegacyTransformNode>> children;
+	LegacyTransformNode* parent = nullptr;
+
+	glm::mat4 getLocalModelMatrix()
+	{
+		const glm::mat4 transformX = glm::rotate(glm::mat4(1.0f), glm::radians(eulerRotation.x), glm::vec3(1.0f, 0.0f, 0.0f));
+		const glm::mat4 transformY = glm::rotate(glm::mat4(1.0f), glm::radians(eulerRotation.y), glm::vec3(0.0f, 1.0f, 0.0f));
+		const glm::mat4 transformZ = glm::rotate(glm::mat4(1.0f), glm::radians(eulerRotation.z), glm::vec3(0.0f, 0.0f, 1.0f));
+
+		// Y * X * Z
+		const glm::mat4 roationMatrix = transformY * transformX * transformZ;
+
+		// translation * rotation * scale (also know as TRS matrix)
+		return glm::translate(glm::mat4(1.0f), position) * roationMatrix * glm::scale(glm::mat4(1.0f), scale);
+	}
+
+	void updateSelfAndChildren()
+	{
+		glm::mat4 localModelMatrix = getLocalModelMatrix();
+
+		modelMatrix = parent ? parent->modelMatrix * localModelMatrix : localModelMatrix;
+
+		for (std::unique_ptr<LegacyTransformNode>& child : children)
+		{
+			child->updateSelfAndChildren();
+		}
+	}
+};
+
+// Replica of the entity before the pool: every entity, children list node and bounding volume is a heap allocation.
+struct LegacyEntity
+{
+	Transform transform;
+
+	std::list<std::unique_ptr<LegacyEntity>> children;
+	LegacyEntity* parent;
+
+	std::unique_ptr<BoundingVolume> boundingVolume;
+
+	LegacyEntity(TransformHierarchy* hierarchy, LegacyEntity* parent, BasicModel* model)
+		: transform(hierarchy, hierarchy->createNode(parent ? parent->transform.getIndex() : TransformHierarchy::INVALID_INDEX)), parent(parent)
+	{
+		boundingVolume = std::make_unique<Sphere>(model);
+	}
+
+	uint32_t countVisible(const Frustum& frustum)
+	{
+		uint32_t visible = boundingVolume->isOnFrustum(frustum, transform) ? 1 : 0;
+
+		for (std::unique_ptr<LegacyEntity>& child : children)
+		{
+			visible += child->countVisible(frustum);
+		}
+
+		return visible;
+	}
+};
+
+static uint32_t countVisible(Entity* entity, const Frustum& frustum)
+{
+	uint32_t visible = entity->boundingVolume->isOnFrustum(frustum, entity->transform) ? 1 : 0;
+
+	for (Entity* child = entity->firstChild; child; child = child->nextSibling)
+	{
+		visible += countVisible(child, frustum);
+	}
+
+	return visible;
+}
+
+static float randomFloat(float min, float max)
+{
+	return min + (max - min) * (static_cast<float>(std::rand()) / static_cast<float>(RAND_MAX));
+}
+
+template<typename F>
+static double measureMilliseconds(uint32_t iterations, F function)
+{
+	std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+
+	for (uint32_t i = 0; i < iterations; i++)
+	{
+		function();
+	}
+
+	std::chrono::duration<double, std::milli> elapsed = std::chrono::high_resolution_clock::now() - start;
+
+	return elapsed.count() / double(iterations);
+}
+
+void benchmarkTransformUpdate()
+{
+	const uint32_t nodeCounts[] = { 1000, 100000, 1000000 };
+	const uint32_t branchingFactor = 4;
+
+	std::cout << "[LOG] BENCHMARK: Transform update (recursive tree vs. flattened hierarchy)." << std::endl;
+
+	for (uint32_t nodeCount : nodeCounts)
+	{
+		std::vector<LegacyTransformNode*> legacyNodes;
+		std::unique_ptr<LegacyTransformNode> legacyRoot = std::make_unique<LegacyTransformNode>();
+		TransformHierarchy hierarchy;
+
+		legacyNodes.reserve(nodeCount);
+		legacyNodes.push_back(legacyRoot.get());
+
+		hierarchy.reserve(nodeCount);
+		hierarchy.createNode();
+
+		std::srand(42);
+
+		// Both structures receive the same tree: node "i" is a child of node "(i - 1) / branchingFactor".
+		for (uint32_t i = 1; i < nodeCount; i++)
+		{
+			uint32_t parent = (i - 1) / branchingFactor;
+
+			glm::vec3 position(randomFloat(-10.0f, 10.0f), randomFloat(-10.0f, 10.0f), randomFloat(-10.0f, 10.0f));
+			glm::vec3 eulerRotation(randomFloat(0.0f, 360.0f), randomFloat(0.0f, 360.0f), randomFloat(0.0f, 360.0f));
+			glm::vec3 scale(randomFloat(0.5f, 1.5f));
+
+			LegacyTransformNode* legacyParent = legacyNodes[parent];
+
+			legacyParent->children.emplace_back(std::make_unique<LegacyTransformNode>());
+
+			LegacyTransformNode* legacyNode = legacyParent->children.back().get();
+
+			legacyNode->parent = legacyParent;
+			legacyNode->position = position;
+			legacyNode->eulerRotation = eulerRotation;
+			legacyNode->scale = scale;
+
+			legacyNodes.push_back(legacyNode);
+
+			uint32_t index = hierarchy.createNode(parent);
+
+			hierarchy.setLocalPosition(index, position);
+			hierarchy.setLocalEulerRotation(index, eulerRotation);
+			hierarchy.setLocalScale(index, scale);
+		}
+
+		uint32_t iterations = std::max(3u, 2000000u / nodeCount);
+		uint32_t movedNodes = std::max(1u, nodeCount / 100);
+
+		hierarchy.update();
+
+		// The recursive update recomputes every node on every call (its dirty flag is never cleared).
+		double legacyTime = measureMilliseconds(iterations, [&]() { legacyRoot->updateSelfAndChildren(); });
+
+		// Moving the root dirties the whole tree, which is the worst case for the incremental update.
+		double fullTime = measureMilliseconds(iterations, [&]() { hierarchy.setLocalPosition(0, hierarchy.getLocalPosition(0)); hierarchy.update(); });
+
+		// Moving 1% of the nodes (and their subtrees).
+		double partialTime = measureMilliseconds(iterations, [&]()
+		{
+			for (uint32_t i = 0; i < movedNodes; i++)
+			{
+				uint32_t index = nodeCount - 1 - i * 97 % nodeCount;
+
+				hierarchy.setLocalPosition(index, hierarchy.getLocalPosition(index));
+			}
+
+			hierarchy.update();
+		});
+
+		uint32_t partialRecomputed = hierarchy.getRecomputedCount();
+
+		// Nothing moved.
+		double staticTime = measureMilliseconds(iterations, [&]() { hierarchy.update(); });
+
+		std::cout << '\t' << "[LOG] BENCHMARK: " << nodeCount << " nodes | recursive: " << legacyTime << " ms | flattened: " << fullTime << " ms (" << legacyTime / fullTime << "x)"
+			<< " | 1% moved: " << partialTime << " ms (" << partialRecomputed << " recomputed) | static: " << staticTime << " ms" << std::endl;
+	}
+}
+
+void benchmarkFrustumCulling()
+{
+	const uint32_t sphereCount = 1000000;
+	const uint32_t iterations = 20;
+
+	std::cout << "[LOG] BENCHMARK: Frustum culling of " << sphereCount << " spheres (per entity vs. batch kernels)." << std::endl;
+
+	ProjectionProperties projProps(16.0f / 9.0f, 60.0f, 0.1f, 500.0f);
+	Camera camera(glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f), projProps);
+	Frustum frustum;
+
+	frustum.generateFacesFromCamera(camera, projProps.aspectRatio, glm::radians(projProps.fov), projProps.zNear, projProps.zFar);
+
+	std::vector<std::unique_ptr<BoundingVolume>> volumes;
+	SphereBatch batch;
+
+	volumes.reserve(sphereCount);
+	batch.resize(sphereCount);
+
+	std::srand(42);
+
+	for (uint32_t i = 0; i < sphereCount; i++)
+	{
+		glm::vec3 center(randomFloat(-500.0f, 500.0f), randomFloat(-500.0f, 500.0f), randomFloat(-500.0f, 500.0f));
+		float radius = randomFloat(0.5f, 5.0f);
+
+		volumes.push_back(std::make_unique<Sphere>(center, radius));
+		batch.set(i, center, radius);
+	}
+
+	std::vector<uint32_t> visibleIndices;
+	visibleIndices.reserve(sphereCount);
+
+	// Baseline: one virtual call per plane per sphere, with the spheres scattered through the heap.
+	uint32_t baselineVisible = 0;
+
+	double baselineTime = measureMilliseconds(iterations, [&]()
+	{
+		visibleIndices.clear();
+
+		for (uint32_t i = 0; i < sphereCount; i++)
+		{
+			if (volumes[i]->isOnFrustum(frustum))
+			{
+				visibleIndices.push_back(i);
+			}
+		}
+
+		baselineVisible = uint32_t(visibleIndices.size());
+	});
+
+	std::cout << '\t' << "[LOG] BENCHMARK: per entity: " << baselineTime << " ms (" << sphereCount / baselineTime / 1000.0 << " M spheres/s, " << baselineVisible << " visible)" << std::endl;
+
+	const FrustumCuller::Mode modes[] = { FrustumCuller::Mode::SCALAR, FrustumCuller::Mode::SSE, FrustumCuller::Mode::AVX };
+	const char* modeNames[] = { "batch scalar", "batch SSE", "batch AVX" };
+
+	for (uint32_t m = 0; m < 3; m++)
+	{
+		if (!FrustumCuller::isModeSupported(modes[m]))
+		{
+			std::cout << '\t' << "[LOG] BENCHMARK: " << modeNames[m] << ": not supported by this CPU." << std::endl;
+
+			continue;
+		}
+
+		double time = measureMilliseconds(iterations, [&]() { FrustumCuller::cull(frustum, batch, visibleIndices, modes[m]); });
+
+		std::cout << '\t' << "[LOG] BENCHMARK: " << modeNames[m] << ": " << time << " ms (" << sphereCount / time / 1000.0 << " M spheres/s, "
+			<< visibleIndices.size() << " visible, " << baselineTime / time << "x, " << JobSystem::getWorkerCount() << " workers)" << std::endl;
+	}
+
+	BoundingVolumeHierarchy bvh;
+
+	double buildTime = measureMilliseconds(1, [&]() { bvh.build(batch); });
+	double refitTime = measureMilliseconds(iterations, [&]() { bvh.refit(batch); });
+	double bvhTime = measureMilliseconds(iterations, [&]() { bvh.cull(frustum, batch, visibleIndices); });
+
+	std::cout << '\t' << "[LOG] BENCHMARK: BVH: " << bvhTime << " ms (" << visibleIndices.size() << " visible, " << bvh.getNodesVisited() << " of " << bvh.getNodes().size()
+		<< " nodes visited, " << baselineTime / bvhTime << "x) | build: " << buildTime << " ms | refit: " << refitTime << " ms" << std::endl;
+}
+
+void benchmarkEntityAllocation(BasicModel* model)
+{
+	const uint32_t entityCount = 100000;
+	const uint32_t branchingFactor = 4;
+	const uint32_t iterations = 10;
+
+	std::cout << "[LOG] BENCHMARK: Allocation of " << entityCount << " entities (heap allocated vs. entity pool)." << std::endl;
+
+	ProjectionProperties projProps(16.0f / 9.0f, 60.0f, 0.1f, 500.0f);
+	Camera camera(glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f), projProps);
+	Frustum frustum;
+
+	frustum.generateFacesFromCamera(camera, projProps.aspectRatio, glm::radians(projProps.fov), projProps.zNear, projProps.zFar);
+
+	// Both versions receive the same tree: entity "i" is a child of entity "(i - 1) / branchingFactor".
+	TransformHierarchy legacyHierarchy;
+	std::unique_ptr<LegacyEntity> legacyRoot;
+	std::vector<LegacyEntity*> legacyEntities;
+
+	double legacyBuildTime = measureMilliseconds(iterations, [&]()
+	{
+		legacyRoot.reset();
+		legacyEntities.clear();
+		legacyHierarchy.clear();
+
+		legacyRoot = std::make_unique<LegacyEntity>(&legacyHierarchy, nullptr, model);
+		legacyEntities.push_back(legacyRoot.get());
+
+		for (uint32_t i = 1; i < entityCount; i++)
+		{
+			LegacyEntity* parent = legacyEntities[(i - 1) / branchingFactor];
+
+			parent->children.emplace_back(std::make_unique<LegacyEntity>(&legacyHierarchy, parent, model));
+			legacyEntities.push_back(parent->children.back().get());
+		}
+	});
+
+	legacyHierarchy.update();
+
+	uint32_t legacyVisible = 0;
+	double legacyTraversalTime = measureMilliseconds(iterations, [&]() { legacyVisible = legacyRoot->countVisible(frustum); });
+	double legacyDestroyTime = measureMilliseconds(1, [&]() { legacyRoot.reset(); });
+
+	TransformHierarchy poolHierarchy;
+	EntityPool pool;
+	std::vector<Entity*> poolEntities;
+
+	double poolBuildTime = measureMilliseconds(iterations, [&]()
+	{
+		pool.clear();
+		poolEntities.clear();
+		poolHierarchy.clear();
+
+		poolEntities.push_back(pool.create(&poolHierarchy, nullptr, model));
+
+		for (uint32_t i = 1; i < entityCount; i++)
+		{
+			poolEntities.push_back(poolEntities[(i - 1) / branchingFactor]->addChild(model));
+		}
+	});
+
+	poolHierarchy.update();
+
+	uint32_t poolVisible = 0;
+	double poolTraversalTime = measureMilliseconds(iterations, [&]() { poolVisible = countVisible(poolEntities[0], frustum); });
+	double poolDestroyTime = measureMilliseconds(1, [&]() { pool.release(); });
+
+	std::cout << '\t' << "[LOG] BENCHMARK: heap allocated | build: " << legacyBuildTime << " ms | traversal: " << legacyTraversalTime << " ms (" << legacyVisible
+		<< " visible) | destroy: " << legacyDestroyTime << " ms" << std::endl;
+
+	std::cout << '\t' << "[LOG] BENCHMARK: entity pool | build: " << poolBuildTime << " ms (" << legacyBuildTime / poolBuildTime << "x) | traversal: " << poolTraversalTime
+		<< " ms (" << poolVisible << " visible, " << legacyTraversalTime / poolTraversalTime << "x) | destroy: " << poolDestroyTime << " ms" << std::endl;
+}
+
+void benchmarkVertexCompression(BasicModel* model)
+{
+	std::cout << "[LOG] BENCHMARK: Packed vertex encoders round trip." << std::endl;
+
+	testVertexCompression(model->getVertices(), model->getBounds().aabb);
+
+	std::cout << '\t' << "[LOG] BENCHMARK: vertex size | BMVertex: " << sizeof(BMVertex) << " -> " << sizeof(PackedBMVertex) << " bytes | MeshVertex: "
+		<< sizeof(MeshVertex) << " -> " << sizeof(PackedMeshVertex) << " bytes | indices: " << getIndexSize(model->getIndexType()) << " bytes" << std::endl;
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <list>
+#include <memory>
+#include <chrono>
+#include <vector>
+#include <iostream>
+#include <algorithm>
+#include <cstdlib>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "../../camera.h"
+#include "../../entity.h"
+#include "../../graphics/model.h"
+#include "../../systems/transform_hierarchy.h"
+#include "../../systems/frustum_culler.h"
+#include "../../systems/bvh.h"
+#include "../../systems/entity_pool.h"
+#include "../../utils/vertex_compression.h"
+#include "self_test.h"
+
+// Development benchmarks. They run synchronously (blocking the current frame) and print their results to the console.
+
+// Compares the recursive pointer-based entity update against the flattened transform hierarchy at 1k, 100k and 1M nodes.
+void benchmarkTransformUpdate();
+
+// Compares the per-entity (virtual, scalar) sphere test against the batch culling kernels (scalar, SSE and AVX) and the BVH over 1M random spheres.
+void benchmarkFrustumCulling();
+
+// Compares building, traversing and destroying a 100k entities hierarchy with heap allocated entities (and children lists) against the entity pool.
+void benchmarkEntityAllocation(BasicModel* model);
+
+// Round trips the vertices of the model through the packed vertex encoders (see "testVertexCompression"), also reporting the memory saved.
+void benchmarkVertexCompression(BasicModel* model);
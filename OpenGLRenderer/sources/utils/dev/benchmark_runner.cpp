@@ -0,0 +1,811 @@
+#include "benchmark_runner.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <unistd.h>
+#endif
+
+// Measurements of one frame.
+struct BenchmarkFrame
+{
+	float cpuTime; // Milliseconds, "update" and "render" of the scene.
+	float gpuTime; // Milliseconds, "-1" when the query was not available.
+
+	uint64_t primitives;
+	uint32_t stateCalls;
+
+	uint64_t residentMemory; // Bytes.
+};
+
+// Average GPU time of a "GPUTimer" timer over the measured frames.
+struct BenchmarkPass
+{
+	std::string name;
+	uint32_t depth;
+
+	float averageTime; // Milliseconds.
+};
+
+struct BenchmarkStatistics
+{
+	float average, minimum, maximum, p95;
+};
+
+struct BenchmarkResult
+{
+	SceneTypes type;
+
+	float setupTime; // Milliseconds.
+
+	std::vector<BenchmarkFrame> frames;
+
+	BenchmarkStatistics cpu, gpu;
+
+	uint64_t averagePrimitives, peakResidentMemory;
+	uint32_t averageStateCalls;
+
+	std::vector<BenchmarkPass> passes;
+};
+
+// Sums of the "GPUTimer" timers over the measured frames, indexed like "GPUTimer::getTimers".
+struct BenchmarkPassTotals
+{
+	std::vector<double> times; // Milliseconds.
+	uint32_t frames;
+
+	uint64_t resolvedFrame; // Last "GPUTimer" frame already added.
+};
+
+// Queries of a frame, read "FRAME_LATENCY" frames later (like "GPUTimer").
+struct BenchmarkQueries
+{
+	uint32_t timeElapsed, primitivesGenerated;
+	int32_t frame; // Index in the results, "-1" when unused.
+};
+
+static const uint32_t FRAME_LATENCY = GPUTimer::FRAME_LATENCY;
+
+static float elapsedMilliseconds(const std::chrono::steady_clock::time_point& start)
+{
+	return std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+static uint64_t getResidentMemory()
+{
+#ifdef _WIN32
+	PROCESS_MEMORY_COUNTERS counters;
+
+	if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+	{
+		return uint64_t(counters.WorkingSetSize);
+	}
+
+	return 0;
+#else
+	// Second field of "statm", in pages.
+	std::ifstream file("/proc/self/statm");
+	uint64_t size = 0, resident = 0;
+
+	if (file >> size >> resident)
+	{
+		return resident * uint64_t(sysconf(_SC_PAGESIZE));
+	}
+
+	return 0;
+#endif
+}
+
+static bool parseSceneType(const std::string& name, SceneTypes& type)
+{
+	for (int i = 0; i < int(SceneTypes::NUMBER_OF_SCENE_TYPES); i++)
+	{
+		if (name == getSceneTypeName(SceneTypes(i)))
+		{
+			type = SceneTypes(i);
+
+			return true;
+		}
+	}
+
+	return false;
+}
+
+// Orbit framing most of the content of every scene.
+static CameraPath getDefaultPath(SceneTypes type)
+{
+	switch (type)
+	{
+	case SceneTypes::INSTANCING:
+		return CameraPath::createOrbit(30.0f, 10.0f, glm::vec3(0.0f));
+
+	case SceneTypes::FRUSTUM_CULLING:
+		return CameraPath::createOrbit(60.0f, 15.0f, glm::vec3(0.0f));
+
+	case SceneTypes::GRASS:
+		return CameraPath::createOrbit(25.0f, 5.0f, glm::vec3(0.0f));
+
+	case SceneTypes::PARTICLES:
+		return CameraPath::createOrbit(15.0f, 5.0f, glm::vec3(0.0f, 2.5f, 0.0f));
+
+	case SceneTypes::SKELETAL_ANIMATION:
+		return CameraPath::createOrbit(6.0f, 2.5f, glm::vec3(0.0f, 1.0f, 0.0f));
+
+	case SceneTypes::WATER:
+		return CameraPath::createOrbit(20.0f, 6.0f, glm::vec3(0.0f));
+
+	case SceneTypes::TESSELLATION:
+		return CameraPath::createOrbit(40.0f, 15.0f, glm::vec3(0.0f));
+
+	default:
+		return CameraPath::createOrbit(10.0f, 5.0f, glm::vec3(0.0f));
+	}
+}
+
+static BenchmarkStatistics computeStatistics(std::vector<float> values)
+{
+	BenchmarkStatistics statistics = { 0.0f, 0.0f, 0.0f, 0.0f };
+
+	if (values.empty())
+	{
+		return statistics;
+	}
+
+	std::sort(values.begin(), values.end());
+
+	float sum = 0.0f;
+
+	for (float value : values)
+	{
+		sum += value;
+	}
+
+	statistics.average = sum / float(values.size());
+	statistics.minimum = values.front();
+	statistics.maximum = values.back();
+	statistics.p95 = values[std::min(size_t(std::ceil(0.95f * float(values.size()))), values.size()) - 1];
+
+	return statistics;
+}
+
+static void resolveQueries(BenchmarkQueries& queries, BenchmarkResult& result)
+{
+	if (queries.frame < 0)
+	{
+		return;
+	}
+
+	BenchmarkFrame& frame = result.frames[queries.frame];
+
+	GLint available = 0;
+	glGetQueryObjectiv(queries.timeElapsed, GL_QUERY_RESULT_AVAILABLE, &available);
+
+	if (available)
+	{
+		GLuint64 time = 0, primitives = 0;
+
+		glGetQueryObjectui64v(queries.timeElapsed, GL_QUERY_RESULT, &time);
+		glGetQueryObjectui64v(queries.primitivesGenerated, GL_QUERY_RESULT, &primitives);
+
+		frame.gpuTime = float(double(time) / 1000000.0);
+		frame.primitives = uint64_t(primitives);
+	}
+
+	queries.frame = -1;
+}
+
+// Adds the frame "GPUTimer" resolved last, if it is a new measured one. "GPUTimer" frames start at 1, one per loop iteration.
+static void accumulatePasses(const BenchmarkOptions& options, BenchmarkPassTotals& totals)
+{
+	uint64_t frame = GPUTimer::getResolvedFrame();
+
+	if (frame == totals.resolvedFrame)
+	{
+		return;
+	}
+
+	totals.resolvedFrame = frame;
+
+	if (frame <= options.warmupFrames)
+	{
+		return;
+	}
+
+	const std::vector<GPUTimer::Timer>& timers = GPUTimer::getTimers();
+
+	totals.times.resize(timers.size(), 0.0);
+	totals.frames += 1;
+
+	for (size_t i = 0; i < timers.size(); i++)
+	{
+		if (timers[i].lastFrame == frame)
+		{
+			totals.times[i] += double(timers[i].lastTime);
+		}
+	}
+}
+
+static void writeJsonString(std::ofstream& file, const std::string& value)
+{
+	file << "\"";
+
+	for (char c : value)
+	{
+		if (c == '"' || c == '\\')
+		{
+			file << '\\' << c;
+		}
+		else if ((unsigned char)(c) < 0x20)
+		{
+			char escaped[8];
+			std::snprintf(escaped, sizeof(escaped), "\\u%04x", unsigned(c));
+
+			file << escaped;
+		}
+		else
+		{
+			file << c;
+		}
+	}
+
+	file << "\"";
+}
+
+static void runScene(SceneTypes type, const BenchmarkOptions& options, BenchmarkResult& result)
+{
+	result.type = type;
+
+	Scene* scene = Application::createScene(type);
+
+	if (scene == nullptr)
+	{
+		return;
+	}
+
+	for (const std::pair<std::string, float>& parameter : options.parameters)
+	{
+		if (!scene->setParameter(parameter.first, parameter.second))
+		{
+			std::cout << "[WARNING] BENCHMARK: Parameter \"" << parameter.first << "\" is not used by \"" << getSceneTypeName(type) << "\"." << std::endl;
+		}
+	}
+
+	CameraPath path;
+
+	if (options.pathFilepath.empty() || !CameraPath::load(options.pathFilepath.c_str(), path))
+	{
+		path = getDefaultPath(type);
+	}
+
+	{
+		PROFILE_ZONE("Scene::setup");
+
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+		std::srand(options.seed);
+
+		scene->setup();
+
+		glFinish();
+
+		result.setupTime = elapsedMilliseconds(start);
+	}
+
+	ProjectionProperties projProps(float(options.width) / float(options.height));
+
+	BenchmarkQueries queries[FRAME_LATENCY];
+
+	for (BenchmarkQueries& frameQueries : queries)
+	{
+		glGenQueries(1, &frameQueries.timeElapsed);
+		glGenQueries(1, &frameQueries.primitivesGenerated);
+
+		frameQueries.frame = -1;
+	}
+
+	BenchmarkPassTotals passTotals = { {}, 0, 0 };
+
+	uint32_t totalFrames = options.warmupFrames + options.frames;
+
+	result.frames.resize(options.frames);
+
+	for (uint32_t i = 0; i < totalFrames; i++)
+	{
+		PROFILE_FRAME();
+
+		bool measured = i >= options.warmupFrames;
+		int32_t frameIndex = int32_t(i) - int32_t(options.warmupFrames);
+
+		// The warm-up frames fly the path too, so the measured ones start from a steady state.
+		CameraPath::Keyframe keyframe = path.evaluate(totalFrames > 1 ? float(i) / float(totalFrames - 1) : 0.0f);
+
+		glm::vec3 direction = keyframe.target - keyframe.position;
+		direction = glm::length(direction) > 0.0f ? glm::normalize(direction) : glm::vec3(0.0f, 0.0f, -1.0f);
+
+		Camera camera(keyframe.position, direction, glm::vec3(0.0f, 1.0f, 0.0f), projProps);
+
+		BenchmarkQueries& frameQueries = queries[i % FRAME_LATENCY];
+
+		resolveQueries(frameQueries, result);
+
+		GLState::beginFrame();
+		GPUTimer::beginFrame();
+
+		accumulatePasses(options, passTotals);
+
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+		glBeginQuery(GL_TIME_ELAPSED, frameQueries.timeElapsed);
+		glBeginQuery(GL_PRIMITIVES_GENERATED, frameQueries.primitivesGenerated);
+
+		{
+			PROFILE_ZONE("Scene::update");
+
+			scene->update(options.deltaTime);
+		}
+
+		{
+			PROFILE_ZONE("Scene::render");
+
+			GPUTimer::begin("Scene");
+
+			scene->render(camera, options.deltaTime);
+
+			GPUTimer::end();
+		}
+
+		glEndQuery(GL_PRIMITIVES_GENERATED);
+		glEndQuery(GL_TIME_ELAPSED);
+
+		float cpuTime = elapsedMilliseconds(start);
+
+		// Nothing is presented, flushing keeps the driver from batching several frames together.
+		glFlush();
+
+		if (measured)
+		{
+			BenchmarkFrame& frame = result.frames[frameIndex];
+
+			frame.cpuTime = cpuTime;
+			frame.gpuTime = -1.0f;
+			frame.primitives = 0;
+			frame.stateCalls = 0;
+			frame.residentMemory = getResidentMemory();
+
+			frameQueries.frame = frameIndex;
+		}
+
+		// State calls are only counted by the next "beginFrame", so they are read one frame late.
+		if (measured && frameIndex > 0)
+		{
+			result.frames[frameIndex - 1].stateCalls = GLState::getIssuedCalls();
+		}
+	}
+
+	glFinish();
+
+	GLState::beginFrame();
+
+	if (!result.frames.empty())
+	{
+		result.frames.back().stateCalls = GLState::getIssuedCalls();
+	}
+
+	for (BenchmarkQueries& frameQueries : queries)
+	{
+		resolveQueries(frameQueries, result);
+
+		glDeleteQueries(1, &frameQueries.timeElapsed);
+		glDeleteQueries(1, &frameQueries.primitivesGenerated);
+	}
+
+	// Empty frames resolve the timers of the last "FRAME_LATENCY" ones, which are done after "glFinish".
+	for (uint32_t i = 0; i < FRAME_LATENCY; i++)
+	{
+		GPUTimer::beginFrame();
+
+		accumulatePasses(options, passTotals);
+	}
+
+	const std::vector<GPUTimer::Timer>& timers = GPUTimer::getTimers();
+
+	for (size_t i = 0; i < passTotals.times.size(); i++)
+	{
+		result.passes.push_back({ timers[i].name, timers[i].depth, float(passTotals.times[i] / double(std::max(passTotals.frames, 1u))) });
+	}
+
+	scene->clean();
+
+	delete scene;
+
+	GPUTimer::clean();
+
+	// Summary.
+	std::vector<float> cpuTimes, gpuTimes;
+	uint64_t primitives = 0, stateCalls = 0;
+
+	result.peakResidentMemory = 0;
+
+	for (const BenchmarkFrame& frame : result.frames)
+	{
+		cpuTimes.push_back(frame.cpuTime);
+
+		if (frame.gpuTime >= 0.0f)
+		{
+			gpuTimes.push_back(frame.gpuTime);
+		}
+
+		primitives += frame.primitives;
+		stateCalls += frame.stateCalls;
+
+		result.peakResidentMemory = std::max(result.peakResidentMemory, frame.residentMemory);
+	}
+
+	size_t frameCount = std::max(result.frames.size(), size_t(1));
+
+	result.cpu = computeStatistics(cpuTimes);
+	result.gpu = computeStatistics(gpuTimes);
+
+	result.averagePrimitives = primitives / frameCount;
+	result.averageStateCalls = uint32_t(stateCalls / frameCount);
+
+	if (gpuTimes.size() < result.frames.size())
+	{
+		std::cout << "[WARNING] BENCHMARK: " << result.frames.size() - gpuTimes.size() << " frames of \"" << getSceneTypeName(type) << "\" without GPU time." << std::endl;
+	}
+}
+
+static void writeStatistics(std::ofstream& file, const char* name, const BenchmarkStatistics& statistics)
+{
+	file << "\"" << name << "\":{\"average\":" << statistics.average << ",\"min\":" << statistics.minimum
+		<< ",\"max\":" << statistics.maximum << ",\"p95\":" << statistics.p95 << "}";
+}
+
+static bool writeResults(const BenchmarkOptions& options, const std::vector<BenchmarkResult>& results)
+{
+	std::string jsonFilepath = options.outputPrefix + ".json";
+	std::string csvFilepath = options.outputPrefix + ".csv";
+
+	std::ofstream json(jsonFilepath), csv(csvFilepath);
+
+	if (!json.is_open() || !csv.is_open())
+	{
+		std::cout << "[ERROR] BENCHMARK: Failed to open output files \"" << jsonFilepath << "\" and \"" << csvFilepath << "\"." << std::endl;
+
+		return false;
+	}
+
+	// Summary of every scene.
+	json.precision(4);
+	json << std::fixed;
+
+	json << "{\"width\":" << options.width << ",\"height\":" << options.height << ",\"frames\":" << options.frames
+		<< ",\"warmupFrames\":" << options.warmupFrames << ",\"deltaTime\":" << options.deltaTime << ",\"parameters\":{";
+
+	for (size_t i = 0; i < options.parameters.size(); i++)
+	{
+		json << (i > 0 ? "," : "");
+		writeJsonString(json, options.parameters[i].first);
+		json << ":" << options.parameters[i].second;
+	}
+
+	json << "},\"scenes\":[";
+
+	for (size_t i = 0; i < results.size(); i++)
+	{
+		const BenchmarkResult& result = results[i];
+
+		json << (i > 0 ? "," : "") << "\n{\"scene\":";
+		writeJsonString(json, getSceneTypeName(result.type));
+		json << ",\"setupTime\":" << result.setupTime << ",";
+
+		writeStatistics(json, "cpuTime", result.cpu);
+		json << ",";
+		writeStatistics(json, "gpuTime", result.gpu);
+
+		json << ",\"primitives\":" << result.averagePrimitives << ",\"stateCalls\":" << result.averageStateCalls
+			<< ",\"peakResidentMemory\":" << result.peakResidentMemory << ",\"passes\":[";
+
+		for (size_t j = 0; j < result.passes.size(); j++)
+		{
+			json << (j > 0 ? "," : "") << "{\"name\":";
+			writeJsonString(json, result.passes[j].name);
+			json << ",\"depth\":" << result.passes[j].depth << ",\"gpuTime\":" << result.passes[j].averageTime << "}";
+		}
+
+		json << "]}";
+	}
+
+	json << "\n]}\n";
+
+	// Every frame of every scene.
+	csv.precision(4);
+	csv << std::fixed;
+
+	csv << "scene,frame,cpu_ms,gpu_ms,primitives,state_calls,resident_bytes\n";
+
+	for (const BenchmarkResult& result : results)
+	{
+		for (size_t i = 0; i < result.frames.size(); i++)
+		{
+			const BenchmarkFrame& frame = result.frames[i];
+
+			csv << getSceneTypeName(result.type) << "," << i << "," << frame.cpuTime << "," << frame.gpuTime << ","
+				<< frame.primitives << "," << frame.stateCalls << "," << frame.residentMemory << "\n";
+		}
+	}
+
+	std::cout << "[LOG] BENCHMARK: Results written to \"" << jsonFilepath << "\" and \"" << csvFilepath << "\"." << std::endl;
+
+	return true;
+}
+
+CameraPath CameraPath::createOrbit(float radius, float height, const glm::vec3& target, uint32_t keyframeCount)
+{
+	CameraPath path;
+
+	keyframeCount = std::max(keyframeCount, 2u);
+
+	for (uint32_t i = 0; i <= keyframeCount; i++)
+	{
+		float angle = 2.0f * glm::pi<float>() * float(i % keyframeCount) / float(keyframeCount);
+
+		path.keyframes.push_back({ target + glm::vec3(radius * std::cos(angle), height, radius * std::sin(angle)), target });
+	}
+
+	return path;
+}
+
+bool CameraPath::load(const char* filepath, CameraPath& path)
+{
+	std::ifstream file(filepath);
+
+	if (!file.is_open())
+	{
+		std::cout << "[ERROR] BENCHMARK: Failed to open camera path \"" << filepath << "\"." << std::endl;
+
+		return false;
+	}
+
+	path.keyframes.clear();
+
+	std::string line;
+
+	while (std::getline(file, line))
+	{
+		std::istringstream stream(line);
+		Keyframe keyframe;
+
+		if (stream >> keyframe.position.x >> keyframe.position.y >> keyframe.position.z >> keyframe.target.x >> keyframe.target.y >> keyframe.target.z)
+		{
+			path.keyframes.push_back(keyframe);
+		}
+	}
+
+	if (path.keyframes.empty())
+	{
+		std::cout << "[ERROR] BENCHMARK: Camera path \"" << filepath << "\" has no keyframes." << std::endl;
+
+		return false;
+	}
+
+	return true;
+}
+
+CameraPath::Keyframe CameraPath::evaluate(float t) const
+{
+	if (keyframes.size() < 2)
+	{
+		return keyframes.empty() ? Keyframe{ glm::vec3(0.0f), glm::vec3(0.0f, 0.0f, -1.0f) } : keyframes.front();
+	}
+
+	float position = std::min(std::max(t, 0.0f), 1.0f) * float(keyframes.size() - 1);
+	size_t index = std::min(size_t(position), keyframes.size() - 2);
+	float weight = position - float(index);
+
+	const Keyframe& a = keyframes[index];
+	const Keyframe& b = keyframes[index + 1];
+
+	return { glm::mix(a.position, b.position, weight), glm::mix(a.target, b.target, weight) };
+}
+
+bool parseBenchmarkOptions(int argc, char** argv, BenchmarkOptions& options)
+{
+	bool enabled = false;
+
+	for (int i = 1; i < argc; i++)
+	{
+		std::string argument = argv[i];
+		bool hasValue = i + 1 < argc;
+
+		if (argument == "--benchmark")
+		{
+			enabled = true;
+		}
+		else if (argument == "--scene" && hasValue)
+		{
+			std::string name = argv[++i];
+			SceneTypes type;
+
+			if (name == "all")
+			{
+				options.scenes.clear();
+			}
+			else if (parseSceneType(name, type))
+			{
+				options.scenes.push_back(type);
+			}
+			else
+			{
+				std::cout << "[ERROR] BENCHMARK: Unknown scene \"" << name << "\"." << std::endl;
+
+				return false;
+			}
+		}
+		else if (argument == "--frames" && hasValue)
+		{
+			options.frames = uint32_t(std::max(std::atoi(argv[++i]), 1));
+		}
+		else if (argument == "--warmup" && hasValue)
+		{
+			options.warmupFrames = uint32_t(std::max(std::atoi(argv[++i]), 0));
+		}
+		else if (argument == "--size" && hasValue)
+		{
+			int width = 0, height = 0;
+			char separator = 0;
+
+			std::istringstream stream(argv[++i]);
+
+			if (!(stream >> width >> separator >> height) || separator != 'x' || width <= 0 || height <= 0)
+			{
+				std::cout << "[ERROR] BENCHMARK: Invalid size \"" << argv[i] << "\", expected <width>x<height>." << std::endl;
+
+				return false;
+			}
+
+			options.width = width;
+			options.height = height;
+		}
+		else if (argument == "--param" && hasValue)
+		{
+			std::string parameter = argv[++i];
+			size_t separator = parameter.find('=');
+
+			if (separator == std::string::npos || separator == 0)
+			{
+				std::cout << "[ERROR] BENCHMARK: Invalid parameter \"" << parameter << "\", expected <name>=<value>." << std::endl;
+
+				return false;
+			}
+
+			options.parameters.push_back({ parameter.substr(0, separator), float(std::atof(parameter.c_str() + separator + 1)) });
+		}
+		else if (argument == "--path" && hasValue)
+		{
+			options.pathFilepath = argv[++i];
+		}
+		else if (argument == "--output" && hasValue)
+		{
+			options.outputPrefix = argv[++i];
+		}
+		else if (argument == "--seed" && hasValue)
+		{
+			options.seed = uint32_t(std::strtoul(argv[++i], nullptr, 10));
+		}
+		else if (argument == "--context" && hasValue)
+		{
+			std::string context = argv[++i];
+
+			if (context == "native")
+			{
+				options.contextAPI = GLFW_NATIVE_CONTEXT_API;
+			}
+			else if (context == "egl")
+			{
+				options.contextAPI = GLFW_EGL_CONTEXT_API;
+			}
+			else if (context == "osmesa")
+			{
+				options.contextAPI = GLFW_OSMESA_CONTEXT_API;
+			}
+			else
+			{
+				std::cout << "[ERROR] BENCHMARK: Unknown context API \"" << context << "\"." << std::endl;
+
+				return false;
+			}
+		}
+	}
+
+	if (enabled && options.scenes.empty())
+	{
+		for (int i = 0; i < int(SceneTypes::NUMBER_OF_SCENE_TYPES); i++)
+		{
+			options.scenes.push_back(SceneTypes(i));
+		}
+	}
+
+	return enabled;
+}
+
+int runBenchmark(const BenchmarkOptions& options)
+{
+	if (!glfwInit())
+	{
+		std::cout << "[ERROR] BENCHMARK: Failed to initialize GLFW." << std::endl;
+
+		return -1;
+	}
+
+	// Hidden window: the scenes render into its default framebuffer, which is never presented.
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 6);
+	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+	glfwWindowHint(GLFW_CONTEXT_CREATION_API, options.contextAPI);
+	glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+
+	GLFWwindow* window = glfwCreateWindow(options.width, options.height, "Benchmark", NULL, NULL);
+
+	if (!window)
+	{
+		std::cout << "[ERROR] BENCHMARK: Failed to create an OpenGL 4.6 context." << std::endl;
+		glfwTerminate();
+
+		return -1;
+	}
+
+	glfwMakeContextCurrent(window);
+
+	glfwSwapInterval(0);
+
+	if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+	{
+		std::cout << "[ERROR] BENCHMARK: Failed to initialize GLAD." << std::endl;
+		glfwTerminate();
+
+		return -1;
+	}
+
+	std::cout << "[LOG] BENCHMARK: " << glGetString(GL_RENDERER) << " (" << glGetString(GL_VERSION) << ")." << std::endl;
+
+	// Same state as the application.
+	glEnable(GL_DEPTH_TEST);
+	glEnable(GL_BLEND);
+
+	glDepthMask(GL_TRUE);
+	glDepthFunc(GL_LESS);
+
+	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+	glViewport(0, 0, options.width, options.height);
+
+	JobSystem::setup();
+
+	std::vector<BenchmarkResult> results(options.scenes.size());
+
+	for (size_t i = 0; i < options.scenes.size(); i++)
+	{
+		std::cout << "[LOG] BENCHMARK: Running \"" << getSceneTypeName(options.scenes[i]) << "\" (" << options.frames << " frames)." << std::endl;
+
+		runScene(options.scenes[i], options, results[i]);
+
+		const BenchmarkResult& result = results[i];
+
+		std::cout << "[LOG] BENCHMARK: \"" << getSceneTypeName(result.type) << "\" CPU " << result.cpu.average << " ms (p95 " << result.cpu.p95
+			<< " ms), GPU " << result.gpu.average << " ms (p95 " << result.gpu.p95 << " ms), " << result.averagePrimitives << " primitives, "
+			<< result.averageStateCalls << " state calls." << std::endl;
+	}
+
+	JobSystem::clean();
+
+	bool written = writeResults(options, results);
+
+	glfwDestroyWindow(window);
+	glfwTerminate();
+
+	return written ? 0 : -1;
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <utility>
+#include <cstdint>
+#include <cstdlib>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/constants.hpp>
+
+#include "../../application.h"
+#include "../../camera.h"
+#include "../../scene.h"
+#include "../../graphics/gl_state.h"
+#include "../../systems/job_system.h"
+#include "../../utils/gpu_timer.h"
+
+// Camera keyframes, evenly spaced in time and linearly interpolated.
+struct CameraPath
+{
+	struct Keyframe
+	{
+		glm::vec3 position, target;
+	};
+
+	std::vector<Keyframe> keyframes;
+
+	// Orbit around the origin, looking at "target". Closed: the last keyframe is the first one.
+	static CameraPath createOrbit(float radius, float height, const glm::vec3& target, uint32_t keyframeCount = 16);
+
+	// Text file with one keyframe per line: "px py pz tx ty tz".
+	static bool load(const char* filepath, CameraPath& path);
+
+	// "t" in [0, 1].
+	Keyframe evaluate(float t) const;
+};
+
+// Options of the benchmark ("--benchmark" in the command line). It renders in a hidden window, so it still needs a display and an
+// OpenGL 4.6 driver:
+//
+//   --benchmark                Runs the benchmark instead of the windowed application.
+//   --scene <name|all>         Scene to run (see "getSceneTypeName"), all of them by default.
+//   --frames <N>               Measured frames per scene (600).
+//   --warmup <N>               Frames run before measuring (60).
+//   --size <width>x<height>    Hidden window size (1280x720).
+//   --param <name>=<value>     Scene parameter, may be repeated (e.g. "instances=250000", "maxParticles=10000", "meshSize=1000").
+//   --path <file>              Camera keyframes (see "CameraPath::load"), an orbit per scene by default.
+//   --output <prefix>          Writes "<prefix>.json" and "<prefix>.csv" ("benchmark").
+//   --seed <N>                 Seed of "std::rand", set before every scene setup (1).
+//   --context <native|egl|osmesa>  Context creation API of the window (GLFW still needs a display with any of them).
+//
+struct BenchmarkOptions
+{
+	std::vector<SceneTypes> scenes;
+
+	uint32_t frames = 600;
+	uint32_t warmupFrames = 60;
+
+	int width = 1280, height = 720;
+
+	// Every frame advances the scenes by the same time, so runs are deterministic.
+	float deltaTime = 1.0f / 60.0f;
+
+	// The scenes place their instances and particles with "std::rand", so it's seeded again before every setup.
+	uint32_t seed = 1;
+
+	std::vector<std::pair<std::string, float>> parameters;
+
+	std::string pathFilepath;
+	std::string outputPrefix = "benchmark";
+
+	int contextAPI = GLFW_NATIVE_CONTEXT_API;
+};
+
+// Returns false when the command line has no "--benchmark" (or has invalid options).
+bool parseBenchmarkOptions(int argc, char** argv, BenchmarkOptions& options);
+
+// Creates a hidden window (with its own context) and runs every scene of the options. Returns the process exit code.
+int runBenchmark(const BenchmarkOptions& options);
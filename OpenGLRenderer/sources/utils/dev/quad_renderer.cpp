@@ -1,5 +1,12 @@
 #include "quad_renderer.h"
 
+// Names of the uniforms set every frame, hashed by the compiler.
+static constexpr UniformName TEXTURE_UNIFORM("uTexture");
+static constexpr UniformName COLOR_CHANNELS_UNIFORM("uColorChannels");
+static constexpr UniformName LINEARIZE_UNIFORM("uLinearize");
+static constexpr UniformName NEAR_UNIFORM("uNear");
+static constexpr UniformName FAR_UNIFORM("uFar");
+
 QuadRenderer::QuadRenderer()
 	: VAO(), VBO(), IBO(), quadRender(nullptr)
 {
@@ -22,10 +29,10 @@ void QuadRenderer::setup()
 	quadRender = new ShaderProgram("sources/shaders/dev/render_debug_quad_vs.glsl", "sources/shaders/dev/render_debug_quad_fs.glsl");
 
 	glGenVertexArrays(1, &VAO);
-	glBindVertexArray(VAO);
+	GLState::bindVertexArray(VAO);
 
 	glGenBuffers(1, &VBO);
-	glBindBuffer(GL_ARRAY_BUFFER, VBO);
+	GLState::bindBuffer(GL_ARRAY_BUFFER, VBO);
 	glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
 
 	glEnableVertexAttribArray(0);
@@ -35,19 +42,19 @@ void QuadRenderer::setup()
 	glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)(3 * sizeof(float)));
 
 	glGenBuffers(1, &IBO);
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, IBO);
+	GLState::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, IBO);
 	glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
 
-	glBindVertexArray(0);
-	glBindBuffer(GL_ARRAY_BUFFER, 0);
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+	GLState::bindVertexArray(0);
+	GLState::bindBuffer(GL_ARRAY_BUFFER, 0);
+	GLState::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
 }
 
 void QuadRenderer::clean()
 {
-	glDeleteBuffers(1, &IBO);
-	glDeleteBuffers(1, &VBO);
-	glDeleteVertexArrays(1, &VAO);
+	GLState::deleteBuffers(1, &IBO);
+	GLState::deleteBuffers(1, &VBO);
+	GLState::deleteVertexArrays(1, &VAO);
 
 	quadRender->clean();
 
@@ -58,19 +65,19 @@ void QuadRenderer::render(int x, int y, int width, int height, int unit, int col
 {
 	quadRender->bind();
 
-	quadRender->setUniform1i("uTexture", unit);
-	quadRender->setUniform1i("uColorChannels", colorChannels);
-	quadRender->setUniform1i("uLinearize", linearize);
-	quadRender->setUniform1f("uNear", zNear);
-	quadRender->setUniform1f("uFar", zFar);
+	quadRender->setUniform1i(TEXTURE_UNIFORM, unit);
+	quadRender->setUniform1i(COLOR_CHANNELS_UNIFORM, colorChannels);
+	quadRender->setUniform1i(LINEARIZE_UNIFORM, linearize);
+	quadRender->setUniform1f(NEAR_UNIFORM, zNear);
+	quadRender->setUniform1f(FAR_UNIFORM, zFar);
 
 	glViewport(x, y, width, height);
 
-	glBindVertexArray(VAO);
+	GLState::bindVertexArray(VAO);
 
 	glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
 
-	glBindVertexArray(0);
+	GLState::bindVertexArray(0);
 
 	quadRender->unbind();
 }
@@ -0,0 +1,531 @@
+#include "self_test.h"
+
+struct TestMesh
+{
+	const char* name;
+
+	std::vector<glm::vec3> positions;
+	std::vector<uint32_t> indices;
+};
+
+static float randomFloat(float min, float max)
+{
+	return min + (max - min) * (static_cast<float>(std::rand()) / static_cast<float>(RAND_MAX));
+}
+
+static bool check(bool passed, const char* test, const char* description)
+{
+	if (!passed)
+	{
+		std::cout << '\t' << "[ERROR] SELF TEST: " << test << ": " << description << "." << std::endl;
+	}
+
+	return passed;
+}
+
+// Grid of "size" x "size" quads over [0, 1]^2 (in XZ), with heights given by "height".
+template<typename F>
+static TestMesh createGrid(const char* name, uint32_t size, F height)
+{
+	TestMesh mesh = { name, {}, {} };
+
+	for (uint32_t z = 0; z <= size; z++)
+	{
+		for (uint32_t x = 0; x <= size; x++)
+		{
+			float u = float(x) / float(size), v = float(z) / float(size);
+
+			mesh.positions.push_back(glm::vec3(u, height(u, v), v));
+		}
+	}
+
+	for (uint32_t z = 0; z < size; z++)
+	{
+		for (uint32_t x = 0; x < size; x++)
+		{
+			uint32_t a = z * (size + 1) + x, b = a + 1, c = a + size + 1, d = c + 1;
+
+			mesh.indices.insert(mesh.indices.end(), { a, c, b, b, c, d });
+		}
+	}
+
+	return mesh;
+}
+
+// Unit UV sphere. The first column of vertices is duplicated, so the seam has two wedges per position.
+static TestMesh createSphere(uint32_t rings, uint32_t sectors)
+{
+	TestMesh mesh = { "sphere", {}, {} };
+
+	for (uint32_t r = 0; r <= rings; r++)
+	{
+		for (uint32_t s = 0; s <= sectors; s++)
+		{
+			float theta = glm::pi<float>() * float(r) / float(rings);
+			float phi = 2.0f * glm::pi<float>() * float(s % sectors) / float(sectors);
+
+			mesh.positions.push_back(glm::vec3(std::sin(theta) * std::cos(phi), std::cos(theta), std::sin(theta) * std::sin(phi)));
+		}
+	}
+
+	for (uint32_t r = 0; r < rings; r++)
+	{
+		for (uint32_t s = 0; s < sectors; s++)
+		{
+			uint32_t a = r * (sectors + 1) + s, b = a + 1, c = a + sectors + 1, d = c + 1;
+
+			// The triangles touching the poles are degenerate.
+			if (r > 0)
+			{
+				mesh.indices.insert(mesh.indices.end(), { a, c, b });
+			}
+
+			if (r + 1 < rings)
+			{
+				mesh.indices.insert(mesh.indices.end(), { b, c, d });
+			}
+		}
+	}
+
+	return mesh;
+}
+
+// Distance to the plane of the triangle when the projection falls inside it, otherwise to the closest edge.
+static double pointTriangleDistance(const glm::dvec3& p, const glm::dvec3& a, const glm::dvec3& b, const glm::dvec3& c)
+{
+	glm::dvec3 normal = glm::cross(b - a, c - a);
+	double area = glm::length(normal);
+
+	if (area > 0.0)
+	{
+		normal /= area;
+
+		glm::dvec3 projected = p - normal * glm::dot(p - a, normal);
+
+		bool inside = glm::dot(glm::cross(b - a, projected - a), normal) >= 0.0
+			&& glm::dot(glm::cross(c - b, projected - b), normal) >= 0.0
+			&& glm::dot(glm::cross(a - c, projected - c), normal) >= 0.0;
+
+		if (inside)
+		{
+			return std::abs(glm::dot(p - a, normal));
+		}
+	}
+
+	double distance = std::numeric_limits<double>::max();
+	const glm::dvec3* edges[3][2] = { { &a, &b }, { &b, &c }, { &c, &a } };
+
+	for (uint32_t i = 0; i < 3; i++)
+	{
+		glm::dvec3 edge = *edges[i][1] - *edges[i][0];
+		double t = glm::dot(edge, edge) > 0.0 ? glm::clamp(glm::dot(p - *edges[i][0], edge) / glm::dot(edge, edge), 0.0, 1.0) : 0.0;
+
+		distance = std::min(distance, glm::length(p - (*edges[i][0] + edge * t)));
+	}
+
+	return distance;
+}
+
+// Largest distance from a vertex of the mesh to the triangles of a LOD, by brute force.
+static double measureDeviation(const TestMesh& mesh, const std::vector<uint32_t>& indices, const MeshLod& lod)
+{
+	std::vector<uint8_t> used(mesh.positions.size(), 0);
+	double deviation = 0.0;
+
+	for (uint32_t index : mesh.indices)
+	{
+		if (used[index])
+		{
+			continue;
+		}
+
+		used[index] = 1;
+
+		double distance = std::numeric_limits<double>::max();
+
+		for (uint32_t i = lod.indexOffset; i < lod.indexOffset + lod.indexCount; i += 3)
+		{
+			distance = std::min(distance, pointTriangleDistance(mesh.positions[index], mesh.positions[indices[i]], mesh.positions[indices[i + 1]], mesh.positions[indices[i + 2]]));
+		}
+
+		deviation = std::max(deviation, distance);
+	}
+
+	return deviation;
+}
+
+static bool testLodChain(const TestMesh& mesh, bool flat)
+{
+	const float reductionRatio = 0.5f;
+
+	std::vector<uint32_t> indices = mesh.indices;
+	std::vector<MeshLod> lods;
+
+	MeshSimplifier::buildLodChain(mesh.positions, indices, lods, 4, reductionRatio);
+
+	glm::vec3 minAABB = mesh.positions[0], maxAABB = mesh.positions[0];
+
+	for (const glm::vec3& position : mesh.positions)
+	{
+		minAABB = glm::min(minAABB, position);
+		maxAABB = glm::max(maxAABB, position);
+	}
+
+	double meshSize = glm::length(maxAABB - minAABB);
+	bool passed = true;
+
+	passed &= check(lods.size() >= 2, mesh.name, "no LOD was generated");
+	passed &= check(lods[0].indexOffset == 0 && lods[0].indexCount == mesh.indices.size() && lods[0].error == 0.0f, mesh.name, "the LOD 0 is not the input mesh");
+
+	for (uint32_t i = 1; i < lods.size(); i++)
+	{
+		uint32_t triangles = lods[i].indexCount / 3, previousTriangles = lods[i - 1].indexCount / 3;
+		double deviation = measureDeviation(mesh, indices, lods[i]);
+
+		std::cout << '\t' << "[LOG] SELF TEST: " << mesh.name << " LOD " << i << ": " << previousTriangles << " -> " << triangles
+			<< " triangles, error " << lods[i].error << " (measured " << deviation / meshSize << ")" << std::endl;
+
+		passed &= check(triangles > 0 && triangles <= uint32_t(float(previousTriangles) * reductionRatio), mesh.name, "LOD above its triangle target");
+		passed &= check(lods[i].indexOffset >= lods[i - 1].indexOffset + lods[i - 1].indexCount, mesh.name, "LOD overlapping the previous one");
+
+		// The same deviation, measured in another way (up to rounding errors).
+		passed &= check(deviation <= double(lods[i].error) * meshSize * (1.0 + 1e-4) + 1e-6 * meshSize, mesh.name, "deviation above the reported error");
+
+		if (flat)
+		{
+			passed &= check(lods[i].error <= 1e-6f && deviation <= 1e-6 * meshSize, mesh.name, "flat mesh simplified with an error");
+		}
+	}
+
+	return passed;
+}
+
+bool testMeshSimplifier()
+{
+	std::cout << "[LOG] SELF TEST: Mesh simplifier LOD chains." << std::endl;
+
+	bool passed = true;
+
+	passed &= testLodChain(createSphere(32, 64), false);
+	passed &= testLodChain(createGrid("bumpy grid", 48, [](float u, float v) { return 0.05f * std::sin(u * 12.0f) * std::cos(v * 9.0f); }), false);
+	passed &= testLodChain(createGrid("flat grid", 48, [](float, float) { return 0.0f; }), true);
+
+	return passed;
+}
+
+// Triangles rotated to start at their smallest index (keeping the winding) and sorted, to compare them as multisets.
+static std::vector<std::array<uint32_t, 3>> getSortedTriangles(const std::vector<uint32_t>& indices)
+{
+	std::vector<std::array<uint32_t, 3>> triangles;
+
+	for (size_t i = 0; i + 2 < indices.size(); i += 3)
+	{
+		std::array<uint32_t, 3> triangle = { indices[i], indices[i + 1], indices[i + 2] };
+
+		std::rotate(triangle.begin(), std::min_element(triangle.begin(), triangle.end()), triangle.end());
+
+		triangles.push_back(triangle);
+	}
+
+	std::sort(triangles.begin(), triangles.end());
+
+	return triangles;
+}
+
+bool testMeshOptimizer()
+{
+	std::cout << "[LOG] SELF TEST: Mesh optimizer." << std::endl;
+
+	const uint32_t size = 200;
+
+	TestMesh mesh = createGrid("shuffled grid", size, [](float, float) { return 0.0f; });
+	uint32_t vertexCount = uint32_t(mesh.positions.size());
+	uint32_t triangleCount = uint32_t(mesh.indices.size() / 3);
+
+	for (uint32_t i = triangleCount - 1; i > 0; i--)
+	{
+		uint32_t j = uint32_t(std::rand()) % (i + 1);
+
+		std::swap_ranges(&mesh.indices[i * 3], &mesh.indices[i * 3] + 3, &mesh.indices[j * 3]);
+	}
+
+	std::vector<uint32_t> indices = mesh.indices;
+	std::vector<MeshLod> lods = { { 0, uint32_t(indices.size()), 0.0f } };
+	float acmrBefore = 0.0f, acmrAfter = 0.0f;
+
+	std::vector<uint32_t> remap = MeshOptimizer::optimize(mesh.positions, indices, lods, &acmrBefore, &acmrAfter);
+
+	std::cout << '\t' << "[LOG] SELF TEST: " << mesh.name << ": ACMR " << acmrBefore << " -> " << acmrAfter << std::endl;
+
+	bool passed = true;
+
+	passed &= check(acmrBefore > 2.5f && acmrAfter < 0.8f, mesh.name, "ACMR not reduced");
+
+	// The remap must be a permutation of the vertices.
+	std::vector<uint8_t> used(vertexCount, 0);
+	bool permutation = remap.size() == vertexCount;
+
+	for (uint32_t i = 0; permutation && i < vertexCount; i++)
+	{
+		permutation = remap[i] < vertexCount && !used[remap[i]];
+
+		if (permutation)
+		{
+			used[remap[i]] = 1;
+		}
+	}
+
+	passed &= check(permutation, mesh.name, "vertex remap is not a permutation");
+
+	if (!permutation)
+	{
+		return false;
+	}
+
+	// Same triangles, once the new indices are mapped back to the original vertices.
+	std::vector<uint32_t> inverseRemap(vertexCount);
+
+	for (uint32_t i = 0; i < vertexCount; i++)
+	{
+		inverseRemap[remap[i]] = i;
+	}
+
+	std::vector<uint32_t> originalIndices(indices.size());
+
+	for (size_t i = 0; i < indices.size(); i++)
+	{
+		originalIndices[i] = inverseRemap[indices[i]];
+	}
+
+	std::vector<std::array<uint32_t, 3>> triangles = getSortedTriangles(mesh.indices);
+
+	passed &= check(getSortedTriangles(originalIndices) == triangles, mesh.name, "triangles changed");
+
+	// Same triangles drawn with the remapped vertices: every grid position identifies its original vertex.
+	std::vector<glm::vec3> positions = mesh.positions;
+
+	MeshOptimizer::remapVertices(positions, remap);
+
+	std::vector<uint32_t> positionIndices(indices.size());
+
+	for (size_t i = 0; i < indices.size(); i++)
+	{
+		const glm::vec3& position = positions[indices[i]];
+
+		positionIndices[i] = uint32_t(std::round(position.z * size)) * (size + 1) + uint32_t(std::round(position.x * size));
+	}
+
+	passed &= check(getSortedTriangles(positionIndices) == triangles, mesh.name, "remapped vertices draw other triangles");
+
+	return passed;
+}
+
+// Quad facing the camera at depth "z", from "minX" to "maxX" and covering the whole height of the test view.
+static OccluderMesh createQuadOccluder(float minX, float maxX, float z)
+{
+	OccluderMesh occluder;
+
+	occluder.positions = { glm::vec3(minX, -100.0f, z), glm::vec3(maxX, -100.0f, z), glm::vec3(maxX, 100.0f, z), glm::vec3(minX, 100.0f, z) };
+	occluder.indices = { 0, 1, 2, 0, 2, 3 };
+
+	return occluder;
+}
+
+static bool checkTileDepths(const OcclusionCuller& culler, const char* test)
+{
+	const std::vector<float>& depths = culler.getDepthBuffer();
+	bool consistent = true;
+
+	for (uint32_t ty = 0; ty < culler.getTilesY(); ty++)
+	{
+		for (uint32_t tx = 0; tx < culler.getTilesX(); tx++)
+		{
+			float minDepth = 1.0f, maxDepth = 0.0f;
+
+			for (uint32_t y = ty * OcclusionCuller::TILE_SIZE; y < (ty + 1) * OcclusionCuller::TILE_SIZE; y++)
+			{
+				for (uint32_t x = tx * OcclusionCuller::TILE_SIZE; x < (tx + 1) * OcclusionCuller::TILE_SIZE; x++)
+				{
+					minDepth = std::min(minDepth, depths[y * culler.getWidth() + x]);
+					maxDepth = std::max(maxDepth, depths[y * culler.getWidth() + x]);
+				}
+			}
+
+			uint32_t tile = ty * culler.getTilesX() + tx;
+
+			consistent &= culler.getTileMinDepths()[tile] == minDepth && culler.getTileMaxDepths()[tile] == maxDepth;
+		}
+	}
+
+	return check(consistent, test, "tile depth bounds not matching their pixels");
+}
+
+bool testOcclusionCuller()
+{
+	std::cout << "[LOG] SELF TEST: Occlusion culler." << std::endl;
+
+	// 256 x 128 pixels, so a unit is a pixel and "x = 0" is the edge between two tiles (pixels 127 and 128).
+	OcclusionCuller culler(256, 128);
+	glm::mat4 viewProjectionMatrix = glm::ortho(-128.0f, 128.0f, -64.0f, 64.0f, 0.1f, 100.0f);
+
+	bool passed = true;
+
+	// Full screen occluder.
+	culler.begin(viewProjectionMatrix);
+	culler.rasterizeOccluder(createQuadOccluder(-200.0f, 200.0f, -10.0f), glm::mat4(1.0f));
+	culler.finish();
+
+	passed &= check(culler.getRasterizedTriangles() == 2, "full screen quad", "occluder not rasterized");
+	passed &= checkTileDepths(culler, "full screen quad");
+	passed &= check(!culler.isSphereVisible(glm::vec3(20.0f, 10.0f, -20.0f), 3.0f), "full screen quad", "sphere behind the occluder visible");
+	passed &= check(culler.isSphereVisible(glm::vec3(20.0f, 10.0f, -5.0f), 3.0f), "full screen quad", "sphere in front of the occluder occluded");
+	passed &= check(culler.isSphereVisible(glm::vec3(0.0f, 0.0f, -5.0f), 3.0f), "full screen quad", "sphere in front across a tile edge occluded");
+	passed &= check(!culler.isSphereVisible(glm::vec3(0.0f, 0.0f, -20.0f), 3.0f), "full screen quad", "sphere behind across a tile edge visible");
+
+	// Occluder ending in the middle of a tile (pixel 132), so the tiles from 128 to 135 are only partially covered.
+	culler.begin(viewProjectionMatrix);
+	culler.rasterizeOccluder(createQuadOccluder(-200.0f, 4.0f, -10.0f), glm::mat4(1.0f));
+	culler.finish();
+
+	passed &= checkTileDepths(culler, "half screen quad");
+	passed &= check(culler.isSphereVisible(glm::vec3(4.0f, 0.0f, -20.0f), 2.0f), "half screen quad", "sphere behind across the occluder edge occluded");
+	passed &= check(!culler.isSphereVisible(glm::vec3(0.0f, 0.0f, -20.0f), 2.0f), "half screen quad", "sphere behind in a partially covered tile visible");
+	passed &= check(culler.isSphereVisible(glm::vec3(40.0f, 0.0f, -20.0f), 2.0f), "half screen quad", "sphere beside the occluder occluded");
+
+	return passed;
+}
+
+bool testVertexCompression(const std::vector<BMVertex>& vertices, const AABBBounds& aabb, uint32_t randomCount)
+{
+	std::cout << "[LOG] SELF TEST: Packed vertex encoders round trip." << std::endl;
+
+	PositionQuantization quantization = computePositionQuantization(aabb);
+
+	float maxPositionError = 0.0f, maxUVsError = 0.0f, maxModelNormalAngle = 0.0f;
+
+	for (const BMVertex& vertex : vertices)
+	{
+		uint16_t quantizedPosition[3];
+
+		quantizePosition(vertex.position, quantization, quantizedPosition);
+
+		glm::vec3 positionError = glm::abs(dequantizePosition(quantizedPosition, quantization) - vertex.position) / quantization.scale;
+		glm::vec2 uvsError = glm::abs(decodeHalf2(encodeHalf2(vertex.uvs)) - vertex.uvs) / glm::max(glm::abs(vertex.uvs), glm::vec2(1.0f));
+
+		maxPositionError = std::max(maxPositionError, std::max(positionError.x, std::max(positionError.y, positionError.z)));
+		maxUVsError = std::max(maxUVsError, std::max(uvsError.x, uvsError.y));
+
+		if (glm::length(vertex.normal) > 0.0f)
+		{
+			glm::vec3 normal = glm::normalize(vertex.normal);
+			float angle = std::acos(glm::clamp(glm::dot(decodeOctahedral(encodeOctahedral(normal)), normal), -1.0f, 1.0f));
+
+			maxModelNormalAngle = std::max(maxModelNormalAngle, angle);
+		}
+	}
+
+	// Random directions cover the whole octahedron, including the folded lower hemisphere and its seams.
+	float maxNormalAngle = 0.0f;
+	uint32_t weightSumErrors = 0;
+	float maxWeightError = 0.0f;
+
+	for (uint32_t i = 0; i < randomCount; i++)
+	{
+		glm::vec3 normal(randomFloat(-1.0f, 1.0f), randomFloat(-1.0f, 1.0f), randomFloat(-1.0f, 1.0f));
+
+		if (glm::length(normal) < 1e-3f)
+		{
+			continue;
+		}
+
+		normal = glm::normalize(normal);
+
+		float angle = std::acos(glm::clamp(glm::dot(decodeOctahedral(encodeOctahedral(normal)), normal), -1.0f, 1.0f));
+
+		maxNormalAngle = std::max(maxNormalAngle, angle);
+
+		int boneIDs[4] = { std::rand() % 256, std::rand() % 256, std::rand() % 2 == 0 ? -1 : std::rand() % 256, -1 };
+		float weights[4] = { randomFloat(0.0f, 1.0f), randomFloat(0.0f, 1.0f), randomFloat(0.0f, 1.0f), 0.0f };
+		float totalWeight = weights[0] + weights[1] + (boneIDs[2] != -1 ? weights[2] : 0.0f);
+		uint8_t encodedBoneIDs[4], encodedWeights[4];
+
+		encodeBoneWeights(boneIDs, weights, 4, encodedBoneIDs, encodedWeights);
+
+		if (encodedWeights[0] + encodedWeights[1] + encodedWeights[2] + encodedWeights[3] != 255 || encodedWeights[3] != 0)
+		{
+			weightSumErrors += 1;
+		}
+
+		for (uint32_t b = 0; b < 3; b++)
+		{
+			float expected = boneIDs[b] != -1 ? weights[b] / totalWeight : 0.0f;
+
+			maxWeightError = std::max(maxWeightError, std::abs(encodedWeights[b] / 255.0f - expected));
+		}
+	}
+
+	// Expected bounds: half a quantization step, half float precision (11 bits of mantissa), 0.05 degrees and one unit. The slack
+	// covers the float rounding of the round trips themselves (about 1% of a quantization step for positions of the AABB size).
+	const float positionBound = 0.5f / 65535.0f, uvsBound = 1.0f / 2048.0f, normalBound = glm::radians(0.05f), weightBound = 1.0f / 255.0f;
+	const float slack = 1.05f;
+
+	std::cout << '\t' << "[LOG] SELF TEST: positions (" << vertices.size() << "): max error " << maxPositionError << " of the AABB (bound " << positionBound << ")" << std::endl;
+	std::cout << '\t' << "[LOG] SELF TEST: UVs: max relative error " << maxUVsError << " (bound " << uvsBound << ")" << std::endl;
+	std::cout << '\t' << "[LOG] SELF TEST: normals: max error " << glm::degrees(maxModelNormalAngle) << " degrees (model), " << glm::degrees(maxNormalAngle)
+		<< " degrees (" << randomCount << " random, bound " << glm::degrees(normalBound) << ")" << std::endl;
+	std::cout << '\t' << "[LOG] SELF TEST: bone weights: max error " << maxWeightError << " (bound " << weightBound << "), " << weightSumErrors << " sums other than 255" << std::endl;
+
+	bool passed = true;
+
+	passed &= check(maxPositionError <= positionBound * slack, "vertex compression", "position error above half a quantization step");
+	passed &= check(maxUVsError <= uvsBound * slack, "vertex compression", "UVs error above the half float precision");
+	passed &= check(std::max(maxModelNormalAngle, maxNormalAngle) <= normalBound * slack, "vertex compression", "normal error above 0.05 degrees");
+	passed &= check(maxWeightError <= weightBound * slack, "vertex compression", "bone weight error above one unit");
+	passed &= check(weightSumErrors == 0, "vertex compression", "bone weights not summing 255");
+
+	return passed;
+}
+
+// Random vertices in an off-center AABB, with UVs beyond [0, 1] (tiled textures).
+static bool testRandomVertexCompression()
+{
+	AABBBounds aabb;
+
+	aabb.center = glm::vec3(120.0f, -3.5f, 40.0f);
+	aabb.extents = glm::vec3(250.0f, 4.0f, 75.0f);
+
+	std::vector<BMVertex> vertices(100000);
+
+	for (BMVertex& vertex : vertices)
+	{
+		vertex.position = aabb.center + aabb.extents * glm::vec3(randomFloat(-1.0f, 1.0f), randomFloat(-1.0f, 1.0f), randomFloat(-1.0f, 1.0f));
+		vertex.normal = glm::vec3(randomFloat(-1.0f, 1.0f), randomFloat(-1.0f, 1.0f), randomFloat(-1.0f, 1.0f));
+		vertex.uvs = glm::vec2(randomFloat(-8.0f, 8.0f), randomFloat(-8.0f, 8.0f));
+	}
+
+	return testVertexCompression(vertices, aabb);
+}
+
+int runSelfTests()
+{
+	uint32_t failed = 0;
+
+	// Fixed seed, so failures can be reproduced.
+	std::srand(1);
+
+	failed += testMeshSimplifier() ? 0 : 1;
+	failed += testMeshOptimizer() ? 0 : 1;
+	failed += testOcclusionCuller() ? 0 : 1;
+	failed += testRandomVertexCompression() ? 0 : 1;
+
+	if (failed > 0)
+	{
+		std::cout << "[ERROR] SELF TEST: " << failed << " tests failed." << std::endl;
+
+		return 1;
+	}
+
+	std::cout << "[LOG] SELF TEST: All tests passed." << std::endl;
+
+	return 0;
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cmath>
+#include <limits>
+#include <iostream>
+#include <array>
+#include <algorithm>
+#include <cstdlib>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/constants.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "../../graphics/basic_model.h"
+#include "../../systems/occlusion_culler.h"
+#include "../../utils/bounds.h"
+#include "../../utils/mesh_optimizer.h"
+#include "../../utils/mesh_simplifier.h"
+#include "../../utils/vertex_compression.h"
+
+// Development self tests ("--selftest" in the command line). They don't need an OpenGL context, print every check to the
+// console and return false when a result is out of its expected bounds.
+
+// Builds the LOD chains of a sphere (with a UV seam), a bumpy grid and a flat grid, checking the triangle count of every LOD
+// and that the surface deviation measured by brute force stays within the reported "MeshLod::error" (zero for the flat grid).
+bool testMeshSimplifier();
+
+// Optimizes a grid with shuffled triangles, checking that the ACMR drops, that the triangles (and their winding) are kept and
+// that the vertex fetch remap is a permutation whose remapped vertices draw the same triangles.
+bool testMeshOptimizer();
+
+// Rasterizes quad occluders with an orthographic camera (one unit per pixel), checking spheres behind, in front and across the
+// edges of the occluders and tiles, and that the tiles depth bounds match their pixels.
+bool testOcclusionCuller();
+
+// Round trips the vertices (quantized positions in "aabb", half UVs and octahedral normals), plus "randomCount" random normals and
+// bone weights, through the packed vertex encoders, checking their worst errors against the expected bounds.
+bool testVertexCompression(const std::vector<BMVertex>& vertices, const AABBBounds& aabb, uint32_t randomCount = 1000000);
+
+// Runs all the self tests. Returns the process exit code: 0 when all of them passed.
+int runSelfTests();
@@ -0,0 +1,192 @@
+#include "gpu_timer.h"
+
+const uint32_t GPUTimer::FRAME_LATENCY;
+const uint32_t GPUTimer::AVERAGE_SAMPLES;
+
+GPUTimer::Frame GPUTimer::frames[GPUTimer::FRAME_LATENCY];
+std::vector<uint32_t> GPUTimer::openScopes;
+
+std::vector<GPUTimer::Timer> GPUTimer::timers;
+
+uint64_t GPUTimer::currentFrame = 0;
+uint64_t GPUTimer::resolvedFrame = 0;
+uint32_t GPUTimer::droppedFrames = 0;
+
+void GPUTimer::beginFrame()
+{
+	if (!openScopes.empty())
+	{
+		std::cout << "[WARNING] GPU TIMER: " << openScopes.size() << " timers were not ended in frame " << currentFrame << "." << std::endl;
+
+		while (!openScopes.empty())
+		{
+			end();
+		}
+	}
+
+	currentFrame += 1;
+
+	Frame& frame = frames[currentFrame % FRAME_LATENCY];
+
+	// The queries of this slot were issued "FRAME_LATENCY" frames ago.
+	if (frame.number != 0)
+	{
+		resolveFrame(frame);
+	}
+
+	frame.number = currentFrame;
+	frame.usedQueries = 0;
+	frame.scopes.clear();
+}
+
+void GPUTimer::begin(const char* name)
+{
+	Frame& frame = frames[currentFrame % FRAME_LATENCY];
+
+	if (frame.number == 0)
+	{
+		return; // No frame started yet (e.g. while loading a scene).
+	}
+
+	Scope scope{ findTimer(name, uint32_t(openScopes.size())), 0, 0 };
+
+	scope.beginQuery = issueTimestamp(frame);
+
+	openScopes.push_back(uint32_t(frame.scopes.size()));
+	frame.scopes.push_back(scope);
+}
+
+void GPUTimer::end()
+{
+	Frame& frame = frames[currentFrame % FRAME_LATENCY];
+
+	if (openScopes.empty())
+	{
+		return;
+	}
+
+	frame.scopes[openScopes.back()].endQuery = issueTimestamp(frame);
+
+	openScopes.pop_back();
+}
+
+void GPUTimer::clean()
+{
+	for (Frame& frame : frames)
+	{
+		if (!frame.queries.empty())
+		{
+			glDeleteQueries(int(frame.queries.size()), frame.queries.data());
+		}
+
+		frame.queries.clear();
+		frame.scopes.clear();
+		frame.usedQueries = 0;
+		frame.number = 0;
+	}
+
+	openScopes.clear();
+	timers.clear();
+
+	currentFrame = 0;
+	resolvedFrame = 0;
+	droppedFrames = 0;
+}
+
+uint32_t GPUTimer::findTimer(const char* name, uint32_t depth)
+{
+	for (uint32_t i = 0; i < timers.size(); i++)
+	{
+		if (timers[i].depth == depth && timers[i].name == name)
+		{
+			return i;
+		}
+	}
+
+	timers.push_back({ name, depth, 0.0f, 0.0f, {}, 0, 0, 0 });
+
+	return uint32_t(timers.size()) - 1;
+}
+
+uint32_t GPUTimer::issueTimestamp(Frame& frame)
+{
+	if (frame.usedQueries == frame.queries.size())
+	{
+		uint32_t query = 0;
+
+		glGenQueries(1, &query);
+
+		frame.queries.push_back(query);
+	}
+
+	glQueryCounter(frame.queries[frame.usedQueries], GL_TIMESTAMP);
+
+	return frame.usedQueries++;
+}
+
+void GPUTimer::resolveFrame(Frame& frame)
+{
+	if (frame.usedQueries == 0)
+	{
+		return;
+	}
+
+	// Queries complete in order, the last one is enough to know that the whole frame is ready.
+	int available = 0;
+
+	glGetQueryObjectiv(frame.queries[frame.usedQueries - 1], GL_QUERY_RESULT_AVAILABLE, &available);
+
+	if (!available)
+	{
+		droppedFrames += 1;
+
+		return;
+	}
+
+	std::vector<uint64_t> timestamps(frame.usedQueries);
+
+	for (uint32_t i = 0; i < frame.usedQueries; i++)
+	{
+		glGetQueryObjectui64v(frame.queries[i], GL_QUERY_RESULT, &timestamps[i]);
+	}
+
+	// Timers hit several times in the frame report their total.
+	std::vector<float> frameTimes(timers.size(), 0.0f);
+	std::vector<bool> hit(timers.size(), false);
+
+	for (const Scope& scope : frame.scopes)
+	{
+		frameTimes[scope.timer] += float(double(timestamps[scope.endQuery] - timestamps[scope.beginQuery]) / 1000000.0);
+		hit[scope.timer] = true;
+	}
+
+	for (uint32_t i = 0; i < timers.size(); i++)
+	{
+		if (hit[i])
+		{
+			addSample(timers[i], frameTimes[i]);
+
+			timers[i].lastFrame = frame.number;
+		}
+	}
+
+	resolvedFrame = frame.number;
+}
+
+void GPUTimer::addSample(Timer& timer, float time)
+{
+	timer.lastTime = time;
+
+	timer.samples[timer.nextSample] = time;
+	timer.nextSample = (timer.nextSample + 1) % AVERAGE_SAMPLES;
+	timer.sampleCount = std::min(timer.sampleCount + 1, AVERAGE_SAMPLES);
+
+	float sum = 0.0f;
+
+	for (uint32_t i = 0; i < timer.sampleCount; i++)
+	{
+		sum += timer.samples[i];
+	}
+
+	timer.averageTime = sum / float(timer.sampleCount);
+}
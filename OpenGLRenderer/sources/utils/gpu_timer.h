@@ -0,0 +1,87 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <algorithm>
+#include <iostream>
+
+#include <glad/glad.h>
+
+// GPU time of the passes of a frame, measured with "GL_TIMESTAMP" queries.
+//
+// Every "begin"/"end" pair writes two timestamps into the command stream. The queries of a frame are only read back
+// "FRAME_LATENCY" frames later, when the GPU is done with them, so reading the results never stalls the pipeline.
+// Timestamps (unlike "GL_TIME_ELAPSED") can be nested: a pass may be timed inside the frame and its draws inside the pass.
+//
+// Timers are identified by their name and nesting depth. A timer hit several times in a frame reports the sum.
+//
+class GPUTimer
+{
+public:
+	// Frames in flight before the queries of a frame are read.
+	static const uint32_t FRAME_LATENCY = 4;
+
+	// Frames in the rolling average of every timer.
+	static const uint32_t AVERAGE_SAMPLES = 64;
+
+	struct Timer
+	{
+		std::string name;
+		uint32_t depth;
+
+		float lastTime; // Milliseconds.
+		float averageTime;
+
+		float samples[AVERAGE_SAMPLES];
+		uint32_t sampleCount, nextSample;
+
+		uint64_t lastFrame; // Last frame with results for this timer.
+	};
+
+	// Starts a new frame, reading the results of the frame issued "FRAME_LATENCY" frames ago.
+	static void beginFrame();
+
+	static void begin(const char* name);
+	static void end();
+
+	static void clean();
+
+	// Timers in the order they were first seen. Only the ones with "lastFrame == getResolvedFrame()" ran in the last results.
+	static const std::vector<Timer>& getTimers() { return timers; }
+	static uint64_t getResolvedFrame() { return resolvedFrame; }
+
+	// Frames whose results were not ready after "FRAME_LATENCY" frames, so they were discarded instead of waited for.
+	static uint32_t getDroppedFrames() { return droppedFrames; }
+
+private:
+	struct Scope
+	{
+		uint32_t timer;
+		uint32_t beginQuery, endQuery; // Indices in "Frame::queries".
+	};
+
+	struct Frame
+	{
+		uint64_t number;
+
+		std::vector<uint32_t> queries; // Grown on demand, reused every "FRAME_LATENCY" frames.
+		uint32_t usedQueries;
+
+		std::vector<Scope> scopes;
+	};
+
+	static Frame frames[FRAME_LATENCY];
+	static std::vector<uint32_t> openScopes; // Indices in the "scopes" of the current frame.
+
+	static std::vector<Timer> timers;
+
+	static uint64_t currentFrame, resolvedFrame;
+	static uint32_t droppedFrames;
+
+	static uint32_t findTimer(const char* name, uint32_t depth);
+	static uint32_t issueTimestamp(Frame& frame);
+
+	static void resolveFrame(Frame& frame);
+	static void addSample(Timer& timer, float time);
+};
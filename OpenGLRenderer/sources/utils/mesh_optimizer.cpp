@@ -0,0 +1,417 @@
+#include "mesh_optimizer.h"
+
+// Forsyth's scoring. The cache is only a heuristic here (its size doesn't have to match the GPU), 32 entries works well in practice.
+static const uint32_t SCORING_CACHE_SIZE = 32;
+
+static const float CACHE_DECAY_POWER = 1.5f;
+static const float LAST_TRIANGLE_SCORE = 0.75f;
+static const float VALENCE_BOOST_SCALE = 2.0f;
+static const float VALENCE_BOOST_POWER = 0.5f;
+
+static float computeVertexScore(int cachePosition, uint32_t remainingTriangles)
+{
+	// Vertices without triangles left must never attract new ones.
+	if (remainingTriangles == 0)
+	{
+		return -1.0f;
+	}
+
+	float score = 0.0f;
+
+	if (cachePosition >= 0)
+	{
+		// The vertices of the last triangle get a fixed score, otherwise the optimizer would favor strips too much.
+		if (cachePosition < 3)
+		{
+			score = LAST_TRIANGLE_SCORE;
+		}
+		else
+		{
+			score = std::pow(1.0f - float(cachePosition - 3) / float(SCORING_CACHE_SIZE - 3), CACHE_DECAY_POWER);
+		}
+	}
+
+	// Vertices with few triangles left are boosted, so they are finished before leaving the cache (no isolated triangles).
+	return score + VALENCE_BOOST_SCALE * std::pow(float(remainingTriangles), -VALENCE_BOOST_POWER);
+}
+
+// FIFO cache simulation, "timestamps" must be zeroed and "time" must start above "cacheSize". Returns the misses of the triangle.
+static uint32_t updateFIFOCache(const uint32_t* triangle, std::vector<uint32_t>& timestamps, uint32_t& time, uint32_t cacheSize)
+{
+	uint32_t misses = 0;
+
+	for (uint32_t i = 0; i < 3; i++)
+	{
+		if (time - timestamps[triangle[i]] > cacheSize)
+		{
+			timestamps[triangle[i]] = time;
+			time += 1;
+
+			misses += 1;
+		}
+	}
+
+	return misses;
+}
+
+float MeshOptimizer::computeACMR(const uint32_t* indices, uint32_t indexCount, uint32_t vertexCount, uint32_t cacheSize)
+{
+	uint32_t triangleCount = indexCount / 3;
+
+	if (triangleCount == 0)
+	{
+		return 0.0f;
+	}
+
+	std::vector<uint32_t> timestamps(vertexCount, 0);
+	uint32_t time = cacheSize + 1;
+	uint32_t misses = 0;
+
+	for (uint32_t triangle = 0; triangle < triangleCount; triangle++)
+	{
+		misses += updateFIFOCache(&indices[triangle * 3], timestamps, time, cacheSize);
+	}
+
+	return float(misses) / float(triangleCount);
+}
+
+void MeshOptimizer::optimizeVertexCache(uint32_t* indices, uint32_t indexCount, uint32_t vertexCount)
+{
+	uint32_t triangleCount = indexCount / 3;
+
+	if (triangleCount == 0)
+	{
+		return;
+	}
+
+	// Triangles of every vertex (compressed rows). Emitted triangles are swapped out of the first "remainingTriangles" of the row.
+	std::vector<uint32_t> remainingTriangles(vertexCount, 0);
+	std::vector<uint32_t> adjacencyOffsets(vertexCount + 1, 0);
+	std::vector<uint32_t> adjacency(triangleCount * 3);
+
+	for (uint32_t i = 0; i < triangleCount * 3; i++)
+	{
+		remainingTriangles[indices[i]] += 1;
+	}
+
+	for (uint32_t vertex = 0; vertex < vertexCount; vertex++)
+	{
+		adjacencyOffsets[vertex + 1] = adjacencyOffsets[vertex] + remainingTriangles[vertex];
+	}
+
+	{
+		std::vector<uint32_t> fill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+
+		for (uint32_t i = 0; i < triangleCount * 3; i++)
+		{
+			adjacency[fill[indices[i]]++] = i / 3;
+		}
+	}
+
+	std::vector<int> cachePositions(vertexCount, -1);
+	std::vector<float> vertexScores(vertexCount);
+	std::vector<float> triangleScores(triangleCount, 0.0f);
+	std::vector<bool> emitted(triangleCount, false);
+
+	for (uint32_t vertex = 0; vertex < vertexCount; vertex++)
+	{
+		vertexScores[vertex] = computeVertexScore(-1, remainingTriangles[vertex]);
+	}
+
+	for (uint32_t i = 0; i < triangleCount * 3; i++)
+	{
+		triangleScores[i / 3] += vertexScores[indices[i]];
+	}
+
+	std::vector<uint32_t> result;
+	std::vector<uint32_t> cache, newCache;
+
+	result.reserve(triangleCount * 3);
+	cache.reserve(SCORING_CACHE_SIZE + 3);
+	newCache.reserve(SCORING_CACHE_SIZE + 3);
+
+	int bestTriangle = int(std::max_element(triangleScores.begin(), triangleScores.end()) - triangleScores.begin());
+	uint32_t inputCursor = 0;
+
+	while (result.size() < triangleCount * 3)
+	{
+		// The cache has nothing to offer: starting again from the next triangle in the input order.
+		if (bestTriangle < 0)
+		{
+			while (emitted[inputCursor])
+			{
+				inputCursor += 1;
+			}
+
+			bestTriangle = int(inputCursor);
+		}
+
+		const uint32_t* triangle = &indices[bestTriangle * 3];
+
+		emitted[bestTriangle] = true;
+		newCache.clear();
+
+		for (uint32_t i = 0; i < 3; i++)
+		{
+			uint32_t vertex = triangle[i];
+			uint32_t* row = &adjacency[adjacencyOffsets[vertex]];
+
+			result.push_back(vertex);
+
+			// Degenerate triangles reference the same vertex more than once, but only appear once in its row.
+			uint32_t* position = std::find(row, row + remainingTriangles[vertex], uint32_t(bestTriangle));
+
+			if (position != row + remainingTriangles[vertex])
+			{
+				std::swap(*position, row[remainingTriangles[vertex] - 1]);
+
+				remainingTriangles[vertex] -= 1;
+			}
+
+			if (std::find(newCache.begin(), newCache.end(), vertex) == newCache.end())
+			{
+				newCache.push_back(vertex);
+			}
+		}
+
+		for (uint32_t vertex : cache)
+		{
+			if (std::find(newCache.begin(), newCache.end(), vertex) == newCache.end())
+			{
+				newCache.push_back(vertex);
+			}
+		}
+
+		// Updating the scores of the vertices that moved in (or out of) the cache, and of their triangles.
+		for (uint32_t i = 0; i < newCache.size(); i++)
+		{
+			uint32_t vertex = newCache[i];
+
+			cachePositions[vertex] = i < SCORING_CACHE_SIZE ? int(i) : -1;
+
+			float score = computeVertexScore(cachePositions[vertex], remainingTriangles[vertex]);
+			float delta = score - vertexScores[vertex];
+
+			vertexScores[vertex] = score;
+
+			for (uint32_t t = 0; t < remainingTriangles[vertex]; t++)
+			{
+				triangleScores[adjacency[adjacencyOffsets[vertex] + t]] += delta;
+			}
+		}
+
+		cache.assign(newCache.begin(), newCache.begin() + std::min(uint32_t(newCache.size()), SCORING_CACHE_SIZE));
+
+		// Next triangle: the best one using a vertex in the cache.
+		float bestScore = -1.0f;
+
+		bestTriangle = -1;
+
+		for (uint32_t vertex : cache)
+		{
+			for (uint32_t t = 0; t < remainingTriangles[vertex]; t++)
+			{
+				uint32_t candidate = adjacency[adjacencyOffsets[vertex] + t];
+
+				if (triangleScores[candidate] > bestScore)
+				{
+					bestScore = triangleScores[candidate];
+					bestTriangle = int(candidate);
+				}
+			}
+		}
+	}
+
+	std::copy(result.begin(), result.end(), indices);
+}
+
+void MeshOptimizer::optimizeOverdraw(uint32_t* indices, uint32_t indexCount, const std::vector<glm::vec3>& positions, float threshold)
+{
+	uint32_t triangleCount = indexCount / 3;
+	uint32_t vertexCount = uint32_t(positions.size());
+
+	if (triangleCount < 2)
+	{
+		return;
+	}
+
+	// Hard boundaries: triangles where the cache optimizer started over (all their vertices are misses).
+	std::vector<uint32_t> hardClusters;
+	std::vector<uint32_t> timestamps(vertexCount, 0);
+	uint32_t time = SIMULATED_CACHE_SIZE + 1;
+
+	for (uint32_t triangle = 0; triangle < triangleCount; triangle++)
+	{
+		if (updateFIFOCache(&indices[triangle * 3], timestamps, time, SIMULATED_CACHE_SIZE) == 3)
+		{
+			hardClusters.push_back(triangle);
+		}
+	}
+
+	hardClusters.push_back(triangleCount);
+
+	// Soft boundaries: splitting the hard clusters further, as long as every piece keeps an ACMR close to the whole cluster.
+	std::vector<uint32_t> clusters;
+
+	for (uint32_t c = 0; c + 1 < hardClusters.size(); c++)
+	{
+		uint32_t start = hardClusters[c], end = hardClusters[c + 1];
+		uint32_t misses = 0, triangles = 0;
+
+		// ACMR of the whole cluster, reusing the timestamps of the boundaries (the cache is cleared before each simulation).
+		time += SIMULATED_CACHE_SIZE + 1;
+
+		for (uint32_t triangle = start; triangle < end; triangle++)
+		{
+			misses += updateFIFOCache(&indices[triangle * 3], timestamps, time, SIMULATED_CACHE_SIZE);
+		}
+
+		float clusterACMR = float(misses) / float(end - start);
+
+		misses = 0;
+
+		time += SIMULATED_CACHE_SIZE + 1; // Clears the cache.
+
+		clusters.push_back(start);
+
+		for (uint32_t triangle = start; triangle < end; triangle++)
+		{
+			misses += updateFIFOCache(&indices[triangle * 3], timestamps, time, SIMULATED_CACHE_SIZE);
+			triangles += 1;
+
+			if (triangle + 1 < end && float(misses) / float(triangles) <= threshold * clusterACMR)
+			{
+				clusters.push_back(triangle + 1);
+
+				time += SIMULATED_CACHE_SIZE + 1;
+				misses = 0;
+				triangles = 0;
+			}
+		}
+	}
+
+	clusters.push_back(triangleCount);
+
+	// Sorting the clusters from the outside of the mesh to the inside: the position of the cluster relative to the mesh center,
+	// along its average normal. Outer clusters are usually in front of the ones they cover.
+	uint32_t clusterCount = uint32_t(clusters.size()) - 1;
+
+	std::vector<glm::vec3> clusterCentroids(clusterCount, glm::vec3(0.0f));
+	std::vector<glm::vec3> clusterNormals(clusterCount, glm::vec3(0.0f));
+	glm::vec3 meshCentroid(0.0f);
+	float meshArea = 0.0f;
+
+	for (uint32_t c = 0; c < clusterCount; c++)
+	{
+		float clusterArea = 0.0f;
+
+		for (uint32_t triangle = clusters[c]; triangle < clusters[c + 1]; triangle++)
+		{
+			const glm::vec3& p0 = positions[indices[triangle * 3 + 0]];
+			const glm::vec3& p1 = positions[indices[triangle * 3 + 1]];
+			const glm::vec3& p2 = positions[indices[triangle * 3 + 2]];
+
+			glm::vec3 normal = glm::cross(p1 - p0, p2 - p0); // Twice the area, weighting the normal and the centroid.
+			float area = glm::length(normal);
+
+			clusterCentroids[c] += (p0 + p1 + p2) * (area / 3.0f);
+			clusterNormals[c] += normal;
+			clusterArea += area;
+		}
+
+		meshCentroid += clusterCentroids[c];
+		meshArea += clusterArea;
+
+		clusterCentroids[c] = clusterArea > 0.0f ? clusterCentroids[c] / clusterArea : positions[indices[clusters[c] * 3]];
+	}
+
+	meshCentroid = meshArea > 0.0f ? meshCentroid / meshArea : meshCentroid;
+
+	std::vector<float> sortKeys(clusterCount);
+	std::vector<uint32_t> order(clusterCount);
+
+	for (uint32_t c = 0; c < clusterCount; c++)
+	{
+		float normalLength = glm::length(clusterNormals[c]);
+		glm::vec3 normal = normalLength > 0.0f ? clusterNormals[c] / normalLength : glm::vec3(0.0f);
+
+		sortKeys[c] = glm::dot(clusterCentroids[c] - meshCentroid, normal);
+		order[c] = c;
+	}
+
+	std::stable_sort(order.begin(), order.end(), [&sortKeys](uint32_t a, uint32_t b) { return sortKeys[a] > sortKeys[b]; });
+
+	std::vector<uint32_t> result;
+
+	result.reserve(triangleCount * 3);
+
+	for (uint32_t c : order)
+	{
+		result.insert(result.end(), indices + clusters[c] * 3, indices + clusters[c + 1] * 3);
+	}
+
+	std::copy(result.begin(), result.end(), indices);
+}
+
+std::vector<uint32_t> MeshOptimizer::optimizeVertexFetch(std::vector<uint32_t>& indices, uint32_t vertexCount)
+{
+	const uint32_t UNUSED = ~0u;
+
+	std::vector<uint32_t> remap(vertexCount, UNUSED);
+	uint32_t nextVertex = 0;
+
+	for (uint32_t& index : indices)
+	{
+		if (remap[index] == UNUSED)
+		{
+			remap[index] = nextVertex;
+			nextVertex += 1;
+		}
+
+		index = remap[index];
+	}
+
+	for (uint32_t& newIndex : remap)
+	{
+		if (newIndex == UNUSED)
+		{
+			newIndex = nextVertex;
+			nextVertex += 1;
+		}
+	}
+
+	return remap;
+}
+
+std::vector<uint32_t> MeshOptimizer::optimize(const std::vector<glm::vec3>& positions, std::vector<uint32_t>& indices, const std::vector<MeshLod>& lods,
+	float* acmrBefore, float* acmrAfter)
+{
+	uint32_t vertexCount = uint32_t(positions.size());
+
+	if (acmrBefore)
+	{
+		*acmrBefore = lods.empty() ? 0.0f : computeACMR(&indices[lods[0].indexOffset], lods[0].indexCount, vertexCount);
+	}
+
+	// LODs are independent index buffers over the same vertices, each one is optimized by itself.
+	for (const MeshLod& lod : lods)
+	{
+		if (lod.indexCount == 0)
+		{
+			continue;
+		}
+
+		optimizeVertexCache(&indices[lod.indexOffset], lod.indexCount, vertexCount);
+		optimizeOverdraw(&indices[lod.indexOffset], lod.indexCount, positions);
+	}
+
+	// The first use of every vertex is in the LOD 0, which is the most drawn up close.
+	std::vector<uint32_t> remap = optimizeVertexFetch(indices, vertexCount);
+
+	if (acmrAfter)
+	{
+		*acmrAfter = lods.empty() ? 0.0f : computeACMR(&indices[lods[0].indexOffset], lods[0].indexCount, vertexCount);
+	}
+
+	return remap;
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cmath>
+#include <algorithm>
+
+#include <glm/glm.hpp>
+
+#include "../utils/mesh_simplifier.h"
+
+// Import time reordering of triangles and vertices, so the GPU does less work for the same mesh:
+//
+//   1. Vertex cache: triangles are reordered (Forsyth's "Linear-Speed Vertex Cache Optimisation") so the vertices shaded
+//      by a triangle are likely reused by the next ones, instead of being shaded again.
+//   2. Overdraw: the cache optimized triangles are split into clusters, which are sorted front to back from the outside of
+//      the mesh (Sander et al. "Fast Triangle Reordering for Vertex Locality and Reduced Overdraw"). Clusters keep their
+//      internal order, so the cache efficiency is mostly preserved.
+//   3. Vertex fetch: vertices are reordered by first use, so the vertex buffer is read almost sequentially.
+//
+// The efficiency of the vertex cache is measured as the average cache miss ratio (ACMR): shaded vertices per triangle.
+// It goes from 3 (no reuse) down to about 0.5 (every vertex shaded once in a regular grid).
+//
+class MeshOptimizer
+{
+public:
+	// Size of the FIFO cache simulated by "computeACMR". Recent GPUs don't have a fixed size cache, but it is still a good estimate.
+	static const uint32_t SIMULATED_CACHE_SIZE = 16;
+
+	static float computeACMR(const uint32_t* indices, uint32_t indexCount, uint32_t vertexCount, uint32_t cacheSize = SIMULATED_CACHE_SIZE);
+
+	static void optimizeVertexCache(uint32_t* indices, uint32_t indexCount, uint32_t vertexCount);
+
+	// Expects cache optimized indices. Clusters are only split where the ACMR stays below "threshold" times the original one.
+	static void optimizeOverdraw(uint32_t* indices, uint32_t indexCount, const std::vector<glm::vec3>& positions, float threshold = 1.05f);
+
+	// Rewrites the indices and returns the new index of every vertex (unused vertices are moved to the end).
+	static std::vector<uint32_t> optimizeVertexFetch(std::vector<uint32_t>& indices, uint32_t vertexCount);
+
+	// Applies the three steps to every LOD of the mesh, returning the vertex remap of "optimizeVertexFetch".
+	// Writes the ACMR of the LOD 0 before and after into "acmrBefore" and "acmrAfter".
+	static std::vector<uint32_t> optimize(const std::vector<glm::vec3>& positions, std::vector<uint32_t>& indices, const std::vector<MeshLod>& lods,
+		float* acmrBefore = nullptr, float* acmrAfter = nullptr);
+
+	// Moves every vertex to the position given by "remap".
+	template<typename T>
+	static void remapVertices(std::vector<T>& vertices, const std::vector<uint32_t>& remap)
+	{
+		std::vector<T> remapped(vertices.size());
+
+		for (size_t i = 0; i < vertices.size(); i++)
+		{
+			remapped[remap[i]] = vertices[i];
+		}
+
+		vertices.swap(remapped);
+	}
+};
@@ -0,0 +1,533 @@
+#include "mesh_simplifier.h"
+
+// Symmetric 4x4 matrix stored as its 10 unique coefficients.
+struct Quadric
+{
+	double a2 = 0.0, ab = 0.0, ac = 0.0, ad = 0.0;
+	double b2 = 0.0, bc = 0.0, bd = 0.0;
+	double c2 = 0.0, cd = 0.0;
+	double d2 = 0.0;
+
+	double weight = 0.0; // Sum of the weights of the planes.
+
+	static Quadric fromPlane(double a, double b, double c, double d, double weight)
+	{
+		Quadric q;
+
+		q.a2 = a * a * weight; q.ab = a * b * weight; q.ac = a * c * weight; q.ad = a * d * weight;
+		q.b2 = b * b * weight; q.bc = b * c * weight; q.bd = b * d * weight;
+		q.c2 = c * c * weight; q.cd = c * d * weight;
+		q.d2 = d * d * weight;
+
+		q.weight = weight;
+
+		return q;
+	}
+
+	void add(const Quadric& other)
+	{
+		a2 += other.a2; ab += other.ab; ac += other.ac; ad += other.ad;
+		b2 += other.b2; bc += other.bc; bd += other.bd;
+		c2 += other.c2; cd += other.cd;
+		d2 += other.d2;
+
+		weight += other.weight;
+	}
+
+	// Weighted mean of the squared distances from "p" to the planes of the quadric.
+	double evaluate(const glm::vec3& p) const
+	{
+		double x = p.x, y = p.y, z = p.z;
+
+		double error = a2 * x * x + 2.0 * ab * x * y + 2.0 * ac * x * z + 2.0 * ad * x
+			+ b2 * y * y + 2.0 * bc * y * z + 2.0 * bd * y
+			+ c2 * z * z + 2.0 * cd * z
+			+ d2;
+
+		return weight > 0.0 ? std::max(error, 0.0) / weight : 0.0;
+	}
+};
+
+struct Collapse
+{
+	double cost;
+
+	uint32_t from, to; // Welded vertices.
+	uint32_t fromVersion, toVersion;
+
+	bool operator>(const Collapse& other) const { return cost > other.cost; }
+};
+
+static uint64_t getEdgeKey(uint32_t a, uint32_t b)
+{
+	return a < b ? (uint64_t(a) << 32) | b : (uint64_t(b) << 32) | a;
+}
+
+struct PositionHash
+{
+	size_t operator()(const glm::vec3& p) const
+	{
+		uint32_t h[3];
+
+		std::memcpy(h, &p, sizeof(h));
+
+		return size_t(h[0] * 73856093u ^ h[1] * 19349663u ^ h[2] * 83492791u);
+	}
+};
+
+static double getMeshSize(const std::vector<glm::vec3>& positions)
+{
+	glm::vec3 minAABB = positions[0], maxAABB = positions[0];
+
+	for (const glm::vec3& position : positions)
+	{
+		minAABB = glm::min(minAABB, position);
+		maxAABB = glm::max(maxAABB, position);
+	}
+
+	return std::max(double(glm::length(maxAABB - minAABB)), 1e-12);
+}
+
+// Closest point of a triangle (Ericson, "Real-Time Collision Detection", 5.1.5).
+static glm::dvec3 closestPointOnTriangle(const glm::dvec3& p, const glm::dvec3& a, const glm::dvec3& b, const glm::dvec3& c)
+{
+	glm::dvec3 ab = b - a, ac = c - a, ap = p - a;
+
+	double d1 = glm::dot(ab, ap), d2 = glm::dot(ac, ap);
+
+	if (d1 <= 0.0 && d2 <= 0.0) { return a; }
+
+	glm::dvec3 bp = p - b;
+	double d3 = glm::dot(ab, bp), d4 = glm::dot(ac, bp);
+
+	if (d3 >= 0.0 && d4 <= d3) { return b; }
+
+	double vc = d1 * d4 - d3 * d2;
+
+	if (vc <= 0.0 && d1 >= 0.0 && d3 <= 0.0) { return a + ab * (d1 / (d1 - d3)); }
+
+	glm::dvec3 cp = p - c;
+	double d5 = glm::dot(ab, cp), d6 = glm::dot(ac, cp);
+
+	if (d6 >= 0.0 && d5 <= d6) { return c; }
+
+	double vb = d5 * d2 - d1 * d6;
+
+	if (vb <= 0.0 && d2 >= 0.0 && d6 <= 0.0) { return a + ac * (d2 / (d2 - d6)); }
+
+	double va = d3 * d6 - d5 * d4;
+
+	if (va <= 0.0 && (d4 - d3) >= 0.0 && (d5 - d6) >= 0.0) { return b + (c - b) * ((d4 - d3) / ((d4 - d3) + (d5 - d6))); }
+
+	double denominator = 1.0 / (va + vb + vc);
+
+	return a + ab * (vb * denominator) + ac * (vc * denominator);
+}
+
+// Largest distance from a vertex of "sourceIndices" to the surface of "simplifiedIndices". The simplified triangles are binned
+// into a uniform grid, searched in rings around every vertex until no unvisited cell can be closer than the best triangle.
+static double measureDeviation(const std::vector<glm::vec3>& positions, const std::vector<uint32_t>& sourceIndices, const std::vector<uint32_t>& simplifiedIndices)
+{
+	if (sourceIndices.empty() || simplifiedIndices.empty())
+	{
+		return 0.0;
+	}
+
+	glm::dvec3 minAABB(positions[simplifiedIndices[0]]), maxAABB = minAABB;
+
+	for (uint32_t index : simplifiedIndices)
+	{
+		minAABB = glm::min(minAABB, glm::dvec3(positions[index]));
+		maxAABB = glm::max(maxAABB, glm::dvec3(positions[index]));
+	}
+
+	// About one triangle per cell.
+	uint32_t triangleCount = uint32_t(simplifiedIndices.size() / 3);
+	glm::dvec3 size = glm::max(maxAABB - minAABB, glm::dvec3(1e-12));
+	double cellSize = std::max(std::cbrt(size.x * size.y * size.z / double(triangleCount)), glm::length(size) / 256.0);
+	glm::ivec3 resolution = glm::clamp(glm::ivec3(glm::ceil(size / cellSize)), glm::ivec3(1), glm::ivec3(256));
+
+	auto getCell = [&](const glm::dvec3& p) { return glm::clamp(glm::ivec3(glm::floor((p - minAABB) / cellSize)), glm::ivec3(0), resolution - 1); };
+
+	std::vector<std::vector<uint32_t>> cells(size_t(resolution.x) * resolution.y * resolution.z);
+
+	for (uint32_t t = 0; t < triangleCount; t++)
+	{
+		glm::dvec3 p0 = positions[simplifiedIndices[3 * t + 0]], p1 = positions[simplifiedIndices[3 * t + 1]], p2 = positions[simplifiedIndices[3 * t + 2]];
+		glm::ivec3 minCell = getCell(glm::min(glm::min(p0, p1), p2)), maxCell = getCell(glm::max(glm::max(p0, p1), p2));
+
+		for (int z = minCell.z; z <= maxCell.z; z++)
+		{
+			for (int y = minCell.y; y <= maxCell.y; y++)
+			{
+				for (int x = minCell.x; x <= maxCell.x; x++)
+				{
+					cells[(size_t(z) * resolution.y + y) * resolution.x + x].push_back(t);
+				}
+			}
+		}
+	}
+
+	std::vector<uint8_t> measured(positions.size(), 0);
+	double deviation = 0.0;
+
+	for (uint32_t index : sourceIndices)
+	{
+		if (measured[index])
+		{
+			continue;
+		}
+
+		measured[index] = 1;
+
+		glm::dvec3 p = positions[index];
+		glm::ivec3 cell = getCell(p);
+
+		// Points outside the grid are at least this far from its border cells.
+		glm::dvec3 outside = glm::max(glm::max(minAABB - p, p - maxAABB), glm::dvec3(0.0));
+		double best = std::numeric_limits<double>::max();
+
+		for (int ring = 0; ring <= glm::compMax(resolution); ring++)
+		{
+			// Every cell of this ring (and beyond) is at least "ring - 1" cells away.
+			if (ring > 0 && best <= std::max(glm::length(outside), double(ring - 1) * cellSize))
+			{
+				break;
+			}
+
+			glm::ivec3 minCell = glm::max(cell - ring, glm::ivec3(0)), maxCell = glm::min(cell + ring, resolution - 1);
+
+			for (int z = minCell.z; z <= maxCell.z; z++)
+			{
+				for (int y = minCell.y; y <= maxCell.y; y++)
+				{
+					for (int x = minCell.x; x <= maxCell.x; x++)
+					{
+						if (glm::compMax(glm::abs(glm::ivec3(x, y, z) - cell)) != ring)
+						{
+							continue;
+						}
+
+						for (uint32_t t : cells[(size_t(z) * resolution.y + y) * resolution.x + x])
+						{
+							glm::dvec3 closest = closestPointOnTriangle(p, positions[simplifiedIndices[3 * t + 0]], positions[simplifiedIndices[3 * t + 1]], positions[simplifiedIndices[3 * t + 2]]);
+
+							best = std::min(best, glm::length(p - closest));
+						}
+					}
+				}
+			}
+		}
+
+		deviation = std::max(deviation, best);
+	}
+
+	return deviation;
+}
+
+std::vector<uint32_t> MeshSimplifier::simplify(const std::vector<glm::vec3>& positions, const std::vector<uint32_t>& indices,
+	uint32_t targetIndexCount, float maxError, float* resultError)
+{
+	uint32_t vertexCount = uint32_t(positions.size());
+	uint32_t triangleCount = uint32_t(indices.size() / 3);
+
+	if (resultError)
+	{
+		*resultError = 0.0f;
+	}
+
+	if (indices.size() <= targetIndexCount || vertexCount == 0)
+	{
+		return indices;
+	}
+
+	// Welding vertices by position: the topology is built over welded vertices, the triangles keep their original ones (wedges).
+	std::vector<uint32_t> welded(vertexCount);
+	std::vector<uint32_t> wedgeCounts(vertexCount, 0);
+
+	{
+		std::unordered_map<glm::vec3, uint32_t, PositionHash> firstVertices;
+
+		for (uint32_t i = 0; i < vertexCount; i++)
+		{
+			welded[i] = firstVertices.insert({ positions[i], i }).first->second;
+			wedgeCounts[welded[i]] += 1;
+		}
+	}
+
+	// Errors are measured relative to the mesh size, so the same threshold works for every model.
+	double meshSize = getMeshSize(positions);
+	double maxCost = double(maxError) * meshSize * double(maxError) * meshSize;
+
+	std::vector<uint32_t> triangles(indices);
+	std::vector<uint8_t> aliveTriangles(triangleCount, 1);
+	std::vector<std::vector<uint32_t>> vertexTriangles(vertexCount);
+	std::vector<Quadric> quadrics(vertexCount);
+	std::vector<uint32_t> versions(vertexCount, 0);
+	std::vector<uint8_t> locked(vertexCount, 0);
+	std::unordered_map<uint64_t, uint32_t> edgeUses;
+
+	for (uint32_t t = 0; t < triangleCount; t++)
+	{
+		uint32_t w[3] = { welded[triangles[3 * t + 0]], welded[triangles[3 * t + 1]], welded[triangles[3 * t + 2]] };
+
+		glm::dvec3 p0 = positions[w[0]], p1 = positions[w[1]], p2 = positions[w[2]];
+		glm::dvec3 normal = glm::cross(p1 - p0, p2 - p0);
+		double area = glm::length(normal);
+
+		if (area > 0.0)
+		{
+			normal /= area;
+
+			// Area weighted, so big triangles count more than small ones.
+			Quadric quadric = Quadric::fromPlane(normal.x, normal.y, normal.z, -glm::dot(normal, p0), area * 0.5);
+
+			for (uint32_t i = 0; i < 3; i++)
+			{
+				quadrics[w[i]].add(quadric);
+			}
+		}
+
+		for (uint32_t i = 0; i < 3; i++)
+		{
+			vertexTriangles[w[i]].push_back(t);
+			edgeUses[getEdgeKey(w[i], w[(i + 1) % 3])] += 1;
+		}
+	}
+
+	// Seam vertices can't be moved (their wedges would lose their attributes), nor border ones (it would shrink the borders).
+	for (uint32_t i = 0; i < vertexCount; i++)
+	{
+		locked[i] = wedgeCounts[i] > 1 ? 1 : 0;
+	}
+
+	for (const std::pair<const uint64_t, uint32_t>& edge : edgeUses)
+	{
+		if (edge.second != 2)
+		{
+			locked[uint32_t(edge.first >> 32)] = 1;
+			locked[uint32_t(edge.first & 0xFFFFFFFF)] = 1;
+		}
+	}
+
+	std::priority_queue<Collapse, std::vector<Collapse>, std::greater<Collapse>> collapses;
+
+	auto pushCollapse = [&](uint32_t from, uint32_t to)
+	{
+		if (!locked[from])
+		{
+			Quadric quadric = quadrics[from];
+
+			quadric.add(quadrics[to]);
+
+			collapses.push({ quadric.evaluate(positions[to]), from, to, versions[from], versions[to] });
+		}
+	};
+
+	for (uint32_t t = 0; t < triangleCount; t++)
+	{
+		for (uint32_t i = 0; i < 3; i++)
+		{
+			uint32_t a = welded[triangles[3 * t + i]], b = welded[triangles[3 * t + (i + 1) % 3]];
+
+			pushCollapse(a, b);
+			pushCollapse(b, a);
+		}
+	}
+
+	uint32_t indexCount = uint32_t(indices.size());
+
+	std::vector<uint32_t> neighbours;
+
+	while (indexCount > targetIndexCount && !collapses.empty())
+	{
+		Collapse collapse = collapses.top();
+
+		collapses.pop();
+
+		if (collapse.fromVersion != versions[collapse.from] || collapse.toVersion != versions[collapse.to])
+		{
+			continue; // Outdated.
+		}
+
+		if (collapse.cost > maxCost)
+		{
+			break;
+		}
+
+		uint32_t from = collapse.from, to = collapse.to;
+		uint32_t toWedge = 0xFFFFFFFF;
+		bool valid = true;
+
+		// The triangles of "from" that don't use "to" are kept, moving "from" to the position of "to". Rejecting the collapse if any of them flips.
+		for (uint32_t t : vertexTriangles[from])
+		{
+			if (!aliveTriangles[t])
+			{
+				continue;
+			}
+
+			uint32_t w[3] = { welded[triangles[3 * t + 0]], welded[triangles[3 * t + 1]], welded[triangles[3 * t + 2]] };
+
+			if (w[0] == to || w[1] == to || w[2] == to)
+			{
+				for (uint32_t i = 0; i < 3; i++)
+				{
+					if (w[i] == to)
+					{
+						toWedge = triangles[3 * t + i];
+					}
+				}
+
+				continue;
+			}
+
+			glm::vec3 p[3] = { positions[w[0]], positions[w[1]], positions[w[2]] };
+			glm::vec3 normalBefore = glm::cross(p[1] - p[0], p[2] - p[0]);
+
+			for (uint32_t i = 0; i < 3; i++)
+			{
+				if (w[i] == from)
+				{
+					p[i] = positions[to];
+				}
+			}
+
+			glm::vec3 normalAfter = glm::cross(p[1] - p[0], p[2] - p[0]);
+
+			if (glm::dot(normalBefore, normalAfter) <= 0.0f)
+			{
+				valid = false;
+
+				break;
+			}
+		}
+
+		if (!valid || toWedge == 0xFFFFFFFF)
+		{
+			continue;
+		}
+
+		// "from" is never a seam vertex, so all its triangles are in the same chart and share the same wedge of "to".
+		for (uint32_t t : vertexTriangles[from])
+		{
+			if (!aliveTriangles[t])
+			{
+				continue;
+			}
+
+			uint32_t* triangle = &triangles[3 * t];
+
+			if (welded[triangle[0]] == to || welded[triangle[1]] == to || welded[triangle[2]] == to)
+			{
+				aliveTriangles[t] = 0;
+				indexCount -= 3;
+
+				continue;
+			}
+
+			for (uint32_t i = 0; i < 3; i++)
+			{
+				if (welded[triangle[i]] == from)
+				{
+					triangle[i] = toWedge;
+				}
+			}
+
+			vertexTriangles[to].push_back(t);
+		}
+
+		vertexTriangles[from].clear();
+
+		quadrics[to].add(quadrics[from]);
+
+		versions[from] += 1;
+		versions[to] += 1;
+
+		// Compacting the triangles of "to" and updating the collapses around it.
+		std::vector<uint32_t>& toTriangles = vertexTriangles[to];
+
+		toTriangles.erase(std::remove_if(toTriangles.begin(), toTriangles.end(), [&](uint32_t t) { return !aliveTriangles[t]; }), toTriangles.end());
+
+		neighbours.clear();
+
+		for (uint32_t t : toTriangles)
+		{
+			for (uint32_t i = 0; i < 3; i++)
+			{
+				uint32_t w = welded[triangles[3 * t + i]];
+
+				if (w != to)
+				{
+					neighbours.push_back(w);
+				}
+			}
+		}
+
+		std::sort(neighbours.begin(), neighbours.end());
+		neighbours.erase(std::unique(neighbours.begin(), neighbours.end()), neighbours.end());
+
+		for (uint32_t neighbour : neighbours)
+		{
+			pushCollapse(neighbour, to);
+			pushCollapse(to, neighbour);
+		}
+	}
+
+	std::vector<uint32_t> result;
+
+	result.reserve(indexCount);
+
+	for (uint32_t t = 0; t < triangleCount; t++)
+	{
+		if (aliveTriangles[t])
+		{
+			result.push_back(triangles[3 * t + 0]);
+			result.push_back(triangles[3 * t + 1]);
+			result.push_back(triangles[3 * t + 2]);
+		}
+	}
+
+	// The quadric cost is a mean of squared distances to planes, not a bound: the reported error is measured instead.
+	if (resultError)
+	{
+		*resultError = float(measureDeviation(positions, indices, result) / meshSize);
+	}
+
+	return result;
+}
+
+void MeshSimplifier::buildLodChain(const std::vector<glm::vec3>& positions, std::vector<uint32_t>& indices, std::vector<MeshLod>& lods,
+	uint32_t maxLods, float reductionRatio, float maxError)
+{
+	if (lods.empty())
+	{
+		lods.push_back({ 0, uint32_t(indices.size()), 0.0f });
+	}
+
+	std::vector<uint32_t> source(indices.begin() + lods.back().indexOffset, indices.begin() + lods.back().indexOffset + lods.back().indexCount);
+	std::vector<uint32_t> original(indices.begin() + lods[0].indexOffset, indices.begin() + lods[0].indexOffset + lods[0].indexCount);
+
+	double meshSize = getMeshSize(positions);
+
+	for (uint32_t i = 0; i < maxLods; i++)
+	{
+		uint32_t target = uint32_t(float(source.size() / 3) * reductionRatio) * 3;
+		std::vector<uint32_t> simplified = simplify(positions, source, target, maxError);
+
+		// Not worth a new LOD when it saves less than 10% of the triangles.
+		if (simplified.empty() || simplified.size() > source.size() * 9 / 10)
+		{
+			break;
+		}
+
+		// Measured against the LOD 0, since every LOD is simplified from the previous one.
+		float error = float(measureDeviation(positions, original, simplified) / meshSize);
+
+		lods.push_back({ uint32_t(indices.size()), uint32_t(simplified.size()), error });
+
+		indices.insert(indices.end(), simplified.begin(), simplified.end());
+
+		source.swap(simplified);
+	}
+}
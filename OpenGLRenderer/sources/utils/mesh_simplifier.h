@@ -0,0 +1,44 @@
+#pragma once
+
+#include <vector>
+#include <queue>
+#include <unordered_map>
+#include <cstdint>
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+#include <limits>
+
+#include <glm/glm.hpp>
+#include <glm/gtx/component_wise.hpp>
+
+// Range of a LOD inside the index buffer shared by all LODs of a mesh.
+struct MeshLod
+{
+	uint32_t indexOffset;
+	uint32_t indexCount;
+
+	float error; // Largest distance from a vertex of the LOD 0 to this LOD, relative to the mesh size.
+};
+
+// Quadric error metric (Garland-Heckbert) mesh simplifier.
+//
+// Uses half-edge collapses: a vertex is always collapsed onto one of its neighbours, so the simplified mesh only references
+// vertices of the original one. LODs are just new index buffers over the same vertex buffer, and vertex attributes stay valid.
+// Vertices on attribute seams (same position, different normal/uvs) or on open borders are never moved, which preserves the
+// silhouette of open meshes and the texture mapping.
+//
+class MeshSimplifier
+{
+public:
+	// Collapses edges until the index count reaches "targetIndexCount" or the next collapse would exceed "maxError"
+	// (relative to the mesh size, as a quadric cost). Returns the new index buffer and writes the measured error (largest
+	// distance from an input vertex to the simplified surface, relative to the mesh size) into "resultError".
+	static std::vector<uint32_t> simplify(const std::vector<glm::vec3>& positions, const std::vector<uint32_t>& indices,
+		uint32_t targetIndexCount, float maxError = 1.0f, float* resultError = nullptr);
+
+	// Appends up to "maxLods" simplified versions of the LOD 0 (the first "lods[0].indexCount" indices) to "indices",
+	// each one with "reductionRatio" of the triangles of the previous. Stops when the simplification can't make progress.
+	static void buildLodChain(const std::vector<glm::vec3>& positions, std::vector<uint32_t>& indices, std::vector<MeshLod>& lods,
+		uint32_t maxLods = 4, float reductionRatio = 0.5f, float maxError = 0.05f);
+};
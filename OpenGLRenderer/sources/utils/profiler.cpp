@@ -0,0 +1,129 @@
+#include "profiler.h"
+
+#ifdef ENABLE_PROFILER
+
+const uint32_t Profiler::THREAD_BUFFER_SIZE;
+const uint32_t Profiler::MAX_FRAMES;
+
+const std::chrono::steady_clock::time_point Profiler::startTime = std::chrono::steady_clock::now();
+
+std::vector<std::unique_ptr<Profiler::ThreadBuffer>> Profiler::threadBuffers;
+std::mutex Profiler::threadBuffersMutex;
+
+uint64_t Profiler::frameStarts[Profiler::MAX_FRAMES] = {};
+uint64_t Profiler::frameCounter = 0;
+
+// Buffer of the calling thread, registered by its first zone.
+static thread_local void* currentThreadBuffer = nullptr;
+
+void Profiler::recordZone(const char* name, uint64_t begin, uint64_t end)
+{
+	ThreadBuffer* buffer = getThreadBuffer();
+	uint64_t index = buffer->writeIndex.load(std::memory_order_relaxed);
+
+	buffer->zones[index % THREAD_BUFFER_SIZE] = { name, begin, end };
+
+	// Published after the zone is written, so "dumpTrace" never reads a zone being written (unless it was lapped).
+	buffer->writeIndex.store(index + 1, std::memory_order_release);
+}
+
+void Profiler::markFrame()
+{
+	frameStarts[frameCounter % MAX_FRAMES] = now();
+	frameCounter += 1;
+}
+
+void Profiler::setThreadName(const char* name)
+{
+	ThreadBuffer* buffer = getThreadBuffer();
+
+	std::lock_guard<std::mutex> lock(threadBuffersMutex);
+
+	buffer->name = name;
+}
+
+bool Profiler::dumpTrace(const char* filepath, uint32_t frameCount)
+{
+	std::ofstream file(filepath);
+
+	if (!file.is_open())
+	{
+		std::cout << "[ERROR] PROFILER: Failed to open trace file \"" << filepath << "\"." << std::endl;
+
+		return false;
+	}
+
+	// Zones ending before the first requested frame are skipped.
+	uint64_t startTime = 0;
+
+	frameCount = std::min(frameCount, MAX_FRAMES);
+
+	if (frameCount > 0 && frameCounter >= frameCount)
+	{
+		startTime = frameStarts[(frameCounter - frameCount) % MAX_FRAMES];
+	}
+
+	std::lock_guard<std::mutex> lock(threadBuffersMutex);
+
+	uint32_t zoneCount = 0;
+	bool firstEvent = true;
+
+	file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+	file.precision(3);
+	file << std::fixed;
+
+	for (const std::unique_ptr<ThreadBuffer>& buffer : threadBuffers)
+	{
+		file << (firstEvent ? "" : ",") << "\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":" << buffer->ID
+			<< ",\"args\":{\"name\":\"" << buffer->name << "\"}}";
+
+		firstEvent = false;
+
+		uint64_t end = buffer->writeIndex.load(std::memory_order_acquire);
+		uint64_t begin = end > THREAD_BUFFER_SIZE ? end - THREAD_BUFFER_SIZE : 0;
+
+		for (uint64_t i = begin; i < end; i++)
+		{
+			const Zone& zone = buffer->zones[i % THREAD_BUFFER_SIZE];
+
+			if (zone.end < startTime)
+			{
+				continue;
+			}
+
+			// Complete events ("X"), in microseconds.
+			file << ",\n{\"name\":\"" << zone.name << "\",\"cat\":\"cpu\",\"ph\":\"X\",\"pid\":0,\"tid\":" << buffer->ID
+				<< ",\"ts\":" << double(zone.begin) / 1000.0 << ",\"dur\":" << double(zone.end - zone.begin) / 1000.0 << "}";
+
+			zoneCount += 1;
+		}
+	}
+
+	file << "\n]}\n";
+
+	std::cout << "[LOG] PROFILER: " << zoneCount << " zones of " << threadBuffers.size() << " threads written to \"" << filepath << "\"." << std::endl;
+
+	return true;
+}
+
+Profiler::ThreadBuffer* Profiler::getThreadBuffer()
+{
+	if (currentThreadBuffer == nullptr)
+	{
+		std::lock_guard<std::mutex> lock(threadBuffersMutex);
+
+		std::unique_ptr<ThreadBuffer> buffer(new ThreadBuffer());
+
+		buffer->ID = uint32_t(threadBuffers.size());
+		buffer->name = "Thread " + std::to_string(buffer->ID);
+		buffer->zones.resize(THREAD_BUFFER_SIZE);
+
+		currentThreadBuffer = buffer.get();
+
+		threadBuffers.push_back(std::move(buffer));
+	}
+
+	return (ThreadBuffer*)currentThreadBuffer;
+}
+
+#endif
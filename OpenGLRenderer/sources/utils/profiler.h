@@ -0,0 +1,107 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <memory>
+#include <atomic>
+#include <mutex>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <algorithm>
+
+// CPU profiler with scoped zones, exported as Chrome trace events (chrome://tracing or https://ui.perfetto.dev).
+//
+// "PROFILE_ZONE(name)" measures the rest of the enclosing scope, the name must be a string literal. Every thread writes
+// its zones into its own ring buffer without locks, only the first zone of a thread takes a lock (to register its buffer).
+// "PROFILE_FRAME()" marks the start of a frame, so a dump can be limited to the last frames.
+//
+// The instrumentation only exists when "ENABLE_PROFILER" is defined (Debug configurations of the project). Otherwise the
+// macros expand to nothing and this header declares nothing else.
+//
+#ifdef ENABLE_PROFILER
+
+#define PROFILER_CONCAT_IMPL(a, b) a##b
+#define PROFILER_CONCAT(a, b) PROFILER_CONCAT_IMPL(a, b)
+
+#define PROFILE_ZONE(name) ProfilerZone PROFILER_CONCAT(profilerZone, __LINE__)(name)
+#define PROFILE_FRAME() Profiler::markFrame()
+#define PROFILE_THREAD_NAME(name) Profiler::setThreadName(name)
+
+class Profiler
+{
+public:
+	// Zones kept per thread, the oldest ones are overwritten.
+	static const uint32_t THREAD_BUFFER_SIZE = 1 << 16;
+
+	// Frames that can be dumped.
+	static const uint32_t MAX_FRAMES = 120;
+
+	// Nanoseconds since the start of the program.
+	static uint64_t now()
+	{
+		return uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - startTime).count());
+	}
+
+	static void recordZone(const char* name, uint64_t begin, uint64_t end);
+
+	// Call from the main thread, once per frame.
+	static void markFrame();
+
+	static void setThreadName(const char* name);
+
+	// Writes the zones of the last "frameCount" frames (all kept zones with 0). Call between frames, while the workers are idle.
+	static bool dumpTrace(const char* filepath, uint32_t frameCount = MAX_FRAMES);
+
+private:
+	struct Zone
+	{
+		const char* name;
+		uint64_t begin, end;
+	};
+
+	struct ThreadBuffer
+	{
+		uint32_t ID;
+		std::string name;
+
+		std::vector<Zone> zones;
+		std::atomic<uint64_t> writeIndex{ 0 }; // Written only by the owner thread.
+	};
+
+	static const std::chrono::steady_clock::time_point startTime;
+
+	static std::vector<std::unique_ptr<ThreadBuffer>> threadBuffers;
+	static std::mutex threadBuffersMutex;
+
+	static uint64_t frameStarts[MAX_FRAMES];
+	static uint64_t frameCounter;
+
+	static ThreadBuffer* getThreadBuffer();
+};
+
+class ProfilerZone
+{
+public:
+	ProfilerZone(const char* name)
+		: name(name), begin(Profiler::now())
+	{}
+
+	~ProfilerZone()
+	{
+		Profiler::recordZone(name, begin, Profiler::now());
+	}
+
+private:
+	const char* name;
+	uint64_t begin;
+};
+
+#else
+
+#define PROFILE_ZONE(name)
+#define PROFILE_FRAME()
+#define PROFILE_THREAD_NAME(name)
+
+#endif
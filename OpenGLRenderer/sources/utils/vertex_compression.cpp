@@ -0,0 +1,151 @@
+#include "vertex_compression.h"
+
+static constexpr UniformName POSITION_ORIGIN_UNIFORM("uPositionOrigin");
+static constexpr UniformName POSITION_SCALE_UNIFORM("uPositionScale");
+static constexpr UniformName OCTAHEDRAL_NORMALS_UNIFORM("uOctahedralNormals");
+
+static const float MAX_UINT16 = 65535.0f;
+
+static float signNotZero(float value)
+{
+	return value >= 0.0f ? 1.0f : -1.0f;
+}
+
+PositionQuantization computePositionQuantization(const AABBBounds& bounds)
+{
+	PositionQuantization quantization;
+
+	quantization.origin = bounds.center - bounds.extents;
+
+	// Flat models (e.g. a plane) would divide by zero.
+	quantization.scale = glm::max(bounds.extents * 2.0f, glm::vec3(1e-6f));
+
+	return quantization;
+}
+
+void quantizePosition(const glm::vec3& position, const PositionQuantization& quantization, uint16_t* quantizedPosition)
+{
+	glm::vec3 normalized = glm::clamp((position - quantization.origin) / quantization.scale, 0.0f, 1.0f);
+
+	for (int i = 0; i < 3; i++)
+	{
+		quantizedPosition[i] = uint16_t(std::round(normalized[i] * MAX_UINT16));
+	}
+}
+
+glm::vec3 dequantizePosition(const uint16_t* quantizedPosition, const PositionQuantization& quantization)
+{
+	glm::vec3 normalized(quantizedPosition[0] / MAX_UINT16, quantizedPosition[1] / MAX_UINT16, quantizedPosition[2] / MAX_UINT16);
+
+	return quantization.origin + normalized * quantization.scale;
+}
+
+uint32_t encodeOctahedral(const glm::vec3& normal)
+{
+	glm::vec3 n = normal / (std::abs(normal.x) + std::abs(normal.y) + std::abs(normal.z));
+	glm::vec2 encoded(n.x, n.y);
+
+	// Folding the lower hemisphere over the diagonals of the square.
+	if (n.z < 0.0f)
+	{
+		encoded.x = (1.0f - std::abs(n.y)) * signNotZero(n.x);
+		encoded.y = (1.0f - std::abs(n.x)) * signNotZero(n.y);
+	}
+
+	return glm::packSnorm2x16(encoded);
+}
+
+glm::vec3 decodeOctahedral(uint32_t encodedNormal)
+{
+	glm::vec2 encoded = glm::unpackSnorm2x16(encodedNormal);
+	glm::vec3 n(encoded.x, encoded.y, 1.0f - std::abs(encoded.x) - std::abs(encoded.y));
+
+	float t = std::max(-n.z, 0.0f);
+
+	n.x -= t * signNotZero(n.x);
+	n.y -= t * signNotZero(n.y);
+
+	return glm::normalize(n);
+}
+
+uint32_t encodeHalf2(const glm::vec2& value)
+{
+	return glm::packHalf2x16(value);
+}
+
+glm::vec2 decodeHalf2(uint32_t encodedValue)
+{
+	return glm::unpackHalf2x16(encodedValue);
+}
+
+void encodeBoneWeights(const int* boneIDs, const float* weights, uint32_t count, uint8_t* encodedBoneIDs, uint8_t* encodedWeights)
+{
+	float totalWeight = 0.0f;
+
+	for (uint32_t i = 0; i < count; i++)
+	{
+		if (boneIDs[i] != -1)
+		{
+			totalWeight += weights[i];
+		}
+	}
+
+	// Largest remainder rounding: flooring every weight, then giving the missing units to the largest fractional parts.
+	std::vector<float> remainders(count, -1.0f);
+	int remainingUnits = totalWeight > 0.0f ? 255 : 0;
+
+	for (uint32_t i = 0; i < count; i++)
+	{
+		encodedBoneIDs[i] = boneIDs[i] != -1 ? uint8_t(boneIDs[i]) : 0;
+		encodedWeights[i] = 0;
+
+		if (boneIDs[i] != -1 && totalWeight > 0.0f)
+		{
+			float units = weights[i] / totalWeight * 255.0f;
+
+			encodedWeights[i] = uint8_t(std::floor(units));
+			remainders[i] = units - std::floor(units);
+
+			remainingUnits -= encodedWeights[i];
+		}
+	}
+
+	while (remainingUnits > 0)
+	{
+		uint32_t largest = uint32_t(std::max_element(remainders.begin(), remainders.end()) - remainders.begin());
+
+		encodedWeights[largest] += 1;
+		remainders[largest] = -1.0f;
+
+		remainingUnits -= 1;
+	}
+}
+
+bool canUseShortIndices(uint32_t vertexCount)
+{
+	return vertexCount <= 65536;
+}
+
+std::vector<uint16_t> narrowIndices(const std::vector<uint32_t>& indices)
+{
+	std::vector<uint16_t> shortIndices(indices.size());
+
+	for (size_t i = 0; i < indices.size(); i++)
+	{
+		shortIndices[i] = uint16_t(indices[i]);
+	}
+
+	return shortIndices;
+}
+
+uint32_t getIndexSize(uint32_t indexType)
+{
+	return indexType == GL_UNSIGNED_SHORT ? sizeof(uint16_t) : sizeof(uint32_t);
+}
+
+void setVertexFormatUniforms(ShaderProgram* shader, VertexFormat format, const PositionQuantization& quantization)
+{
+	shader->setUniform3f(shader->findUniform(POSITION_ORIGIN_UNIFORM), quantization.origin);
+	shader->setUniform3f(shader->findUniform(POSITION_SCALE_UNIFORM), quantization.scale);
+	shader->setUniform1i(shader->findUniform(OCTAHEDRAL_NORMALS_UNIFORM), format == VertexFormat::PACKED ? 1 : 0);
+}
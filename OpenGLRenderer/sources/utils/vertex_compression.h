@@ -0,0 +1,62 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cmath>
+#include <algorithm>
+
+#include <glad/glad.h>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/packing.hpp>
+
+#include "../graphics/shader.h"
+#include "../utils/bounds.h"
+
+// Layout of the vertex buffers of a model. Models keep their full precision vertices on the CPU either way.
+//
+//   FULL:   32 bits floats for everything (and 32 bits bone IDs).
+//   PACKED: positions quantized to 16 bits inside the model AABB, octahedral normals (2x 16 bits), half float UVs,
+//           8 bits bone IDs and 8 bits normalized weights.
+//
+enum class VertexFormat { FULL, PACKED };
+
+// Maps 16 bits normalized positions (in [0, 1]) back to the model space, as "origin + position * scale".
+// The default value is the identity, used by full precision vertices.
+struct PositionQuantization
+{
+	glm::vec3 origin = { 0.0f, 0.0f, 0.0f };
+	glm::vec3 scale = { 1.0f, 1.0f, 1.0f };
+};
+
+PositionQuantization computePositionQuantization(const AABBBounds& bounds);
+
+void quantizePosition(const glm::vec3& position, const PositionQuantization& quantization, uint16_t* quantizedPosition);
+glm::vec3 dequantizePosition(const uint16_t* quantizedPosition, const PositionQuantization& quantization);
+
+// Unit vector projected onto an octahedron, unfolded into a square and stored as two 16 bits normalized components.
+// The error is bounded (below 0.05 degrees), unlike storing only "x" and "y" of the normal.
+uint32_t encodeOctahedral(const glm::vec3& normal);
+glm::vec3 decodeOctahedral(uint32_t encodedNormal);
+
+uint32_t encodeHalf2(const glm::vec2& value);
+glm::vec2 decodeHalf2(uint32_t encodedValue);
+
+// Unused bones (ID "-1") become bone 0 with a null weight. Weights are rounded so their sum is exactly 255,
+// otherwise the skinned vertex would be slightly scaled. Bone IDs must be lower than 256.
+void encodeBoneWeights(const int* boneIDs, const float* weights, uint32_t count, uint8_t* encodedBoneIDs, uint8_t* encodedWeights);
+
+// 16 bits indices can address up to 65536 vertices.
+bool canUseShortIndices(uint32_t vertexCount);
+std::vector<uint16_t> narrowIndices(const std::vector<uint32_t>& indices);
+
+uint32_t getIndexSize(uint32_t indexType);
+
+// Sets the decoding uniforms of the vertex shaders that accept packed vertices:
+//
+//   uniform vec3 uPositionOrigin;
+//   uniform vec3 uPositionScale;
+//   uniform bool uOctahedralNormals;
+//
+// Programs without them are ignored, so the same model can be drawn with any program.
+void setVertexFormatUniforms(ShaderProgram* shader, VertexFormat format, const PositionQuantization& quantization);